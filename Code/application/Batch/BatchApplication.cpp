@@ -15,9 +15,13 @@
 #include "ApplicationServicesImp.h"
 #include "ArgumentList.h"
 #include "BatchApplication.h"
+#include "BatchScheduler.h"
 #include "ConfigurationSettingsImp.h"
 #include "InstallerServicesImp.h"
+#include "PlugInArg.h"
+#include "PlugInArgList.h"
 #include "PlugInManagerServicesImp.h"
+#include "PlugInResource.h"
 #include "ProgressBriefConsole.h"
 #include "ProgressConsole.h"
 #include "SessionManagerImp.h"
@@ -25,7 +29,9 @@
 #include <QtCore/QDirIterator>
 #include <QtCore/QFile>
 #include <QtCore/QString>
+#include <QtCore/QStringList>
 
+#include <algorithm>
 #include <vector>
 using namespace std;
 
@@ -211,7 +217,26 @@ int BatchApplication::run(int argc, char** argv)
       pManager->executeStartupPlugIns(mpProgress);
    }
 
-   bool bSuccess = executeStartupBatchWizards();
+   // Run the batch files in worker processes if requested
+   unsigned int processCount = 0;
+   if (getUnsignedOption("processes", 1, 1024, processCount) == false)
+   {
+      return -1;
+   }
+
+   bool bSuccess = false;
+   if (pArgumentList != NULL && pArgumentList->exists("benchmark") == true)
+   {
+      bSuccess = executeBenchmarks();
+   }
+   else if (processCount > 1)
+   {
+      bSuccess = executeScheduledBatchWizards(processCount, bVeryBrief);
+   }
+   else
+   {
+      bSuccess = executeStartupBatchWizards();
+   }
 
    // Close the session to cleanup created objects
    SessionManagerImp::instance()->close();
@@ -234,6 +259,134 @@ int BatchApplication::run(int argc, char** argv)
    return -1;
 }
 
+bool BatchApplication::executeScheduledBatchWizards(unsigned int processCount, bool bVeryBrief)
+{
+   ArgumentList* pArgumentList = ArgumentList::instance();
+   if (pArgumentList == NULL)
+   {
+      return false;
+   }
+
+   vector<string> batchFiles = pArgumentList->getOptions("input");
+   if (batchFiles.empty() == true)
+   {
+      return true;
+   }
+
+   // Share the processors between the workers and pass on the deployment
+   const QString dlm = QString::fromStdString(pArgumentList->getDelimiter());
+   unsigned int workerThreads = max(ConfigurationSettings::getSettingThreadCount() / processCount, 1u);
+
+   QStringList workerArguments;
+   workerArguments << dlm + (bVeryBrief ? "verybrief" : "brief");
+   workerArguments << dlm + "processors:" + QString::number(workerThreads);
+
+   string deployment = pArgumentList->getOption("deployment");
+   if (deployment.empty() == false)
+   {
+      workerArguments << dlm + "deployment:" + QString::fromStdString(deployment);
+   }
+
+   string debugDeployment = pArgumentList->getOption("debugDeployment");
+   if (debugDeployment.empty() == false)
+   {
+      workerArguments << dlm + "debugDeployment:" + QString::fromStdString(debugDeployment);
+   }
+
+   unsigned int retryCount = 0;
+   unsigned int memoryLimit = 0;
+   if (getUnsignedOption("retries", 0, 100, retryCount) == false ||
+      getUnsignedOption("memory", 0, 4194304, memoryLimit) == false)
+   {
+      return false;
+   }
+
+   BatchScheduler scheduler(mpProgress);
+   scheduler.setProcessCount(processCount);
+   scheduler.setRetryCount(retryCount);
+   scheduler.setMemoryLimit(memoryLimit);
+   scheduler.setResultsFilename(pArgumentList->getOption("results"));
+   scheduler.setWorkerArguments(workerArguments);
+
+   return scheduler.run(batchFiles);
+}
+
+bool BatchApplication::executeBenchmarks()
+{
+   ArgumentList* pArgumentList = ArgumentList::instance();
+   if (pArgumentList == NULL)
+   {
+      return false;
+   }
+
+   // Each timing test runs with its default input values and reports its results as double output arguments
+   bool bSuccess = true;
+   vector<string> plugInNames = pArgumentList->getOptions("benchmark");
+   for (vector<string>::const_iterator iter = plugInNames.begin(); iter != plugInNames.end(); ++iter)
+   {
+      ExecutableResource pPlugIn(*iter, string(), mpProgress, true);
+      if (pPlugIn->getPlugIn() == NULL)
+      {
+         reportError("The " + *iter + " plug-in could not be found.");
+         bSuccess = false;
+         continue;
+      }
+
+      if (pPlugIn->execute() == false)
+      {
+         reportError("The " + *iter + " plug-in failed.");
+         bSuccess = false;
+         continue;
+      }
+
+      cout << endl << *iter << ":" << endl;
+      PlugInArgList& outArgList = pPlugIn->getOutArgList();
+      for (unsigned short i = 0; i < outArgList.getCount(); ++i)
+      {
+         PlugInArg* pArg = NULL;
+         if (outArgList.getArg(i, pArg) == true && pArg != NULL)
+         {
+            double* pValue = pArg->getPlugInArgValue<double>();
+            if (pValue != NULL)
+            {
+               cout << "   " << pArg->getName() << ": " << *pValue << endl;
+            }
+         }
+      }
+   }
+
+   return bSuccess;
+}
+
+bool BatchApplication::getUnsignedOption(const string& option, unsigned int minimum, unsigned int maximum,
+                                         unsigned int& value) const
+{
+   // An option which is not given keeps its default value
+   ArgumentList* pArgumentList = ArgumentList::instance();
+   if (pArgumentList == NULL)
+   {
+      return true;
+   }
+
+   string optionValue = pArgumentList->getOption(option);
+   if (optionValue.empty() == true)
+   {
+      return true;
+   }
+
+   bool ok = false;
+   unsigned int parsedValue = QString::fromStdString(optionValue).toUInt(&ok);
+   if (ok == false || parsedValue < minimum || parsedValue > maximum)
+   {
+      reportError("The " + pArgumentList->getDelimiter() + option + " value must be a whole number from " +
+         QString::number(minimum).toStdString() + " to " + QString::number(maximum).toStdString() + ".");
+      return false;
+   }
+
+   value = parsedValue;
+   return true;
+}
+
 void BatchApplication::reportWarning(const string& warningMessage) const
 {
    if (warningMessage.empty() == false)
@@ -32,6 +32,11 @@ public:
    void reportError(const std::string& errorMessage) const;
 
 private:
+   bool executeScheduledBatchWizards(unsigned int processCount, bool bVeryBrief);
+   bool executeBenchmarks();
+   bool getUnsignedOption(const std::string& option, unsigned int minimum, unsigned int maximum,
+      unsigned int& value) const;
+
    BatchApplication& operator=(const BatchApplication& rhs);
 };
 
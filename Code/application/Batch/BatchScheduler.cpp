@@ -0,0 +1,415 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2007 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#include "AppConfig.h"
+#include "ArgumentList.h"
+#include "BatchFileParser.h"
+#include "BatchFileset.h"
+#include "BatchScheduler.h"
+#include "BatchWizard.h"
+#include "ConfigurationSettings.h"
+#include "Filename.h"
+#include "ObjectFactory.h"
+#include "Progress.h"
+#include "Value.h"
+#include "WizardUtilities.h"
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QDateTime>
+#include <QtCore/QDir>
+#include <QtCore/QFileInfo>
+#include <QtCore/QProcess>
+#include <QtCore/QTextStream>
+
+#if !defined(WIN_API)
+#include <sys/resource.h>
+#endif
+
+#include <algorithm>
+#include <deque>
+#include <memory>
+using namespace std;
+
+namespace
+{
+   const int sPollInterval = 100;
+
+   class WorkerProcess : public QProcess
+   {
+   public:
+      WorkerProcess(unsigned int memoryLimit) :
+         mMemoryLimit(memoryLimit)
+      {
+      }
+
+   protected:
+      void setupChildProcess()
+      {
+#if !defined(WIN_API)
+         // Runs in the child after the fork, so the limit only applies to the worker
+         if (mMemoryLimit > 0)
+         {
+            struct rlimit limit;
+            limit.rlim_cur = static_cast<rlim_t>(mMemoryLimit) * 1024 * 1024;
+            limit.rlim_max = limit.rlim_cur;
+            setrlimit(RLIMIT_AS, &limit);
+         }
+#endif
+      }
+
+   private:
+      unsigned int mMemoryLimit;
+   };
+}
+
+BatchScheduler::BatchScheduler(Progress* pProgress) :
+   mpProgress(pProgress),
+   mProcessCount(1),
+   mRetryCount(0),
+   mMemoryLimit(0),
+   mSucceeded(0),
+   mFailed(0)
+{
+}
+
+BatchScheduler::~BatchScheduler()
+{
+   for (QStringList::const_iterator iter = mJobFiles.begin(); iter != mJobFiles.end(); ++iter)
+   {
+      QFile::remove(*iter);
+   }
+}
+
+void BatchScheduler::setProcessCount(unsigned int count)
+{
+   mProcessCount = max(count, 1u);
+}
+
+void BatchScheduler::setRetryCount(unsigned int count)
+{
+   mRetryCount = count;
+}
+
+void BatchScheduler::setMemoryLimit(unsigned int megabytes)
+{
+   mMemoryLimit = megabytes;
+}
+
+void BatchScheduler::setWorkerArguments(const QStringList& arguments)
+{
+   mWorkerArguments = arguments;
+}
+
+void BatchScheduler::setResultsFilename(const string& filename)
+{
+   mResultsFilename = filename;
+}
+
+bool BatchScheduler::run(const vector<string>& batchFiles)
+{
+   // Create a directory for the job batch files and the worker logs
+   QString tempPath = QDir::tempPath();
+   const Filename* pTempPath = ConfigurationSettings::getSettingTempPath();
+   if (pTempPath != NULL)
+   {
+      tempPath = QString::fromStdString(pTempPath->getFullPathAndName());
+   }
+
+   mJobDirectory = QDir(tempPath).absoluteFilePath(QString("BatchJobs-%1-%2").arg(
+      QDateTime::currentDateTime().toString("yyyyMMdd-hhmmss")).arg(QCoreApplication::applicationPid()));
+   if (QDir().mkpath(mJobDirectory) == false)
+   {
+      if (mpProgress != NULL)
+      {
+         mpProgress->updateProgress("Unable to create the batch job directory: " + mJobDirectory.toStdString(),
+            0, ERRORS);
+      }
+
+      return false;
+   }
+
+   QString resultsFilename = QString::fromStdString(mResultsFilename);
+   if (resultsFilename.isEmpty() == true)
+   {
+      resultsFilename = QDir(mJobDirectory).absoluteFilePath("results.log");
+   }
+
+   mResults.setFileName(resultsFilename);
+   if (mResults.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text) == false)
+   {
+      if (mpProgress != NULL)
+      {
+         mpProgress->updateProgress("Unable to open the batch results log: " + resultsFilename.toStdString(),
+            0, ERRORS);
+      }
+
+      return false;
+   }
+
+   if (mpProgress != NULL)
+   {
+      mpProgress->updateProgress("Writing batch results to: " + resultsFilename.toStdString(), 0, NORMAL);
+   }
+
+   bool bSuccess = true;
+   for (vector<string>::const_iterator fileIter = batchFiles.begin(); fileIter != batchFiles.end(); ++fileIter)
+   {
+      BatchFileParser fileParser;
+      if (fileParser.setFile(*fileIter) == false)
+      {
+         if (mpProgress != NULL)
+         {
+            mpProgress->updateProgress(fileParser.getError(), 0, ERRORS);
+         }
+
+         bSuccess = false;
+         continue;
+      }
+
+      // Jobs of the next wizard start once every job of the current wizard has finished
+      for (auto_ptr<BatchWizard> pBatchWizard(fileParser.read()); pBatchWizard.get() != NULL;
+         pBatchWizard.reset(fileParser.read()))
+      {
+         vector<Job> jobs;
+         if (createJobs(pBatchWizard.get(), jobs) == false)
+         {
+            bSuccess = false;
+            continue;
+         }
+
+         bSuccess = runJobs(jobs) && bSuccess;
+      }
+   }
+
+   QTextStream results(&mResults);
+   results << QDateTime::currentDateTime().toString(Qt::ISODate) << "\tSUMMARY\t" << mSucceeded <<
+      " succeeded, " << mFailed << " failed" << endl;
+   mResults.close();
+
+   if (mpProgress != NULL)
+   {
+      QString message = QString("Batch processing complete: %1 succeeded, %2 failed").arg(mSucceeded).arg(mFailed);
+      mpProgress->updateProgress(message.toStdString(), 100, bSuccess ? NORMAL : WARNING);
+   }
+
+   return bSuccess;
+}
+
+bool BatchScheduler::createJobs(BatchWizard* pBatchWizard, vector<Job>& jobs)
+{
+   Service<ObjectFactory> pObjFact;
+   pBatchWizard->initializeFilesets(pObjFact.get());
+
+   string repeatName;
+   bool bRepeatWizard = pBatchWizard->isRepeating(repeatName);
+
+   bool bCreatedOnce = false;
+   while ((!bRepeatWizard && !bCreatedOnce) || !pBatchWizard->isComplete())
+   {
+      // Each file set of the job contains only the current file of the original file set
+      BatchWizard jobWizard;
+      jobWizard.setWizardFilename(pBatchWizard->getWizardFilename());
+      jobWizard.setCleanup(pBatchWizard->doesCleanup());
+
+      vector<BatchFileset*> jobFilesets;
+      string repeatFile;
+
+      const vector<BatchFileset*>& filesets = pBatchWizard->getFilesets();
+      for (vector<BatchFileset*>::const_iterator iter = filesets.begin(); iter != filesets.end(); ++iter)
+      {
+         BatchFileset* pFileset = *iter;
+         if (pFileset == NULL)
+         {
+            continue;
+         }
+
+         BatchFileset* pJobFileset = new BatchFileset();
+         pJobFileset->setName(pFileset->getName());
+         pJobFileset->setDirectory(pFileset->getDirectory());
+         jobFilesets.push_back(pJobFileset);
+
+         string currentFile = pFileset->getCurrentFile();
+         if (currentFile.empty() == false)
+         {
+            QFileInfo fileInfo(QString::fromStdString(currentFile));
+            pJobFileset->setDirectory(fileInfo.absolutePath().toStdString());
+            pJobFileset->addFilesetRequirement(BatchFileset::INCLUDE, fileInfo.fileName().toStdString());
+         }
+
+         if (bRepeatWizard == true && pFileset->getName() == repeatName)
+         {
+            jobWizard.setRepeatFileset(pJobFileset);
+            repeatFile = currentFile;
+         }
+         else
+         {
+            jobWizard.addFileset(pJobFileset);
+         }
+      }
+
+      const vector<Value*>& values = pBatchWizard->getInputValues();
+      for (vector<Value*>::const_iterator iter = values.begin(); iter != values.end(); ++iter)
+      {
+         Value* pValue = *iter;
+         if (pValue != NULL)
+         {
+            jobWizard.setInputValue(pValue->getItemName(), pValue->getNodeName(), pValue->getNodeType(),
+               pValue->getValue());
+         }
+      }
+
+      Job job;
+      job.mBatchFile = QDir(mJobDirectory).absoluteFilePath(QString("job%1.batchwiz").arg(mJobFiles.size() + 1));
+      job.mLogFile = job.mBatchFile + ".log";
+      job.mDescription = QString::fromStdString(pBatchWizard->getWizardFilename());
+      if (repeatFile.empty() == false)
+      {
+         job.mDescription += " (" + QString::fromStdString(repeatFile) + ")";
+      }
+      job.mAttempts = 0;
+
+      bool bWritten = WizardUtilities::writeBatchWizard(vector<BatchWizard*>(1, &jobWizard),
+         job.mBatchFile.toStdString());
+      for (vector<BatchFileset*>::iterator iter = jobFilesets.begin(); iter != jobFilesets.end(); ++iter)
+      {
+         delete *iter;
+      }
+
+      if (bWritten == false)
+      {
+         if (mpProgress != NULL)
+         {
+            mpProgress->updateProgress("Unable to write the batch job file: " + job.mBatchFile.toStdString(),
+               0, ERRORS);
+         }
+
+         return false;
+      }
+
+      mJobFiles.append(job.mBatchFile);
+      jobs.push_back(job);
+
+      pBatchWizard->updateFilesets();
+      bCreatedOnce = true;
+   }
+
+   return true;
+}
+
+bool BatchScheduler::runJobs(vector<Job>& jobs)
+{
+   deque<unsigned int> pending;
+   for (unsigned int i = 0; i < jobs.size(); ++i)
+   {
+      pending.push_back(i);
+   }
+
+   vector<pair<WorkerProcess*, unsigned int> > running;
+   unsigned int completed = 0;
+   bool bSuccess = true;
+
+   while (pending.empty() == false || running.empty() == false)
+   {
+      // Start jobs until every worker is busy
+      while (running.size() < mProcessCount && pending.empty() == false)
+      {
+         unsigned int index = pending.front();
+         pending.pop_front();
+
+         Job& job = jobs[index];
+         ++job.mAttempts;
+         job.mTimer.start();
+
+         if (mpProgress != NULL)
+         {
+            QString message = "Processing: " + job.mDescription;
+            if (job.mAttempts > 1)
+            {
+               message += QString(" (attempt %1)").arg(job.mAttempts);
+            }
+
+            mpProgress->updateProgress(message.toStdString(), completed * 100 / jobs.size(), NORMAL);
+         }
+
+         QStringList arguments = mWorkerArguments;
+         arguments << QString::fromStdString(ArgumentList::instance()->getDelimiter()) + "input:" + job.mBatchFile;
+
+         WorkerProcess* pProcess = new WorkerProcess(mMemoryLimit);
+         pProcess->setProcessChannelMode(QProcess::MergedChannels);
+         pProcess->setStandardOutputFile(job.mLogFile, QIODevice::Append);
+         pProcess->start(QCoreApplication::applicationFilePath(), arguments);
+         running.push_back(make_pair(pProcess, index));
+      }
+
+      // Poll the workers, giving each a share of the poll interval
+      int interval = max(sPollInterval / static_cast<int>(running.size()), 1);
+      for (vector<pair<WorkerProcess*, unsigned int> >::iterator iter = running.begin(); iter != running.end();)
+      {
+         WorkerProcess* pProcess = iter->first;
+         if (pProcess->waitForFinished(interval) == false && pProcess->state() != QProcess::NotRunning)
+         {
+            ++iter;
+            continue;
+         }
+
+         Job& job = jobs[iter->second];
+         bool bJobSuccess = (pProcess->error() != QProcess::FailedToStart &&
+            pProcess->exitStatus() == QProcess::NormalExit && pProcess->exitCode() == 0);
+         int exitCode = (pProcess->error() == QProcess::FailedToStart ? -1 : pProcess->exitCode());
+
+         if (bJobSuccess == false && job.mAttempts <= mRetryCount)
+         {
+            if (mpProgress != NULL)
+            {
+               mpProgress->updateProgress("Job failed and will be retried: " + job.mDescription.toStdString(),
+                  completed * 100 / jobs.size(), WARNING);
+            }
+
+            pending.push_back(iter->second);
+         }
+         else
+         {
+            ++completed;
+            writeResult(job, bJobSuccess, exitCode);
+            if (bJobSuccess == false)
+            {
+               bSuccess = false;
+               if (mpProgress != NULL)
+               {
+                  mpProgress->updateProgress("Job failed: " + job.mDescription.toStdString() + "\nSee " +
+                     job.mLogFile.toStdString(), completed * 100 / jobs.size(), WARNING);
+               }
+            }
+         }
+
+         delete pProcess;
+         iter = running.erase(iter);
+      }
+   }
+
+   return bSuccess;
+}
+
+void BatchScheduler::writeResult(const Job& job, bool bSuccess, int exitCode)
+{
+   if (bSuccess == true)
+   {
+      ++mSucceeded;
+   }
+   else
+   {
+      ++mFailed;
+   }
+
+   QTextStream results(&mResults);
+   results << QDateTime::currentDateTime().toString(Qt::ISODate) << "\t" << (bSuccess ? "SUCCESS" : "FAILURE") <<
+      "\t" << "attempts=" << job.mAttempts << "\t" << "exit=" << exitCode << "\t" <<
+      QString::number(job.mTimer.elapsed() / 1000.0, 'f', 1) << "s\t" << job.mDescription << "\t" <<
+      job.mLogFile << endl;
+}
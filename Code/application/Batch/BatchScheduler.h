@@ -0,0 +1,138 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2007 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#ifndef BATCHSCHEDULER_H
+#define BATCHSCHEDULER_H
+
+#include <QtCore/QFile>
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+#include <QtCore/QTime>
+
+#include <string>
+#include <vector>
+
+class BatchWizard;
+class Progress;
+
+/**
+ *  Runs batch files in worker processes of the batch application.
+ *
+ *  Each wizard in a batch file is split into one job for each file in its
+ *  repeating file set.  Every job is written to its own batch file and run by
+ *  a separate process, with up to the process count running at once.  The jobs
+ *  of a wizard must all finish before the next wizard starts, so a wizard which
+ *  uses the output of a previous wizard behaves as it does when run sequentially.
+ *
+ *  A failed job is run again until it succeeds or the retry count is reached.
+ *  The outcome of each job is written to a results log as the job finishes, and
+ *  the output of each worker process is written to a log file next to its job.
+ */
+class BatchScheduler
+{
+public:
+   /**
+    *  Creates the scheduler.
+    *
+    *  @param   pProgress
+    *           The progress object to update.  This may be \c NULL.
+    */
+   BatchScheduler(Progress* pProgress);
+
+   /**
+    *  Destroys the scheduler and removes the job batch files.
+    */
+   ~BatchScheduler();
+
+   /**
+    *  Sets the maximum number of worker processes to run at once.
+    *
+    *  @param   count
+    *           The number of processes.  The default is one.
+    */
+   void setProcessCount(unsigned int count);
+
+   /**
+    *  Sets the number of times a failed job is run again.
+    *
+    *  @param   count
+    *           The number of retries.  The default is zero.
+    */
+   void setRetryCount(unsigned int count);
+
+   /**
+    *  Sets the address space available to each worker process.
+    *
+    *  The limit is not applied on Windows.
+    *
+    *  @param   megabytes
+    *           The limit in megabytes, or zero for no limit.  The default is zero.
+    */
+   void setMemoryLimit(unsigned int megabytes);
+
+   /**
+    *  Sets the arguments passed to every worker process in addition to its batch file.
+    *
+    *  @param   arguments
+    *           The command line arguments.
+    */
+   void setWorkerArguments(const QStringList& arguments);
+
+   /**
+    *  Sets the file to which the outcome of each job is written.
+    *
+    *  @param   filename
+    *           The results log filename.  If empty, the log is written to the
+    *           directory containing the job batch files.
+    */
+   void setResultsFilename(const std::string& filename);
+
+   /**
+    *  Runs the wizards in the given batch files.
+    *
+    *  @param   batchFiles
+    *           The batch files to run, in order.
+    *
+    *  @return  Returns \c true if every job succeeded, otherwise \c false.
+    */
+   bool run(const std::vector<std::string>& batchFiles);
+
+private:
+   struct Job
+   {
+      QString mBatchFile;
+      QString mLogFile;
+      QString mDescription;
+      unsigned int mAttempts;
+      QTime mTimer;
+   };
+
+   bool createJobs(BatchWizard* pBatchWizard, std::vector<Job>& jobs);
+   bool runJobs(std::vector<Job>& jobs);
+   void writeResult(const Job& job, bool bSuccess, int exitCode);
+
+   Progress* mpProgress;
+   unsigned int mProcessCount;
+   unsigned int mRetryCount;
+   unsigned int mMemoryLimit;
+   QStringList mWorkerArguments;
+   std::string mResultsFilename;
+
+   QString mJobDirectory;
+   QStringList mJobFiles;
+   QFile mResults;
+   unsigned int mSucceeded;
+   unsigned int mFailed;
+
+   // Not implemented.
+   BatchScheduler(const BatchScheduler&);
+   BatchScheduler& operator=(const BatchScheduler&);
+};
+
+#endif
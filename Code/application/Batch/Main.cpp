@@ -49,6 +49,11 @@ int main(int argc, char** argv)
    pArgumentList->registerOption("input");
    pArgumentList->registerOption("generate");
    pArgumentList->registerOption("processors");
+   pArgumentList->registerOption("processes");
+   pArgumentList->registerOption("retries");
+   pArgumentList->registerOption("memory");
+   pArgumentList->registerOption("results");
+   pArgumentList->registerOption("benchmark");
    pArgumentList->registerOption("version");
    pArgumentList->registerOption("showHiddenExtensions");
    pArgumentList->registerOption("help");
@@ -168,6 +173,13 @@ int main(int argc, char** argv)
       cout << "     " << dlm << "brief                 Displays brief output messages" << endl;
       cout << "     " << dlm << "verybrief             Displays only abort, warning, and error messages" << endl;
       cout << "     " << dlm << "processors            Sets number of available processors" << endl;
+      cout << "     " << dlm << "processes             Runs the files of each file set in this many worker processes" <<
+         endl;
+      cout << "     " << dlm << "retries               Sets the number of times a failed worker job is run again" << endl;
+      cout << "     " << dlm << "memory                Sets the memory limit in MB of each worker process" << endl;
+      cout << "     " << dlm << "results               Sets the file to which worker job results are written" << endl;
+      cout << "     " << dlm << "benchmark             Runs the named timing test plug-in and displays its results" <<
+         endl;
       //cout << "     " << dlm << "test        Runs a set of operational tests" << endl;
       //cout << "     " << dlm << "testAll     Runs the full set of system tests" << endl;
       cout << "     " << dlm << "showHiddenExtensions  Show hidden extensions when listing installed extensions" << endl;
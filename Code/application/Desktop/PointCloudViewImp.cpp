@@ -28,6 +28,7 @@
 #include "Undo.h"
 
 #include <QtCore/QFile>
+#include <QtCore/QTimer>
 #include <QtGui/QAction>
 #include <QtGui/QActionGroup>
 #include <QtGui/QMenu>
@@ -35,7 +36,9 @@
 #include <QtOpenGL/QGLBuffer>
 #include <QtOpenGL/QGLShader>
 #include <QtOpenGL/QGLShaderProgram>
+#include <algorithm>
 #include <limits>
+#include <map>
 #include <GL/glew.h>
 
 using namespace std;
@@ -46,11 +49,25 @@ using namespace std;
 namespace
 {
    const string shortcutContext = "View/PointCloud";
+
+   // The number of octree points drawn when no decimation is set
+   const uint32_t sLodPointBudget = 5000000;
+
+   // The maximum number of octree nodes drawn at once
+   const size_t sMaxLodNodes = 4096;
+
+   // Octree nodes larger than this many screen pixels are replaced by their children
+   const double sLodRefineSize = 128.0;
+
+   // The time in milliseconds the camera must be still before the points are refined
+   const int sLodRefineDelay = 250;
 }
 
 PointCloudViewImp::PointCloudViewImp(const std::string& id, const std::string& viewName, QGLContext* drawContext,
       QWidget* parent) : PerspectiveViewImp(id, viewName, drawContext, parent),
       mpPrimaryPointCloud(),
+      mOctree(NULL),
+      mpLodTimer(NULL),
       mpVertexBuffer(NULL),
       mVertexBufferUpToDate(false),
       mpColorizationBuffer(NULL),
@@ -179,6 +196,12 @@ PointCloudViewImp::PointCloudViewImp(const std::string& id, const std::string& v
 
    setStretchType(LINEAR);
    setPointColorizationType(POINT_HEIGHT);
+
+   // Level of detail refinement
+   mpLodTimer = new QTimer(this);
+   mpLodTimer->setSingleShot(true);
+   mpLodTimer->setInterval(sLodRefineDelay);
+   VERIFYNR(connect(mpLodTimer, SIGNAL(timeout()), this, SLOT(refineLevelOfDetail())));
 }
 
 PointCloudViewImp::~PointCloudViewImp()
@@ -404,6 +427,9 @@ bool PointCloudViewImp::setPrimaryPointCloud(PointCloudElement* pPointCloud)
       return false; //primary can only set once per instance
    }
    mpPrimaryPointCloud.reset(pPointCloud);
+   mOctree = PointCloudOctree(dynamic_cast<const PointCloudDataDescriptor*>(pPointCloud->getDataDescriptor()));
+   mLodRanges.clear();
+   mPendingLodRanges.clear();
    mVertexBufferUpToDate = false;
    updateVertexBufferIfNeeded();
    notify(SIGNAL_NAME(Subject, Modified));
@@ -725,6 +751,208 @@ bool PointCloudViewImp::initShaders()
    return true;
 }
 
+bool PointCloudViewImp::LodRange::operator==(const LodRange& other) const
+{
+   return mFirstPoint == other.mFirstPoint && mPointCount == other.mPointCount && mStride == other.mStride;
+}
+
+void PointCloudViewImp::refineLevelOfDetail()
+{
+   if (mPendingLodRanges.empty() == false)
+   {
+      mVertexBufferUpToDate = false;
+      mColorizationBufferUpToDate = false;
+      refresh();
+   }
+}
+
+void PointCloudViewImp::selectLevelOfDetail(vector<LodRange>& ranges) const
+{
+   ranges.clear();
+   const PointCloudElement* pElement = mpPrimaryPointCloud.get();
+   if (pElement == NULL || mOctree.isValid() == false)
+   {
+      return;
+   }
+   const PointCloudDataDescriptor* pDesc = dynamic_cast<const PointCloudDataDescriptor*>(pElement->getDataDescriptor());
+   VERIFYNRV(pDesc != NULL);
+
+   // Combine the world matrices so node corners are transformed the same way as the vertex shaders
+   double matrix[16];
+   for (int col = 0; col < 4; ++col)
+   {
+      for (int row = 0; row < 4; ++row)
+      {
+         matrix[col * 4 + row] = 0.0;
+         for (int k = 0; k < 4; ++k)
+         {
+            matrix[col * 4 + row] += mProjMatrix[k * 4 + row] * mModelMatrix[col * 4 + k];
+         }
+      }
+   }
+
+   const double minX = pDesc->getXMin();
+   const double maxY = pDesc->getYMax();
+   const double minZ = pDesc->getZMin();
+   const double maxZ = pDesc->getZMax();
+   const double width = max(mViewPort[2], 1);
+   const double height = max(mViewPort[3], 1);
+   const double pointArea = max(static_cast<double>(mPointSize * mPointSize), 1.0);
+
+   // Projects a node and returns its size in screen pixels, or a negative value if it is outside of the view
+   struct Projector
+   {
+      const double* mpMatrix;
+      double mMinX;
+      double mMaxY;
+      double mMinZ;
+      double mMaxZ;
+      double mScale;
+      double mZScale;
+      double mWidth;
+      double mHeight;
+
+      double project(const PointCloudOctree::Node& node, double& area) const
+      {
+         const double xs[2] = { node.mMinX, node.mMaxX };
+         const double ys[2] = { node.mMinY, node.mMaxY };
+         const double zs[2] = { node.mMinZ, node.mMaxZ };
+         int outside[6] = { 0, 0, 0, 0, 0, 0 };
+         bool behindEye = false;
+         double screenMinX = numeric_limits<double>::max();
+         double screenMinY = numeric_limits<double>::max();
+         double screenMaxX = -screenMinX;
+         double screenMaxY = -screenMinY;
+         for (int corner = 0; corner < 8; ++corner)
+         {
+            double z = zs[(corner >> 2) & 1];
+            const double vertex[3] = { (xs[corner & 1] - mMinX) * mScale, (mMaxY - ys[(corner >> 1) & 1]) * mScale,
+               (mMinZ < 0.0 ? z - mMinZ : mMaxZ - z) * mZScale };
+            double clip[4];
+            for (int row = 0; row < 4; ++row)
+            {
+               clip[row] = mpMatrix[row] * vertex[0] + mpMatrix[4 + row] * vertex[1] +
+                  mpMatrix[8 + row] * vertex[2] + mpMatrix[12 + row];
+            }
+            for (int axis = 0; axis < 3; ++axis)
+            {
+               outside[axis * 2] += clip[axis] < -clip[3] ? 1 : 0;
+               outside[axis * 2 + 1] += clip[axis] > clip[3] ? 1 : 0;
+            }
+            if (clip[3] <= 0.0)
+            {
+               behindEye = true;
+               continue;
+            }
+            screenMinX = min(screenMinX, clip[0] / clip[3]);
+            screenMaxX = max(screenMaxX, clip[0] / clip[3]);
+            screenMinY = min(screenMinY, clip[1] / clip[3]);
+            screenMaxY = max(screenMaxY, clip[1] / clip[3]);
+         }
+         for (int plane = 0; plane < 6; ++plane)
+         {
+            if (outside[plane] == 8)
+            {
+               return -1.0;
+            }
+         }
+         if (behindEye)
+         {
+            // The node surrounds the eye so it fills the view
+            area = mWidth * mHeight;
+            return numeric_limits<double>::max();
+         }
+
+         double screenWidth = (min(screenMaxX, 1.0) - max(screenMinX, -1.0)) * mWidth / 2.0;
+         double screenHeight = (min(screenMaxY, 1.0) - max(screenMinY, -1.0)) * mHeight / 2.0;
+         area = max(screenWidth, 0.0) * max(screenHeight, 0.0);
+         return max((screenMaxX - screenMinX) * mWidth, (screenMaxY - screenMinY) * mHeight) / 2.0;
+      }
+   } projector = { matrix, minX, maxY, minZ, maxZ, mScaleFactor, mScaleFactor * mZExaggerationFactor, width, height };
+
+   // Refine the largest nodes on screen first so the node limit is spent where it is most visible
+   multimap<double, pair<PointCloudOctree::Node, double>, greater<double> > candidates;
+   vector<pair<PointCloudOctree::Node, double> > selected;
+   PointCloudOctree::Node root = mOctree.getRoot();
+   double area = 0.0;
+   double size = projector.project(root, area);
+   if (size >= 0.0)
+   {
+      candidates.insert(make_pair(size, make_pair(root, area)));
+   }
+
+   vector<PointCloudOctree::Node> children;
+   while (candidates.empty() == false)
+   {
+      double nodeSize = candidates.begin()->first;
+      pair<PointCloudOctree::Node, double> node = candidates.begin()->second;
+      candidates.erase(candidates.begin());
+
+      children.clear();
+      if (nodeSize > sLodRefineSize && selected.size() + candidates.size() + 8 <= sMaxLodNodes)
+      {
+         mOctree.getChildren(node.first, children);
+      }
+      if (children.empty())
+      {
+         selected.push_back(node);
+         continue;
+      }
+      for (vector<PointCloudOctree::Node>::const_iterator child = children.begin(); child != children.end(); ++child)
+      {
+         size = projector.project(*child, area);
+         if (size >= 0.0)
+         {
+            candidates.insert(make_pair(size, make_pair(*child, area)));
+         }
+      }
+   }
+
+   // Draw about one point per point-sized pixel of each node, limited to the point budget
+   double requested = 0.0;
+   for (vector<pair<PointCloudOctree::Node, double> >::iterator node = selected.begin(); node != selected.end(); ++node)
+   {
+      node->second = min(static_cast<double>(node->first.mPointCount), max(node->second / pointArea, 1.0));
+      requested += node->second;
+   }
+   const double budget = sLodPointBudget / (mDecimation + 1.0);
+   const double scale = requested > budget ? budget / requested : 1.0;
+
+   map<uint32_t, LodRange> sortedRanges;
+   for (vector<pair<PointCloudOctree::Node, double> >::const_iterator node = selected.begin();
+      node != selected.end(); ++node)
+   {
+      // Strides are powers of two so small camera movements do not reload the points
+      double stride = node->first.mPointCount / max(node->second * scale, 1.0);
+      LodRange range;
+      range.mFirstPoint = node->first.mFirstPoint;
+      range.mPointCount = node->first.mPointCount;
+      range.mStride = 1;
+      while (range.mStride < stride && range.mStride < range.mPointCount)
+      {
+         range.mStride *= 2;
+      }
+      sortedRanges[range.mFirstPoint] = range;
+   }
+
+   // Read the points in storage order
+   for (map<uint32_t, LodRange>::const_iterator range = sortedRanges.begin(); range != sortedRanges.end(); ++range)
+   {
+      ranges.push_back(range->second);
+   }
+}
+
+uint32_t PointCloudViewImp::getSampleCount(const vector<LodRange>& ranges)
+{
+   uint32_t sampleCount = 0;
+   for (vector<LodRange>::const_iterator range = ranges.begin(); range != ranges.end(); ++range)
+   {
+      sampleCount += (range->mPointCount + range->mStride - 1) / range->mStride;
+   }
+
+   return sampleCount;
+}
+
 void PointCloudViewImp::updateVertexBufferIfNeeded()
 {
    if (mVertexBufferUpToDate)
@@ -741,6 +969,27 @@ void PointCloudViewImp::updateVertexBufferIfNeeded()
    VERIFYNRV(pDesc != NULL);
 
    uint32_t pointCount = pDesc->getPointCount();
+   uint32_t decimation = mDecimation + 1;
+   vector<LodRange> ranges;
+   if (mOctree.isValid())
+   {
+      ranges.swap(mPendingLodRanges);
+      if (ranges.empty())
+      {
+         selectLevelOfDetail(ranges);
+      }
+   }
+   else
+   {
+      LodRange range;
+      range.mFirstPoint = 0;
+      range.mPointCount = pointCount;
+      range.mStride = decimation;
+      ranges.push_back(range);
+   }
+
+   uint32_t sampleCount = getSampleCount(ranges);
+
    GLfloat minX = std::numeric_limits<float>::max();
    GLfloat minY = std::numeric_limits<float>::max();
    GLfloat minZ = std::numeric_limits<float>::max();
@@ -748,48 +997,58 @@ void PointCloudViewImp::updateVertexBufferIfNeeded()
    GLfloat maxY = -1.0 * minY;
    GLfloat maxZ = -1.0 * minZ;
 
-   mta::StatusBarReporter queryReporter("Querying points", "app", "75711F5F-7286-4B5B-8F46-6E1EF33CAA19");
    int oldPercent = 0, curPercent = 0;
    PointCloudAccessor pAccessor = mpPrimaryPointCloud->getPointCloudAccessor();
    uint32_t validPointCount = 0;
-   uint32_t decimation = mDecimation + 1;
    if (!pAccessor.isValid())
    {
       return;
    }
-   if (!pAccessor->isPointValid())
+   if (mOctree.isValid())
    {
-      pAccessor->nextValidPoint();
+      // The octree bounds must not change when the points are refined
+      minX = pDesc->getXMin();
+      maxX = pDesc->getXMax();
+      minY = pDesc->getYMin();
+      maxY = pDesc->getYMax();
+      minZ = pDesc->getZMin();
+      maxZ = pDesc->getZMax();
+      validPointCount = sampleCount;
    }
-   for (unsigned int i = 0; i < pointCount; i += decimation)
+   else
    {
-      curPercent = i * 100 / pointCount;
-      if (curPercent - oldPercent >= 1) 
+      mta::StatusBarReporter queryReporter("Querying points", "app", "75711F5F-7286-4B5B-8F46-6E1EF33CAA19");
+      for (unsigned int i = 0; i < pointCount; i += decimation)
       {
-         queryReporter.reportProgress(min(curPercent, 99));
-      }
-      oldPercent = curPercent;
-      if (!pAccessor.isValid())
-      {
-         return;
-      }
+         curPercent = i * 100 / pointCount;
+         if (curPercent - oldPercent >= 1)
+         {
+            queryReporter.reportProgress(min(curPercent, 99));
+         }
+         oldPercent = curPercent;
+         pAccessor->toIndex(i);
+         if (!pAccessor.isValid())
+         {
+            return;
+         }
+         if (!pAccessor->isPointValid())
+         {
+            continue;
+         }
 
-      GLfloat xValue = pAccessor->getXAsDouble();
-      minX = std::min(xValue, minX);
-      maxX = std::max(xValue, maxX);
-      GLfloat yValue = pAccessor->getYAsDouble();
-      minY = std::min(yValue, minY);
-      maxY = std::max(yValue, maxY);
-      GLfloat zValue = pAccessor->getZAsDouble();
-      minZ = std::min(zValue, minZ);
-      maxZ = std::max(zValue, maxZ);
-      validPointCount++;
-      for (unsigned int skip = 0; (skip < decimation) && (i + skip + 1 < pointCount); ++skip)
-      {
-         pAccessor->nextValidPoint();
+         GLfloat xValue = pAccessor->getXAsDouble();
+         minX = std::min(xValue, minX);
+         maxX = std::max(xValue, maxX);
+         GLfloat yValue = pAccessor->getYAsDouble();
+         minY = std::min(yValue, minY);
+         maxY = std::max(yValue, maxY);
+         GLfloat zValue = pAccessor->getZAsDouble();
+         minZ = std::min(zValue, minZ);
+         maxZ = std::max(zValue, maxZ);
+         validPointCount++;
       }
+      queryReporter.reportProgress(100);
    }
-   queryReporter.reportProgress(100);
 
    mpVertexBuffer->bind();
    mpVertexBuffer->allocate(sizeof(GLfloat)*3*validPointCount);
@@ -799,7 +1058,21 @@ void PointCloudViewImp::updateVertexBufferIfNeeded()
    {
       // wasn't enough room, try to reallocate with more decimation
       decimation++;
-      validPointCount = origValidPointCount / decimation;
+      if (mOctree.isValid())
+      {
+         // The octree point budget is reduced by the decimation
+         uint32_t oldDecimation = mDecimation;
+         mDecimation = decimation - 1;
+         selectLevelOfDetail(ranges);
+         mDecimation = oldDecimation;
+         validPointCount = getSampleCount(ranges);
+         sampleCount = validPointCount;
+      }
+      else
+      {
+         validPointCount = origValidPointCount / decimation;
+         ranges.front().mStride = decimation;
+      }
       mpVertexBuffer->allocate(sizeof(GLfloat)*3*validPointCount);
       pBuffer = reinterpret_cast<GLfloat*>(mpVertexBuffer->map(QGLBuffer::ReadWrite));
    }
@@ -826,60 +1099,62 @@ void PointCloudViewImp::updateVertexBufferIfNeeded()
    mta::StatusBarReporter barReporter("Transferring points", "app", "75711F5F-7286-4B5B-8F46-6E1EF33CAA19");
    oldPercent = 0;
    curPercent = 0;
-   pAccessor->toIndex(0);
-   if (!pAccessor.isValid())
-   {
-      return;
-   }
-   if (!pAccessor->isPointValid())
-   {
-      pAccessor->nextValidPoint();
-   }
    GLfloat minZcalc = std::numeric_limits<float>::max();
    GLfloat maxZcalc = -1.0 * minZcalc;
-   for (unsigned int i = 0; i < pointCount; i += decimation)
+   uint32_t writtenPointCount = 0;
+   uint64_t processedPointCount = 0;
+   for (vector<LodRange>::const_iterator range = ranges.begin(); range != ranges.end(); ++range)
    {
-      curPercent = i * 100 / pointCount;
-      if (curPercent - oldPercent >= 1) 
+      for (uint32_t i = 0; i < range->mPointCount && writtenPointCount < validPointCount; i += range->mStride)
       {
-         barReporter.reportProgress(min(curPercent, 99));
-      }
-      oldPercent = curPercent;
-      if (!pAccessor.isValid())
-      {
-         mpVertexBuffer->unmap();
-         return;
-      }
+         curPercent = static_cast<int>(++processedPointCount * 100 / max(sampleCount, 1U));
+         if (curPercent - oldPercent >= 1)
+         {
+            barReporter.reportProgress(min(curPercent, 99));
+         }
+         oldPercent = curPercent;
+         pAccessor->toIndex(range->mFirstPoint + i);
+         if (!pAccessor.isValid())
+         {
+            mpVertexBuffer->unmap();
+            return;
+         }
+         if (!pAccessor->isPointValid())
+         {
+            continue;
+         }
 
-      *pBuffer = pAccessor->getXAsDouble() - minX;
-      pBuffer++;
-      *pBuffer = maxY - pAccessor->getYAsDouble();
-      pBuffer++;
-      GLfloat zValue;
-      if (minZ < 0.0)
-      {
-         zValue = pAccessor->getZAsDouble() - minZ;
-      }
-      else
-      {
-         zValue = maxZ - pAccessor->getZAsDouble();
-      }
+         *pBuffer = pAccessor->getXAsDouble() - minX;
+         pBuffer++;
+         *pBuffer = maxY - pAccessor->getYAsDouble();
+         pBuffer++;
+         GLfloat zValue;
+         if (minZ < 0.0)
+         {
+            zValue = pAccessor->getZAsDouble() - minZ;
+         }
+         else
+         {
+            zValue = maxZ - pAccessor->getZAsDouble();
+         }
 
-      minZcalc = std::min(zValue, minZcalc);
-      maxZcalc = std::max(zValue, maxZcalc);
-      *pBuffer = zValue;
-      pBuffer++;
-      for (unsigned int skip = 0; (skip < decimation) && (i + skip + 1 < pointCount); ++skip)
-      {
-         pAccessor->nextValidPoint();
+         minZcalc = std::min(zValue, minZcalc);
+         maxZcalc = std::max(zValue, maxZcalc);
+         *pBuffer = zValue;
+         pBuffer++;
+         writtenPointCount++;
       }
    }
    mpVertexBuffer->unmap();
    mpShaderProg->setAttributeBuffer(MVERTEX_ATTRIB_NUM, GL_FLOAT, 0, 3, 0);
-   double scale = pDesc->getZScale();
-   double offset = pDesc->getZOffset();
-   mUpperStretch = maxZ * scale + offset;
-   mLowerStretch = minZ * scale + offset;
+   if (!mOctree.isValid() || mLodRanges.empty())
+   {
+      // Keep the stretch when refining the octree points
+      double scale = pDesc->getZScale();
+      double offset = pDesc->getZOffset();
+      mUpperStretch = maxZ * scale + offset;
+      mLowerStretch = minZ * scale + offset;
+   }
    mMaxZ = maxZ;
    mMinZ = minZ;
    // This should check x, y, and z as well as update dynamically
@@ -887,7 +1162,9 @@ void PointCloudViewImp::updateVertexBufferIfNeeded()
    // values until we have proper statistics support for point clouds
    //mFrontPlane = std::min(mFrontPlane,mMinZ * 0.8);
    //mBackPlane = std::max(mBackPlane,mMaxZ * 1.5);
-   mTotalPoints = validPointCount;
+   mTotalPoints = writtenPointCount;
+   mLodRanges.swap(ranges);
+   mColorizationBufferUpToDate = false;
    barReporter.reportProgress(100);
    mVertexBufferUpToDate = true;
 }
@@ -950,24 +1227,19 @@ void PointCloudViewImp::updateColorizationBufferIfNeeded()
       return;
    }
 
-   uint32_t pointCount = pDesc->getPointCount();
+   // Use the same points as the vertex buffer
+   uint32_t sampleCount = getSampleCount(mLodRanges);
 
    int oldPercent = 0, curPercent = 0;
    PointCloudAccessor pAccessor = mpPrimaryPointCloud->getPointCloudAccessor();
-   uint32_t decimation = mDecimation + 1;
-   uint32_t validPointCount = pointCount / decimation;
    if (!pAccessor.isValid())
    {
       return;
    }
-   if (!pAccessor->isPointValid())
-   {
-      pAccessor->nextValidPoint();
-   }
 
    mpColorizationBuffer->bind();
-   mpColorizationBuffer->allocate(sizeof(GLfloat)*1*validPointCount);
-   GLfloat* pBuffer = reinterpret_cast<GLfloat*>(mpVertexBuffer->map(QGLBuffer::ReadWrite));
+   mpColorizationBuffer->allocate(sizeof(GLfloat)*1*mTotalPoints);
+   GLfloat* pBuffer = reinterpret_cast<GLfloat*>(mpColorizationBuffer->map(QGLBuffer::ReadWrite));
    if (pBuffer == NULL)
    {
       return;
@@ -976,50 +1248,49 @@ void PointCloudViewImp::updateColorizationBufferIfNeeded()
    mta::StatusBarReporter barReporter("Transferring colorization data", "app", "58AC5F1A-BEFE-44E9-B292-D2E0D390A084");
    oldPercent = 0;
    curPercent = 0;
-   if (!pAccessor.isValid())
-   {
-      return;
-   }
-   if (!pAccessor->isPointValid())
-   {
-      pAccessor->nextValidPoint();
-   }
    GLfloat minCalc = std::numeric_limits<float>::max();
    GLfloat maxCalc = -1.0 * minCalc;
-   for (unsigned int i = 0; i < pointCount; i += decimation)
+   uint32_t writtenPointCount = 0;
+   uint64_t processedPointCount = 0;
+   for (vector<LodRange>::const_iterator range = mLodRanges.begin(); range != mLodRanges.end(); ++range)
    {
-      curPercent = i * 100 / pointCount;
-      if (curPercent - oldPercent >= 1) 
-      {
-         barReporter.reportProgress(min(curPercent, 99));
-      }
-      oldPercent = curPercent;
-      if (!pAccessor.isValid())
+      for (uint32_t i = 0; i < range->mPointCount && writtenPointCount < mTotalPoints; i += range->mStride)
       {
-         mpColorizationBuffer->unmap();
-         return;
-      }
+         curPercent = static_cast<int>(++processedPointCount * 100 / max(sampleCount, 1U));
+         if (curPercent - oldPercent >= 1)
+         {
+            barReporter.reportProgress(min(curPercent, 99));
+         }
+         oldPercent = curPercent;
+         pAccessor->toIndex(range->mFirstPoint + i);
+         if (!pAccessor.isValid())
+         {
+            mpColorizationBuffer->unmap();
+            return;
+         }
+         if (!pAccessor->isPointValid())
+         {
+            continue;
+         }
 
-      GLfloat value;
-      switch (mCurrentColorization)
-      {
-      case POINT_INTENSITY:
-         value = pAccessor->getIntensityAsDouble();
-         break;
-      case POINT_CLASSIFICATION:
-         value = pAccessor->getClassificationAsDouble();
-         break;
-      default:
-         mpColorizationBuffer->unmap();
-         return;
-      }
-      minCalc = std::min(value, minCalc);
-      maxCalc = std::max(value, maxCalc);
-      *pBuffer = value;
-      pBuffer++;
-      for (unsigned int skip = 0; (skip < decimation) && (i + skip + 1 < pointCount); ++skip)
-      {
-         pAccessor->nextValidPoint();
+         GLfloat value;
+         switch (mCurrentColorization)
+         {
+         case POINT_INTENSITY:
+            value = pAccessor->getIntensityAsDouble();
+            break;
+         case POINT_CLASSIFICATION:
+            value = pAccessor->getClassificationAsDouble();
+            break;
+         default:
+            mpColorizationBuffer->unmap();
+            return;
+         }
+         minCalc = std::min(value, minCalc);
+         maxCalc = std::max(value, maxCalc);
+         *pBuffer = value;
+         pBuffer++;
+         writtenPointCount++;
       }
    }
    mpColorizationBuffer->unmap();
@@ -1058,6 +1329,22 @@ void PointCloudViewImp::drawContents()
       return;
    }
    glClear(GL_DEPTH_BUFFER_BIT); // this should really be in ViewImp::draw() but it'll work here for now
+   if (mOctree.isValid() && mVertexBufferUpToDate)
+   {
+      // Reload the points when the camera stops moving instead of on every frame
+      vector<LodRange> ranges;
+      selectLevelOfDetail(ranges);
+      if (ranges == mLodRanges)
+      {
+         mpLodTimer->stop();
+         mPendingLodRanges.clear();
+      }
+      else if (!(ranges == mPendingLodRanges))
+      {
+         mPendingLodRanges.swap(ranges);
+         mpLodTimer->start();
+      }
+   }
    updateVertexBufferIfNeeded();
    updateColorMapTextureIfNeeded();
    updateColorizationBufferIfNeeded();
@@ -14,13 +14,17 @@
 #include "ColorMap.h"
 #include "PerspectiveViewImp.h"
 #include "PointCloudElement.h"
+#include "PointCloudOctree.h"
 #include "PointCloudView.h"
 
+#include <vector>
+
 class QAction;
 class QGLBuffer;
 class QGLShader;
 class QGLShaderProgram;
 class QMenu;
+class QTimer;
 
 class PointCloudViewImp : public PerspectiveViewImp, public Observer
 {
@@ -80,6 +84,7 @@ protected slots:
    void setStretchType(QAction* pAction);
    void setPointColorizationType(QAction* pAction);
    virtual void zoomExtents();
+   void refineLevelOfDetail();
 
 protected:
    virtual void drawContents();
@@ -91,7 +96,22 @@ protected:
    virtual void updateStatusBar(const QPoint& screenCoord);
 
 private:
+   /**
+    * A range of points in the vertex buffer. Every mStride'th point starting
+    * at mFirstPoint is drawn.
+    */
+   struct LodRange
+   {
+      uint32_t mFirstPoint;
+      uint32_t mPointCount;
+      uint32_t mStride;
+
+      bool operator==(const LodRange& other) const;
+   };
+
    void initializeDrawing();
+   void selectLevelOfDetail(std::vector<LodRange>& ranges) const;
+   static uint32_t getSampleCount(const std::vector<LodRange>& ranges);
    void updateVertexBufferIfNeeded();
    void updateColorizationBufferIfNeeded();
    void updateColorMapTextureIfNeeded();
@@ -99,6 +119,10 @@ private:
    bool initShaders();
 
    AttachmentPtr<PointCloudElement> mpPrimaryPointCloud;
+   PointCloudOctree mOctree;
+   std::vector<LodRange> mLodRanges;
+   std::vector<LodRange> mPendingLodRanges;
+   QTimer* mpLodTimer;
 
    // Ideally, these members would belong to the layer containing each element.
    // Until support for that can be implemented, this data will be stored
@@ -204,7 +204,7 @@ CachedPage::UnitPtr Hdf4Pager::fetchUnit(DataRequest *pOriginalRequest)
 
    int pageSize = static_cast<int>(bpp*lNumValues[0]*lNumValues[1]*lNumValues[2]);
 
-   ArrayResource<char> pData(pageSize, true);
+   PageBufferResource pData(pageSize);
    if (pData.get() == NULL)
    {
       return pUnit;
@@ -219,7 +219,7 @@ CachedPage::UnitPtr Hdf4Pager::fetchUnit(DataRequest *pOriginalRequest)
    }
 
    CachedPage::CacheUnit* pCacheUnit = new CachedPage::CacheUnit(pData.release(), startRow, concurrentRows,
-      pageSize, (fileInterleave == BSQ ? startBand : CachedPage::CacheUnit::ALL_BANDS));
+      pageSize, (fileInterleave == BSQ ? startBand : CachedPage::CacheUnit::ALL_BANDS), 0, true);
    pUnit.reset(pCacheUnit);
    return pUnit;
 }
@@ -296,7 +296,7 @@ CachedPage::UnitPtr Hdf5Pager::fetchUnit(DataRequest *pOriginalRequest)
 
    size_t pageSize = static_cast<size_t>(bpp*counts[0]*counts[1]*counts[2]);
 
-   ArrayResource<char> pData(pageSize, true);
+   PageBufferResource pData(pageSize);
    if (pData.get() == NULL)
    {
       return pUnit;
@@ -349,7 +349,7 @@ CachedPage::UnitPtr Hdf5Pager::fetchUnit(DataRequest *pOriginalRequest)
    }
 
    CachedPage::CacheUnit* pCacheUnit = new CachedPage::CacheUnit(pData.release(), startRow, concurrentRows,
-      pageSize, (fileInterleave == BSQ ? startBand : CachedPage::CacheUnit::ALL_BANDS));
+      pageSize, (fileInterleave == BSQ ? startBand : CachedPage::CacheUnit::ALL_BANDS), 0, true);
    pUnit.reset(pCacheUnit);
    return pUnit;
 }
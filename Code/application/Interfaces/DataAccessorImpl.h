@@ -107,6 +107,7 @@ public:
       mCurrentColumn(0),
       mRowOffset(0),
       mColumnOffset(0),
+      mPageRequests(0),
       mRefCount(0),
       mConvertToDoubleFunc(NULL),
       mConvertToIntegerFunc(NULL)
@@ -387,6 +388,45 @@ public:
       return mConcurrentColumns;
    }
 
+   /**
+    *  Access the number of rows available concurrently.
+    *
+    *  This is the number of rows in the page of data which contains
+    *  the current row, counted from the first row of the page.
+    *
+    *  @return The number of concurrent rows.
+    *
+    *  @see getRowStride()
+    */
+   inline size_t getConcurrentRows() const
+   {
+      return mConcurrentRows;
+   }
+
+   /**
+    *  Access the number of bands available concurrently.
+    *
+    *  @return The number of concurrent bands.
+    */
+   inline size_t getConcurrentBands() const
+   {
+      return mConcurrentBands;
+   }
+
+   /**
+    *  Access the number of bytes from the start of one row to the start of the next.
+    *
+    *  Unlike getRowSize(), this includes preline and postline bytes.
+    *
+    *  @return The number of bytes between consecutive rows in a page of data.
+    *
+    *  @see getConcurrentRows()
+    */
+   inline size_t getRowStride() const
+   {
+      return mRowSize;
+   }
+
 private:
    friend class RasterElementImp;
 
@@ -463,6 +503,7 @@ private:
    size_t mAccessorColumn;
    size_t mAccessorRow;
    size_t mAccessorBand;
+   size_t mPageRequests;               // Number of pages requested, added to the pager statistics when deleted
 
    int mRefCount;
    convertToDouble mConvertToDoubleFunc;
@@ -13,6 +13,7 @@
 #include "Any.h"
 #include "AnyData.h"
 #include "ComplexData.h"
+#include "PagerStatistics.h"
 #include "Service.h"
 #include "Subject.h"
 #include "switchOnEncoding.h"
@@ -723,6 +724,82 @@ public:
     */
    virtual void deleteMemoryBlock(char* memory) = 0; 
 
+   /**
+    *  Adds to the paging statistics of the application.
+    *
+    *  Pagers which keep a page cache, such as CachedPager, add their cache
+    *  counters when they are destroyed.  This method is thread-safe.
+    *
+    *  @param   statistics
+    *           The counters to add to the totals.
+    *
+    *  @see     getPagerStatistics()
+    */
+   virtual void addPagerStatistics(const PagerStatistics& statistics) = 0;
+
+   /**
+    *  Gets the paging statistics of the application.
+    *
+    *  Each RasterElement counts the pages requested by its DataAccessors
+    *  without locking the totals, so the counters of the existing elements
+    *  are added to the totals when this method is called.
+    *
+    *  @return  The totals of every counter added since the application
+    *           started or resetPagerStatistics() was last called.
+    */
+   virtual PagerStatistics getPagerStatistics() const = 0;
+
+   /**
+    *  Sets every paging statistic of the application to zero.
+    *
+    *  This can be called before running an algorithm to measure only the
+    *  paging done by that algorithm.
+    */
+   virtual void resetPagerStatistics() = 0;
+
+   /**
+    *  Gets a buffer for a page of raster data.
+    *
+    *  Page buffers are recycled after they are released, so a pager which
+    *  reads pages of similar sizes repeatedly does not allocate new memory
+    *  for each page.  The bytes in page buffers are limited by a budget shared
+    *  by all pagers, and free buffers are returned to the system while the
+    *  budget is exceeded.  The PageBufferResource class can be used to
+    *  release a buffer automatically.
+    *
+    *  @param   size
+    *           The minimum size of the buffer in bytes.
+    *
+    *  @return  A pointer to the buffer, or \b NULL if the memory could not be
+    *           allocated.  The contents of the buffer are undefined.
+    *
+    *  @see     releasePageBuffer()
+    */
+   virtual char* getPageBuffer(size_t size) = 0;
+
+   /**
+    *  Releases a buffer obtained from getPageBuffer().
+    *
+    *  @param   pBuffer
+    *           The buffer to release.
+    *
+    *  @return  \c True if the buffer was released, or \c false if it was not
+    *           obtained from getPageBuffer().
+    */
+   virtual bool releasePageBuffer(char* pBuffer) = 0;
+
+   /**
+    *  Gets the number of bytes by which the page buffers in use exceed their
+    *  budget.
+    *
+    *  Page caches remove their least recently used pages until these bytes
+    *  are released, even if they are not full.
+    *
+    *  @return  The bytes in use above the budget, or zero if the budget is
+    *           not exceeded.
+    */
+   virtual size_t getPageBufferBudgetExcess() const = 0;
+
    /**
     *  This static method retrieves an individual data value from a block of memory.
     *
@@ -0,0 +1,225 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2007 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#ifndef PAGERSTATISTICS_H
+#define PAGERSTATISTICS_H
+
+#include "AppConfig.h"
+
+#include <sstream>
+#include <string>
+
+/**
+ *  Counters which describe how raster data is paged into memory.
+ *
+ *  Each RasterElement counts the pages requested by its DataAccessors, and
+ *  a CachedPager records how its page cache is used.  The totals for the
+ *  application are available from ModelServices::getPagerStatistics().
+ *
+ *  Fetch latencies are kept in a histogram with LATENCY_BUCKET_COUNT buckets.
+ *  Bucket 0 counts latencies below one microsecond, and bucket \em i counts
+ *  latencies from 2<sup>i-1</sup> up to 2<sup>i</sup> microseconds.  The last
+ *  bucket also counts every longer latency.
+ *
+ *  @see     ModelServices::addPagerStatistics()
+ */
+class PagerStatistics
+{
+public:
+   /**
+    *  The number of buckets in the latency histogram.
+    */
+   static const unsigned int LATENCY_BUCKET_COUNT = 20;
+
+   /**
+    *  Creates statistics with every counter set to zero.
+    */
+   PagerStatistics()
+   {
+      reset();
+   }
+
+   /**
+    *  Sets every counter to zero.
+    */
+   void reset()
+   {
+      mAccessorCount = 0;
+      mAccessorRefetches = 0;
+      mPageRequests = 0;
+      mCacheHits = 0;
+      mCacheMisses = 0;
+      mCacheEvictions = 0;
+      mCacheRefetches = 0;
+      mBytesRead = 0;
+      for (unsigned int i = 0; i < LATENCY_BUCKET_COUNT; ++i)
+      {
+         mFetchLatency[i] = 0;
+      }
+   }
+
+   /**
+    *  Adds the counters of other statistics to these statistics.
+    *
+    *  @param   statistics
+    *           The statistics to add.
+    */
+   void merge(const PagerStatistics& statistics)
+   {
+      mAccessorCount += statistics.mAccessorCount;
+      mAccessorRefetches += statistics.mAccessorRefetches;
+      mPageRequests += statistics.mPageRequests;
+      mCacheHits += statistics.mCacheHits;
+      mCacheMisses += statistics.mCacheMisses;
+      mCacheEvictions += statistics.mCacheEvictions;
+      mCacheRefetches += statistics.mCacheRefetches;
+      mBytesRead += statistics.mBytesRead;
+      for (unsigned int i = 0; i < LATENCY_BUCKET_COUNT; ++i)
+      {
+         mFetchLatency[i] += statistics.mFetchLatency[i];
+      }
+   }
+
+   /**
+    *  Gets the histogram bucket which counts a latency.
+    *
+    *  @param   microseconds
+    *           The latency in microseconds.
+    *
+    *  @return  The index of the bucket.
+    */
+   static unsigned int getLatencyBucket(uint64_t microseconds)
+   {
+      unsigned int bucket = 0;
+      while (microseconds > 0 && bucket < LATENCY_BUCKET_COUNT - 1)
+      {
+         microseconds >>= 1;
+         ++bucket;
+      }
+
+      return bucket;
+   }
+
+   /**
+    *  Gets the fraction of page cache lookups which found the page in the
+    *  cache.
+    *
+    *  @return  The hit rate from 0 to 1, or 0 if the cache was never used.
+    */
+   double getCacheHitRate() const
+   {
+      uint64_t lookups = mCacheHits + mCacheMisses;
+      if (lookups == 0)
+      {
+         return 0.0;
+      }
+
+      return static_cast<double>(mCacheHits) / lookups;
+   }
+
+   /**
+    *  Formats the statistics as text for the message log.
+    *
+    *  @return  One line for each counter which is not zero.
+    */
+   std::string toString() const
+   {
+      std::stringstream text;
+      text << "Data accessors: " << mAccessorCount << "\n";
+      text << "Accessor refetches: " << mAccessorRefetches << "\n";
+      text << "Page requests: " << mPageRequests << "\n";
+      if (mCacheHits + mCacheMisses > 0)
+      {
+         text << "Cache hits: " << mCacheHits << "\n";
+         text << "Cache misses: " << mCacheMisses << "\n";
+         text << "Cache hit rate: " << getCacheHitRate() << "\n";
+         text << "Cache evictions: " << mCacheEvictions << "\n";
+         text << "Cache refetches: " << mCacheRefetches << "\n";
+         text << "Bytes read: " << mBytesRead << "\n";
+      }
+      formatHistogram(text, "Fetch latency", mFetchLatency);
+      return text.str();
+   }
+
+   /**
+    *  The number of DataAccessors created.
+    */
+   uint64_t mAccessorCount;
+
+   /**
+    *  The number of times a DataAccessor advanced past the rows of its page
+    *  and requested the next page.
+    */
+   uint64_t mAccessorRefetches;
+
+   /**
+    *  The number of pages requested from pagers by DataAccessors.
+    */
+   uint64_t mPageRequests;
+
+   /**
+    *  The number of pages found in a page cache.
+    */
+   uint64_t mCacheHits;
+
+   /**
+    *  The number of pages not found in a page cache, which were read.
+    */
+   uint64_t mCacheMisses;
+
+   /**
+    *  The number of pages removed from a page cache to keep it within its
+    *  size.
+    */
+   uint64_t mCacheEvictions;
+
+   /**
+    *  The number of pages read again after being removed from a page cache.
+    *  A high count compared to mCacheMisses means the cache is thrashing.
+    */
+   uint64_t mCacheRefetches;
+
+   /**
+    *  The number of bytes read into page caches.
+    */
+   uint64_t mBytesRead;
+
+   /**
+    *  The histogram of the time taken to read pages which were not found in a
+    *  page cache.
+    */
+   uint64_t mFetchLatency[LATENCY_BUCKET_COUNT];
+
+private:
+   static void formatHistogram(std::stringstream& text, const std::string& name, const uint64_t* pHistogram)
+   {
+      for (unsigned int i = 0; i < LATENCY_BUCKET_COUNT; ++i)
+      {
+         if (pHistogram[i] > 0)
+         {
+            text << name << " ";
+            if (i == 0)
+            {
+               text << "below 1";
+            }
+            else if (i == LATENCY_BUCKET_COUNT - 1)
+            {
+               text << "from " << (static_cast<uint64_t>(1) << (i - 1));
+            }
+            else
+            {
+               text << (static_cast<uint64_t>(1) << (i - 1)) << " to " << (static_cast<uint64_t>(1) << i);
+            }
+            text << " us: " << pHistogram[i] << "\n";
+         }
+      }
+   }
+};
+
+#endif
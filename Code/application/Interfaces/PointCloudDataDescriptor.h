@@ -20,6 +20,8 @@ enum PointCloudArrangementEnum
    POINT_ARRAY=0,          /**< The points are represented as a 1-D array of points. The specific order is defined by the importer or creating plugin */
    POINT_KDTREE_XY_ARRAY,  /**< The points are represented as a K-d tree indexed by 2-D (x,y) location */
    POINT_KDTREE_XYZ_ARRAY, /**< The points are represented as a K-d tree indexed by 3-D (x,y,z) location */
+   POINT_OCTREE_ARRAY,     /**< The points are represented as a 1-D array sorted by octree node. The octree index
+                                is stored in the element metadata. See PointCloudOctree. */
    USER=64                 /**< The points use another, user-defined representation. For example: an R* tree representation.
                                 User-defined representations may not be supported by PointCloudAccessor and other support classes
                                 so care should be used when selecting such an arrangement. */
@@ -362,6 +362,34 @@ public:
     */
    virtual bool createInMemoryPager(void* pData, bool bOwner = true) = 0;
 
+   /**
+    *  Creates a pager plug-in instance that will be used by this object to
+    *  store data compressed in memory.
+    *
+    *  This method creates a raster pager plug-in which divides the data into
+    *  tiles of rows and stores each tile compressed in memory.  Only the most
+    *  recently used tiles are kept decompressed, and the least recently used
+    *  compressed tiles are moved to a temporary file when the compressed data
+    *  grows large.  Data which has not been written to reads as zero.
+    *
+    *  Compressed storage is intended for large results which compress well,
+    *  such as masks, classification results and other bands with few
+    *  distinct values, which would otherwise use a large block of memory or
+    *  a temporary file.  Accessing data of other interleaves than the one
+    *  specified in the data descriptor is slower than for an in-memory pager.
+    *
+    *  This method should be called instead of createDefaultPager() on a
+    *  RasterElement with ProcessingLocation::IN_MEMORY or
+    *  ProcessingLocation::ON_DISK.  When the RasterElement is restored
+    *  from a session, its data is restored into a new compressed pager.
+    *
+    *  @return  Returns \b true if the compressed pager plug-in was
+    *           successfully created; otherwise returns \b false.
+    *
+    *  @see     RasterUtilities::createCompressedRasterElement()
+    */
+   virtual bool createCompressedPager() = 0;
+
    /**
     * If there is no pager set into the RasterElement, create a default
     * one.
@@ -12,6 +12,7 @@
 #include "AppConfig.h"
 #include "XercesIncludes.h"
 
+#include <string>
 #include <vector>
 
 class XmlReader;
@@ -122,6 +123,17 @@ public:
     */
    virtual std::vector<int64_t> getBlockSizes() const = 0;
 
+   /**
+    *  Returns an identifier for the location of the current block.
+    *
+    *  A SessionItem which keeps this identifier can pass it to
+    *  SessionItemSerializer::updateBlock() when the session is saved again, so
+    *  that only the parts of the block which have changed are written.
+    *
+    *  @return The identifier of the current block.
+    */
+   virtual std::string getBlockId() const = 0;
+
 protected:
    /**
     *  Destroys the SessionItemDeserializer object.
@@ -12,6 +12,7 @@
 class XMLWriter;
 
 #include "AppConfig.h"
+#include <string>
 #include <vector>
 
 /**
@@ -131,6 +132,54 @@ public:
     */
    virtual void endBlock() = 0;
 
+   /**
+    *  Returns an identifier for the location of the current block.
+    *
+    *  A SessionItem which saves the same block in a later session save can
+    *  pass this identifier to updateBlock() to overwrite only the parts of the
+    *  block which have changed.
+    *
+    *  @return The identifier of the current block.
+    *
+    *  @see SessionItemDeserializer::getBlockId()
+    */
+   virtual std::string getBlockId() const = 0;
+
+   /**
+    *  Updates the block saved by a previous session save instead of replacing it.
+    *
+    *  reserve() must be called for the current block before calling this method.
+    *  If the current block is stored in the same location as \em previousBlockId
+    *  and still contains the reserved number of bytes, the existing data is kept.
+    *  Subsequent calls to serialize() overwrite the existing data starting at
+    *  the position set with seek(), and any data which is not overwritten
+    *  retains its previous value.  The previous block is not changed until
+    *  the whole session has been saved, so a failed save leaves the previous
+    *  session intact.
+    *
+    *  @param previousBlockId
+    *            The value returned by getBlockId() or
+    *            SessionItemDeserializer::getBlockId() when the block was last
+    *            saved or restored.
+    *
+    *  @return True if the existing block will be updated. If false is
+    *          returned, the block must be completely written as usual.
+    */
+   virtual bool updateBlock(const std::string& previousBlockId) = 0;
+
+   /**
+    *  Sets the position in the current block where the next call to serialize() writes.
+    *
+    *  This method may only be called after updateBlock() returns \c true.
+    *
+    *  @param offset
+    *            The number of bytes from the start of the block.
+    *
+    *  @return True if the position was set, or false if updateBlock() has not
+    *          been called or \em offset is outside of the reserved size.
+    */
+   virtual bool seek(int64_t offset) = 0;
+
 protected:
    /**
     *  Destroys the SessionItemSerializer object.
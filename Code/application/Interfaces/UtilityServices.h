@@ -214,6 +214,59 @@ public:
     */
    virtual std::string getTextFromFile(const std::string& filename) = 0;
 
+   /**
+    *  Runs a function on a thread from the application's thread pool.
+    *
+    *  Pool threads are reused, so running many short functions does not
+    *  create a thread for each of them.  The pool has at most one thread for
+    *  each processor, and functions are queued while every pool thread is
+    *  busy.  A thread in waitForThreadPool() runs queued functions until the
+    *  function it waits for has returned, so a function may wait for other
+    *  functions it has started in the pool without deadlocking.  A function
+    *  must not block waiting for other pool functions in any other way.
+    *  Threads which have been idle for some time are destroyed.
+    *
+    *  @param   pFunction
+    *           The function to run.  Plug-ins must wait for the function to
+    *           return before they are destroyed, since the plug-in's module
+    *           may be unloaded once all of its plug-ins have been destroyed.
+    *           Use startInThreadPool() to wait for it.
+    *  @param   pData
+    *           The argument to pass to the function.
+    */
+   virtual void runInThreadPool(void (*pFunction)(void*), void* pData) = 0;
+
+   /**
+    *  Runs a function on a thread from the application's thread pool so that
+    *  the caller can wait for it to return.
+    *
+    *  The pool marks the function complete after it has returned, so no code
+    *  from the caller's module is running on the pool thread once
+    *  waitForThreadPool() returns.
+    *
+    *  @param   pFunction
+    *           The function to run.
+    *  @param   pData
+    *           The argument to pass to the function.
+    *
+    *  @return  The task running the function, which must be passed to
+    *           waitForThreadPool() exactly once.
+    *
+    *  @see     runInThreadPool()
+    */
+   virtual unsigned int startInThreadPool(void (*pFunction)(void*), void* pData) = 0;
+
+   /**
+    *  Waits for a function run by startInThreadPool() to return.
+    *
+    *  The calling thread runs the function itself if no pool thread has
+    *  started it, and otherwise runs other queued functions while it waits.
+    *
+    *  @param   task
+    *           The value returned by startInThreadPool().
+    */
+   virtual void waitForThreadPool(unsigned int task) = 0;
+
 protected:
    /**
     * This will be cleaned up during application close.  Plug-ins do not
@@ -0,0 +1,707 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2007 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#include "AppVersion.h"
+#include "AppVerify.h"
+#include "CompressedPager.h"
+#include "ConfigurationSettings.h"
+#include "DataRequest.h"
+#include "Filename.h"
+#include "ModelServices.h"
+#include "PageCompression.h"
+#include "PlugInArgList.h"
+#include "PlugInManagerServices.h"
+#include "RasterDataDescriptor.h"
+#include "RasterElement.h"
+#include "UtilityServices.h"
+
+#include <QtCore/QMutexLocker>
+#include <QtCore/QTime>
+
+#include <algorithm>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+using namespace std;
+
+namespace
+{
+   // Tiles hold whole rows, so a tile may be larger than this for very wide data
+   const size_t sTargetTileSize = 1024 * 1024;
+
+   const unsigned int sDefaultWorkingSetSize = 64;
+   const size_t sMegabyte = 1024 * 1024;
+   const int sLeaseWaitMilliseconds = 100;
+}
+
+CompressedPager::Page::Page(void* pData, unsigned int numRows, size_t tile, Qt::HANDLE thread) :
+   InMemoryPage(pData, numRows),
+   mTile(tile),
+   mThread(thread)
+{
+}
+
+size_t CompressedPager::Page::getTile() const
+{
+   return mTile;
+}
+
+Qt::HANDLE CompressedPager::Page::getThread() const
+{
+   return mThread;
+}
+
+CompressedPager::Tile::Tile() :
+   mpData(NULL),
+   mRaw(false),
+   mSpillOffset(-1),
+   mSpillSize(0),
+   mLeases(0),
+   mDirty(false),
+   mBusy(false),
+   mCompressTask(0),
+   mResident(false),
+   mCompressedInMemory(false)
+{
+}
+
+CompressedPager::CompressedPager() :
+   mpRaster(NULL),
+   mInterleave(BIP),
+   mNumRows(0),
+   mNumColumns(0),
+   mNumBands(0),
+   mBytesPerElement(0),
+   mTileRows(0),
+   mTilesPerBand(0),
+   mRowSize(0),
+   mTileSize(0),
+   mWorkingSetSize(0),
+   mMemoryBudget(0),
+   mMaxCompressions(1),
+   mResidentBytes(0),
+   mCompressedBytes(0),
+   mPendingCompressions(0),
+   mLeases(0),
+   mSpillEnd(0)
+{
+   setName("Compressed Pager");
+   setCopyright("Copyright (2010) by Ball Aerospace & Technologies Corp.");
+   setCreator("Ball Aerospace & Technologies Corp.");
+   setDescription("Provides access to data which is stored compressed in memory");
+   setDescriptorId("{7B0E5A3C-2F64-4D1B-9C8E-41A6D2F3B857}");
+   setVersion(APP_VERSION_NUMBER);
+   setProductionStatus(APP_IS_PRODUCTION_RELEASE);
+   setShortDescription("Provides a compressed RAM backing for data");
+}
+
+CompressedPager::~CompressedPager()
+{
+   // Tiles being compressed on the thread pool refer to this pager.  The pool finishes a task only after its
+   // function has returned and released the lock, so the pager is no longer used once every task is waited for.
+   deque<unsigned int> compressTasks;
+   mMutex.lock();
+   compressTasks.swap(mCompressTasks);
+   mMutex.unlock();
+   Service<UtilityServices> pUtilities;
+   for (deque<unsigned int>::const_iterator iter = compressTasks.begin(); iter != compressTasks.end(); ++iter)
+   {
+      pUtilities->waitForThreadPool(*iter);
+   }
+
+   Service<ModelServices> pModel;
+   for (vector<Tile>::iterator iter = mTiles.begin(); iter != mTiles.end(); ++iter)
+   {
+      if (iter->mpData != NULL)
+      {
+         pModel->releasePageBuffer(iter->mpData);
+      }
+   }
+
+   if (mSpillFilename.empty() == false)
+   {
+      mSpillFile.close();
+      remove(mSpillFilename.c_str());
+   }
+}
+
+bool CompressedPager::getInputSpecification(PlugInArgList*& pArgList)
+{
+   Service<PlugInManagerServices> pPlugInMgr;
+
+   pArgList = pPlugInMgr->getPlugInArgList();
+   VERIFY(pArgList != NULL);
+
+   VERIFY(pArgList->addArg<RasterElement>("Raster Element"));
+   VERIFY(pArgList->addArg<unsigned int>("Working Set Size", sDefaultWorkingSetSize,
+      "The number of megabytes of decompressed tiles to keep in memory."));
+   VERIFY(pArgList->addArg<unsigned int>("Memory Budget", 0, "The number of megabytes of compressed tiles to keep "
+      "in memory before writing them to a temporary file.  If zero, an eighth of the physical memory is used."));
+
+   return true;
+}
+
+bool CompressedPager::execute(PlugInArgList* pInput, PlugInArgList* pOutput)
+{
+   VERIFY(mpRaster == NULL);
+   VERIFY(pInput != NULL);
+
+   mpRaster = pInput->getPlugInArgValue<RasterElement>("Raster Element");
+   VERIFY(mpRaster != NULL);
+
+   const RasterDataDescriptor* pDescriptor =
+      dynamic_cast<const RasterDataDescriptor*>(mpRaster->getDataDescriptor());
+   VERIFY(pDescriptor != NULL);
+
+   mInterleave = pDescriptor->getInterleaveFormat();
+   mNumRows = pDescriptor->getRowCount();
+   mNumColumns = pDescriptor->getColumnCount();
+   mNumBands = pDescriptor->getBandCount();
+   mBytesPerElement = pDescriptor->getBytesPerElement();
+   VERIFY(mNumRows > 0 && mNumColumns > 0 && mNumBands > 0 && mBytesPerElement > 0);
+
+   mRowSize = static_cast<size_t>(mNumColumns) * mBytesPerElement;
+   if (mInterleave != BSQ)
+   {
+      mRowSize *= mNumBands;
+   }
+
+   mTileRows = static_cast<unsigned int>(min(max(sTargetTileSize / mRowSize, static_cast<size_t>(1)),
+      static_cast<size_t>(mNumRows)));
+   mTilesPerBand = (mNumRows + mTileRows - 1) / mTileRows;
+   mTileSize = mTileRows * mRowSize;
+   mTiles.resize((mInterleave == BSQ ? mNumBands : 1) * static_cast<size_t>(mTilesPerBand));
+
+   unsigned int workingSetSize = sDefaultWorkingSetSize;
+   pInput->getPlugInArgValue("Working Set Size", workingSetSize);
+   mWorkingSetSize = workingSetSize * sMegabyte;
+
+   unsigned int memoryBudget = 0;
+   pInput->getPlugInArgValue("Memory Budget", memoryBudget);
+   mMemoryBudget = memoryBudget * sMegabyte;
+
+   Service<UtilityServices> pUtilities;
+   if (mMemoryBudget == 0)
+   {
+      mMemoryBudget = pUtilities->getTotalPhysicalMemory() / 8;
+      if (mMemoryBudget == 0)
+      {
+         mMemoryBudget = 512 * sMegabyte;
+      }
+   }
+
+   mMaxCompressions = max(pUtilities->getNumProcessors(), 1U);
+   return true;
+}
+
+RasterPage* CompressedPager::getPage(DataRequest* pOriginalRequest, DimensionDescriptor startRow,
+                                     DimensionDescriptor startColumn, DimensionDescriptor startBand)
+{
+   VERIFYRV(mpRaster != NULL, NULL);
+   VERIFYRV(pOriginalRequest != NULL, NULL);
+
+   if (pOriginalRequest->getInterleaveFormat() != mInterleave)
+   {
+      return NULL;
+   }
+
+   unsigned int rowNumber = startRow.getActiveNumber();
+   unsigned int colNumber = startColumn.getActiveNumber();
+   unsigned int bandNumber = startBand.getActiveNumber();
+   if (rowNumber >= mNumRows || colNumber >= mNumColumns || bandNumber >= mNumBands)
+   {
+      return NULL;
+   }
+
+   size_t tile = rowNumber / mTileRows;
+   if (mInterleave == BSQ)
+   {
+      tile += static_cast<size_t>(bandNumber) * mTilesPerBand;
+   }
+
+   Qt::HANDLE thread = QThread::currentThreadId();
+   char* pTile = acquireTile(tile, pOriginalRequest->getWritable(), thread);
+   if (pTile == NULL)
+   {
+      return NULL;
+   }
+
+   unsigned int tileRow = rowNumber % mTileRows;
+   unsigned int tileRows = min(mTileRows, mNumRows - (rowNumber - tileRow));
+   size_t offset = tileRow * mRowSize;
+   switch (mInterleave)
+   {
+   case BIP:
+      offset += (static_cast<size_t>(colNumber) * mNumBands + bandNumber) * mBytesPerElement;
+      break;
+   case BSQ:
+      offset += static_cast<size_t>(colNumber) * mBytesPerElement;
+      break;
+   case BIL:
+      offset += (static_cast<size_t>(bandNumber) * mNumColumns + colNumber) * mBytesPerElement;
+      break;
+   default:
+      break;
+   }
+
+   return new Page(pTile + offset, tileRows - tileRow, tile, thread);
+}
+
+void CompressedPager::releasePage(RasterPage* pPage)
+{
+   Page* pTilePage = dynamic_cast<Page*>(pPage);
+   if (pTilePage == NULL)
+   {
+      return;
+   }
+
+   QMutexLocker lock(&mMutex);
+   Tile& tile = mTiles[pTilePage->getTile()];
+   VERIFYNRV(tile.mLeases > 0);
+   --tile.mLeases;
+   --mLeases;
+
+   map<Qt::HANDLE, unsigned int>::iterator threadLeases = mThreadLeases.find(pTilePage->getThread());
+   if (threadLeases != mThreadLeases.end() && --threadLeases->second == 0)
+   {
+      mThreadLeases.erase(threadLeases);
+   }
+   delete pTilePage;
+
+   // Threads waiting for space in the working set check it again
+   evictTiles(0, lock);
+   mTileReady.wakeAll();
+}
+
+int CompressedPager::getSupportedRequestVersion() const
+{
+   return 1;
+}
+
+void CompressedPager::compressTile(void* pTask)
+{
+   CompressTask* pCompressTask = reinterpret_cast<CompressTask*>(pTask);
+   CompressedPager* pPager = pCompressTask->mpPager;
+
+   size_t tileIndex = pCompressTask->mTile;
+   char* pData = pCompressTask->mpData;
+   delete pCompressTask;
+
+   // storeTile() is called without holding the lock and returns holding it.  Completion is not signaled
+   // here, since the pager may be destroyed as soon as it sees the task finish.
+   QMutexLocker lock(&pPager->mMutex);
+   lock.unlock();
+   pPager->storeTile(tileIndex, pData, lock);
+   --pPager->mPendingCompressions;
+}
+
+char* CompressedPager::acquireTile(size_t tileIndex, bool writable, Qt::HANDLE thread)
+{
+   QMutexLocker lock(&mMutex);
+   Tile& tile = mTiles[tileIndex];
+   QTime waitTime;
+   waitTime.start();
+   for (;;)
+   {
+      if (tile.mBusy)
+      {
+         // Wait for a compression through the thread pool, which runs it on this thread if every pool thread
+         // is busy.  Each task is waited for once, so a task which is no longer listed is already being waited for.
+         deque<unsigned int>::iterator task = find(mCompressTasks.begin(), mCompressTasks.end(), tile.mCompressTask);
+         tile.mCompressTask = 0;
+         if (task != mCompressTasks.end())
+         {
+            unsigned int compressTask = *task;
+            mCompressTasks.erase(task);
+            lock.unlock();
+            Service<UtilityServices>()->waitForThreadPool(compressTask);
+            lock.relock();
+         }
+         else
+         {
+            mTileReady.wait(&mMutex);
+         }
+         continue;
+      }
+
+      if (tile.mpData != NULL)
+      {
+         break;
+      }
+
+      // Make room for the tile, which may release the lock
+      evictTiles(mTileSize, lock);
+      if (tile.mBusy || tile.mpData != NULL)
+      {
+         continue;
+      }
+
+      // The rest of the working set is leased, so wait for other threads to release a tile.  The wait is
+      // limited, since those threads may be waiting for a tile leased by this one.
+      unsigned int ownLeases = 0;
+      map<Qt::HANDLE, unsigned int>::const_iterator threadLeases = mThreadLeases.find(thread);
+      if (threadLeases != mThreadLeases.end())
+      {
+         ownLeases = threadLeases->second;
+      }
+
+      int remainingTime = sLeaseWaitMilliseconds - waitTime.elapsed();
+      if (mResidentBytes + mTileSize <= mWorkingSetSize || mLeases == ownLeases || remainingTime <= 0)
+      {
+         break;
+      }
+
+      mTileReady.wait(&mMutex, static_cast<unsigned long>(remainingTime));
+   }
+
+   if (tile.mpData == NULL)
+   {
+      // Decompress without holding the lock, so other threads can decompress other tiles.  The tile is
+      // counted in the working set while it is decompressed.
+      tile.mBusy = true;
+      mResidentBytes += mTileSize;
+      lock.unlock();
+
+      Service<ModelServices> pModel;
+      char* pData = pModel->getPageBuffer(mTileSize);
+      if (pData != NULL && restoreTile(tile, pData) == false)
+      {
+         pModel->releasePageBuffer(pData);
+         pData = NULL;
+      }
+
+      lock.relock();
+      tile.mBusy = false;
+      mTileReady.wakeAll();
+      if (pData == NULL)
+      {
+         mResidentBytes -= mTileSize;
+         return NULL;
+      }
+
+      tile.mpData = pData;
+      tile.mResident = true;
+      tile.mResidentPos = mResidentTiles.insert(mResidentTiles.end(), tileIndex);
+   }
+   else
+   {
+      mResidentTiles.splice(mResidentTiles.end(), mResidentTiles, tile.mResidentPos);
+   }
+
+   if (tile.mCompressedInMemory)
+   {
+      mCompressedTiles.splice(mCompressedTiles.end(), mCompressedTiles, tile.mCompressedPos);
+   }
+
+   ++tile.mLeases;
+   ++mLeases;
+   ++mThreadLeases[thread];
+   if (writable)
+   {
+      tile.mDirty = true;
+   }
+
+   char* pData = tile.mpData;
+   evictTiles(0, lock);
+   return pData;
+}
+
+bool CompressedPager::restoreTile(const Tile& tile, char* pData)
+{
+   // The tile is busy, so its compressed data is not changed by other threads
+   if (tile.mCompressedInMemory)
+   {
+      if (tile.mRaw)
+      {
+         VERIFY(tile.mCompressed.size() == mTileSize);
+         memcpy(pData, &tile.mCompressed.front(), mTileSize);
+         return true;
+      }
+
+      return PageCompression::decompress(&tile.mCompressed.front(), tile.mCompressed.size(), pData, mTileSize);
+   }
+
+   if (tile.mSpillOffset >= 0)
+   {
+      vector<char> compressed;
+      if (readSpill(tile.mSpillOffset, tile.mSpillSize, compressed) == false)
+      {
+         return false;
+      }
+
+      if (tile.mRaw)
+      {
+         memcpy(pData, &compressed.front(), mTileSize);
+         return true;
+      }
+
+      return PageCompression::decompress(&compressed.front(), compressed.size(), pData, mTileSize);
+   }
+
+   // The tile has never been written
+   memset(pData, 0, mTileSize);
+   return true;
+}
+
+void CompressedPager::storeTile(size_t tileIndex, char* pData, QMutexLocker& lock)
+{
+   // Called without holding the lock while the tile is busy
+   vector<char> compressed;
+   PageCompression::compress(pData, mTileSize, compressed);
+   bool raw = compressed.size() >= mTileSize;
+   if (raw)
+   {
+      compressed.assign(pData, pData + mTileSize);
+   }
+   else
+   {
+      vector<char>(compressed.begin(), compressed.end()).swap(compressed);
+   }
+   Service<ModelServices>()->releasePageBuffer(pData);
+
+   lock.relock();
+   Tile& tile = mTiles[tileIndex];
+   releaseSpill(tile);
+   if (tile.mCompressedInMemory == false)
+   {
+      tile.mCompressedInMemory = true;
+      tile.mCompressedPos = mCompressedTiles.insert(mCompressedTiles.end(), tileIndex);
+   }
+   else
+   {
+      mCompressedTiles.splice(mCompressedTiles.end(), mCompressedTiles, tile.mCompressedPos);
+   }
+
+   mCompressedBytes -= tile.mCompressed.size();
+   tile.mCompressed.swap(compressed);
+   tile.mRaw = raw;
+   mCompressedBytes += tile.mCompressed.size();
+   tile.mDirty = false;
+   tile.mBusy = false;
+   tile.mCompressTask = 0;
+   mTileReady.wakeAll();
+
+   spillTiles(lock);
+}
+
+void CompressedPager::evictTiles(size_t reserve, QMutexLocker& lock)
+{
+   // Called while holding the lock, and leaves room for the reserved number of bytes if possible
+   list<size_t>::iterator iter = mResidentTiles.begin();
+   while (mResidentBytes + reserve > mWorkingSetSize && iter != mResidentTiles.end())
+   {
+      size_t tileIndex = *iter;
+      Tile& tile = mTiles[tileIndex];
+      if (tile.mLeases > 0 || tile.mBusy)
+      {
+         ++iter;
+         continue;
+      }
+
+      iter = mResidentTiles.erase(iter);
+      tile.mResident = false;
+      mResidentBytes -= mTileSize;
+
+      char* pData = tile.mpData;
+      tile.mpData = NULL;
+      if (tile.mDirty == false)
+      {
+         Service<ModelServices>()->releasePageBuffer(pData);
+         continue;
+      }
+
+      // Compress the tile on the thread pool unless every processor is already compressing a tile
+      tile.mBusy = true;
+      if (mPendingCompressions < mMaxCompressions)
+      {
+         ++mPendingCompressions;
+         CompressTask* pTask = new CompressTask;
+         pTask->mpPager = this;
+         pTask->mTile = tileIndex;
+         pTask->mpData = pData;
+         tile.mCompressTask = Service<UtilityServices>()->startInThreadPool(CompressedPager::compressTile, pTask);
+         mCompressTasks.push_back(tile.mCompressTask);
+
+         // Wait for the oldest tasks, which have almost always finished, so the list of tasks stays short
+         if (mCompressTasks.size() > 2 * mMaxCompressions)
+         {
+            unsigned int task = mCompressTasks.front();
+            mCompressTasks.pop_front();
+            lock.unlock();
+            Service<UtilityServices>()->waitForThreadPool(task);
+            lock.relock();
+            iter = mResidentTiles.begin();
+         }
+      }
+      else
+      {
+         lock.unlock();
+         storeTile(tileIndex, pData, lock);
+         iter = mResidentTiles.begin();
+      }
+   }
+}
+
+void CompressedPager::spillTiles(QMutexLocker& lock)
+{
+   // Called while holding the lock
+   list<size_t>::iterator iter = mCompressedTiles.begin();
+   while (mCompressedBytes > mMemoryBudget && iter != mCompressedTiles.end())
+   {
+      size_t tileIndex = *iter;
+      Tile& tile = mTiles[tileIndex];
+      if (tile.mBusy)
+      {
+         ++iter;
+         continue;
+      }
+
+      iter = mCompressedTiles.erase(iter);
+      tile.mCompressedInMemory = false;
+      tile.mBusy = true;
+
+      vector<char> compressed;
+      compressed.swap(tile.mCompressed);
+      mCompressedBytes -= compressed.size();
+
+      lock.unlock();
+      int64_t offset = writeSpill(compressed);
+      lock.relock();
+
+      tile.mBusy = false;
+      mTileReady.wakeAll();
+      if (offset < 0)
+      {
+         // Keep the tile in memory if the temporary file cannot be written
+         tile.mCompressed.swap(compressed);
+         tile.mCompressedInMemory = true;
+         tile.mCompressedPos = mCompressedTiles.insert(mCompressedTiles.end(), tileIndex);
+         mCompressedBytes += tile.mCompressed.size();
+         break;
+      }
+
+      tile.mSpillOffset = offset;
+      tile.mSpillSize = compressed.size();
+      iter = mCompressedTiles.begin();
+   }
+}
+
+void CompressedPager::releaseSpill(Tile& tile)
+{
+   if (tile.mSpillOffset >= 0)
+   {
+      QMutexLocker spillLock(&mSpillMutex);
+      int64_t offset = tile.mSpillOffset;
+      size_t size = tile.mSpillSize;
+      tile.mSpillOffset = -1;
+      tile.mSpillSize = 0;
+
+      // Merge the space with the free space next to it, so that it can hold larger tiles
+      map<int64_t, size_t>::iterator next = mFreeSpill.lower_bound(offset);
+      if (next != mFreeSpill.end() && offset + static_cast<int64_t>(size) == next->first)
+      {
+         size += next->second;
+         mFreeSpill.erase(next++);
+      }
+
+      if (next != mFreeSpill.begin())
+      {
+         map<int64_t, size_t>::iterator previous = next;
+         --previous;
+         if (previous->first + static_cast<int64_t>(previous->second) == offset)
+         {
+            offset = previous->first;
+            size += previous->second;
+            mFreeSpill.erase(previous);
+         }
+      }
+
+      // Space at the end of the file is written again by the next tile which does not fit in the free space
+      if (offset + static_cast<int64_t>(size) == mSpillEnd)
+      {
+         mSpillEnd = offset;
+      }
+      else
+      {
+         mFreeSpill.insert(make_pair(offset, size));
+      }
+   }
+}
+
+int64_t CompressedPager::writeSpill(const vector<char>& data)
+{
+   QMutexLocker spillLock(&mSpillMutex);
+   if (mSpillFilename.empty())
+   {
+      const Filename* pTempPath = ConfigurationSettings::getSettingTempPath();
+      string tempPath;
+      if (pTempPath != NULL)
+      {
+         tempPath = pTempPath->getFullPathAndName();
+      }
+
+      char* pTempFilename = tempnam(tempPath.c_str(), "RC");
+      if (pTempFilename == NULL)
+      {
+         return -1;
+      }
+      string filename = pTempFilename;
+      free(pTempFilename);
+
+      if (mSpillFile.open(filename, O_RDWR | O_CREAT | O_BINARY, S_IREAD | S_IWRITE) == false)
+      {
+         return -1;
+      }
+      mSpillFilename = filename;
+   }
+
+   // Reuse the smallest free space which holds the tile
+   int64_t offset = mSpillEnd;
+   map<int64_t, size_t>::iterator space = mFreeSpill.end();
+   for (map<int64_t, size_t>::iterator iter = mFreeSpill.begin(); iter != mFreeSpill.end(); ++iter)
+   {
+      if (iter->second >= data.size() && (space == mFreeSpill.end() || iter->second < space->second))
+      {
+         space = iter;
+      }
+   }
+
+   if (space != mFreeSpill.end())
+   {
+      offset = space->first;
+   }
+
+   if (mSpillFile.seek(offset, SEEK_SET) != offset ||
+      mSpillFile.write(&data.front(), static_cast<int64_t>(data.size())) != static_cast<int64_t>(data.size()))
+   {
+      return -1;
+   }
+
+   if (space != mFreeSpill.end())
+   {
+      size_t remainingSize = space->second - data.size();
+      mFreeSpill.erase(space);
+      if (remainingSize > 0)
+      {
+         mFreeSpill.insert(make_pair(offset + static_cast<int64_t>(data.size()), remainingSize));
+      }
+   }
+
+   mSpillEnd = max(mSpillEnd, offset + static_cast<int64_t>(data.size()));
+   return offset;
+}
+
+bool CompressedPager::readSpill(int64_t offset, size_t size, vector<char>& data)
+{
+   QMutexLocker spillLock(&mSpillMutex);
+   data.resize(size);
+   return mSpillFile.seek(offset, SEEK_SET) == offset &&
+      mSpillFile.read(&data.front(), static_cast<int64_t>(size)) == static_cast<int64_t>(size);
+}
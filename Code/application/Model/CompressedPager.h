@@ -0,0 +1,145 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2007 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#ifndef COMPRESSEDPAGER_H
+#define COMPRESSEDPAGER_H
+
+#include "FileResource.h"
+#include "InMemoryPage.h"
+#include "RasterPagerShell.h"
+#include "TypesFile.h"
+
+#include <QtCore/QMutex>
+#include <QtCore/QThread>
+#include <QtCore/QWaitCondition>
+
+#include <deque>
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+
+class QMutexLocker;
+class RasterElement;
+
+/**
+ *  Stores the data of a writable RasterElement compressed in memory.
+ *
+ *  The data is divided into tiles of whole rows, with one band in each tile of
+ *  BSQ data.  Tiles are decompressed into a small working set of page buffers
+ *  as they are requested.  Once the working set is full, the least recently
+ *  used tiles are removed from it, and tiles which were written to are
+ *  compressed again on the application's thread pool.  While the rest of the
+ *  working set is leased by other threads, a thread requesting another tile
+ *  waits briefly for one to be released.  Tiles which have never been written
+ *  to use no memory.  The compressed tiles which were least recently used are
+ *  written to a temporary file while the compressed data exceeds the memory
+ *  budget, and the space of adjacent released tiles in the file is merged so
+ *  that it can be reused.
+ */
+class CompressedPager : public RasterPagerShell
+{
+public:
+   CompressedPager();
+   ~CompressedPager();
+
+   bool getInputSpecification(PlugInArgList*& pArgList);
+   bool execute(PlugInArgList* pInput, PlugInArgList* pOutput);
+
+   RasterPage* getPage(DataRequest* pOriginalRequest, DimensionDescriptor startRow, DimensionDescriptor startColumn,
+      DimensionDescriptor startBand);
+   void releasePage(RasterPage* pPage);
+
+   int getSupportedRequestVersion() const;
+
+private:
+   class Page : public InMemoryPage
+   {
+   public:
+      Page(void* pData, unsigned int numRows, size_t tile, Qt::HANDLE thread);
+
+      size_t getTile() const;
+      Qt::HANDLE getThread() const;
+
+   private:
+      size_t mTile;
+      Qt::HANDLE mThread;
+   };
+
+   struct Tile
+   {
+      Tile();
+
+      char* mpData;
+      std::vector<char> mCompressed;
+      bool mRaw;
+      int64_t mSpillOffset;
+      size_t mSpillSize;
+      unsigned int mLeases;
+      bool mDirty;
+      bool mBusy;
+      unsigned int mCompressTask;
+      bool mResident;
+      std::list<size_t>::iterator mResidentPos;
+      bool mCompressedInMemory;
+      std::list<size_t>::iterator mCompressedPos;
+   };
+
+   struct CompressTask
+   {
+      CompressedPager* mpPager;
+      size_t mTile;
+      char* mpData;
+   };
+
+   static void compressTile(void* pTask);
+
+   char* acquireTile(size_t tile, bool writable, Qt::HANDLE thread);
+   bool restoreTile(const Tile& tile, char* pData);
+   void storeTile(size_t tile, char* pData, QMutexLocker& lock);
+   void evictTiles(size_t reserve, QMutexLocker& lock);
+   void spillTiles(QMutexLocker& lock);
+   void releaseSpill(Tile& tile);
+   int64_t writeSpill(const std::vector<char>& data);
+   bool readSpill(int64_t offset, size_t size, std::vector<char>& data);
+
+   RasterElement* mpRaster;
+   InterleaveFormatType mInterleave;
+   unsigned int mNumRows;
+   unsigned int mNumColumns;
+   unsigned int mNumBands;
+   unsigned int mBytesPerElement;
+   unsigned int mTileRows;
+   unsigned int mTilesPerBand;
+   size_t mRowSize;
+   size_t mTileSize;
+   size_t mWorkingSetSize;
+   size_t mMemoryBudget;
+   unsigned int mMaxCompressions;
+
+   QMutex mMutex;
+   QWaitCondition mTileReady;
+   std::vector<Tile> mTiles;
+   std::list<size_t> mResidentTiles;
+   std::list<size_t> mCompressedTiles;
+   size_t mResidentBytes;
+   size_t mCompressedBytes;
+   unsigned int mPendingCompressions;
+   std::deque<unsigned int> mCompressTasks;
+   unsigned int mLeases;
+   std::map<Qt::HANDLE, unsigned int> mThreadLeases;
+
+   QMutex mSpillMutex;
+   std::string mSpillFilename;
+   LargeFileResource mSpillFile;
+   int64_t mSpillEnd;
+   std::map<int64_t, size_t> mFreeSpill;
+};
+
+#endif
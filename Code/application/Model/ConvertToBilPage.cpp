@@ -11,7 +11,7 @@
 
 ConvertToBilPage::ConvertToBilPage(unsigned int rows, unsigned int columns, unsigned int bands,
                                    unsigned int bytesPerElement) :
-   mCache(rows * columns * bands * bytesPerElement, true),
+   mCache(rows * columns * bands * bytesPerElement),
    mRows(rows),
    mColumns(columns),
    mBands(bands)
@@ -31,7 +31,7 @@ public:
    void* getRawData();
 
 private:
-   ArrayResource<unsigned char> mCache;
+   PageBufferResource mCache;
 
    unsigned int mRows;
    unsigned int mColumns;
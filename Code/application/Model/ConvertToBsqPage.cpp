@@ -10,7 +10,7 @@
 #include "ConvertToBsqPage.h"
 
 ConvertToBsqPage::ConvertToBsqPage(unsigned int rows, unsigned int columns, unsigned int bytesPerElement) :
-   mCache(rows * columns * bytesPerElement, true),
+   mCache(rows * columns * bytesPerElement),
    mRows(rows),
    mColumns(columns)
 {
@@ -46,6 +46,21 @@
 
 using namespace std;
 
+namespace
+{
+   // Page buffers may use a quarter of the physical memory
+   size_t getPageBufferBudget()
+   {
+      size_t physicalMemory = UtilityServicesImp::instance()->getTotalPhysicalMemory();
+      if (physicalMemory == 0)
+      {
+         return 256 * 1024 * 1024;
+      }
+
+      return physicalMemory / 4;
+   }
+}
+
 ModelServicesImp* ModelServicesImp::spInstance = NULL;
 bool ModelServicesImp::mDestroyed = false;
 
@@ -77,7 +92,8 @@ void ModelServicesImp::destroy()
 }
 
 ModelServicesImp::ModelServicesImp() : 
-   SettableSessionItemAdapter("{543BF9C3-2861-4240-ADD7-6748C3BF4F90}")
+   SettableSessionItemAdapter("{543BF9C3-2861-4240-ADD7-6748C3BF4F90}"),
+   mPageBuffers(getPageBufferBudget())
 {
    mElementTypes.push_back("AnnotationElement");
    mElementTypes.push_back("Any");
@@ -773,6 +789,13 @@ bool ModelServicesImp::destroyElement(DataElement* pElement)
       DataElementImp* pElementImp = dynamic_cast<DataElementImp*>(pElement);
       if (pElementImp != NULL)
       {
+         // Keep the paging statistics of the element in the totals
+         RasterElementImp* pRasterImp = dynamic_cast<RasterElementImp*>(pElementImp);
+         if (pRasterImp != NULL)
+         {
+            addPagerStatistics(pRasterImp->getPagerStatistics());
+         }
+
          notify(SIGNAL_NAME(ModelServices, ElementDestroyed), boost::any(pElement));
          delete pElementImp;
       }
@@ -821,6 +844,64 @@ void ModelServicesImp::deleteMemoryBlock(char* memory)
    delete [] memory;
 }
 
+void ModelServicesImp::addPagerStatistics(const PagerStatistics& statistics)
+{
+   mta::MutexLock lock(mPagerStatisticsMutex);
+   mPagerStatistics.merge(statistics);
+}
+
+PagerStatistics ModelServicesImp::getPagerStatistics() const
+{
+   PagerStatistics statistics;
+   {
+      mta::MutexLock lock(mPagerStatisticsMutex);
+      statistics = mPagerStatistics;
+   }
+
+   for (multimap<Key, DataElement*>::const_iterator iter = mElements.begin(); iter != mElements.end(); ++iter)
+   {
+      const RasterElementImp* pRasterImp = dynamic_cast<const RasterElementImp*>(iter->second);
+      if (pRasterImp != NULL)
+      {
+         statistics.merge(pRasterImp->getPagerStatistics());
+      }
+   }
+
+   return statistics;
+}
+
+void ModelServicesImp::resetPagerStatistics()
+{
+   {
+      mta::MutexLock lock(mPagerStatisticsMutex);
+      mPagerStatistics.reset();
+   }
+
+   for (multimap<Key, DataElement*>::iterator iter = mElements.begin(); iter != mElements.end(); ++iter)
+   {
+      RasterElementImp* pRasterImp = dynamic_cast<RasterElementImp*>(iter->second);
+      if (pRasterImp != NULL)
+      {
+         pRasterImp->resetPagerStatistics();
+      }
+   }
+}
+
+char* ModelServicesImp::getPageBuffer(size_t size)
+{
+   return mPageBuffers.obtainBuffer(size);
+}
+
+bool ModelServicesImp::releasePageBuffer(char* pBuffer)
+{
+   return mPageBuffers.releaseBuffer(pBuffer);
+}
+
+size_t ModelServicesImp::getPageBufferBudgetExcess() const
+{
+   return mPageBuffers.getBudgetExcess();
+}
+
 bool ModelServicesImp::isKindOfElement(const string& className, const string& elementName) const
 {
    bool bSuccess = false;
@@ -13,7 +13,9 @@
 #include <xercesc/dom/DOM.hpp>
 
 #include "DataElement.h"
+#include "DMutex.h"
 #include "ModelServices.h"
+#include "PageBufferPool.h"
 #include "SettableSessionItemAdapter.h"
 #include "StringUtilities.h"
 #include "SubjectImp.h"
@@ -72,6 +74,13 @@ public:
    char* getMemoryBlock(size_t size);
    void deleteMemoryBlock(char* memory); 
 
+   void addPagerStatistics(const PagerStatistics& statistics);
+   PagerStatistics getPagerStatistics() const;
+   void resetPagerStatistics();
+   char* getPageBuffer(size_t size);
+   bool releasePageBuffer(char* pBuffer);
+   size_t getPageBufferBudgetExcess() const;
+
    bool isKindOfElement(const std::string& className, const std::string& elementName) const;
    void getElementTypes(const std::string& className, std::vector<std::string>& classList) const;
    bool isKindOfDataDescriptor(const std::string& className, const std::string& descriptorName) const;
@@ -151,6 +160,9 @@ private:
    static bool mDestroyed;
    std::vector<std::string> mElementTypes;
    std::multimap<Key, DataElement*> mElements;
+   PagerStatistics mPagerStatistics;
+   mutable mta::DMutex mPagerStatisticsMutex;
+   PageBufferPool mPageBuffers;
 
    std::multimap<Key, DataElement*>::iterator findElement(const DataElement* pElement);
    std::multimap<Key, DataElement*>::iterator findElement(const Key& key, const std::string& type);
@@ -0,0 +1,201 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2007 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#include "AppConfig.h"
+#include "PageBufferPool.h"
+
+#if defined(WIN_API)
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+using namespace std;
+
+namespace
+{
+   // Buffers are allocated in whole pages
+   const size_t sMinimumClassSize = 4096;
+
+   // Buffers at least this large are backed by huge pages when possible
+   const size_t sHugePageThreshold = 2 * 1024 * 1024;
+}
+
+PageBufferPool::PageBufferPool(size_t budget) :
+   mBudget(budget),
+   mBytesInUse(0),
+   mBytesFree(0)
+{
+}
+
+PageBufferPool::~PageBufferPool()
+{
+   for (map<size_t, vector<char*> >::iterator iter = mFreeBuffers.begin(); iter != mFreeBuffers.end(); ++iter)
+   {
+      for (vector<char*>::iterator buffer = iter->second.begin(); buffer != iter->second.end(); ++buffer)
+      {
+         deallocate(*buffer, iter->first);
+      }
+   }
+}
+
+char* PageBufferPool::obtainBuffer(size_t size)
+{
+   if (size == 0)
+   {
+      return NULL;
+   }
+
+   const size_t classSize = getClassSize(size);
+   char* pBuffer = NULL;
+   {
+      mta::MutexLock lock(mMutex);
+      map<size_t, vector<char*> >::iterator iter = mFreeBuffers.find(classSize);
+      if (iter != mFreeBuffers.end() && iter->second.empty() == false)
+      {
+         pBuffer = iter->second.back();
+         iter->second.pop_back();
+         mBytesFree -= classSize;
+         mBytesInUse += classSize;
+         mBuffersInUse[pBuffer] = classSize;
+         return pBuffer;
+      }
+
+      // Make room for the new buffer by returning free buffers of other sizes
+      mBytesInUse += classSize;
+      trim();
+   }
+
+   // Allocate without the lock, since the system may need to zero the memory
+   pBuffer = allocate(classSize);
+
+   mta::MutexLock lock(mMutex);
+   if (pBuffer == NULL)
+   {
+      mBytesInUse -= classSize;
+      return NULL;
+   }
+
+   mBuffersInUse[pBuffer] = classSize;
+   return pBuffer;
+}
+
+bool PageBufferPool::releaseBuffer(char* pBuffer)
+{
+   if (pBuffer == NULL)
+   {
+      return false;
+   }
+
+   mta::MutexLock lock(mMutex);
+   map<char*, size_t>::iterator iter = mBuffersInUse.find(pBuffer);
+   if (iter == mBuffersInUse.end())
+   {
+      return false;
+   }
+
+   const size_t classSize = iter->second;
+   mBuffersInUse.erase(iter);
+   mBytesInUse -= classSize;
+   mFreeBuffers[classSize].push_back(pBuffer);
+   mBytesFree += classSize;
+   trim();
+   return true;
+}
+
+size_t PageBufferPool::getBudgetExcess() const
+{
+   mta::MutexLock lock(mMutex);
+   return (mBytesInUse > mBudget) ? mBytesInUse - mBudget : 0;
+}
+
+size_t PageBufferPool::getClassSize(size_t size)
+{
+   if (size <= sMinimumClassSize)
+   {
+      return sMinimumClassSize;
+   }
+
+   // Round up to a multiple of a quarter of the largest power of two below the
+   // size, so that no more than a fifth of a buffer is unused
+   size_t power = sMinimumClassSize;
+   while (power <= (size - 1) / 2)
+   {
+      power *= 2;
+   }
+
+   const size_t step = power / 4;
+   return ((size + step - 1) / step) * step;
+}
+
+char* PageBufferPool::allocate(size_t size)
+{
+#if defined(WIN_API)
+   void* pBuffer = NULL;
+   SIZE_T largePageSize = GetLargePageMinimum();
+   if (size >= sHugePageThreshold && largePageSize > 0 && size % largePageSize == 0)
+   {
+      // Large pages require the lock pages in memory privilege, so fall back to normal pages
+      pBuffer = VirtualAlloc(NULL, size, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+   }
+
+   if (pBuffer == NULL)
+   {
+      pBuffer = VirtualAlloc(NULL, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+   }
+
+   return static_cast<char*>(pBuffer);
+#else
+   void* pBuffer = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANON, -1, 0);
+   if (pBuffer == MAP_FAILED)
+   {
+      return NULL;
+   }
+
+#if defined(MADV_HUGEPAGE)
+   if (size >= sHugePageThreshold)
+   {
+      madvise(pBuffer, size, MADV_HUGEPAGE);
+   }
+#endif
+
+   return static_cast<char*>(pBuffer);
+#endif
+}
+
+void PageBufferPool::deallocate(char* pBuffer, size_t size)
+{
+#if defined(WIN_API)
+   VirtualFree(pBuffer, 0, MEM_RELEASE);
+#else
+   munmap(pBuffer, size);
+#endif
+}
+
+void PageBufferPool::trim()
+{
+   // Return the largest free buffers first, which frees the most memory for each buffer
+   while (mBytesFree > 0 && mBytesInUse + mBytesFree > mBudget)
+   {
+      map<size_t, vector<char*> >::reverse_iterator iter = mFreeBuffers.rbegin();
+      while (iter != mFreeBuffers.rend() && iter->second.empty())
+      {
+         ++iter;
+      }
+
+      if (iter == mFreeBuffers.rend())
+      {
+         break;
+      }
+
+      deallocate(iter->second.back(), iter->first);
+      iter->second.pop_back();
+      mBytesFree -= iter->first;
+   }
+}
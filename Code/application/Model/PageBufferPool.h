@@ -0,0 +1,97 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2007 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#ifndef PAGEBUFFERPOOL_H
+#define PAGEBUFFERPOOL_H
+
+#include "DMutex.h"
+
+#include <map>
+#include <vector>
+
+/**
+ *  Allocates page buffers for pagers and recycles them once released.
+ *
+ *  Requested sizes are rounded up to a size class, with four classes between
+ *  each power of two, and released buffers are kept in a free list for their
+ *  class.  Buffers are allocated directly from the operating system and large
+ *  buffers are backed by huge pages when the system supports them.
+ *
+ *  The budget limits the bytes held by the pool.  Free buffers are returned to
+ *  the system while the pool is over budget, and page caches remove their
+ *  least recently used units until it is not.
+ */
+class PageBufferPool
+{
+public:
+   /**
+    *  Creates an empty pool.
+    *
+    *  @param   budget
+    *           The number of bytes, in use and free, above which free buffers
+    *           are no longer kept.
+    */
+   PageBufferPool(size_t budget);
+
+   /**
+    *  Returns the free buffers to the system.
+    *
+    *  Buffers still in use are not freed.
+    */
+   ~PageBufferPool();
+
+   /**
+    *  Gets a buffer, reusing a free buffer of the same size class if possible.
+    *
+    *  @param   size
+    *           The minimum size of the buffer in bytes.
+    *
+    *  @return  The buffer, or \c NULL if \em size is zero or the memory could
+    *           not be allocated.  The contents are undefined.
+    */
+   char* obtainBuffer(size_t size);
+
+   /**
+    *  Returns a buffer to the pool.
+    *
+    *  @param   pBuffer
+    *           The buffer to return.
+    *
+    *  @return  \c True if the buffer was obtained from this pool, or \c false
+    *           if the buffer was not changed.
+    */
+   bool releaseBuffer(char* pBuffer);
+
+   /**
+    *  Gets the number of bytes in use above the budget.
+    *
+    *  @return  The bytes in use above the budget, or zero if the budget is
+    *           not exceeded.
+    */
+   size_t getBudgetExcess() const;
+
+private:
+   PageBufferPool(const PageBufferPool& rhs);
+   PageBufferPool& operator=(const PageBufferPool& rhs);
+
+   static size_t getClassSize(size_t size);
+   static char* allocate(size_t size);
+   static void deallocate(char* pBuffer, size_t size);
+
+   void trim();
+
+   mutable mta::DMutex mMutex;
+   const size_t mBudget;
+   size_t mBytesInUse;
+   size_t mBytesFree;
+   std::map<char*, size_t> mBuffersInUse;
+   std::map<size_t, std::vector<char*> > mFreeBuffers;
+};
+
+#endif
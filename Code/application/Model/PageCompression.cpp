@@ -0,0 +1,203 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2007 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#include "AppConfig.h"
+#include "PageCompression.h"
+
+#include <algorithm>
+#include <string.h>
+
+using namespace std;
+
+namespace
+{
+   const unsigned int sHashBits = 14;
+   const size_t sMinimumMatch = 4;
+   const size_t sMaximumOffset = 65535;
+
+   // The last bytes of a block are always literals, which lets the decoder stop after them
+   const size_t sLastLiterals = 5;
+   const size_t sMatchStartLimit = 12;
+
+   uint32_t read32(const unsigned char* pData)
+   {
+      uint32_t value;
+      memcpy(&value, pData, sizeof(value));
+      return value;
+   }
+
+   unsigned int hashSequence(uint32_t sequence)
+   {
+      return (sequence * 2654435761U) >> (32 - sHashBits);
+   }
+
+   void writeLength(size_t length, vector<char>& compressed)
+   {
+      while (length >= 255)
+      {
+         compressed.push_back(static_cast<char>(255));
+         length -= 255;
+      }
+      compressed.push_back(static_cast<char>(length));
+   }
+
+   void writeSequence(const unsigned char* pLiterals, size_t literalLength, size_t offset, size_t matchLength,
+      vector<char>& compressed)
+   {
+      size_t extraMatch = (matchLength >= sMinimumMatch ? matchLength - sMinimumMatch : 0);
+      unsigned char token = static_cast<unsigned char>((literalLength < 15 ? literalLength : 15) << 4);
+      if (offset > 0)
+      {
+         token |= static_cast<unsigned char>(extraMatch < 15 ? extraMatch : 15);
+      }
+      compressed.push_back(static_cast<char>(token));
+      if (literalLength >= 15)
+      {
+         writeLength(literalLength - 15, compressed);
+      }
+      compressed.insert(compressed.end(), pLiterals, pLiterals + literalLength);
+
+      if (offset > 0)
+      {
+         compressed.push_back(static_cast<char>(offset & 0xFF));
+         compressed.push_back(static_cast<char>(offset >> 8));
+         if (extraMatch >= 15)
+         {
+            writeLength(extraMatch - 15, compressed);
+         }
+      }
+   }
+
+   bool readLength(const unsigned char*& pSource, const unsigned char* pSourceEnd, size_t& length)
+   {
+      unsigned char value = 255;
+      while (value == 255)
+      {
+         if (pSource >= pSourceEnd)
+         {
+            return false;
+         }
+         value = *pSource++;
+         length += value;
+      }
+
+      return true;
+   }
+}
+
+void PageCompression::compress(const char* pSource, size_t size, vector<char>& compressed)
+{
+   compressed.clear();
+   compressed.reserve(size + size / 255 + 16);
+
+   const unsigned char* pData = reinterpret_cast<const unsigned char*>(pSource);
+   size_t anchor = 0;
+   if (size > sMatchStartLimit)
+   {
+      vector<size_t> table(static_cast<size_t>(1) << sHashBits, 0);
+      const size_t matchStartLimit = size - sMatchStartLimit;
+      const size_t matchEndLimit = size - sLastLiterals;
+
+      // Positions are stored plus one, so zero marks an empty slot
+      size_t position = 0;
+      while (position < matchStartLimit)
+      {
+         uint32_t sequence = read32(pData + position);
+         size_t& slot = table[hashSequence(sequence)];
+         size_t candidate = slot;
+         slot = position + 1;
+         if (candidate == 0 || position - (candidate - 1) > sMaximumOffset ||
+            read32(pData + candidate - 1) != sequence)
+         {
+            ++position;
+            continue;
+         }
+
+         const size_t match = candidate - 1;
+         size_t length = sMinimumMatch;
+         while (position + length < matchEndLimit && pData[match + length] == pData[position + length])
+         {
+            ++length;
+         }
+
+         writeSequence(pData + anchor, position - anchor, position - match, length, compressed);
+         position += length;
+         anchor = position;
+      }
+   }
+
+   writeSequence(pData + anchor, size - anchor, 0, 0, compressed);
+}
+
+bool PageCompression::decompress(const char* pSource, size_t size, char* pDestination, size_t destinationSize)
+{
+   const unsigned char* pInput = reinterpret_cast<const unsigned char*>(pSource);
+   const unsigned char* pInputEnd = pInput + size;
+   unsigned char* pOutput = reinterpret_cast<unsigned char*>(pDestination);
+   unsigned char* pOutputEnd = pOutput + destinationSize;
+
+   while (pInput < pInputEnd)
+   {
+      unsigned char token = *pInput++;
+      size_t literalLength = token >> 4;
+      if (literalLength == 15 && readLength(pInput, pInputEnd, literalLength) == false)
+      {
+         return false;
+      }
+      if (literalLength > static_cast<size_t>(pInputEnd - pInput) ||
+         literalLength > static_cast<size_t>(pOutputEnd - pOutput))
+      {
+         return false;
+      }
+      memcpy(pOutput, pInput, literalLength);
+      pInput += literalLength;
+      pOutput += literalLength;
+
+      // The last sequence holds only literals
+      if (pInput == pInputEnd)
+      {
+         break;
+      }
+
+      if (pInputEnd - pInput < 2)
+      {
+         return false;
+      }
+      size_t offset = pInput[0] | (static_cast<size_t>(pInput[1]) << 8);
+      pInput += 2;
+      if (offset == 0 || offset > static_cast<size_t>(pOutput - reinterpret_cast<unsigned char*>(pDestination)))
+      {
+         return false;
+      }
+
+      size_t matchLength = token & 0x0F;
+      if (matchLength == 15 && readLength(pInput, pInputEnd, matchLength) == false)
+      {
+         return false;
+      }
+      matchLength += sMinimumMatch;
+      if (matchLength > static_cast<size_t>(pOutputEnd - pOutput))
+      {
+         return false;
+      }
+
+      // A match may overlap its own output, which repeats the last offset bytes, so copy
+      // the repeated bytes in chunks that double in size
+      const unsigned char* pMatch = pOutput - offset;
+      while (matchLength > 0)
+      {
+         size_t chunk = min(static_cast<size_t>(pOutput - pMatch), matchLength);
+         memcpy(pOutput, pMatch, chunk);
+         pOutput += chunk;
+         matchLength -= chunk;
+      }
+   }
+
+   return pOutput == pOutputEnd;
+}
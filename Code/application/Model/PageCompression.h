@@ -0,0 +1,58 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2007 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#ifndef PAGECOMPRESSION_H
+#define PAGECOMPRESSION_H
+
+#include <stddef.h>
+#include <vector>
+
+/**
+ *  A fast LZ77 codec for pages of raster data.
+ *
+ *  The compressed data is a series of sequences in the LZ4 block layout.
+ *  Each sequence holds a run of literal bytes followed by a copy of earlier
+ *  output, which suits masks, classification results and other data with
+ *  long runs of repeated values.  The codec favors speed over compression
+ *  ratio and uses no memory beyond a small hash table.
+ */
+namespace PageCompression
+{
+   /**
+    *  Compresses a block of data.
+    *
+    *  @param   pSource
+    *           The data to compress.
+    *  @param   size
+    *           The number of bytes to compress.
+    *  @param   compressed
+    *           Replaced with the compressed data.  It may be larger than
+    *           \em size if the data does not compress.
+    */
+   void compress(const char* pSource, size_t size, std::vector<char>& compressed);
+
+   /**
+    *  Decompresses a block of data created by compress().
+    *
+    *  @param   pSource
+    *           The compressed data.
+    *  @param   size
+    *           The number of compressed bytes.
+    *  @param   pDestination
+    *           The buffer to receive the decompressed data.
+    *  @param   destinationSize
+    *           The number of bytes that were compressed.
+    *
+    *  @return  \c True if exactly \em destinationSize bytes were decompressed,
+    *           or \c false if the compressed data is corrupt.
+    */
+   bool decompress(const char* pSource, size_t size, char* pDestination, size_t destinationSize);
+}
+
+#endif
@@ -153,11 +153,11 @@ void PointCloudElementImp::createData()
    }
    mArrayCount = 0;
    PointCloudArrangement arrangement = pDescriptor->getArrangement();
-   if (arrangement == POINT_ARRAY)
+   if (arrangement == POINT_ARRAY || arrangement == POINT_OCTREE_ARRAY)
    {
       mArrayCount = pDescriptor->getPointCount();
    }
-   else if (arrangement == POINT_KDTREE_XY_ARRAY || POINT_KDTREE_XYZ_ARRAY)
+   else if (arrangement == POINT_KDTREE_XY_ARRAY || arrangement == POINT_KDTREE_XYZ_ARRAY)
    {
       uint32_t numElements = pDescriptor->getPointCount(); // compute the next highest power of 2 of 32-bit v
       numElements--;
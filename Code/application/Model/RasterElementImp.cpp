@@ -23,6 +23,7 @@
 #include "Importer.h"
 #include "ModelServices.h"
 #include "ObjectResource.h"
+#include "PagerStatistics.h"
 #include "PlugInArg.h"
 #include "PlugInArgList.h"
 #include "PlugInResource.h"
@@ -43,6 +44,8 @@
 #include "StatisticsImp.h"
 #include "xmlwriter.h"
 
+#include <QtCore/QMutexLocker>
+
 #include <fstream>
 #include <limits>
 #include <boost/bind.hpp>
@@ -52,6 +55,9 @@ XERCES_CPP_NAMESPACE_USE
 
 namespace
 {
+   // The number of rows covered by each flag which tracks the changes since the last session save
+   const unsigned int sSessionBlockRows = 64;
+
    double convert_s1byte_to_double(const void* pValue, int iIndex, ComplexComponent component)
    {
       return *(reinterpret_cast<const signed char*>(pValue) + iIndex);
@@ -160,8 +166,10 @@ RasterElementImp::RasterElementImp(const DataDescriptorImp& descriptor, const st
    mpBipConverterPager(NULL),
    mpBilConverterPager(NULL),
    mpBsqConverterPager(NULL),
+   mCompressed(false),
    mCubePointerAccessor(NULL, NULL),
    mModified(false),
+   mRawDataWritable(false),
    mpGeoPlugin(NULL)
 {
    RasterDataDescriptorImp* pDescriptor = dynamic_cast<RasterDataDescriptorImp*>(getDataDescriptor());
@@ -459,6 +467,36 @@ Statistics* RasterElementImp::getStatistics(DimensionDescriptor band) const
    return NULL;
 }
 
+PagerStatistics RasterElementImp::getPagerStatistics() const
+{
+   QMutexLocker lock(&mPagerStatisticsMutex);
+   return mPagerStatistics;
+}
+
+void RasterElementImp::resetPagerStatistics()
+{
+   QMutexLocker lock(&mPagerStatisticsMutex);
+   mPagerStatistics.reset();
+}
+
+void RasterElementImp::addAccessorStatistics(const DataAccessorImpl* pAccessor)
+{
+   if (pAccessor == NULL || pAccessor->mPageRequests == 0)
+   {
+      return;
+   }
+
+   RasterElementImp* pElement = dynamic_cast<RasterElementImp*>(pAccessor->mpRasterElement);
+   if (pElement != NULL)
+   {
+      // the first page is requested when the accessor is created and every other page is a refetch
+      QMutexLocker lock(&pElement->mPagerStatisticsMutex);
+      ++pElement->mPagerStatistics.mAccessorCount;
+      pElement->mPagerStatistics.mPageRequests += pAccessor->mPageRequests;
+      pElement->mPagerStatistics.mAccessorRefetches += pAccessor->mPageRequests - 1;
+   }
+}
+
 
 bool RasterElementImp::toXml(XMLWriter* pXml) const
 {
@@ -506,6 +544,7 @@ void RasterElementImp::getElementTypes(vector<string>& classList)
 
 void RasterElementImp::Deleter::operator()(DataAccessorImpl* pDataAccessor)
 {
+   addAccessorStatistics(pDataAccessor);
    delete pDataAccessor;
    delete this;
 }
@@ -1299,6 +1338,14 @@ bool RasterElementImp::setPager(RasterPager* pPager)
 
    //re-assign the pointers to hold onto the new plug-ins.
    mpPager = pPager;
+   mCompressed = false;
+
+   // the data no longer matches anything saved to a session
+   {
+      QMutexLocker lock(&mModifiedBlocksMutex);
+      mModifiedBlocks.assign(getSessionBlockCount(), 1);
+   }
+   mSessionBlockId.clear();
 
    return true;
 }
@@ -1313,6 +1360,20 @@ const string& RasterElementImp::getTemporaryFilename() const
    return mTempFilename;
 }
 
+bool RasterElementImp::isValidSessionSaveItem() const
+{
+   // read-only data without a file to import it from again, such as data computed on demand by a pager,
+   // cannot be restored from a session
+   const RasterDataDescriptor* pDescriptor = dynamic_cast<const RasterDataDescriptor*>(getDataDescriptor());
+   if (pDescriptor != NULL && pDescriptor->getProcessingLocation() == ON_DISK_READ_ONLY &&
+      pDescriptor->getFileDescriptor() == NULL)
+   {
+      return false;
+   }
+
+   return DataElementImp::isValidSessionSaveItem();
+}
+
 bool RasterElementImp::serialize(SessionItemSerializer& serializer) const
 {
    const RasterDataDescriptor* pDescriptor = dynamic_cast<const RasterDataDescriptor*>(getDataDescriptor());
@@ -1320,6 +1381,7 @@ bool RasterElementImp::serialize(SessionItemSerializer& serializer) const
 
    XMLWriter xml(getObjectType().c_str());
    xml.addAttr("displayName", getDisplayName());
+   xml.addAttr("compressed", mCompressed);
    DataElement* pParent = getParent();
    if (pParent)
    {
@@ -1357,9 +1419,6 @@ bool RasterElementImp::serialize(SessionItemSerializer& serializer) const
 
    if (mModified || pDescriptor->getFileDescriptor() == NULL)
    {
-//#pragma message(__FILE__ "(" STRING(__LINE__) ") : warning : Modify this to only save when necessary (tclarke)")
-      //mModified = false;
-
       // serialize the cube
       serializer.endBlock();
       int64_t datasetSize = static_cast<int64_t>(pDescriptor->getRowCount()) *
@@ -1368,27 +1427,141 @@ bool RasterElementImp::serialize(SessionItemSerializer& serializer) const
          pDescriptor->getBytesPerElement();
       serializer.reserve(datasetSize);
 
-      // if the entire thing is contiguous so use a single serialize
-      const void* pRawData = getRawData();
-      if (pRawData != NULL)
+      // take the flags for this save, so rows which are written while saving are flagged for the next save
+      vector<unsigned char> modifiedBlocks;
       {
-         return serializer.serialize(pRawData, datasetSize);
+         QMutexLocker lock(&mModifiedBlocksMutex);
+         modifiedBlocks.swap(mModifiedBlocks);
+         mModifiedBlocks.assign(getSessionBlockCount(), 0);
       }
 
-      // write out all the data a row at a time
-      unsigned int totalOuterBands = (pDescriptor->getInterleaveFormat() == BSQ) ? pDescriptor->getBandCount() : 1;
-      for (unsigned int outerBand = 0; outerBand < totalOuterBands; ++outerBand)
+      // if the cube is still in the block from the last save, only write the rows which changed since then
+      bool success = false;
+      bool fullSave = false;
+      if (mRawDataWritable == false && mSessionBlockId.empty() == false &&
+         modifiedBlocks.size() == getSessionBlockCount() && serializer.updateBlock(mSessionBlockId))
       {
-         // Get a data accessor with an entire concurrent row
-         FactoryResource<DataRequest> pRequest;
+         success = serializeModifiedRows(serializer, modifiedBlocks);
+      }
+      else
+      {
+         success = serializeCube(serializer);
+         fullSave = true;
+      }
+
+      if (success)
+      {
+         // the block can only be updated by the next save once this save is complete, which the serializer
+         // tracks in the block identifier, so a failed save is followed by a full save
+         mSessionBlockId = serializer.getBlockId();
+
+         // a full save captured any writes through a raw data pointer, so later saves can track the rows again,
+         // unless the element wraps memory which its creator can still write to
+         if (fullSave && pDescriptor->getProcessingLocation() != IN_MEMORY_EXISTING)
+         {
+            mRawDataWritable = false;
+         }
+      }
+      else
+      {
+         mSessionBlockId.clear();
+      }
+
+      return success;
+   }
+   return true;
+}
+
+bool RasterElementImp::serializeCube(SessionItemSerializer& serializer) const
+{
+   const RasterDataDescriptor* pDescriptor = dynamic_cast<const RasterDataDescriptor*>(getDataDescriptor());
+   VERIFY(pDescriptor);
+
+   // if the entire thing is contiguous so use a single serialize
+   const void* pRawData = getRawData();
+   if (pRawData != NULL)
+   {
+      int64_t datasetSize = static_cast<int64_t>(pDescriptor->getRowCount()) *
+         pDescriptor->getColumnCount() *
+         pDescriptor->getBandCount() *
+         pDescriptor->getBytesPerElement();
+      return serializer.serialize(pRawData, datasetSize);
+   }
+
+   // write out all the data a row at a time
+   unsigned int totalOuterBands = (pDescriptor->getInterleaveFormat() == BSQ) ? pDescriptor->getBandCount() : 1;
+   for (unsigned int outerBand = 0; outerBand < totalOuterBands; ++outerBand)
+   {
+      // Get a data accessor with an entire concurrent row
+      FactoryResource<DataRequest> pRequest;
 //#pragma message(__FILE__ "(" STRING(__LINE__) ") : warning : fix this when there's a getNextBand() (tclarke)")
-         // since there's not getNextBand() we need to request only 1 band for BSQ
-         if (pDescriptor->getInterleaveFormat() == BSQ)
+      // since there's not getNextBand() we need to request only 1 band for BSQ
+      if (pDescriptor->getInterleaveFormat() == BSQ)
+      {
+         pRequest->setBands(pDescriptor->getActiveBand(outerBand), pDescriptor->getActiveBand(outerBand), 1);
+      }
+      DataAccessor acc = getDataAccessor(pRequest.release());
+      for (unsigned int row = 0; row < pDescriptor->getRowCount(); ++row)
+      {
+         if (!acc.isValid() || !serializer.serialize(acc->getRow(), acc->getRowSize()))
+         {
+            return false;
+         }
+         acc->nextRow();
+      }
+   }
+   return true;
+}
+
+bool RasterElementImp::serializeModifiedRows(SessionItemSerializer& serializer,
+                                             const vector<unsigned char>& modifiedBlocks) const
+{
+   const RasterDataDescriptor* pDescriptor = dynamic_cast<const RasterDataDescriptor*>(getDataDescriptor());
+   VERIFY(pDescriptor);
+
+   const unsigned int numRows = pDescriptor->getRowCount();
+   const unsigned int rowBlocks = (numRows + sSessionBlockRows - 1) / sSessionBlockRows;
+   const bool isBsq = pDescriptor->getInterleaveFormat() == BSQ;
+   const unsigned int totalOuterBands = isBsq ? pDescriptor->getBandCount() : 1;
+   const int64_t rowSize = static_cast<int64_t>(pDescriptor->getColumnCount()) *
+      (isBsq ? 1 : pDescriptor->getBandCount()) * pDescriptor->getBytesPerElement();
+
+   const char* pRawData = reinterpret_cast<const char*>(getRawData());
+   for (unsigned int outerBand = 0; outerBand < totalOuterBands; ++outerBand)
+   {
+      DataAccessor acc(NULL, NULL);
+      for (unsigned int rowBlock = 0; rowBlock < rowBlocks; ++rowBlock)
+      {
+         if (modifiedBlocks[outerBand * rowBlocks + rowBlock] == 0)
+         {
+            continue;
+         }
+
+         const unsigned int startRow = rowBlock * sSessionBlockRows;
+         const unsigned int stopRow = min(startRow + sSessionBlockRows, numRows) - 1;
+         const int64_t offset = (static_cast<int64_t>(outerBand) * numRows + startRow) * rowSize;
+         if (!serializer.seek(offset))
+         {
+            return false;
+         }
+
+         if (pRawData != NULL)
+         {
+            if (!serializer.serialize(pRawData + offset, (stopRow - startRow + 1) * rowSize))
+            {
+               return false;
+            }
+            continue;
+         }
+
+         FactoryResource<DataRequest> pRequest;
+         pRequest->setRows(pDescriptor->getActiveRow(startRow), pDescriptor->getActiveRow(stopRow));
+         if (isBsq)
          {
             pRequest->setBands(pDescriptor->getActiveBand(outerBand), pDescriptor->getActiveBand(outerBand), 1);
          }
-         DataAccessor acc = getDataAccessor(pRequest.release());
-         for (unsigned int row = 0; row < pDescriptor->getRowCount(); ++row)
+         acc = getDataAccessor(pRequest.release());
+         for (unsigned int row = startRow; row <= stopRow; ++row)
          {
             if (!acc.isValid() || !serializer.serialize(acc->getRow(), acc->getRowSize()))
             {
@@ -1424,6 +1597,7 @@ bool RasterElementImp::deserialize(SessionItemDeserializer& deserializer)
          }
       }
       setDisplayName(A(pRoot->getAttribute(X("displayName"))));
+      bool compressed = StringUtilities::fromXmlString<bool>(A(pRoot->getAttribute(X("compressed"))));
 
       for (map<DimensionDescriptor, StatisticsImp*>::iterator iter = mStatistics.begin();
          iter != mStatistics.end(); ++iter)
@@ -1477,7 +1651,9 @@ bool RasterElementImp::deserialize(SessionItemDeserializer& deserializer)
             pDescriptor->setProcessingLocation(IN_MEMORY);
          }
 
-         if (!createDefaultPager())
+         // compressed data is restored into a compressed pager, since the whole cube may not fit in memory
+         bool pagerCreated = compressed ? createCompressedPager() : createDefaultPager();
+         if (!pagerCreated)
          {
             // should never have on-disk read-only data saved to the session
             return false;
@@ -1504,6 +1680,12 @@ bool RasterElementImp::deserialize(SessionItemDeserializer& deserializer)
                acc->nextRow();
             }
          }
+
+         // the cube matches the restored block, so a later save to the same session only writes the changes
+         mModified = true;
+         mSessionBlockId = deserializer.getBlockId();
+         QMutexLocker lock(&mModifiedBlocksMutex);
+         mModifiedBlocks.assign(getSessionBlockCount(), 0);
       }
       else
       {
@@ -1578,6 +1760,7 @@ void RasterElementImp::incrementDataAccessor(DataAccessorImpl& da)
       da.mAccessorColumn < pDescriptor->getColumnCount() &&
       da.mAccessorBand < pDescriptor->getBandCount())
    {
+      ++da.mPageRequests;
       pPage = da.mpRasterPager->getPage(da.mpRequest.get(),
          pDescriptor->getActiveRow(da.mAccessorRow), 
          pDescriptor->getActiveColumn(da.mAccessorColumn), 
@@ -1595,6 +1778,8 @@ void RasterElementImp::incrementDataAccessor(DataAccessorImpl& da)
       da.mbValid = da.mpPage != NULL;
       if (da.isValid())
       {
+         markRowsModified(da.mpRequest.get(), da.mAccessorRow, pPage->getNumRows());
+
          //update the number of concurrent rows
          //based on the amount rows available in
          //the block that was returned to us.
@@ -1721,6 +1906,8 @@ DataAccessor RasterElementImp::getDataAccessor(DataRequest* pRequestIn)
       pRequest->getStartBand());
    if (pPage != NULL)
    {
+      markRowsModified(pRequest.get(), pRequest->getStartRow().getActiveNumber(), pPage->getNumRows());
+
       //if we were successful, create a DataAccessorImpl
       char* pRawData = reinterpret_cast<char*>(pPage->getRawData());
       if (pRawData != NULL)
@@ -1760,6 +1947,7 @@ DataAccessor RasterElementImp::getDataAccessor(DataRequest* pRequestIn)
 
          pImpl->mpRasterPage = pPage;
          pImpl->mpRasterPager = pPager;
+         pImpl->mPageRequests = 1;
 
          switch (pDescriptor->getDataType())
          {
@@ -1939,6 +2127,24 @@ bool RasterElementImp::createInMemoryPager(void* pData, bool bOwner)
    return true;
 }
 
+bool RasterElementImp::createCompressedPager()
+{
+   ExecutableResource pPlugin("Compressed Pager");
+   VERIFY(pPlugin->getPlugIn() != NULL);
+
+   RasterPager* pPager = dynamic_cast<RasterPager*>(pPlugin->getPlugIn());
+   VERIFY(pPager != NULL);
+
+   VERIFY(pPlugin->getInArgList().setPlugInArgValue("Raster Element", dynamic_cast<RasterElement*>(this)));
+   VERIFY(pPlugin->execute());
+   VERIFY(setPager(pPager));
+   mCompressed = true;
+
+   pPlugin->releasePlugIn();
+
+   return true;
+}
+
 bool RasterElementImp::createDefaultPager()
 {
    if (mpPager != NULL)
@@ -1979,12 +2185,71 @@ bool RasterElementImp::createDefaultPager()
    return false;
 }
 
+unsigned int RasterElementImp::getSessionBlockCount() const
+{
+   const RasterDataDescriptor* pDescriptor = dynamic_cast<const RasterDataDescriptor*>(getDataDescriptor());
+   VERIFYRV(pDescriptor != NULL, 0);
+
+   unsigned int rowBlocks = (pDescriptor->getRowCount() + sSessionBlockRows - 1) / sSessionBlockRows;
+   unsigned int outerBands = (pDescriptor->getInterleaveFormat() == BSQ) ? pDescriptor->getBandCount() : 1;
+   return rowBlocks * outerBands;
+}
+
+void RasterElementImp::markRowsModified(const DataRequest* pRequest, unsigned int startRow, unsigned int numRows)
+{
+   if (pRequest == NULL || pRequest->getWritable() == false)
+   {
+      return;
+   }
+
+   const RasterDataDescriptor* pDescriptor = dynamic_cast<const RasterDataDescriptor*>(getDataDescriptor());
+   VERIFYNRV(pDescriptor != NULL);
+
+   // the flags are sized when the pager is set, so they are not resized here
+   unsigned int rowCount = pDescriptor->getRowCount();
+   QMutexLocker lock(&mModifiedBlocksMutex);
+   if (mModifiedBlocks.size() != getSessionBlockCount() || startRow >= rowCount)
+   {
+      return;
+   }
+
+   unsigned int firstOuterBand = 0;
+   unsigned int lastOuterBand = 0;
+   if (pDescriptor->getInterleaveFormat() == BSQ)
+   {
+      firstOuterBand = pRequest->getStartBand().getActiveNumber();
+      lastOuterBand = pRequest->getStopBand().getActiveNumber();
+   }
+
+   unsigned int rowBlocks = (rowCount + sSessionBlockRows - 1) / sSessionBlockRows;
+   unsigned int stopRow = min(startRow + max(numRows, 1U), rowCount) - 1;
+   for (unsigned int outerBand = firstOuterBand; outerBand <= lastOuterBand; ++outerBand)
+   {
+      for (unsigned int rowBlock = startRow / sSessionBlockRows; rowBlock <= stopRow / sSessionBlockRows; ++rowBlock)
+      {
+         mModifiedBlocks[outerBand * rowBlocks + rowBlock] = 1;
+      }
+   }
+}
+
 const void* RasterElementImp::getRawData() const
 {
-   return const_cast<RasterElementImp*>(this)->getRawData();
+   return const_cast<RasterElementImp*>(this)->getCubePointer();
 }
 
 void *RasterElementImp::getRawData()
+{
+   void* pRawData = getCubePointer();
+   if (pRawData != NULL)
+   {
+      // writes through the pointer can not be tracked, so always save the entire cube to the session
+      mRawDataWritable = true;
+   }
+
+   return pRawData;
+}
+
+void* RasterElementImp::getCubePointer()
 {
    if (!mCubePointerAccessor.isValid())
    {
@@ -2023,6 +2288,8 @@ bool RasterElementImp::setRawData(void* pData, bool bOwner)
       return false;
    }
 
+   // the caller can still write to the data directly
+   mRawDataWritable = true;
    return createInMemoryPager(pData, bOwner);
 }
 
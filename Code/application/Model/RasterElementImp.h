@@ -14,12 +14,14 @@
 #include "DataAccessor.h"
 #include "DataElementImp.h"
 #include "DimensionDescriptor.h"
+#include "PagerStatistics.h"
 #include "SafePtr.h"
 #include "StatisticsImp.h"
 #include "TypesFile.h"
 #include "ProgressAdapter.h"
 
 #include <boost/any.hpp>
+#include <QtCore/QMutex>
 #include <vector>
 
 class RasterElementImp : public DataElementImp
@@ -43,6 +45,8 @@ public:
    const RasterElement* getTerrain() const;
 
    Statistics* getStatistics(DimensionDescriptor band) const;
+   PagerStatistics getPagerStatistics() const;
+   void resetPagerStatistics();
 
    RasterElement *createChip(DataElement *pParent, const std::string &appendName,
       const std::vector<DimensionDescriptor>& selectedRows,
@@ -55,10 +59,12 @@ public:
    bool createDefaultPager();
    bool createMemoryMappedPager();
    bool createInMemoryPager(void* pData, bool bOwner = true);
+   bool createCompressedPager();
    bool setPager(RasterPager* pPager);
    RasterPager* getPager() const;
 
    const std::string& getTemporaryFilename() const;
+   bool isValidSessionSaveItem() const;
    bool serialize(SessionItemSerializer& serializer) const;
    bool deserialize(SessionItemDeserializer &deserializer);
 
@@ -175,6 +181,14 @@ protected:
 private:
    RasterElementImp(const RasterElementImp& rhs);
    RasterElementImp& operator=(const RasterElementImp& rhs);
+
+   void* getCubePointer();
+   static void addAccessorStatistics(const DataAccessorImpl* pAccessor);
+   unsigned int getSessionBlockCount() const;
+   void markRowsModified(const DataRequest* pRequest, unsigned int startRow, unsigned int numRows);
+   bool serializeCube(SessionItemSerializer& serializer) const;
+   bool serializeModifiedRows(SessionItemSerializer& serializer, const std::vector<unsigned char>& modifiedBlocks) const;
+
    SafePtr<RasterElement> mpTerrain;
    std::map<DimensionDescriptor, StatisticsImp*> mStatistics;
 
@@ -184,11 +198,24 @@ private:
    RasterPager* mpBipConverterPager;
    RasterPager* mpBilConverterPager;
    RasterPager* mpBsqConverterPager;
+   bool mCompressed;
 
    DataAccessor mCubePointerAccessor;
 
    mutable bool mModified;
 
+   // Flags the rows which have changed since the cube was last saved to or restored from a session.
+   // Each flag covers a block of rows in one band for BSQ data, or in all bands for BIP and BIL data.
+   // The flags are set by threads obtaining writable accessors, so they are guarded by a mutex.
+   mutable std::vector<unsigned char> mModifiedBlocks;
+   mutable QMutex mModifiedBlocksMutex;
+   mutable std::string mSessionBlockId;
+   mutable bool mRawDataWritable;
+
+   // Each accessor counts its own pages, which are added here when it is deleted
+   PagerStatistics mPagerStatistics;
+   mutable QMutex mPagerStatisticsMutex;
+
    Georeference* mpGeoPlugin;
 };
 
@@ -254,6 +281,10 @@ private:
    { \
       return impClass::createInMemoryPager(pData, bOwner); \
    } \
+   bool createCompressedPager() \
+   { \
+      return impClass::createCompressedPager(); \
+   } \
    bool createMemoryMappedPager() \
    { \
       return impClass::createMemoryMappedPager(); \
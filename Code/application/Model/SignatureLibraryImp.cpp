@@ -27,6 +27,7 @@
 #include "switchOnEncoding.h"
 
 #include <algorithm>
+#include <math.h>
 
 using namespace std;
 
@@ -79,6 +80,82 @@ namespace
    {
       copy(pSource, &pSource[count], dest.begin());
    }
+
+   typedef vector<vector<pair<unsigned int, double> > > ResampleWeights;
+
+   void applyWeights(const ResampleWeights& weights, const double* pFrom, double* pTo)
+   {
+      for (ResampleWeights::size_type band = 0; band < weights.size(); ++band)
+      {
+         double value = 0.0;
+         for (vector<pair<unsigned int, double> >::const_iterator weight = weights[band].begin();
+            weight != weights[band].end(); ++weight)
+         {
+            value += pFrom[weight->first] * weight->second;
+         }
+         pTo[band] = value;
+      }
+   }
+
+   // Resampling to a fixed set of wavelengths is a linear map of the data, so it can be found by
+   // resampling each original band on its own.  Each resampled band is then a weighted sum of a few
+   // original bands, which is applied to every signature without calling the resampler again.
+   bool computeWeights(Resampler* pResampler, const vector<double>& fromWavelengths,
+      const vector<double>& toWavelengths, const vector<vector<double> >& checkSignatures, ResampleWeights& weights)
+   {
+      weights.assign(toWavelengths.size(), vector<pair<unsigned int, double> >());
+
+      vector<double> basis(fromWavelengths.size(), 0.0);
+      vector<double> toData;
+      vector<double> toFwhm;
+      vector<int> toBands;
+      string errorMessage;
+      for (vector<double>::size_type band = 0; band < fromWavelengths.size(); ++band)
+      {
+         basis[band] = 1.0;
+         toData.clear();
+         toBands.clear();
+         if (pResampler->execute(basis, toData, fromWavelengths, toWavelengths, toFwhm, toBands,
+            errorMessage) == false || toData.size() != toWavelengths.size())
+         {
+            return false;
+         }
+         basis[band] = 0.0;
+
+         for (vector<double>::size_type toBand = 0; toBand < toData.size(); ++toBand)
+         {
+            if (toData[toBand] != 0.0)
+            {
+               weights[toBand].push_back(make_pair(static_cast<unsigned int>(band), toData[toBand]));
+            }
+         }
+      }
+
+      // The user may select a resampler which is not linear, so check the weights against actual signatures
+      vector<double> weighted(toWavelengths.size());
+      for (vector<vector<double> >::const_iterator signature = checkSignatures.begin();
+         signature != checkSignatures.end(); ++signature)
+      {
+         toData.clear();
+         toBands.clear();
+         if (pResampler->execute(*signature, toData, fromWavelengths, toWavelengths, toFwhm, toBands,
+            errorMessage) == false || toData.size() != toWavelengths.size())
+         {
+            return false;
+         }
+
+         applyWeights(weights, &signature->front(), &weighted.front());
+         for (vector<double>::size_type toBand = 0; toBand < toData.size(); ++toBand)
+         {
+            if (fabs(weighted[toBand] - toData[toBand]) > 1e-9 * max(1.0, fabs(toData[toBand])))
+            {
+               return false;
+            }
+         }
+      }
+
+      return true;
+   }
 }
 
 const double *SignatureLibraryImp::getOrdinateData(unsigned int index) const
@@ -214,20 +291,53 @@ bool SignatureLibraryImp::resample(const vector<double> &abscissa)
       return false;
    }
 
-   vector<double> originalOrdinateData(mOriginalAbscissa.size());
+   const unsigned int numOriginalBands = mOriginalAbscissa.size();
+   vector<double> originalOrdinateData(static_cast<size_t>(mSignatures.size()) * numOriginalBands);
+   vector<double> originalSignature(numOriginalBands);
+   for (unsigned int i = 0; i < mSignatures.size(); ++i)
+   {
+      switchOnEncoding(pDesc->getDataType(), getOriginalAsDouble, da->getRow(), numOriginalBands,
+         originalSignature);
+      std::copy(originalSignature.begin(), originalSignature.end(),
+         originalOrdinateData.begin() + static_cast<size_t>(i) * numOriginalBands);
+      da->nextRow();
+   }
+
+   // Resampling the bands individually takes one resampler call per original band,
+   // so only do it when there are more signatures than bands
+   ResampleWeights weights;
+   if (mSignatures.size() > numOriginalBands && numOriginalBands > 0)
+   {
+      // Check the weights against two different signatures, so a resampler which is not linear is unlikely
+      // to match them by chance
+      vector<vector<double> > checkSignatures(2);
+      checkSignatures[0].assign(originalOrdinateData.begin(), originalOrdinateData.begin() + numOriginalBands);
+      checkSignatures[1].assign(originalOrdinateData.end() - numOriginalBands, originalOrdinateData.end());
+      if (computeWeights(pResampler, mOriginalAbscissa, abscissa, checkSignatures, weights) == false)
+      {
+         weights.clear();
+      }
+   }
+
    vector<double> toData;
    vector<double> toFwhm;
    vector<int> toBands;
    string errorMessage;
    for (unsigned int i = 0; i < mSignatures.size(); ++i)
    {
-      switchOnEncoding(pDesc->getDataType(), getOriginalAsDouble, da->getRow(), mOriginalAbscissa.size(),
-         originalOrdinateData);
+      const double* pOriginal = &originalOrdinateData[static_cast<size_t>(i) * numOriginalBands];
+      if (weights.empty() == false)
+      {
+         applyWeights(weights, pOriginal, &mResampledData[i * abscissa.size()]);
+         continue;
+      }
+
+      originalSignature.assign(pOriginal, pOriginal + numOriginalBands);
       toData.clear();
-      toData.reserve(mAbscissa.size());
+      toData.reserve(abscissa.size());
       toBands.clear();
-      toBands.reserve(mAbscissa.size());
-      bool success = pResampler->execute(originalOrdinateData, toData, 
+      toBands.reserve(abscissa.size());
+      bool success = pResampler->execute(originalSignature, toData, 
          mOriginalAbscissa, abscissa, toFwhm, toBands, errorMessage);
       if (!success || toData.size() != abscissa.size())
       {
@@ -235,7 +345,6 @@ bool SignatureLibraryImp::resample(const vector<double> &abscissa)
          return false;
       }
       std::copy(toData.begin(), toData.end(), &mResampledData[i*abscissa.size()]);
-      da->nextRow();
    }
 
    mAbscissa = abscissa;
@@ -50,6 +50,7 @@
 #include <ossim/imaging/ossimNitfTileSource.h>
 
 #include <list>
+#include <set>
 #include <sstream>
 #include <vector>
 
@@ -58,6 +59,30 @@ using namespace std;
 //#pragma message(__FILE__ "(" STRING(__LINE__) ") : warning : TODO: The NULL pix value for OSSIM_PARTIAL " \
 //   "is a bad value (leckels)")
 
+namespace
+{
+   // The TREs which populate the data descriptor or are used for georeferencing.  The other TREs are not parsed
+   // until the image segment is imported.
+   const set<string>& getDescriptorTres()
+   {
+      static set<string> names;
+      if (names.empty() == true)
+      {
+         names.insert("ACFTA");
+         names.insert("ACFTB");
+         names.insert("BANDSA");
+         names.insert("BANDSB");
+         names.insert("BLOCKA");
+         names.insert("ICHIPB");
+         names.insert("RPC00A");
+         names.insert("RPC00B");
+         names.insert("STDIDB");
+      }
+
+      return names;
+   }
+}
+
 Nitf::NitfImporterShell::NitfImporterShell()
 {
    setExtensions("NITF Files (*.ntf *.NTF *.nitf *.NITF *.r0 *.R0)");
@@ -87,6 +112,8 @@ vector<ImportDescriptor*> Nitf::NitfImporterShell::getImportDescriptors(const st
       return vector<ImportDescriptor*>();
    }
 
+   mTreCache.open(filename);
+
    vector<ImportDescriptor*> importDescriptors;
 
    ossim_int32 numImageSegments = pFileHeader->getNumberOfImages();
@@ -107,6 +134,65 @@ vector<ImportDescriptor*> Nitf::NitfImporterShell::getImportDescriptors(const st
    return importDescriptors;
 }
 
+void Nitf::NitfImporterShell::polishDataDescriptor(DataDescriptor* pDescriptor)
+{
+   RasterElementImporterShell::polishDataDescriptor(pDescriptor);
+
+   RasterDataDescriptor* pRasterDescriptor = dynamic_cast<RasterDataDescriptor*>(pDescriptor);
+   if (pRasterDescriptor == NULL)
+   {
+      return;
+   }
+
+   const FileDescriptor* pFileDescriptor = pRasterDescriptor->getFileDescriptor();
+   if (pFileDescriptor == NULL)
+   {
+      return;
+   }
+
+   const string& datasetLocation = pFileDescriptor->getDatasetLocation();
+   if (datasetLocation.empty() == true)
+   {
+      return;
+   }
+
+   string filename = pFileDescriptor->getFilename().getFullPathAndName();
+   string imageSegmentText = datasetLocation.substr(1);
+   ossim_uint32 imageSegment = StringUtilities::fromDisplayString<unsigned int>(imageSegmentText) - 1;
+
+   Nitf::OssimFileResource pNitfFile(filename);
+   if (pNitfFile.get() == NULL)
+   {
+      return;
+   }
+
+   const ossimNitfFileHeaderV2_X* pFileHeader =
+      dynamic_cast<const ossimNitfFileHeaderV2_X*>(pNitfFile->getHeader().get());
+   if (pFileHeader == NULL)
+   {
+      return;
+   }
+
+   ossimRefPtr<ossimNitfImageHeader> pImageHeader = pNitfFile->getNewImageHeader(static_cast<long>(imageSegment));
+   const ossimNitfImageHeaderV2_X* pImageSubheader = dynamic_cast<ossimNitfImageHeaderV2_X*>(pImageHeader.get());
+   if (pImageSubheader == NULL)
+   {
+      return;
+   }
+
+   string errorMessage;
+   mTreCache.open(filename);
+   Nitf::importTres(imageSegment + 1, pFileHeader, pImageSubheader, pRasterDescriptor, mTreParsers, errorMessage,
+      &mTreCache);
+
+   // The data descriptor may be polished more than once, so only add new messages
+   string& parseMessage = mParseMessages[imageSegment];
+   if (parseMessage.find(errorMessage) == string::npos)
+   {
+      parseMessage += errorMessage;
+   }
+}
+
 unsigned char Nitf::NitfImporterShell::getFileAffinity(const string& filename)
 {
    // Check that the file exists
@@ -645,7 +731,6 @@ ImportDescriptor* Nitf::NitfImporterShell::getImportDescriptor(const string& fil
    pDescriptor->setValidDataTypes(vector<EncodingType>(1, dataType));
    pDescriptor->setProcessingLocation(IN_MEMORY);
 
-   map<string, TrePlugInResource> parsers;
    string errorMessage;
 
    // Set the file descriptor
@@ -662,8 +747,11 @@ ImportDescriptor* Nitf::NitfImporterShell::getImportDescriptor(const string& fil
    pFileDescriptor->setBitsPerElement(bitsPerPixel);
 
    // Populate the metadata and set applicable values in the data descriptor
-   if (Nitf::importMetadata(imageSegment + 1, pFile, pFileHeader, pImageSubheader, pDescriptor, parsers,
-      errorMessage) == true)
+   // The TRE parsers and the parsed TREs are kept between image segments and calls so that the file header
+   // TREs are only parsed once per file, and only the TREs needed for the data descriptor are parsed until
+   // the image segment is imported in polishDataDescriptor()
+   if (Nitf::importMetadata(imageSegment + 1, pFile, pFileHeader, pImageSubheader, pDescriptor, mTreParsers,
+      errorMessage, &mTreCache, &getDescriptorTres()) == true)
    {
       // Populate specific fields in the data descriptor or file descriptor from the TREs
       const DynamicObject* pMetadata = pDescriptor->getMetadata();
@@ -10,6 +10,7 @@
 #ifndef NITFIMPORTERSHELL_H
 #define NITFIMPORTERSHELL_H
 
+#include "NitfMetadataParsing.h"
 #include "NitfResource.h"
 #include "RasterElementImporterShell.h"
 
@@ -72,6 +73,16 @@ namespace Nitf
       virtual bool validate(const DataDescriptor* pDescriptor,
          const std::vector<const DataDescriptor*>& importedDescriptors, std::string& errorMessage) const;
 
+      /**
+       *  @copydoc RasterElementImporterShell::polishDataDescriptor()
+       *
+       *  \par
+       *  The default implementation also imports the TREs which were not
+       *  needed to populate the data descriptor in getImportDescriptor(), so
+       *  that they are only parsed for the image segments being imported.
+       */
+      virtual void polishDataDescriptor(DataDescriptor* pDescriptor);
+
       /**
        *  @copydoc RasterElementImporterShell::createView()
        *
@@ -207,6 +218,8 @@ namespace Nitf
       double getGsd(const DataVariant& spacing, const std::string& units) const;
 
       std::map<ossim_uint32, std::string> mParseMessages;
+      std::map<std::string, TrePlugInResource> mTreParsers;
+      TreCache mTreCache;
    };
 }
 #endif
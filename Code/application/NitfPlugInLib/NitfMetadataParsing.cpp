@@ -7,6 +7,10 @@
  * http://www.gnu.org/licenses/lgpl.html
  */
 
+#include <QtCore/QDateTime>
+#include <QtCore/QFileInfo>
+#include <QtCore/QString>
+
 #include "AppVerify.h"
 #include "DateTime.h"
 #include "DynamicObject.h"
@@ -28,6 +32,7 @@
 #include <iostream>
 #include <map>
 #include <memory>
+#include <set>
 #include <utility>
 
 #include <ossim/base/ossimRtti.h>
@@ -53,42 +58,57 @@ using namespace std;
 
 bool Nitf::TrePlugInResource::parseTag(const ossimNitfRegisteredTag& input, DynamicObject& output,
    RasterDataDescriptor& descriptor, string& errorMessage) const
+{
+   if (parseTag(input, output, errorMessage) == false)
+   {
+      return false;
+   }
+
+   importTag(output, descriptor, errorMessage);
+   return true;
+}
+
+bool Nitf::TrePlugInResource::parseTag(const ossimNitfRegisteredTag& input, DynamicObject& output,
+   string& errorMessage) const
 {
    bool parsed = false;
    const TreParser* pParser = dynamic_cast<const TreParser*>(get());
    if (pParser != NULL)
    {
-      string errorMessage1;
-      string errorMessage2;
-      parsed = pParser->ossimTagToDynamicObject(input, output, errorMessage1);
+      string parseMessage;
+      parsed = pParser->ossimTagToDynamicObject(input, output, parseMessage);
       if (!parsed)
       {
          stringstream strm;
          const_cast<ossimNitfRegisteredTag&>(input).writeStream(strm);
-         parsed = pParser->toDynamicObject(strm, input.getSizeInBytes(), output, errorMessage1);
+         parsed = pParser->toDynamicObject(strm, input.getSizeInBytes(), output, parseMessage);
       }
 
-      if (parsed)
+      if (!parseMessage.empty())
       {
-         pParser->importMetadata(output, descriptor, errorMessage2);
+         errorMessage += getArgs().mPlugInName + ": " + parseMessage;
       }
+   }
+   return parsed;
+}
 
-      if (!errorMessage1.empty() || !errorMessage2.empty())
-      {
-         errorMessage += getArgs().mPlugInName + ": ";
-
-         if (!errorMessage1.empty())
-         {
-            errorMessage += errorMessage1;
-         }
+bool Nitf::TrePlugInResource::importTag(const DynamicObject& tre, RasterDataDescriptor& descriptor,
+   string& errorMessage) const
+{
+   const TreParser* pParser = dynamic_cast<const TreParser*>(get());
+   if (pParser == NULL)
+   {
+      return false;
+   }
 
-         if (!errorMessage2.empty())
-         {
-            errorMessage += errorMessage2 + "\n";
-         }
-      }
+   string importMessage;
+   bool imported = pParser->importMetadata(tre, descriptor, importMessage);
+   if (!importMessage.empty())
+   {
+      errorMessage += getArgs().mPlugInName + ": " + importMessage + "\n";
    }
-   return parsed;
+
+   return imported;
 }
 
 bool Nitf::TrePlugInResource::writeTag(const DynamicObject& input, const ossim_uint32& ownerIndex,
@@ -199,9 +219,184 @@ bool Nitf::TrePlugInResource::exportMetadata(const RasterDataDescriptor& descrip
    return false;
 }
 
+Nitf::TreCache::TreCache(unsigned int maxFiles) :
+   mMaxFiles(maxFiles),
+   mpFile(NULL)
+{}
+
+Nitf::TreCache::~TreCache()
+{
+   clear();
+}
+
+bool Nitf::TreCache::open(const string& filename)
+{
+   mpFile = NULL;
+   if (filename.empty() || mMaxFiles == 0)
+   {
+      return false;
+   }
+
+   QFileInfo fileInfo(QString::fromStdString(filename));
+   if (fileInfo.exists() == false)
+   {
+      return false;
+   }
+
+   const long long size = fileInfo.size();
+   const unsigned int modified = fileInfo.lastModified().toTime_t();
+
+   map<string, FileEntry>::iterator iter = mFiles.find(filename);
+   if (iter != mFiles.end())
+   {
+      if (iter->second.mSize != size || iter->second.mModified != modified)
+      {
+         // The file has changed since its TREs were parsed
+         clearFile(iter->second);
+         iter->second.mSize = size;
+         iter->second.mModified = modified;
+      }
+
+      mLru.splice(mLru.begin(), mLru, iter->second.mLruPos);
+   }
+   else
+   {
+      while (mFiles.size() >= mMaxFiles && mLru.empty() == false)
+      {
+         map<string, FileEntry>::iterator oldest = mFiles.find(mLru.back());
+         if (oldest != mFiles.end())
+         {
+            clearFile(oldest->second);
+            mFiles.erase(oldest);
+         }
+
+         mLru.pop_back();
+      }
+
+      FileEntry file;
+      file.mSize = size;
+      file.mModified = modified;
+      file.mLruPos = mLru.insert(mLru.begin(), filename);
+      iter = mFiles.insert(make_pair(filename, file)).first;
+   }
+
+   mpFile = &iter->second;
+   return true;
+}
+
+const DynamicObject* Nitf::TreCache::find(ossim_uint64 offset, string& parserName) const
+{
+   if (mpFile == NULL)
+   {
+      return NULL;
+   }
+
+   map<ossim_uint64, Entry>::const_iterator iter = mpFile->mTres.find(offset);
+   if (iter == mpFile->mTres.end())
+   {
+      return NULL;
+   }
+
+   parserName = iter->second.mParserName;
+   return iter->second.mpTre;
+}
+
+void Nitf::TreCache::insert(ossim_uint64 offset, const string& parserName, const DynamicObject& tre)
+{
+   if (mpFile == NULL)
+   {
+      return;
+   }
+
+   map<ossim_uint64, Entry>::iterator iter = mpFile->mTres.find(offset);
+   if (iter == mpFile->mTres.end())
+   {
+      Entry entry;
+      entry.mpTre = reinterpret_cast<DynamicObject*>(Service<ObjectFactory>()->createObject("DynamicObject"));
+      if (entry.mpTre == NULL)
+      {
+         return;
+      }
+
+      iter = mpFile->mTres.insert(make_pair(offset, entry)).first;
+   }
+
+   iter->second.mParserName = parserName;
+   iter->second.mpTre->clear();
+   iter->second.mpTre->merge(&tre);
+}
+
+void Nitf::TreCache::clear()
+{
+   for (map<string, FileEntry>::iterator iter = mFiles.begin(); iter != mFiles.end(); ++iter)
+   {
+      clearFile(iter->second);
+   }
+
+   mFiles.clear();
+   mLru.clear();
+   mpFile = NULL;
+}
+
+void Nitf::TreCache::clearFile(FileEntry& file)
+{
+   Service<ObjectFactory> pFactory;
+   for (map<ossim_uint64, Entry>::iterator iter = file.mTres.begin(); iter != file.mTres.end(); ++iter)
+   {
+      pFactory->destroyObject(iter->second.mpTre, "DynamicObject");
+   }
+
+   file.mTres.clear();
+}
+
+namespace
+{
+   // Adds the TREs of the image subheader and then the file header. If pNames is not NULL, only the TREs with a name
+   // in it are added when named is true and only the TREs with a name not in it are added when named is false.
+   void addTags(const unsigned int& currentImage, const ossimNitfFileHeaderV2_X* pFileHeader,
+      const ossimNitfImageHeaderV2_X* pImageSubheader, RasterDataDescriptor* pDescriptor, DynamicObject* pTres,
+      DynamicObject* pTreInfo, map<string, TrePlugInResource>& parsers, string& errorMessage, TreCache* pTreCache,
+      const set<string>* pNames, bool named)
+   {
+      const unsigned int numImageTags = pImageSubheader->getNumberOfTags();
+      for (unsigned int imageTag = 0; imageTag < numImageTags; ++imageTag)
+      {
+         ossimNitfTagInformation tagInfo;
+         if (pImageSubheader->getTagInformation(tagInfo, imageTag) == false)
+         {
+            stringstream errorStream;
+            errorStream << "Unable to retrieve tag #" << imageTag << " from the image subheader." << endl;
+            errorMessage += errorStream.str();
+         }
+         else if (pNames == NULL || (pNames->find(tagInfo.getTagName()) != pNames->end()) == named)
+         {
+            addTagToMetadata(currentImage, tagInfo, pDescriptor, pTres, pTreInfo, parsers, errorMessage, pTreCache);
+         }
+      }
+
+      const unsigned int numFileTags = pFileHeader->getNumberOfTags();
+      for (unsigned int fileTag = 0; fileTag < numFileTags; ++fileTag)
+      {
+         ossimNitfTagInformation tagInfo;
+         if (pFileHeader->getTagInformation(tagInfo, fileTag) == false)
+         {
+            stringstream errorStream;
+            errorStream << "Unable to retrieve tag #" << fileTag << " from the file header." << endl;
+            errorMessage += errorStream.str();
+         }
+         else if (pNames == NULL || (pNames->find(tagInfo.getTagName()) != pNames->end()) == named)
+         {
+            // For file headers, currentImage is always 0.
+            addTagToMetadata(0, tagInfo, pDescriptor, pTres, pTreInfo, parsers, errorMessage, pTreCache);
+         }
+      }
+   }
+}
+
 bool Nitf::importMetadata(const unsigned int& currentImage, const Nitf::OssimFileResource& pFile,
    const ossimNitfFileHeaderV2_X* pFileHeader, const ossimNitfImageHeaderV2_X* pImageSubheader,
-   RasterDataDescriptor* pDescriptor, map<string, TrePlugInResource>& parsers, string& errorMessage)
+   RasterDataDescriptor* pDescriptor, map<string, TrePlugInResource>& parsers, string& errorMessage,
+   TreCache* pTreCache, const set<string>* pTreNames)
 {
 //#pragma message(__FILE__ "(" STRING(__LINE__) ") : warning : Separate the file header parsing " \
 //   "from the subheader parsing (dadkins)")
@@ -244,38 +439,8 @@ bool Nitf::importMetadata(const unsigned int& currentImage, const Nitf::OssimFil
    FactoryResource<DynamicObject> pTres;
    FactoryResource<DynamicObject> pTreInfo;
 
-   const unsigned int numImageTags = pImageSubheader->getNumberOfTags();
-   for (unsigned int imageTag = 0; imageTag < numImageTags; ++imageTag)
-   {
-      ossimNitfTagInformation tagInfo;
-      if (pImageSubheader->getTagInformation(tagInfo, imageTag) == false)
-      {
-         stringstream errorStream;
-         errorStream << "Unable to retrieve tag #" << imageTag << " from the image subheader." << endl;
-         errorMessage += errorStream.str();
-      }
-      else
-      {
-         addTagToMetadata(currentImage, tagInfo, pDescriptor, pTres.get(), pTreInfo.get(), parsers, errorMessage);
-      }
-   }
-
-   const unsigned int numFileTags = pFileHeader->getNumberOfTags();
-   for (unsigned int fileTag = 0; fileTag < numFileTags; ++fileTag)
-   {
-      ossimNitfTagInformation tagInfo;
-      if (pFileHeader->getTagInformation(tagInfo, fileTag) == false)
-      {
-         stringstream errorStream;
-         errorStream << "Unable to retrieve tag #" << fileTag << " from the file header." << endl;
-         errorMessage += errorStream.str();
-      }
-      else
-      {
-         // For file headers, currentImage is always 0.
-         addTagToMetadata(0, tagInfo, pDescriptor, pTres.get(), pTreInfo.get(), parsers, errorMessage);
-      }
-   }
+   addTags(currentImage, pFileHeader, pImageSubheader, pDescriptor, pTres.get(), pTreInfo.get(), parsers,
+      errorMessage, pTreCache, pTreNames, true);
 
    // FTITLE parsing requires the metadata object to be populated first
    DynamicObject* pMetadata = pDescriptor->getMetadata();
@@ -410,47 +575,118 @@ bool Nitf::importMetadata(const unsigned int& currentImage, const Nitf::OssimFil
    return true;
 }
 
+bool Nitf::importTres(const unsigned int& currentImage, const ossimNitfFileHeaderV2_X* pFileHeader,
+   const ossimNitfImageHeaderV2_X* pImageSubheader, RasterDataDescriptor* pDescriptor,
+   map<string, TrePlugInResource>& parsers, string& errorMessage, TreCache* pTreCache)
+{
+   VERIFY(pFileHeader != NULL && pImageSubheader != NULL && pDescriptor != NULL);
+
+   DynamicObject* pMetadata = pDescriptor->getMetadata();
+   VERIFY(pMetadata != NULL);
+
+   FactoryResource<DynamicObject> pTres;
+   FactoryResource<DynamicObject> pTreInfo;
+   VERIFY(pTres.get() != NULL && pTreInfo.get() != NULL);
+
+   const string tresPath = Nitf::NITF_METADATA + "/" + Nitf::TRE_METADATA;
+   const string treInfoPath = Nitf::NITF_METADATA + "/" + Nitf::TRE_INFO_METADATA;
+
+   const DynamicObject* pImportedTres = pMetadata->getAttributeByPath(tresPath).getPointerToValue<DynamicObject>();
+   const DynamicObject* pImportedTreInfo =
+      pMetadata->getAttributeByPath(treInfoPath).getPointerToValue<DynamicObject>();
+   if (pImportedTres != NULL && pImportedTreInfo != NULL)
+   {
+      pTres->merge(pImportedTres);
+      pTreInfo->merge(pImportedTreInfo);
+   }
+
+   vector<string> importedNames;
+   pTres->getAttributeNames(importedNames);
+   const set<string> names(importedNames.begin(), importedNames.end());
+
+   addTags(currentImage, pFileHeader, pImageSubheader, pDescriptor, pTres.get(), pTreInfo.get(), parsers,
+      errorMessage, pTreCache, &names, false);
+
+   pMetadata->setAttributeByPath(tresPath, *pTres.get());
+   pMetadata->setAttributeByPath(treInfoPath, *pTreInfo.get());
+   return true;
+}
+
 bool Nitf::addTagToMetadata(const unsigned int& ownerIndex, const ossimNitfTagInformation& tagInfo,
    RasterDataDescriptor* pDescriptor, DynamicObject* pTres, DynamicObject* pTreInfo,
-   map<string, TrePlugInResource>& parsers, string& errorMessage)
+   map<string, TrePlugInResource>& parsers, string& errorMessage, TreCache* pTreCache)
 {
    // Verify that input is valid
    ossimString tagName = tagInfo.getTagName();
    VERIFY(tagName.empty() == false);
    VERIFY(pTres != NULL);
    VERIFY(pTreInfo != NULL);
+   VERIFY(pDescriptor != NULL);
 
-   // Try to parse the TRE with a specialized parser.
    FactoryResource<DynamicObject> pTag;
    VERIFY(pTag.get() != NULL);
 
-   ossimRefPtr<ossimNitfRegisteredTag> pRegTag = tagInfo.getTagData();
-   VERIFY(pRegTag.get() != NULL);
-
-   // Do NOT make a copy of pParser as it has ownership which gets transferred when the assignment operator is used.
-   // Doing so would cause a stale pointer to remain in the map and could cause a subsequent crash if it is used later.
-   map<string, TrePlugInResource>::iterator pParser = parsers.find(tagName);
-   if (pParser == parsers.end())
+   // Use the TRE from a previous parse of this file if possible. The parser still needs to
+   // update the descriptor, so it is loaded in either case.
+   string parserName;
+   const DynamicObject* pCachedTag = NULL;
+   if (pTreCache != NULL)
    {
-      pParser = parsers.insert(make_pair(tagName, TrePlugInResource(tagName))).first;
+      pCachedTag = pTreCache->find(tagInfo.getTagDataOffset(), parserName);
    }
 
-   if (pParser->second.parseTag(*pRegTag.get(), *pTag.get(), *pDescriptor, errorMessage) == false)
+   if (pCachedTag != NULL)
    {
-      // Failing that, use UnknownTreParser.
-      pTag->clear();
+      // Do NOT make a copy of pParser as it has ownership which gets transferred when the assignment operator is
+      // used. Doing so would cause a stale pointer to remain in the map and could cause a subsequent crash.
+      map<string, TrePlugInResource>::iterator pParser = parsers.find(parserName);
+      if (pParser == parsers.end())
+      {
+         pParser = parsers.insert(make_pair(parserName, TrePlugInResource(parserName))).first;
+      }
 
-      // Again, do NOT make a copy of pParser.
-      pParser = parsers.find("Unknown Tre Parser");
+      pTag->merge(pCachedTag);
+      pParser->second.importTag(*pTag.get(), *pDescriptor, errorMessage);
+   }
+   else
+   {
+      ossimRefPtr<ossimNitfRegisteredTag> pRegTag = tagInfo.getTagData();
+      VERIFY(pRegTag.get() != NULL);
+
+      // Try to parse the TRE with a specialized parser.
+      // Do NOT make a copy of pParser as it has ownership which gets transferred when the assignment operator is
+      // used. Doing so would cause a stale pointer to remain in the map and could cause a subsequent crash.
+      parserName = tagName;
+      map<string, TrePlugInResource>::iterator pParser = parsers.find(parserName);
       if (pParser == parsers.end())
       {
-         pParser = parsers.insert(make_pair("Unknown Tre Parser", TrePlugInResource("Unknown Tre Parser"))).first;
+         pParser = parsers.insert(make_pair(parserName, TrePlugInResource(parserName))).first;
       }
 
-      if (pParser->second.parseTag(*pRegTag.get(), *pTag.get(), *pDescriptor, errorMessage) == false)
+      if (pParser->second.parseTag(*pRegTag.get(), *pTag.get(), errorMessage) == false)
       {
-         errorMessage += tagName + " has not been imported.\n";
-         return false;
+         // Failing that, use UnknownTreParser.
+         pTag->clear();
+
+         // Again, do NOT make a copy of pParser.
+         parserName = "Unknown Tre Parser";
+         pParser = parsers.find(parserName);
+         if (pParser == parsers.end())
+         {
+            pParser = parsers.insert(make_pair(parserName, TrePlugInResource(parserName))).first;
+         }
+
+         if (pParser->second.parseTag(*pRegTag.get(), *pTag.get(), errorMessage) == false)
+         {
+            errorMessage += tagName + " has not been imported.\n";
+            return false;
+         }
+      }
+
+      pParser->second.importTag(*pTag.get(), *pDescriptor, errorMessage);
+      if (pTreCache != NULL)
+      {
+         pTreCache->insert(tagInfo.getTagDataOffset(), parserName, *pTag.get());
       }
    }
 
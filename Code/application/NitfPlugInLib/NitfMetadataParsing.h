@@ -17,8 +17,10 @@
 
 #include <ossim/base/ossimConstants.h>
 
+#include <list>
 #include <map>
 #include <ostream>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -74,6 +76,40 @@ namespace Nitf
       bool parseTag(const ossimNitfRegisteredTag& input, DynamicObject& output,
          RasterDataDescriptor& descriptor, std::string& errorMessage) const;
 
+      /**
+       * Parse a TRE and store it in a DynamicObject.
+       *
+       * Unlike parseTag(), this does not update a RasterDataDescriptor.
+       * The result can be applied to any number of descriptors by calling
+       * importTag().
+       *
+       * @param input
+       *        The ossimNitfRegisteredTag to read from.
+       * @param output
+       *        The DynamicObject to write to.
+       * @param errorMessage
+       *        If this is modified by the function, it will be displayed to the
+       *        user as a warning that imported TREs might be incomplete, missing, etc.
+       *
+       * @return \c True on success, \c false otherwise.
+       */
+      bool parseTag(const ossimNitfRegisteredTag& input, DynamicObject& output, std::string& errorMessage) const;
+
+      /**
+       * Update a RasterDataDescriptor from a TRE parsed by parseTag().
+       *
+       * @param tre
+       *        The parsed TRE.
+       * @param descriptor
+       *        The RasterDataDescriptor which should be updated.
+       * @param errorMessage
+       *        If this is modified by the function, it will be displayed to the
+       *        user as a warning that imported TREs might be incomplete, missing, etc.
+       *
+       * @return \c True on success, \c false otherwise.
+       */
+      bool importTag(const DynamicObject& tre, RasterDataDescriptor& descriptor, std::string& errorMessage) const;
+
       /**
        * Parse a TRE from a DynamicObject and store it in \c writer.
        *
@@ -115,6 +151,101 @@ namespace Nitf
       SETTING(ExcludedTres, TrePlugInResource, std::vector<std::string>, std::vector<std::string>());
    };
 
+   /**
+    * Keeps parsed TREs by file and offset.
+    *
+    * Converting a TRE to a DynamicObject is the most expensive part of
+    * importing NITF metadata. The file header TREs apply to every image
+    * segment in a file, and a file is frequently queried more than once, so
+    * parsed TREs are kept and copied instead of being parsed again. Each
+    * cached TRE still updates every RasterDataDescriptor it is imported into.
+    *
+    * The TREs of the most recently used files are kept. The file is checked
+    * once when it is opened, and its TREs are discarded if its size or
+    * modification time has changed.
+    */
+   class TreCache
+   {
+   public:
+      /**
+       * Creates an empty cache.
+       *
+       * @param maxFiles
+       *        The maximum number of files whose TREs are kept.
+       */
+      TreCache(unsigned int maxFiles = 4);
+
+      /**
+       * Destroys the cache and all cached TREs.
+       */
+      ~TreCache();
+
+      /**
+       * Selects the file whose TREs are found and added.
+       *
+       * @param filename
+       *        The file containing the TREs.
+       *
+       * @return \c True if the TREs of the file can be cached, \c false
+       *         otherwise.
+       */
+      bool open(const std::string& filename);
+
+      /**
+       * Finds a previously parsed TRE in the open file.
+       *
+       * @param offset
+       *        The offset in bytes of the TRE data in the file.
+       * @param parserName
+       *        Set to the name of the TRE parser plug-in which parsed the TRE.
+       *
+       * @return The parsed TRE or \c NULL if the TRE is not in the cache.
+       */
+      const DynamicObject* find(ossim_uint64 offset, std::string& parserName) const;
+
+      /**
+       * Adds a parsed TRE of the open file to the cache.
+       *
+       * @param offset
+       *        The offset in bytes of the TRE data in the file.
+       * @param parserName
+       *        The name of the TRE parser plug-in which parsed the TRE.
+       * @param tre
+       *        The parsed TRE. A copy is kept in the cache.
+       */
+      void insert(ossim_uint64 offset, const std::string& parserName, const DynamicObject& tre);
+
+      /**
+       * Discards all cached TREs.
+       */
+      void clear();
+
+   private:
+      TreCache(const TreCache& rhs);
+      TreCache& operator=(const TreCache& rhs);
+
+      struct Entry
+      {
+         std::string mParserName;
+         DynamicObject* mpTre;
+      };
+
+      struct FileEntry
+      {
+         long long mSize;
+         unsigned int mModified;
+         std::map<ossim_uint64, Entry> mTres;
+         std::list<std::string>::iterator mLruPos;
+      };
+
+      void clearFile(FileEntry& file);
+
+      unsigned int mMaxFiles;
+      std::map<std::string, FileEntry> mFiles;
+      std::list<std::string> mLru;
+      FileEntry* mpFile;
+   };
+
   /**
    * Imports supported metadata for the specified image into a RasterDataDescriptor.
    *
@@ -132,12 +263,49 @@ namespace Nitf
    *        Contains TRE parsers which have already been loaded into memory -- included for improved performance.
    * @param errorMessage
    *        %Message for import errors, etc.
+   * @param pTreCache
+   *        If this is not \c NULL, TREs which have already been parsed from
+   *        the file opened in the cache are taken from it and newly parsed
+   *        TREs are added to it.
+   * @param pTreNames
+   *        If this is not \c NULL, only the TREs with these names are
+   *        imported. The remaining TREs can be imported later with importTres().
    *
    * @return \c True on success, \c false otherwise.
    */
    bool importMetadata(const unsigned int& currentImage, const Nitf::OssimFileResource& pFile,
       const ossimNitfFileHeaderV2_X* pFileHeader, const ossimNitfImageHeaderV2_X* pImageSubheader,
-      RasterDataDescriptor* pDescriptor, std::map<std::string, TrePlugInResource>& parsers, std::string& errorMessage);
+      RasterDataDescriptor* pDescriptor, std::map<std::string, TrePlugInResource>& parsers, std::string& errorMessage,
+      TreCache* pTreCache = NULL, const std::set<std::string>* pTreNames = NULL);
+
+  /**
+   * Imports the TREs which were left out of an earlier call to importMetadata().
+   *
+   * Only TREs with a name which is not yet in the TRE metadata of
+   * \em pDescriptor are imported.
+   *
+   * @param currentImage
+   *        The index of the image to import.
+   * @param pFileHeader
+   *        The header of the source file.
+   * @param pImageSubheader
+   *        The current image subheader.
+   * @param pDescriptor
+   *        The RasterDataDescriptor to populate.
+   * @param parsers
+   *        Contains TRE parsers which have already been loaded into memory -- included for improved performance.
+   * @param errorMessage
+   *        %Message for import errors, etc.
+   * @param pTreCache
+   *        If this is not \c NULL, TREs which have already been parsed from
+   *        the file opened in the cache are taken from it and newly parsed
+   *        TREs are added to it.
+   *
+   * @return \c True on success, \c false otherwise.
+   */
+   bool importTres(const unsigned int& currentImage, const ossimNitfFileHeaderV2_X* pFileHeader,
+      const ossimNitfImageHeaderV2_X* pImageSubheader, RasterDataDescriptor* pDescriptor,
+      std::map<std::string, TrePlugInResource>& parsers, std::string& errorMessage, TreCache* pTreCache = NULL);
 
    /**
     * Adds a single TRE to a RasterDataDescriptor.
@@ -156,12 +324,16 @@ namespace Nitf
     *        Contains TRE parsers which have already been loaded into memory -- included for performance.
     * @param errorMessage
     *        %Message for import errors, etc.
+    * @param pTreCache
+    *        If this is not \c NULL, the parsed TRE is taken from or added to
+    *        the file opened in the cache.
     *
     * @return \c True on success, \c false otherwise.
     */
    bool addTagToMetadata(const unsigned int& ownerIndex,
       const ossimNitfTagInformation& tagInfo, RasterDataDescriptor* pDescriptor, DynamicObject* pTres,
-      DynamicObject* pTreInfo, std::map<std::string, TrePlugInResource>& parsers, std::string& errorMessage);
+      DynamicObject* pTreInfo, std::map<std::string, TrePlugInResource>& parsers, std::string& errorMessage,
+      TreCache* pTreCache = NULL);
 
    /**
     * Exports supported metadata for the specified image into \c pNitf.
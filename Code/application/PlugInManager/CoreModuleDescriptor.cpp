@@ -9,6 +9,7 @@
 
 #include "AppVersion.h"
 #include "AppVerify.h"
+#include "CompressedPager.h"
 #include "CopyrightInformation.h"
 #include "CoreModuleDescriptor.h"
 #include "InMemoryPager.h"
@@ -103,6 +104,7 @@ GENERATE_FACTORY(OpticksCore);
 
 REGISTER_PLUGIN_BASIC(OpticksCore, CopyrightInformation);
 REGISTER_PLUGIN_BASIC(OpticksCore, InMemoryPager);
+REGISTER_PLUGIN_BASIC(OpticksCore, CompressedPager);
 REGISTER_PLUGIN_BASIC(OpticksCore, MemoryMappedPager);
 REGISTER_PLUGIN_BASIC(OpticksCore, PointCloudInMemoryPager);
 REGISTER_PLUGIN_BASIC(OpticksCore, PointCloudMemoryMappedPager);
@@ -17,6 +17,7 @@
 #include "FileFinderImp.h"
 #include "FilenameImp.h"
 #include "FileResource.h"
+#include "MessageLogResource.h"
 #include "ModuleDescriptor.h"
 #include "ObjectResource.h"
 #include "PlugIn.h"
@@ -28,6 +29,7 @@
 #include "Progress.h"
 #include "StringUtilities.h"
 
+#include <functional>
 #include <iostream>
 #include <vector>
 #include <algorithm>
@@ -36,11 +38,18 @@
 #include <QtCore/QFile>
 #include <QtCore/QFileInfo>
 #include <QtCore/QString>
+#include <QtCore/QTime>
 
 using namespace std;
 
 class SettableSessionItem;
 
+namespace
+{
+   // Modules which take less time to add are not reported individually
+   const int sSlowModuleMilliseconds = 50;
+}
+
 PlugInManagerServicesImp* PlugInManagerServicesImp::spInstance = NULL;
 bool PlugInManagerServicesImp::mDestroyed = false;
 
@@ -422,6 +431,7 @@ void PlugInManagerServicesImp::buildPlugInList(const string& plugInPath)
    }
 
    // Add new modules and update existing modules
+   vector<pair<int, string> > moduleTimes;
    string autoImporter = "AutoImporter" + dlExtension;
    finder.findFile(plugInPath, "*" + dlExtension);
 
@@ -487,7 +497,10 @@ void PlugInManagerServicesImp::buildPlugInList(const string& plugInPath)
       // Add the module if necessary
       if (bAddModule == true)
       {
+         QTime moduleTime;
+         moduleTime.start();
          pModule = addModule(moduleFilename, pPlugInCache.get(), plugInIds);
+         moduleTimes.push_back(make_pair(moduleTime.elapsed(), moduleFilename));
          if (pModule != NULL)
          {
             // disallow multiple modules with the same id
@@ -526,8 +539,27 @@ void PlugInManagerServicesImp::buildPlugInList(const string& plugInPath)
          //can't use cache because AutoImporter determines
          //its extensions by querying all of the other
          //loaded importers
+         QTime moduleTime;
+         moduleTime.start();
          addModule(autoImporterPath, NULL, plugInIds);
+         moduleTimes.push_back(make_pair(moduleTime.elapsed(), autoImporterPath));
+      }
+   }
+
+   // Report the time taken by each slow module, slowest first
+   if (moduleTimes.empty() == false)
+   {
+      sort(moduleTimes.begin(), moduleTimes.end(), greater<pair<int, string> >());
+
+      MessageResource message("Plug-In Discovery", "app", "3F1D6E0B-8B7A-4C52-9E1F-2A6C0D8B5E47");
+      message->addProperty("Modules", static_cast<unsigned int>(moduleTimes.size()));
+      message->addProperty("Slow Module Threshold (ms)", sSlowModuleMilliseconds);
+      for (vector<pair<int, string> >::const_iterator iter = moduleTimes.begin();
+         iter != moduleTimes.end() && iter->first >= sSlowModuleMilliseconds; ++iter)
+      {
+         message->addProperty(iter->second, iter->first);
       }
+      message->finalize();
    }
 
    savePlugInListCache();
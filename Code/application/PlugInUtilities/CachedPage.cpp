@@ -8,23 +8,33 @@
  */
 
 #include "CachedPage.h"
+#include "ModelServices.h"
 
 const DimensionDescriptor CachedPage::CacheUnit::ALL_BANDS = DimensionDescriptor();
 
 CachedPage::CacheUnit::CacheUnit(char* pData, DimensionDescriptor startRow, int concurrentRows, size_t size,
-                                 DimensionDescriptor band, unsigned int interlineBytes) :
+                                 DimensionDescriptor band, unsigned int interlineBytes, bool pageBuffer) :
    mpData(pData),
    mStartRow(startRow),
    mConcurrentRows(concurrentRows),
    mBand(band),
    mSize(size),
-   mInterlineBytes(interlineBytes)
+   mInterlineBytes(interlineBytes),
+   mPageBuffer(pageBuffer)
 {
 }
 
 CachedPage::CacheUnit::~CacheUnit()
 {
-   delete [] mpData;
+   // Page buffers are recycled for later units
+   if (mPageBuffer)
+   {
+      Service<ModelServices>()->releasePageBuffer(mpData);
+   }
+   else
+   {
+      delete [] mpData;
+   }
 }
 
 DimensionDescriptor CachedPage::CacheUnit::getBand()
@@ -68,6 +78,11 @@ unsigned int CachedPage::CacheUnit::getInterlineBytes()
    return mInterlineBytes;
 }
 
+bool CachedPage::CacheUnit::isPageBuffer() const
+{
+   return mPageBuffer;
+}
+
 CachedPage::CachedPage(UnitPtr pCacheUnit, size_t offset, DimensionDescriptor startRow) :
    mpCacheUnit(pCacheUnit),
    mOffset(offset),
@@ -21,6 +21,8 @@
 #include "RasterDataDescriptor.h"
 #include "RasterElement.h"
 
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+
 using namespace std;
 
 CachedPager::CachedPager() :
@@ -49,6 +51,11 @@ CachedPager::CachedPager(const size_t cacheSize) :
 
 CachedPager::~CachedPager()
 {
+   PagerStatistics statistics = getStatistics();
+   if (statistics.mCacheHits + statistics.mCacheMisses > 0)
+   {
+      Service<ModelServices>()->addPagerStatistics(statistics);
+   }
 }
 
 bool CachedPager::getInputSpecification(PlugInArgList *&pArgList)
@@ -99,13 +106,12 @@ bool CachedPager::parseInputArgs(PlugInArgList *pInputArgList)
    mColumnCount = mpDescriptor->getColumnCount();
    mBandCount = mpDescriptor->getBandCount();
 
-   //Get Filename argument
+   //Get Filename argument, which pagers that do not read a file may leave unset
    Filename* pFilename = pInputArgList->getPlugInArgValue<Filename>(PagedFilenameArg());
-   if (pFilename == NULL)
+   if (pFilename != NULL)
    {
-      return false;
+      mFilename = pFilename->getFullPathAndName();
    }
-   mFilename = pFilename->getFullPathAndName();
 
    mCache.initialize(mBytesPerBand, mColumnCount, mBandCount);
 
@@ -168,7 +174,15 @@ RasterPage* CachedPager::getPage(DataRequest *pOriginalRequest,
       pNewRequest->polish(mpDescriptor);
       if (pNewRequest->validate(mpDescriptor) == true)
       {
+         boost::posix_time::ptime startTime = boost::posix_time::microsec_clock::universal_time();
          pUnit = fetchUnit(pNewRequest.get());
+         boost::posix_time::time_duration elapsed = boost::posix_time::microsec_clock::universal_time() - startTime;
+
+         ++mFetchStatistics.mFetchLatency[PagerStatistics::getLatencyBucket(elapsed.total_microseconds())];
+         if (pUnit.get() != NULL)
+         {
+            mFetchStatistics.mBytesRead += pUnit->getSize();
+         }
       }
    }
 
@@ -187,6 +201,15 @@ int CachedPager::getSupportedRequestVersion() const
    return 1;
 }
 
+PagerStatistics CachedPager::getStatistics() const
+{
+   mta::MutexLock lock(*mpMutex);
+
+   PagerStatistics statistics = mCache.getStatistics();
+   statistics.merge(mFetchStatistics);
+   return statistics;
+}
+
 const int CachedPager::getBytesPerBand() const
 {
    return mBytesPerBand;
@@ -0,0 +1,104 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2007 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#include "AppVerify.h"
+#include "ComputedPager.h"
+#include "DataRequest.h"
+#include "ObjectResource.h"
+#include "PlugInArgList.h"
+#include "PlugInResource.h"
+#include "RasterDataDescriptor.h"
+#include "RasterElement.h"
+#include "RasterPager.h"
+#include "RasterUtilities.h"
+
+#include <algorithm>
+
+using namespace std;
+
+ComputedPager::ComputedPager(size_t cacheSize) :
+   CachedPager(cacheSize)
+{
+}
+
+ComputedPager::~ComputedPager()
+{
+}
+
+RasterElement* ComputedPager::createElement(const string& name, DataElement* pParent, unsigned int rows,
+   unsigned int columns, unsigned int bands, EncodingType encoding, ExecutableResource& pager)
+{
+   RasterDataDescriptor* pDescriptor = RasterUtilities::generateRasterDataDescriptor(name, pParent, rows,
+      columns, bands, BSQ, encoding, ON_DISK_READ_ONLY);
+   if (pDescriptor == NULL)
+   {
+      return NULL;
+   }
+
+   ModelResource<RasterElement> pRaster(pDescriptor);
+   if (pRaster.get() == NULL || pager->getPlugIn() == NULL)
+   {
+      return NULL;
+   }
+
+   pager->getInArgList().setPlugInArgValue(PagedElementArg(), pRaster.get());
+   if (pager->execute() == false)
+   {
+      return NULL;
+   }
+
+   RasterPager* pPager = dynamic_cast<RasterPager*>(pager->getPlugIn());
+   if (pPager == NULL || pRaster->setPager(pPager) == false)
+   {
+      return NULL;
+   }
+
+   pager->releasePlugIn();
+   return pRaster.release();
+}
+
+bool ComputedPager::openFile(const string& filename)
+{
+   // The data is computed, so there is no file to open
+   return true;
+}
+
+CachedPage::UnitPtr ComputedPager::fetchUnit(DataRequest* pOriginalRequest)
+{
+   VERIFYRV(pOriginalRequest != NULL, CachedPage::UnitPtr());
+   const RasterElement* pRaster = getRasterElement();
+   VERIFYRV(pRaster != NULL, CachedPage::UnitPtr());
+   const RasterDataDescriptor* pDescriptor = dynamic_cast<const RasterDataDescriptor*>(pRaster->getDataDescriptor());
+   VERIFYRV(pDescriptor != NULL && pDescriptor->getInterleaveFormat() == BSQ, CachedPage::UnitPtr());
+
+   DimensionDescriptor startRow = pOriginalRequest->getStartRow();
+   DimensionDescriptor band = pOriginalRequest->getStartBand();
+   if (startRow.isActiveNumberValid() == false || band.isActiveNumberValid() == false)
+   {
+      return CachedPage::UnitPtr();
+   }
+
+   // Compute whole rows so the unit can be shared by requests for any columns
+   unsigned int rowCount = min(pOriginalRequest->getConcurrentRows(),
+      pOriginalRequest->getStopRow().getActiveNumber() - startRow.getActiveNumber() + 1);
+   size_t size = static_cast<size_t>(rowCount) * getColumnCount() * getBytesPerBand();
+   if (rowCount == 0 || size == 0)
+   {
+      return CachedPage::UnitPtr();
+   }
+
+   PageBufferResource pBuffer(size);
+   if (pBuffer.get() == NULL ||
+      computeRows(startRow.getActiveNumber(), rowCount, band.getActiveNumber(), pBuffer.get()) == false)
+   {
+      return CachedPage::UnitPtr();
+   }
+
+   return CachedPage::UnitPtr(new CachedPage::CacheUnit(pBuffer.release(), startRow, rowCount, size, band, 0, true));
+}
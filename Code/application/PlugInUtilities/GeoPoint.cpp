@@ -14,7 +14,7 @@
 #include "AppConfig.h"
 #include "AppVerify.h"
 #include "GeoPoint.h"
-#include "MgrsEngine.h"
+#include "GridConversions.h"
 #include "StringUtilities.h"
 
 #include <boost/lexical_cast.hpp>
@@ -453,48 +453,14 @@ UtmPoint::UtmPoint(LatLonPoint latLon) :
    mZone(0),
    mHemisphere('N')
 {
-   MgrsEngine* pMgrsEngine = MgrsEngine::Instance();
-   if (pMgrsEngine != NULL)
-   {
-      pMgrsEngine->Initialize_Engine();
-
-      // Setup inputs for the conversion
-      MgrsEngine::Coordinate_Tuple inputCoords;
-      MgrsEngine::Parameter_Tuple inputParams;
-
-      inputCoords.Geodetic.longitude = latLon.getLongitude().getValue() * PI / 180.0;
-      inputCoords.Geodetic.latitude = latLon.getLatitude().getValue() * PI / 180.0;
-      inputCoords.Geodetic.height = 0;
-      inputParams.Geodetic.height_type = MgrsEngine::No_Height;
-
-      int datum_index = 0;
-      pMgrsEngine->Get_Datum_Index("WGE", &datum_index);
-      pMgrsEngine->Set_Datum(MgrsEngine::Interactive, MgrsEngine::Input, datum_index);
-      pMgrsEngine->Set_Coordinate_System(MgrsEngine::Interactive, MgrsEngine::Input, MgrsEngine::Geodetic);
-      pMgrsEngine->Set_Geodetic_Params(MgrsEngine::Interactive, MgrsEngine::Input, inputParams.Geodetic);
-      pMgrsEngine->Set_Geodetic_Coordinates(MgrsEngine::Interactive, MgrsEngine::Input, inputCoords.Geodetic);
-
-      // Setup outputs
-      MgrsEngine::Coordinate_Tuple outputCoords;
-      MgrsEngine::Parameter_Tuple outputParams;
-
-      outputParams.UTM.zone = 0;
-      outputParams.UTM.override = 0;
-
-      pMgrsEngine->Set_Datum(pMgrsEngine->Interactive, pMgrsEngine->Output, datum_index);
-      pMgrsEngine->Set_Coordinate_System(pMgrsEngine->Interactive, pMgrsEngine->Output, pMgrsEngine->UTM);
-      pMgrsEngine->Set_UTM_Params(pMgrsEngine->Interactive, pMgrsEngine->Output, outputParams.UTM);
-
-      // Convert to UTM
-      pMgrsEngine->Convert();
-      pMgrsEngine->Get_UTM_Coordinates(pMgrsEngine->Interactive, pMgrsEngine->Output, &outputCoords.UTM);
-
-      // Set the member values
-      mEasting = outputCoords.UTM.easting;
-      mNorthing = outputCoords.UTM.northing;
-      mZone = outputCoords.UTM.zone;
-      mHemisphere = outputCoords.UTM.hemisphere;
-   }
+   // The conversion also populates the coordinate when the easting or northing is out of range
+   GridConversions::UtmCoordinate utm;
+   GridConversions::latLonToUtm(LocationType(latLon.getLatitude().getValue(), latLon.getLongitude().getValue()), utm);
+
+   mEasting = utm.mEasting;
+   mNorthing = utm.mNorthing;
+   mZone = utm.mZone;
+   mHemisphere = utm.mHemisphere;
 }
 
 UtmPoint::UtmPoint(double dEasting, double dNorthing, int iZone, char hemisphere) :
@@ -515,50 +481,9 @@ LocationType UtmPoint::getCoordinates() const
 
 LatLonPoint UtmPoint::getLatLonCoordinates() const
 {
-   MgrsEngine* pMgrsEngine =  MgrsEngine::Instance();
-   if (pMgrsEngine != NULL)
-   {
-      pMgrsEngine->Initialize_Engine();
-
-      // Setup inputs for the conversion
-      MgrsEngine::Coordinate_Tuple inputCoords;
-      MgrsEngine::Parameter_Tuple inputParams;
-
-      inputCoords.UTM.easting = mEasting;
-      inputCoords.UTM.northing = mNorthing;
-      inputCoords.UTM.zone = mZone;
-      inputCoords.UTM.hemisphere = mHemisphere;
-      inputParams.UTM.zone = mZone;
-      inputParams.UTM.override = 0;
-
-      int datum_index = 0;
-      pMgrsEngine->Get_Datum_Index("WGE", &datum_index);
-      pMgrsEngine->Set_Datum(MgrsEngine::Interactive, MgrsEngine::Input, datum_index);
-      pMgrsEngine->Set_Coordinate_System(MgrsEngine::Interactive, MgrsEngine::Input, MgrsEngine::UTM);
-      pMgrsEngine->Set_UTM_Params(MgrsEngine::Interactive, MgrsEngine::Input, inputParams.UTM);
-      pMgrsEngine->Set_UTM_Coordinates(MgrsEngine::Interactive, MgrsEngine::Input, inputCoords.UTM);
-
-      // Setup outputs
-      MgrsEngine::Coordinate_Tuple outputCoords;
-      MgrsEngine::Parameter_Tuple outputParams;
-
-      outputParams.Geodetic.height_type = MgrsEngine::No_Height;
-
-      pMgrsEngine->Set_Datum(MgrsEngine::Interactive, MgrsEngine::Output, datum_index);
-      pMgrsEngine->Set_Coordinate_System(MgrsEngine::Interactive, MgrsEngine::Output, MgrsEngine::Geodetic);
-      pMgrsEngine->Set_Geodetic_Params(MgrsEngine::Interactive, MgrsEngine::Output, outputParams.Geodetic);
-
-      // Convert to latitude/longitude
-      pMgrsEngine->Convert();
-      pMgrsEngine->Get_Geodetic_Coordinates(MgrsEngine::Interactive, MgrsEngine::Output, &outputCoords.Geodetic);
-
-      LatLonPoint latLon(LocationType(outputCoords.Geodetic.latitude * 180.0 / PI,
-         outputCoords.Geodetic.longitude * 180.0 / PI));
-
-      return latLon;
-   }
-
-   return LatLonPoint(LocationType());
+   LocationType latLon;
+   GridConversions::utmToLatLon(GridConversions::UtmCoordinate(mEasting, mNorthing, mZone, mHemisphere), latLon);
+   return LatLonPoint(latLon);
 }
 
 double UtmPoint::getEasting() const
@@ -636,40 +561,8 @@ string UtmPoint::getZoneText() const
 
 MgrsPoint::MgrsPoint(LatLonPoint latLon)
 {
-   MgrsEngine* pMgrsEngine = MgrsEngine::Instance();
-   if (pMgrsEngine != NULL)
-   {
-      pMgrsEngine->Initialize_Engine();
-
-      // Setup inputs for the conversion
-      MgrsEngine::Coordinate_Tuple inputCoords;
-      MgrsEngine::Parameter_Tuple inputParams;
-
-      inputCoords.Geodetic.longitude = latLon.getLongitude().getValue() * PI / 180.0;
-      inputCoords.Geodetic.latitude = latLon.getLatitude().getValue() * PI / 180.0;
-      inputCoords.Geodetic.height = 0;
-      inputParams.Geodetic.height_type = MgrsEngine::No_Height;
-
-      int datum_index = 0;
-      pMgrsEngine->Get_Datum_Index("WGE", &datum_index);
-      pMgrsEngine->Set_Datum(MgrsEngine::Interactive, MgrsEngine::Input, datum_index);
-      pMgrsEngine->Set_Coordinate_System(MgrsEngine::Interactive, MgrsEngine::Input, MgrsEngine::Geodetic);
-      pMgrsEngine->Set_Geodetic_Params(MgrsEngine::Interactive, MgrsEngine::Input, inputParams.Geodetic);
-      pMgrsEngine->Set_Geodetic_Coordinates(MgrsEngine::Interactive, MgrsEngine::Input, inputCoords.Geodetic);
-
-      // Setup outputs
-      MgrsEngine::Coordinate_Tuple outputCoords;
-
-      pMgrsEngine->Set_Datum(pMgrsEngine->Interactive, pMgrsEngine->Output, datum_index);
-      pMgrsEngine->Set_Coordinate_System(pMgrsEngine->Interactive, pMgrsEngine->Output, pMgrsEngine->MGRS);
-
-      // Convert to MGRS
-      pMgrsEngine->Convert();
-      pMgrsEngine->Get_MGRS_Coordinates(pMgrsEngine->Interactive, pMgrsEngine->Output, &outputCoords.MGRS);
-
-      // Set the text value
-      mText = outputCoords.MGRS.string;
-   }
+   GridConversions::latLonToMgrs(LocationType(latLon.getLatitude().getValue(), latLon.getLongitude().getValue()),
+      mText);
 }
 
 MgrsPoint::MgrsPoint(const string& mgrsText) :
@@ -687,39 +580,9 @@ LocationType MgrsPoint::getCoordinates() const
 
 LatLonPoint MgrsPoint::getLatLonCoordinates() const
 {
-   MgrsEngine* pMgrsEngine = MgrsEngine::Instance();
-   if (pMgrsEngine != NULL)
-   {
-      pMgrsEngine->Initialize_Engine();
-
-      // Setup inputs for the conversion
-      MgrsEngine::Coordinate_Tuple inputCoords;
-
-      strcpy(inputCoords.MGRS.string, mText.c_str());
-
-      pMgrsEngine->Set_Coordinate_System(MgrsEngine::Interactive, MgrsEngine::Input, MgrsEngine::MGRS);
-      pMgrsEngine->Set_MGRS_Coordinates(MgrsEngine::Interactive, MgrsEngine::Input, inputCoords.MGRS);
-
-      // Setup outputs
-      MgrsEngine::Coordinate_Tuple outputCoords;
-      MgrsEngine::Parameter_Tuple outputParams;
-
-      outputParams.Geodetic.height_type = MgrsEngine::No_Height;
-
-      pMgrsEngine->Set_Coordinate_System(MgrsEngine::Interactive, MgrsEngine::Output, MgrsEngine::Geodetic);
-      pMgrsEngine->Set_Geodetic_Params(MgrsEngine::Interactive, MgrsEngine::Output, outputParams.Geodetic);
-
-      // Convert to latitude/longitude
-      pMgrsEngine->Convert();
-      pMgrsEngine->Get_Geodetic_Coordinates(MgrsEngine::Interactive, MgrsEngine::Output, &outputCoords.Geodetic);
-
-      LatLonPoint latLon(LocationType(outputCoords.Geodetic.latitude * 180.0 / PI,
-         outputCoords.Geodetic.longitude * 180.0 / PI));
-
-      return latLon;
-   }
-
-   return LatLonPoint(LocationType());
+   LocationType latLon;
+   GridConversions::mgrsToLatLon(mText, latLon);
+   return LatLonPoint(latLon);
 }
 
 double MgrsPoint::getEasting() const
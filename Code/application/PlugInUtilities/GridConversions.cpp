@@ -0,0 +1,1120 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2007 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#include "AppConfig.h"
+#include "GridConversions.h"
+#include "Mgrs.h"
+
+#include <ctype.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+// The algorithms in this file are the GEOTRANS transverse mercator, UTM and
+// MGRS algorithms from Mgrs.cpp.  The only difference is that all ellipsoid
+// and projection state is held in a TransverseMercator object on the stack
+// instead of in static class members, so the arithmetic (and therefore the
+// results) is identical to MgrsEngine for the WGS-84 datum.
+
+namespace
+{
+   const double WGS84_A = 6378137.0;
+   const double WGS84_B = 6356752.3142;
+
+   struct TransverseMercator
+   {
+      double mA;
+      double mEs;
+      double mEbs;
+      double mAp;
+      double mBp;
+      double mCp;
+      double mDp;
+      double mEp;
+      double mOriginLatitude;
+      double mOriginLongitude;
+      double mFalseEasting;
+      double mFalseNorthing;
+      double mScaleFactor;
+      double mDeltaEasting;
+      double mDeltaNorthing;
+   };
+
+   inline double sphtmd(const TransverseMercator& tm, double latitude)
+   {
+      return tm.mAp * latitude - tm.mBp * sin(2.e0 * latitude) + tm.mCp * sin(4.e0 * latitude) -
+         tm.mDp * sin(6.e0 * latitude) + tm.mEp * sin(8.e0 * latitude);
+   }
+
+   inline double sphsn(const TransverseMercator& tm, double latitude)
+   {
+      return tm.mA / sqrt(1.e0 - tm.mEs * pow(sin(latitude), 2));
+   }
+
+   inline double denom(const TransverseMercator& tm, double latitude)
+   {
+      return sqrt(1.e0 - tm.mEs * pow(sin(latitude), 2));
+   }
+
+   inline double sphsr(const TransverseMercator& tm, double latitude)
+   {
+      return tm.mA * (1.e0 - tm.mEs) / pow(denom(tm, latitude), 3);
+   }
+
+   int geodeticToTransverseMercator(const TransverseMercator& tm, double latitude, double longitude,
+      double& easting, double& northing)
+   {
+      int errorCode = TRANMERC_NO_ERROR;
+      if ((latitude < -T_MAX_LAT) || (latitude > T_MAX_LAT))
+      {
+         errorCode |= TRANMERC_LAT_ERROR;
+      }
+      if (longitude > PI)
+      {
+         longitude -= (2 * PI);
+      }
+      if ((longitude < (tm.mOriginLongitude - MAX_DELTA_LONG)) ||
+         (longitude > (tm.mOriginLongitude + MAX_DELTA_LONG)))
+      {
+         double tempLongitude = (longitude < 0) ? longitude + 2 * PI : longitude;
+         double tempOrigin = (tm.mOriginLongitude < 0) ? tm.mOriginLongitude + 2 * PI : tm.mOriginLongitude;
+         if ((tempLongitude < (tempOrigin - MAX_DELTA_LONG)) || (tempLongitude > (tempOrigin + MAX_DELTA_LONG)))
+         {
+            errorCode |= TRANMERC_LON_ERROR;
+         }
+      }
+      if (errorCode != TRANMERC_NO_ERROR)
+      {
+         return errorCode;
+      }
+
+      double dlam = longitude - tm.mOriginLongitude;
+      if (fabs(dlam) > (9.0 * PI / 180))
+      {
+         // Distortion will result if longitude is more than 9 degrees from the central meridian
+         errorCode |= TRANMERC_LON_WARNING;
+      }
+      if (dlam > PI)
+      {
+         dlam -= (2 * PI);
+      }
+      if (dlam < -PI)
+      {
+         dlam += (2 * PI);
+      }
+      if (fabs(dlam) < 2.e-10)
+      {
+         dlam = 0.0;
+      }
+
+      double s = sin(latitude);
+      double c = cos(latitude);
+      double c2 = c * c;
+      double c3 = c2 * c;
+      double c5 = c3 * c2;
+      double c7 = c5 * c2;
+      double t = tan(latitude);
+      double tan2 = t * t;
+      double tan3 = tan2 * t;
+      double tan4 = tan3 * t;
+      double tan5 = tan4 * t;
+      double tan6 = tan5 * t;
+      double eta = tm.mEbs * c2;
+      double eta2 = eta * eta;
+      double eta3 = eta2 * eta;
+      double eta4 = eta3 * eta;
+
+      double sn = sphsn(tm, latitude);
+      double tmd = sphtmd(tm, latitude);
+      double tmdo = sphtmd(tm, tm.mOriginLatitude);
+
+      // Northing
+      double t1 = (tmd - tmdo) * tm.mScaleFactor;
+      double t2 = sn * s * c * tm.mScaleFactor / 2.e0;
+      double t3 = sn * s * c3 * tm.mScaleFactor * (5.e0 - tan2 + 9.e0 * eta + 4.e0 * eta2) / 24.e0;
+      double t4 = sn * s * c5 * tm.mScaleFactor * (61.e0 - 58.e0 * tan2 + tan4 + 270.e0 * eta -
+         330.e0 * tan2 * eta + 445.e0 * eta2 + 324.e0 * eta3 - 680.e0 * tan2 * eta2 + 88.e0 * eta4 -
+         600.e0 * tan2 * eta3 - 192.e0 * tan2 * eta4) / 720.e0;
+      double t5 = sn * s * c7 * tm.mScaleFactor * (1385.e0 - 3111.e0 * tan2 + 543.e0 * tan4 - tan6) / 40320.e0;
+      northing = tm.mFalseNorthing + t1 + pow(dlam, 2.e0) * t2 + pow(dlam, 4.e0) * t3 + pow(dlam, 6.e0) * t4 +
+         pow(dlam, 8.e0) * t5;
+
+      // Easting
+      double t6 = sn * c * tm.mScaleFactor;
+      double t7 = sn * c3 * tm.mScaleFactor * (1.e0 - tan2 + eta) / 6.e0;
+      double t8 = sn * c5 * tm.mScaleFactor * (5.e0 - 18.e0 * tan2 + tan4 + 14.e0 * eta - 58.e0 * tan2 * eta +
+         13.e0 * eta2 + 4.e0 * eta3 - 64.e0 * tan2 * eta2 - 24.e0 * tan2 * eta3) / 120.e0;
+      double t9 = sn * c7 * tm.mScaleFactor * (61.e0 - 479.e0 * tan2 + 179.e0 * tan4 - tan6) / 5040.e0;
+      easting = tm.mFalseEasting + dlam * t6 + pow(dlam, 3.e0) * t7 + pow(dlam, 5.e0) * t8 + pow(dlam, 7.e0) * t9;
+
+      return errorCode;
+   }
+
+   int transverseMercatorToGeodetic(const TransverseMercator& tm, double easting, double northing,
+      double& latitude, double& longitude)
+   {
+      int errorCode = TRANMERC_NO_ERROR;
+      if ((easting < (tm.mFalseEasting - tm.mDeltaEasting)) || (easting > (tm.mFalseEasting + tm.mDeltaEasting)))
+      {
+         errorCode |= TRANMERC_EASTING_ERROR;
+      }
+      if ((northing < (tm.mFalseNorthing - tm.mDeltaNorthing)) ||
+         (northing > (tm.mFalseNorthing + tm.mDeltaNorthing)))
+      {
+         errorCode |= TRANMERC_NORTHING_ERROR;
+      }
+      if (errorCode != TRANMERC_NO_ERROR)
+      {
+         return errorCode;
+      }
+
+      double tmdo = sphtmd(tm, tm.mOriginLatitude);
+      double tmd = tmdo + (northing - tm.mFalseNorthing) / tm.mScaleFactor;
+
+      // First estimate of the footpoint latitude
+      double sr = sphsr(tm, 0.e0);
+      double ftphi = tmd / sr;
+      for (int i = 0; i < 5; ++i)
+      {
+         double t10 = sphtmd(tm, ftphi);
+         sr = sphsr(tm, ftphi);
+         ftphi = ftphi + (tmd - t10) / sr;
+      }
+
+      sr = sphsr(tm, ftphi);
+      double sn = sphsn(tm, ftphi);
+      double c = cos(ftphi);
+      double t = tan(ftphi);
+      double tan2 = t * t;
+      double tan4 = tan2 * tan2;
+      double eta = tm.mEbs * pow(c, 2);
+      double eta2 = eta * eta;
+      double eta3 = eta2 * eta;
+      double eta4 = eta3 * eta;
+      double de = easting - tm.mFalseEasting;
+      if (fabs(de) < 0.0001)
+      {
+         de = 0.0;
+      }
+
+      // Latitude
+      double t10 = t / (2.e0 * sr * sn * pow(tm.mScaleFactor, 2));
+      double t11 = t * (5.e0 + 3.e0 * tan2 + eta - 4.e0 * pow(eta, 2) - 9.e0 * tan2 * eta) /
+         (24.e0 * sr * pow(sn, 3) * pow(tm.mScaleFactor, 4));
+      double t12 = t * (61.e0 + 90.e0 * tan2 + 46.e0 * eta + 45.E0 * tan4 - 252.e0 * tan2 * eta - 3.e0 * eta2 +
+         100.e0 * eta3 - 66.e0 * tan2 * eta2 - 90.e0 * tan4 * eta + 88.e0 * eta4 + 225.e0 * tan4 * eta2 +
+         84.e0 * tan2 * eta3 - 192.e0 * tan2 * eta4) / (720.e0 * sr * pow(sn, 5) * pow(tm.mScaleFactor, 6));
+      double t13 = t * (1385.e0 + 3633.e0 * tan2 + 4095.e0 * tan4 + 1575.e0 * pow(t, 6)) /
+         (40320.e0 * sr * pow(sn, 7) * pow(tm.mScaleFactor, 8));
+      latitude = ftphi - pow(de, 2) * t10 + pow(de, 4) * t11 - pow(de, 6) * t12 + pow(de, 8) * t13;
+
+      // Longitude
+      double t14 = 1.e0 / (sn * c * tm.mScaleFactor);
+      double t15 = (1.e0 + 2.e0 * tan2 + eta) / (6.e0 * pow(sn, 3) * c * pow(tm.mScaleFactor, 3));
+      double t16 = (5.e0 + 6.e0 * eta + 28.e0 * tan2 - 3.e0 * eta2 + 8.e0 * tan2 * eta + 24.e0 * tan4 -
+         4.e0 * eta3 + 4.e0 * tan2 * eta2 + 24.e0 * tan2 * eta3) / (120.e0 * pow(sn, 5) * c *
+         pow(tm.mScaleFactor, 5));
+      double t17 = (61.e0 + 662.e0 * tan2 + 1320.e0 * tan4 + 720.e0 * pow(t, 6)) /
+         (5040.e0 * pow(sn, 7) * c * pow(tm.mScaleFactor, 7));
+      double dlam = de * t14 - pow(de, 3) * t15 + pow(de, 5) * t16 - pow(de, 7) * t17;
+      longitude = tm.mOriginLongitude + dlam;
+
+      while (latitude > (90.0 * PI / 180.0))
+      {
+         latitude = PI - latitude;
+         longitude += PI;
+         if (longitude > PI)
+         {
+            longitude -= (2 * PI);
+         }
+      }
+      while (latitude < (-90.0 * PI / 180.0))
+      {
+         latitude = -(latitude + PI);
+         longitude += PI;
+         if (longitude > PI)
+         {
+            longitude -= (2 * PI);
+         }
+      }
+      if (longitude > (2 * PI))
+      {
+         longitude -= (2 * PI);
+      }
+      if (longitude < -PI)
+      {
+         longitude += (2 * PI);
+      }
+
+      if (fabs(dlam) > (9.0 * PI / 180))
+      {
+         // Distortion will result if longitude is more than 9 degrees from the central meridian
+         errorCode |= TRANMERC_LON_WARNING;
+      }
+      return errorCode;
+   }
+
+   TransverseMercator computeEllipsoid(double a, double b)
+   {
+      TransverseMercator tm;
+      tm.mA = a;
+      tm.mOriginLatitude = 0;
+      tm.mOriginLongitude = 0;
+      tm.mFalseNorthing = 0;
+      tm.mFalseEasting = 0;
+      tm.mScaleFactor = 1;
+
+      double a2 = a * a;
+      double b2 = b * b;
+      tm.mEs = (a2 - b2) / a2;
+      tm.mEbs = (a2 - b2) / b2;
+
+      // True meridional constants
+      double tn = (a - b) / (a + b);
+      double tn2 = tn * tn;
+      double tn3 = tn2 * tn;
+      double tn4 = tn3 * tn;
+      double tn5 = tn4 * tn;
+      tm.mAp = a * (1.e0 - tn + 5.e0 * (tn2 - tn3) / 4.e0 + 81.e0 * (tn4 - tn5) / 64.e0);
+      tm.mBp = 3.e0 * a * (tn - tn2 + 7.e0 * (tn3 - tn4) / 8.e0 + 55.e0 * tn5 / 64.e0) / 2.e0;
+      tm.mCp = 15.e0 * a * (tn2 - tn3 + 3.e0 * (tn4 - tn5) / 4.e0) / 16.0;
+      tm.mDp = 35.e0 * a * (tn3 - tn4 + 11.e0 * tn5 / 16.e0) / 48.e0;
+      tm.mEp = 315.e0 * a * (tn4 - tn5) / 512.e0;
+
+      // Maximum variance for the easting and northing values
+      tm.mDeltaEasting = 40000000.0;
+      tm.mDeltaNorthing = 40000000.0;
+      double dummyNorthing = 0.0;
+      geodeticToTransverseMercator(tm, T_MAX_LAT, MAX_DELTA_LONG, tm.mDeltaEasting, tm.mDeltaNorthing);
+      geodeticToTransverseMercator(tm, 0, MAX_DELTA_LONG, tm.mDeltaEasting, dummyNorthing);
+      return tm;
+   }
+
+   // Computed once at library load so that no conversion needs to modify shared state
+   const TransverseMercator sWgs84 = computeEllipsoid(WGS84_A, WGS84_B);
+
+   TransverseMercator getUtmProjection(double centralMeridian, double falseNorthing)
+   {
+      TransverseMercator tm = sWgs84;
+      if (centralMeridian > PI)
+      {
+         centralMeridian -= (2 * PI);
+      }
+      tm.mOriginLatitude = 0;
+      tm.mOriginLongitude = centralMeridian;
+      tm.mFalseEasting = 500000;
+      tm.mFalseNorthing = falseNorthing;
+      tm.mScaleFactor = 0.9996;
+      return tm;
+   }
+
+   TransverseMercator getInverseUtmProjection(int zone, char hemisphere)
+   {
+      double centralMeridian = 0;
+      if (zone >= 31)
+      {
+         centralMeridian = ((6 * zone - 183) * PI / 180.0 + 0.00000005);
+      }
+      else
+      {
+         centralMeridian = ((6 * zone + 177) * PI / 180.0 + 0.00000005);
+      }
+      return getUtmProjection(centralMeridian, hemisphere == 'S' ? 10000000 : 0);
+   }
+
+   int geodeticToUtm(double latitude, double longitude, int& zone, char& hemisphere, double& easting,
+      double& northing)
+   {
+      int errorCode = UTM_NO_ERROR;
+      if ((latitude < MIN_LAT) || (latitude > U_MAX_LAT))
+      {
+         errorCode |= UTM_LAT_ERROR;
+      }
+      if ((longitude < -PI) || (longitude > (2 * PI)))
+      {
+         errorCode |= UTM_LON_ERROR;
+      }
+      if (errorCode != UTM_NO_ERROR)
+      {
+         return errorCode;
+      }
+
+      if (longitude < 0)
+      {
+         longitude += (2 * PI);
+      }
+      int latDegrees = static_cast<int>(latitude * 180.0 / PI);
+      int longDegrees = static_cast<int>(longitude * 180.0 / PI);
+
+      int tempZone = 0;
+      if (longitude < PI)
+      {
+         tempZone = static_cast<int>(31 + ((longitude * 180.0 / PI) / 6.0));
+      }
+      else
+      {
+         tempZone = static_cast<int>(((longitude * 180.0 / PI) / 6.0) - 29);
+      }
+      if (tempZone > 60)
+      {
+         tempZone = 1;
+      }
+
+      // UTM special cases
+      if ((latDegrees > 55) && (latDegrees < 64) && (longDegrees > -1) && (longDegrees < 3))
+      {
+         tempZone = 31;
+      }
+      if ((latDegrees > 55) && (latDegrees < 64) && (longDegrees > 2) && (longDegrees < 12))
+      {
+         tempZone = 32;
+      }
+      if ((latDegrees > 71) && (longDegrees > -1) && (longDegrees < 9))
+      {
+         tempZone = 31;
+      }
+      if ((latDegrees > 71) && (longDegrees > 8) && (longDegrees < 21))
+      {
+         tempZone = 33;
+      }
+      if ((latDegrees > 71) && (longDegrees > 20) && (longDegrees < 33))
+      {
+         tempZone = 35;
+      }
+      if ((latDegrees > 71) && (longDegrees > 32) && (longDegrees < 42))
+      {
+         tempZone = 37;
+      }
+
+      double centralMeridian = 0;
+      if (tempZone >= 31)
+      {
+         centralMeridian = (6 * tempZone - 183) * PI / 180.0;
+      }
+      else
+      {
+         centralMeridian = (6 * tempZone + 177) * PI / 180.0;
+      }
+      zone = tempZone;
+
+      double falseNorthing = 0;
+      if (latitude < 0)
+      {
+         falseNorthing = 10000000;
+         hemisphere = 'S';
+      }
+      else
+      {
+         hemisphere = 'N';
+      }
+
+      geodeticToTransverseMercator(getUtmProjection(centralMeridian, falseNorthing), latitude, longitude,
+         easting, northing);
+      if ((easting < MIN_EASTING) || (easting > MAX_EASTING))
+      {
+         errorCode = UTM_EASTING_ERROR;
+      }
+      if ((northing < MIN_NORTHING) || (northing > MAX_NORTHING))
+      {
+         errorCode |= UTM_NORTHING_ERROR;
+      }
+      return errorCode;
+   }
+
+   int validateUtm(int zone, char hemisphere, double easting, double northing)
+   {
+      int errorCode = UTM_NO_ERROR;
+      if ((zone < 1) || (zone > 60))
+      {
+         errorCode |= UTM_ZONE_ERROR;
+      }
+      if ((hemisphere != 'S') && (hemisphere != 'N'))
+      {
+         errorCode |= UTM_HEMISPHERE_ERROR;
+      }
+      if ((easting < MIN_EASTING) || (easting > MAX_EASTING))
+      {
+         errorCode |= UTM_EASTING_ERROR;
+      }
+      if ((northing < MIN_NORTHING) || (northing > MAX_NORTHING))
+      {
+         errorCode |= UTM_NORTHING_ERROR;
+      }
+      return errorCode;
+   }
+
+   int utmToGeodetic(const TransverseMercator& tm, double easting, double northing, double& latitude,
+      double& longitude)
+   {
+      int errorCode = UTM_NO_ERROR;
+      if (transverseMercatorToGeodetic(tm, easting, northing, latitude, longitude) != TRANMERC_NO_ERROR)
+      {
+         errorCode |= UTM_NORTHING_ERROR;
+      }
+      if ((latitude < MIN_LAT) || (latitude > U_MAX_LAT))
+      {
+         errorCode |= UTM_NORTHING_ERROR;
+      }
+      return errorCode;
+   }
+
+   int utmToGeodetic(int zone, char hemisphere, double easting, double northing, double& latitude,
+      double& longitude)
+   {
+      int errorCode = validateUtm(zone, hemisphere, easting, northing);
+      if (errorCode == UTM_NO_ERROR)
+      {
+         errorCode = utmToGeodetic(getInverseUtmProjection(zone, hemisphere), easting, northing, latitude, longitude);
+      }
+      return errorCode;
+   }
+
+   // MGRS letter lookups for the WGS-84 ellipsoid (MGRS group 1)
+   void utmSet(int zone, int& letterLow, int& letterHigh, double& falseNorthing)
+   {
+      int set = 1;
+      while (((zone - set) / 6) * 6 + set != zone)
+      {
+         set = set + 1;
+         if (set > 6)
+         {
+            return;
+         }
+      }
+      if ((set == 1) || (set == 4))
+      {
+         letterLow = LETTER_A;
+         letterHigh = LETTER_H;
+      }
+      else if ((set == 2) || (set == 5))
+      {
+         letterLow = LETTER_J;
+         letterHigh = LETTER_R;
+      }
+      else if ((set == 3) || (set == 6))
+      {
+         letterLow = LETTER_S;
+         letterHigh = LETTER_Z;
+      }
+      falseNorthing = ZERO;
+      if ((set % 2) == 0)
+      {
+         falseNorthing = 1500000.e0;
+      }
+   }
+
+   void utmLimits(int& n, double latitude, int zone, double& southLatitude, double& northLatitude,
+      double& eastLongitude, double& westLongitude)
+   {
+      int southDegrees = 0;
+      if (n <= LETTER_A)
+      {
+         double temp = ((latitude + R80) / (R8)) + 2;
+         temp = temp + .00000001;
+         n = static_cast<int>(temp);
+         if (n > LETTER_H)
+         {
+            n = n + 1;
+         }
+         if (n > LETTER_N)
+         {
+            n = n + 1;
+         }
+         if (n >= LETTER_Y)
+         {
+            n = LETTER_X;
+         }
+         if ((n == LETTER_M) && (latitude == ZERO))
+         {
+            n = LETTER_N;
+         }
+         southDegrees = (n - 3) * 8 - 80;
+      }
+      else
+      {
+         southDegrees = (n - 3) * 8 - 80;
+         n = n - 1;
+      }
+      if (n > LETTER_H)
+      {
+         southDegrees = southDegrees - 8;
+      }
+      if (n > LETTER_N)
+      {
+         southDegrees = southDegrees - 8;
+      }
+      southLatitude = static_cast<double>(southDegrees) * DEGRAD;
+      northLatitude = southLatitude + R8;
+      if (n == LETTER_X)
+      {
+         northLatitude = southLatitude + 12.e0 * DEGRAD;
+      }
+
+      double centralMeridian = static_cast<double>(zone * 6 - 183) * DEGRAD;
+      eastLongitude = centralMeridian + R3;
+      westLongitude = centralMeridian - R3;
+      if ((zone < 31) || (zone > 37) || (n < LETTER_V))
+      {
+         return;
+      }
+      if ((n == LETTER_V) && (zone == 31))
+      {
+         eastLongitude = R3;
+      }
+      if ((n == LETTER_V) && (zone == 32))
+      {
+         westLongitude = R3;
+      }
+      if (n < LETTER_X)
+      {
+         return;
+      }
+      if (zone == 31)
+      {
+         eastLongitude = R9;
+      }
+      if (zone == 33)
+      {
+         westLongitude = R9;
+         eastLongitude = R21;
+      }
+      if (zone == 35)
+      {
+         westLongitude = R21;
+         eastLongitude = R33;
+      }
+      if (zone == 37)
+      {
+         westLongitude = R33;
+      }
+   }
+
+   void utmToMgrsLetters(int zone, int* pLetters, double latitude, double x, double y)
+   {
+      int letterLow = 0;
+      int letterHigh = 0;
+      double falseNorthing = 0.0;
+      utmSet(zone, letterLow, letterHigh, falseNorthing);
+
+      double southLatitude = 0.0;
+      double northLatitude = 0.0;
+      double eastLongitude = 0.0;
+      double westLongitude = 0.0;
+      pLetters[0] = LETTER_A;
+      utmLimits(pLetters[0], latitude, zone, southLatitude, northLatitude, eastLongitude, westLongitude);
+
+      // MgrsEngine recomputes the zone at the southern band limit here, which can change it
+      double centralMeridian = static_cast<double>(zone * 6 - 183) * DEGRAD;
+      char hemisphere = 'N';
+      double xLetter = 0.0;
+      double yLetter = 0.0;
+      geodeticToUtm(southLatitude, centralMeridian, zone, hemisphere, xLetter, yLetter);
+
+      yLetter = static_cast<double>(static_cast<int>(y + RND5));
+      if (static_cast<double>(static_cast<int>(yLetter + RND5)) == static_cast<double>(static_cast<int>(1.e7 + RND5)))
+      {
+         yLetter = static_cast<double>(static_cast<int>(yLetter - 1.e0 + RND5));
+      }
+      while (yLetter >= TWOMIL)
+      {
+         yLetter = yLetter - TWOMIL;
+      }
+      yLetter = yLetter - falseNorthing;
+      if (yLetter < ZERO)
+      {
+         yLetter = yLetter + TWOMIL;
+      }
+      pLetters[2] = static_cast<int>((yLetter + RND1) / ONEHT);
+      if (pLetters[2] > LETTER_H)
+      {
+         pLetters[2] = pLetters[2] + 1;
+      }
+      if (pLetters[2] > LETTER_N)
+      {
+         pLetters[2] = pLetters[2] + 1;
+      }
+
+      xLetter = static_cast<double>(static_cast<int>(x));
+      if (((pLetters[0] == LETTER_V) && (zone == 31)) &&
+         (static_cast<double>(static_cast<int>(xLetter + RND5)) == static_cast<double>(static_cast<int>(5.e5 + RND5))))
+      {
+         xLetter = static_cast<double>(static_cast<int>(xLetter - 1.e0 + RND5));
+      }
+      pLetters[1] = letterLow + (static_cast<int>((xLetter + RND1) / ONEHT) - 1);
+      if ((letterLow == LETTER_J) && (pLetters[1] > LETTER_N))
+      {
+         pLetters[1] = pLetters[1] + 1;
+      }
+   }
+
+   bool lettersToUtm(const int* pLetters, int letterLow, int letterHigh, double& xLetter, double& yLetter,
+      double falseNorthing, double yScaledLow, double yLow)
+   {
+      if ((pLetters[1] < letterLow) || (pLetters[1] > letterHigh) || (pLetters[2] > LETTER_V))
+      {
+         return false;
+      }
+      yLetter = static_cast<double>(pLetters[2]) * ONEHT + falseNorthing;
+      xLetter = static_cast<double>(pLetters[1] - letterLow + 1) * ONEHT;
+      if ((letterLow == LETTER_J) && (pLetters[1] > LETTER_O))
+      {
+         xLetter = xLetter - ONEHT;
+      }
+      if (pLetters[2] > LETTER_O)
+      {
+         yLetter = yLetter - ONEHT;
+      }
+      if (pLetters[2] > LETTER_I)
+      {
+         yLetter = yLetter - ONEHT;
+      }
+      if (static_cast<double>(static_cast<int>(yLetter + RND5)) >= static_cast<double>(static_cast<int>(TWOMIL + RND5)))
+      {
+         yLetter = yLetter - TWOMIL;
+      }
+      yLetter = static_cast<double>(static_cast<int>(yLetter + RND5));
+      yLetter = yLetter - yScaledLow;
+      if (yLetter < ZERO)
+      {
+         yLetter = yLetter + TWOMIL;
+      }
+      yLetter = static_cast<double>(static_cast<int>(yLow + yLetter + RND5));
+      return true;
+   }
+
+   bool gridToUtm(int& zone, const int* pLetters, char& hemisphere, double& easting, double& northing,
+      int precision)
+   {
+      if (((zone == 32) || (zone == 34) || (zone == 36)) && (pLetters[0] == LETTER_X))
+      {
+         return false;
+      }
+
+      int number = pLetters[0] + 1;
+      double southLatitude = 0.0;
+      double northLatitude = 0.0;
+      double eastLongitude = 0.0;
+      double westLongitude = 0.0;
+      utmLimits(number, 0.0, zone, southLatitude, northLatitude, eastLongitude, westLongitude);
+
+      double centralMeridian = static_cast<double>(zone * 6 - 183) * DEGRAD;
+      double xLetter = 0.0;
+      double yLetter = 0.0;
+      geodeticToUtm(southLatitude, centralMeridian, zone, hemisphere, xLetter, yLetter);
+
+      double yLow = static_cast<double>(static_cast<int>(static_cast<double>(static_cast<int>(yLetter / ONEHT)) * ONEHT));
+      double yScaledLow = yLow;
+      while (yScaledLow >= TWOMIL)
+      {
+         yScaledLow = yScaledLow - TWOMIL;
+      }
+      yScaledLow = static_cast<double>(static_cast<int>(yScaledLow));
+
+      int letterLow = 0;
+      int letterHigh = 0;
+      double falseNorthing = 0.0;
+      utmSet(zone, letterLow, letterHigh, falseNorthing);
+      bool success = lettersToUtm(pLetters, letterLow, letterHigh, xLetter, yLetter, falseNorthing, yScaledLow, yLow);
+      easting = xLetter + easting;
+      northing = yLetter + northing;
+
+      // Check that the point is within the zone letter bounds
+      double latitude = 0.0;
+      double longitude = 0.0;
+      utmToGeodetic(zone, hemisphere, easting, northing, latitude, longitude);
+      double divisor = pow(10.0, precision);
+      if (((southLatitude - DEGRAD / divisor) > latitude) || (latitude > (northLatitude + DEGRAD / divisor)))
+      {
+         success = false;
+      }
+      return success;
+   }
+
+   int roundMgrs(double value)
+   {
+      double integerValue = 0.0;
+      double fraction = modf(value, &integerValue);
+      int roundedValue = static_cast<int>(integerValue);
+      if ((fraction > 0.5) || ((fraction == 0.5) && (roundedValue % 2 == 1)))
+      {
+         ++roundedValue;
+      }
+      return roundedValue;
+   }
+
+   std::string makeMgrsString(int zone, const int* pLetters, double easting, double northing, int precision)
+   {
+      char mgrs[32];
+      int i = 0;
+      if (zone != 0)
+      {
+         i = sprintf(mgrs + i, "%2.2d", zone);
+      }
+      for (int j = 0; j < 3; ++j)
+      {
+         mgrs[i++] = ALBET[pLetters[j]];
+      }
+
+      double divisor = pow(10.0, (5 - precision));
+      easting = fmod(easting, 100000.0);
+      if (easting >= 99999.5)
+      {
+         easting = 0.0;
+      }
+      i += sprintf(mgrs + i, "%*.*d", precision, precision, roundMgrs(easting / divisor));
+      northing = fmod(northing, 100000.0);
+      if (northing >= 99999.5)
+      {
+         northing = 0.0;
+      }
+      i += sprintf(mgrs + i, "%*.*d", precision, precision, roundMgrs(northing / divisor));
+      return std::string(mgrs, i);
+   }
+
+   bool breakMgrsString(const char* pMgrs, int& zone, int* pLetters, double& easting, double& northing,
+      int& precision)
+   {
+      bool success = true;
+      int i = 0;
+      while (pMgrs[i] == ' ')
+      {
+         ++i;
+      }
+
+      int j = i;
+      while (isdigit(pMgrs[i]))
+      {
+         ++i;
+      }
+      int numDigits = i - j;
+      if (numDigits > 2)
+      {
+         success = false;
+      }
+      else if (numDigits > 0)
+      {
+         char zoneString[3];
+         strncpy(zoneString, pMgrs + j, 2);
+         zoneString[2] = 0;
+         sscanf(zoneString, "%d", &zone);
+         if ((zone < 1) || (zone > 60))
+         {
+            success = false;
+         }
+      }
+      else
+      {
+         zone = 0;
+      }
+
+      j = i;
+      while (isalpha(pMgrs[i]))
+      {
+         ++i;
+      }
+      if (i - j == 3)
+      {
+         for (int letter = 0; letter < 3; ++letter)
+         {
+            pLetters[letter] = toupper(pMgrs[j + letter]) - static_cast<int>('A');
+            if ((pLetters[letter] == LETTER_I) || (pLetters[letter] == LETTER_O))
+            {
+               success = false;
+            }
+         }
+      }
+      else
+      {
+         success = false;
+      }
+
+      j = i;
+      while (isdigit(pMgrs[i]))
+      {
+         ++i;
+      }
+      numDigits = i - j;
+      if ((numDigits <= 10) && (numDigits % 2 == 0))
+      {
+         int n = numDigits / 2;
+         precision = n;
+         if (n > 0)
+         {
+            char eastString[6];
+            char northString[6];
+            int east = 0;
+            int north = 0;
+            strncpy(eastString, pMgrs + j, n);
+            eastString[n] = 0;
+            sscanf(eastString, "%d", &east);
+            strncpy(northString, pMgrs + j + n, n);
+            northString[n] = 0;
+            sscanf(northString, "%d", &north);
+            double multiplier = pow(10.0, 5 - n);
+            easting = east * multiplier;
+            northing = north * multiplier;
+         }
+         else
+         {
+            easting = 0.0;
+            northing = 0.0;
+         }
+      }
+      else
+      {
+         success = false;
+      }
+      return success;
+   }
+
+   bool utmToMgrsString(int zone, char hemisphere, double easting, double northing, int precision,
+      std::string& mgrs)
+   {
+      mgrs.clear();
+      if (validateUtm(zone, hemisphere, easting, northing) != UTM_NO_ERROR ||
+         (precision < 0) || (precision > MAX_PRECISION))
+      {
+         return false;
+      }
+
+      double latitude = 0.0;
+      double longitude = 0.0;
+      utmToGeodetic(zone, hemisphere, easting, northing, latitude, longitude);
+
+      int letters[MGRS_LETTERS];
+      utmToMgrsLetters(zone, letters, latitude, easting, northing);
+      if ((zone == 31) && (letters[0] == LETTER_V) && (easting > 500000))
+      {
+         easting = 500000;
+      }
+      if (northing > 10000000)
+      {
+         northing = 10000000;
+      }
+      mgrs = makeMgrsString(zone, letters, easting, northing, precision);
+      return true;
+   }
+
+   bool mgrsStringToUtm(const std::string& mgrs, int& zone, char& hemisphere, double& easting, double& northing)
+   {
+      int letters[MGRS_LETTERS];
+      int precision = 0;
+      zone = 0;
+      if (!breakMgrsString(mgrs.c_str(), zone, letters, easting, northing, precision) || zone == 0)
+      {
+         return false;
+      }
+      return gridToUtm(zone, letters, hemisphere, easting, northing, precision);
+   }
+
+   bool latLonToMgrsString(double latitude, double longitude, int precision, std::string& mgrs)
+   {
+      mgrs.clear();
+      if ((latitude < -PI_OVER_2) || (latitude > PI_OVER_2) || (longitude < -PI) || (longitude > (2 * PI)) ||
+         (precision < 0) || (precision > MAX_PRECISION))
+      {
+         return false;
+      }
+
+      // UPS is not supported for the polar regions
+      if ((latitude < MIN_UTM_LAT) || (latitude > MAX_UTM_LAT))
+      {
+         return false;
+      }
+
+      int zone = 0;
+      char hemisphere = 'N';
+      double easting = 0.0;
+      double northing = 0.0;
+      int errorCode = geodeticToUtm(latitude, longitude, zone, hemisphere, easting, northing);
+      bool success = utmToMgrsString(zone, hemisphere, easting, northing, precision, mgrs);
+      return success && errorCode == UTM_NO_ERROR;
+   }
+}
+
+namespace GridConversions
+{
+   bool latLonToUtm(const LocationType& latLon, UtmCoordinate& utm)
+   {
+      return geodeticToUtm(latLon.mX * PI / 180.0, latLon.mY * PI / 180.0, utm.mZone, utm.mHemisphere,
+         utm.mEasting, utm.mNorthing) == UTM_NO_ERROR;
+   }
+
+   bool utmToLatLon(const UtmCoordinate& utm, LocationType& latLon)
+   {
+      double latitude = 0.0;
+      double longitude = 0.0;
+      if (utmToGeodetic(utm.mZone, utm.mHemisphere, utm.mEasting, utm.mNorthing, latitude, longitude) != UTM_NO_ERROR)
+      {
+         return false;
+      }
+      latLon = LocationType(latitude * 180.0 / PI, longitude * 180.0 / PI);
+      return true;
+   }
+
+   bool latLonToMgrs(const LocationType& latLon, std::string& mgrs, int precision)
+   {
+      return latLonToMgrsString(latLon.mX * PI / 180.0, latLon.mY * PI / 180.0, precision, mgrs);
+   }
+
+   bool mgrsToLatLon(const std::string& mgrs, LocationType& latLon)
+   {
+      UtmCoordinate utm;
+      if (!mgrsToUtm(mgrs, utm))
+      {
+         return false;
+      }
+      return utmToLatLon(utm, latLon);
+   }
+
+   bool utmToMgrs(const UtmCoordinate& utm, std::string& mgrs, int precision)
+   {
+      return utmToMgrsString(utm.mZone, utm.mHemisphere, utm.mEasting, utm.mNorthing, precision, mgrs);
+   }
+
+   bool mgrsToUtm(const std::string& mgrs, UtmCoordinate& utm)
+   {
+      return mgrsStringToUtm(mgrs, utm.mZone, utm.mHemisphere, utm.mEasting, utm.mNorthing);
+   }
+
+   unsigned int latLonToUtm(const LocationType* pLatLon, UtmCoordinate* pUtm, unsigned int count)
+   {
+      if (pLatLon == NULL || pUtm == NULL)
+      {
+         return 0;
+      }
+
+      unsigned int numConverted = 0;
+      for (unsigned int i = 0; i < count; ++i)
+      {
+         if (latLonToUtm(pLatLon[i], pUtm[i]))
+         {
+            ++numConverted;
+         }
+         else
+         {
+            pUtm[i] = UtmCoordinate();
+         }
+      }
+      return numConverted;
+   }
+
+   unsigned int utmToLatLon(const UtmCoordinate* pUtm, LocationType* pLatLon, unsigned int count)
+   {
+      if (pUtm == NULL || pLatLon == NULL)
+      {
+         return 0;
+      }
+
+      // Reuse the projection for runs of coordinates in the same zone
+      unsigned int numConverted = 0;
+      TransverseMercator tm = sWgs84;
+      int currentZone = -1;
+      char currentHemisphere = 0;
+      for (unsigned int i = 0; i < count; ++i)
+      {
+         const UtmCoordinate& utm = pUtm[i];
+         double latitude = 0.0;
+         double longitude = 0.0;
+         int errorCode = validateUtm(utm.mZone, utm.mHemisphere, utm.mEasting, utm.mNorthing);
+         if (errorCode == UTM_NO_ERROR)
+         {
+            if (utm.mZone != currentZone || utm.mHemisphere != currentHemisphere)
+            {
+               tm = getInverseUtmProjection(utm.mZone, utm.mHemisphere);
+               currentZone = utm.mZone;
+               currentHemisphere = utm.mHemisphere;
+            }
+            errorCode = utmToGeodetic(tm, utm.mEasting, utm.mNorthing, latitude, longitude);
+         }
+
+         if (errorCode == UTM_NO_ERROR)
+         {
+            pLatLon[i] = LocationType(latitude * 180.0 / PI, longitude * 180.0 / PI);
+            ++numConverted;
+         }
+         else
+         {
+            pLatLon[i] = LocationType();
+         }
+      }
+      return numConverted;
+   }
+
+   unsigned int utmToLatLon(int zone, char hemisphere, const LocationType* pEastingNorthing,
+      LocationType* pLatLon, unsigned int count)
+   {
+      if (pEastingNorthing == NULL || pLatLon == NULL || (zone < 1) || (zone > 60) ||
+         ((hemisphere != 'S') && (hemisphere != 'N')))
+      {
+         return 0;
+      }
+
+      const TransverseMercator tm = getInverseUtmProjection(zone, hemisphere);
+      unsigned int numConverted = 0;
+      for (unsigned int i = 0; i < count; ++i)
+      {
+         double easting = pEastingNorthing[i].mX;
+         double northing = pEastingNorthing[i].mY;
+         double latitude = 0.0;
+         double longitude = 0.0;
+         if (validateUtm(zone, hemisphere, easting, northing) == UTM_NO_ERROR &&
+            utmToGeodetic(tm, easting, northing, latitude, longitude) == UTM_NO_ERROR)
+         {
+            pLatLon[i] = LocationType(latitude * 180.0 / PI, longitude * 180.0 / PI);
+            ++numConverted;
+         }
+         else
+         {
+            pLatLon[i] = LocationType();
+         }
+      }
+      return numConverted;
+   }
+
+   unsigned int latLonToMgrs(const LocationType* pLatLon, std::string* pMgrs, unsigned int count, int precision)
+   {
+      if (pLatLon == NULL || pMgrs == NULL)
+      {
+         return 0;
+      }
+
+      unsigned int numConverted = 0;
+      for (unsigned int i = 0; i < count; ++i)
+      {
+         if (latLonToMgrs(pLatLon[i], pMgrs[i], precision))
+         {
+            ++numConverted;
+         }
+      }
+      return numConverted;
+   }
+
+   unsigned int mgrsToLatLon(const std::string* pMgrs, LocationType* pLatLon, unsigned int count)
+   {
+      if (pMgrs == NULL || pLatLon == NULL)
+      {
+         return 0;
+      }
+
+      unsigned int numConverted = 0;
+      for (unsigned int i = 0; i < count; ++i)
+      {
+         if (mgrsToLatLon(pMgrs[i], pLatLon[i]))
+         {
+            ++numConverted;
+         }
+         else
+         {
+            pLatLon[i] = LocationType();
+         }
+      }
+      return numConverted;
+   }
+}
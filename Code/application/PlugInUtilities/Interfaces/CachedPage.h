@@ -39,8 +39,8 @@ public:
        * @param pData
        *        The buffer which has already been populated with the data for the
        *        cache unit.  Must be at least \p size bytes long, and must have
-       *        been allocated with new char[n].  The cache unit takes ownership
-       *        of this buffer.
+       *        been allocated with new char[n], or with ModelServices::getPageBuffer()
+       *        if \p pageBuffer is \c true.  The cache unit takes ownership of this buffer.
        * @param startRow
        *        The starting row for this unit.
        * @param concurrentRows
@@ -51,9 +51,12 @@ public:
        *        The band provided if BSQ, or ALL_BANDS if all bands are provided.
        * @param interlineBytes
        *        The number of interline bytes within the buffer.
+       * @param pageBuffer
+       *        \c True if \p pData was obtained from ModelServices::getPageBuffer(),
+       *        so it is returned to ModelServices when the unit is destroyed.
        */
       CacheUnit(char *pData, DimensionDescriptor startRow, int concurrentRows, size_t size, 
-         DimensionDescriptor band = ALL_BANDS, unsigned int interlineBytes = 0);
+         DimensionDescriptor band = ALL_BANDS, unsigned int interlineBytes = 0, bool pageBuffer = false);
 
       /**
        * Destroy a CacheUnit.
@@ -115,6 +118,13 @@ public:
        */
       unsigned int getInterlineBytes();
 
+      /**
+       * Queries whether the data of the cache unit is a page buffer.
+       *
+       * @return \c True if the data was obtained from ModelServices::getPageBuffer().
+       */
+      bool isPageBuffer() const;
+
    private:
       char* mpData;
       DimensionDescriptor mStartRow;
@@ -122,6 +132,7 @@ public:
       DimensionDescriptor mBand; // for BSQ
       size_t mSize;
       unsigned int mInterlineBytes;
+      bool mPageBuffer;
    };
 
    typedef boost::shared_ptr<CacheUnit> UnitPtr;
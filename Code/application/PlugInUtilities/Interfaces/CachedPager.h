@@ -14,6 +14,7 @@
 
 #include "CachedPage.h"
 #include "PageCache.h"
+#include "PagerStatistics.h"
 #include "RasterPagerShell.h"
 #include "RasterPage.h"
 
@@ -56,7 +57,8 @@ public:
     *
     * This argument should be populated with the Filename that
     * this object will page.  Arguments with this name should 
-    * be of the type Filename.
+    * be of the type Filename.  Pagers which do not read a file,
+    * such as a ComputedPager, do not need this argument.
     */
    static std::string PagedFilenameArg()
    {
@@ -260,6 +262,18 @@ public:
     * @see DataRequest::getRequestVersion()
     */
    int getSupportedRequestVersion() const;
+
+   /**
+    * Gets the paging statistics of this pager.
+    *
+    * The statistics count the cache hits, misses, evictions and refetches,
+    * the bytes read by fetchUnit() and how long each fetch took.  When the
+    * pager is destroyed, the statistics are added to
+    * ModelServices::getPagerStatistics().
+    *
+    * @return The statistics since the pager was created.
+    */
+   PagerStatistics getStatistics() const;
    
 protected:
    /**
@@ -316,6 +330,7 @@ private:
    int mColumnCount;
    int mBandCount;
    int mRowCount;
+   PagerStatistics mFetchStatistics;
 
    /**
     *  This method should be implemented to open the file and store a file handle to be
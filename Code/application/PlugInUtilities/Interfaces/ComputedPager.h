@@ -0,0 +1,111 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2007 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#ifndef COMPUTEDPAGER_H
+#define COMPUTEDPAGER_H
+
+#include "CachedPager.h"
+#include "TypesFile.h"
+
+#include <string>
+
+class DataElement;
+class ExecutableResource;
+
+/**
+ *  \ingroup ShellModule
+ *  A pager which computes the data of a RasterElement as it is read.
+ *
+ *  A ComputedPager lets an algorithm produce its result without storing it.
+ *  The result element has no file or memory block of its own. Each block of
+ *  rows is computed from the source data when a DataAccessor first needs it,
+ *  and kept in the page cache while it is in use. Algorithms can be chained
+ *  by computing one result from another, so reading the last result of the
+ *  chain computes every stage one block at a time and only that result is ever
+ *  written, for example by an exporter.
+ *
+ *  Elements created by createElement() are BSQ and read-only, so a subclass
+ *  computes one band at a time.  They are not saved in sessions, since the
+ *  data could only be saved by computing all of it.
+ *
+ *  @see CachedPager
+ */
+class ComputedPager : public CachedPager
+{
+public:
+   /**
+    *  Creates a ComputedPager plug-in.
+    *
+    *  @param   cacheSize
+    *           The number of bytes of computed data to keep in the page cache.
+    */
+   ComputedPager(size_t cacheSize = 10 * 1024 * 1024);
+
+   /**
+    *  Destroys the ComputedPager plug-in.
+    */
+   ~ComputedPager();
+
+   /**
+    *  Creates a read-only RasterElement whose data is computed by a pager.
+    *
+    *  @param   name
+    *           The name of the new element.
+    *  @param   pParent
+    *           The parent of the new element.  This should be the element
+    *           from which the data is computed, so that the result is
+    *           destroyed before the data it reads.
+    *  @param   rows
+    *           The number of rows in the new element.
+    *  @param   columns
+    *           The number of columns in the new element.
+    *  @param   bands
+    *           The number of bands in the new element.
+    *  @param   encoding
+    *           The data type of the new element.
+    *  @param   pager
+    *           The pager plug-in to compute the data.  Every input argument
+    *           other than CachedPager::PagedElementArg() must already be set.
+    *           On success, the new element takes ownership of the plug-in.
+    *
+    *  @return  The new element, or \c NULL if the element could not be created
+    *           or the pager failed to execute.
+    */
+   static RasterElement* createElement(const std::string& name, DataElement* pParent, unsigned int rows,
+      unsigned int columns, unsigned int bands, EncodingType encoding, ExecutableResource& pager);
+
+protected:
+   /**
+    *  Computes a block of rows in one band of the paged element.
+    *
+    *  This is called with the page cache locked, so it is not called
+    *  concurrently for the same element.
+    *
+    *  @param   startRow
+    *           The active number of the first row to compute.
+    *  @param   rowCount
+    *           The number of rows to compute.
+    *  @param   band
+    *           The active number of the band to compute.
+    *  @param   pData
+    *           The buffer to fill, which holds \em rowCount rows of every
+    *           column in the data type of the paged element.
+    *
+    *  @return  Returns \c true if the rows were computed, otherwise \c false.
+    */
+   virtual bool computeRows(unsigned int startRow, unsigned int rowCount, unsigned int band, char* pData) = 0;
+
+private:
+   ComputedPager& operator=(const ComputedPager& rhs);
+
+   virtual bool openFile(const std::string& filename);
+   virtual CachedPage::UnitPtr fetchUnit(DataRequest* pOriginalRequest);
+};
+
+#endif
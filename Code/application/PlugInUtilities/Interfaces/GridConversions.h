@@ -0,0 +1,260 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2007 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#ifndef GRIDCONVERSIONS_H
+#define GRIDCONVERSIONS_H
+
+#include "LocationType.h"
+
+#include <string>
+
+/**
+ * Stateless conversions between WGS-84 geodetic, UTM and MGRS coordinates.
+ *
+ * These functions produce the same results as the UTM and MGRS conversions
+ * performed by UtmPoint and MgrsPoint, but they do not use any global or
+ * singleton state.  All ellipsoid and projection constants are computed once
+ * when the library is loaded, so the functions may be called concurrently from
+ * any number of threads.
+ *
+ * The batched functions convert an entire array of coordinates in one call.
+ * When all coordinates share a UTM zone and hemisphere, the projection setup
+ * is performed once for the whole array instead of once per coordinate.
+ *
+ * Geodetic coordinates are expressed in degrees in a LocationType where the
+ * latitude is the x-coordinate and the longitude is the y-coordinate, which
+ * matches the convention used by LatLonPoint.
+ */
+namespace GridConversions
+{
+   /**
+    * The default MGRS precision, which produces a string with one meter resolution.
+    */
+   const int DEFAULT_MGRS_PRECISION = 5;
+
+   /**
+    * A single UTM coordinate.
+    */
+   struct UtmCoordinate
+   {
+      /**
+       * Creates a UTM coordinate at the origin of zone 0 in the northern hemisphere.
+       */
+      UtmCoordinate() :
+         mEasting(0.0),
+         mNorthing(0.0),
+         mZone(0),
+         mHemisphere('N')
+      {}
+
+      /**
+       * Creates a UTM coordinate.
+       *
+       * @param easting
+       *        The easting value in meters.
+       * @param northing
+       *        The northing value in meters.
+       * @param zone
+       *        The UTM zone, which must be in the range [1, 60].
+       * @param hemisphere
+       *        The hemisphere, which must be either 'N' or 'S'.
+       */
+      UtmCoordinate(double easting, double northing, int zone, char hemisphere) :
+         mEasting(easting),
+         mNorthing(northing),
+         mZone(zone),
+         mHemisphere(hemisphere)
+      {}
+
+      double mEasting;
+      double mNorthing;
+      int mZone;
+      char mHemisphere;
+   };
+
+   /**
+    * Converts a geodetic coordinate to UTM.
+    *
+    * The zone is computed from the coordinate, including the special zones
+    * over Norway and Svalbard.
+    *
+    * @param latLon
+    *        The geodetic coordinate in degrees.
+    * @param utm
+    *        Populated with the UTM coordinate.
+    *
+    * @return Returns \c true if the coordinate was successfully converted or
+    *         \c false if the coordinate is outside of the valid UTM range.
+    */
+   bool latLonToUtm(const LocationType& latLon, UtmCoordinate& utm);
+
+   /**
+    * Converts a UTM coordinate to a geodetic coordinate.
+    *
+    * @param utm
+    *        The UTM coordinate to convert.
+    * @param latLon
+    *        Populated with the geodetic coordinate in degrees.
+    *
+    * @return Returns \c true if the coordinate was successfully converted or
+    *         \c false if the UTM coordinate is invalid.
+    */
+   bool utmToLatLon(const UtmCoordinate& utm, LocationType& latLon);
+
+   /**
+    * Converts a geodetic coordinate to an MGRS string.
+    *
+    * @param latLon
+    *        The geodetic coordinate in degrees.
+    * @param mgrs
+    *        Populated with the MGRS string.  This will be empty if the
+    *        conversion fails.
+    * @param precision
+    *        The number of digits in each of the easting and northing values,
+    *        which must be in the range [0, 5].
+    *
+    * @return Returns \c true if the coordinate was successfully converted or
+    *         \c false if the coordinate is outside of the UTM latitude range.
+    */
+   bool latLonToMgrs(const LocationType& latLon, std::string& mgrs, int precision = DEFAULT_MGRS_PRECISION);
+
+   /**
+    * Converts an MGRS string to a geodetic coordinate.
+    *
+    * @param mgrs
+    *        The MGRS string to convert.
+    * @param latLon
+    *        Populated with the geodetic coordinate in degrees.
+    *
+    * @return Returns \c true if the string was successfully converted or
+    *         \c false if the string is not a valid UTM-based MGRS string.
+    */
+   bool mgrsToLatLon(const std::string& mgrs, LocationType& latLon);
+
+   /**
+    * Converts a UTM coordinate to an MGRS string.
+    *
+    * @param utm
+    *        The UTM coordinate to convert.
+    * @param mgrs
+    *        Populated with the MGRS string.  This will be empty if the
+    *        conversion fails.
+    * @param precision
+    *        The number of digits in each of the easting and northing values,
+    *        which must be in the range [0, 5].
+    *
+    * @return Returns \c true if the coordinate was successfully converted or
+    *         \c false if the UTM coordinate is invalid.
+    */
+   bool utmToMgrs(const UtmCoordinate& utm, std::string& mgrs, int precision = DEFAULT_MGRS_PRECISION);
+
+   /**
+    * Converts an MGRS string to a UTM coordinate.
+    *
+    * @param mgrs
+    *        The MGRS string to convert.
+    * @param utm
+    *        Populated with the UTM coordinate.
+    *
+    * @return Returns \c true if the string was successfully converted or
+    *         \c false if the string is not a valid UTM-based MGRS string.
+    */
+   bool mgrsToUtm(const std::string& mgrs, UtmCoordinate& utm);
+
+   /**
+    * Converts an array of geodetic coordinates to UTM.
+    *
+    * @param pLatLon
+    *        The first of \em count geodetic coordinates in degrees.
+    * @param pUtm
+    *        The first of \em count UTM coordinates to populate.  Coordinates
+    *        which cannot be converted are set to a default UtmCoordinate.
+    * @param count
+    *        The number of coordinates to convert.
+    *
+    * @return The number of coordinates which were successfully converted.
+    */
+   unsigned int latLonToUtm(const LocationType* pLatLon, UtmCoordinate* pUtm, unsigned int count);
+
+   /**
+    * Converts an array of UTM coordinates to geodetic coordinates.
+    *
+    * @param pUtm
+    *        The first of \em count UTM coordinates.
+    * @param pLatLon
+    *        The first of \em count geodetic coordinates to populate in degrees.
+    *        Coordinates which cannot be converted are set to (0, 0).
+    * @param count
+    *        The number of coordinates to convert.
+    *
+    * @return The number of coordinates which were successfully converted.
+    */
+   unsigned int utmToLatLon(const UtmCoordinate* pUtm, LocationType* pLatLon, unsigned int count);
+
+   /**
+    * Converts an array of easting/northing values in a single UTM zone to
+    * geodetic coordinates.
+    *
+    * This is the fastest way to convert a large number of coordinates, such as
+    * the values in an IGM raster, since the projection is only set up once.
+    *
+    * @param zone
+    *        The UTM zone of all coordinates, which must be in the range [1, 60].
+    * @param hemisphere
+    *        The hemisphere of all coordinates, which must be either 'N' or 'S'.
+    * @param pEastingNorthing
+    *        The first of \em count coordinates where the easting is the
+    *        x-coordinate and the northing is the y-coordinate.
+    * @param pLatLon
+    *        The first of \em count geodetic coordinates to populate in degrees.
+    *        Coordinates which cannot be converted are set to (0, 0).
+    * @param count
+    *        The number of coordinates to convert.
+    *
+    * @return The number of coordinates which were successfully converted.
+    */
+   unsigned int utmToLatLon(int zone, char hemisphere, const LocationType* pEastingNorthing,
+      LocationType* pLatLon, unsigned int count);
+
+   /**
+    * Converts an array of geodetic coordinates to MGRS strings.
+    *
+    * @param pLatLon
+    *        The first of \em count geodetic coordinates in degrees.
+    * @param pMgrs
+    *        The first of \em count strings to populate.  Strings for
+    *        coordinates which cannot be converted are empty.
+    * @param count
+    *        The number of coordinates to convert.
+    * @param precision
+    *        The number of digits in each of the easting and northing values,
+    *        which must be in the range [0, 5].
+    *
+    * @return The number of coordinates which were successfully converted.
+    */
+   unsigned int latLonToMgrs(const LocationType* pLatLon, std::string* pMgrs, unsigned int count,
+      int precision = DEFAULT_MGRS_PRECISION);
+
+   /**
+    * Converts an array of MGRS strings to geodetic coordinates.
+    *
+    * @param pMgrs
+    *        The first of \em count MGRS strings.
+    * @param pLatLon
+    *        The first of \em count geodetic coordinates to populate in degrees.
+    *        Coordinates for strings which cannot be converted are set to (0, 0).
+    * @param count
+    *        The number of strings to convert.
+    *
+    * @return The number of strings which were successfully converted.
+    */
+   unsigned int mgrsToLatLon(const std::string* pMgrs, LocationType* pLatLon, unsigned int count);
+}
+
+#endif
@@ -11,6 +11,7 @@
 #define MUHTTPSERVER_H
 
 #include "AttachmentPtr.h"
+#include "DMutex.h"
 #include "EnumWrapper.h"
 #include "SessionManager.h"
 #ifdef WIN_API
@@ -21,13 +22,22 @@
 #include <QtCore/QObject>
 #include <QtCore/QString>
 #include <boost/any.hpp>
+#include <deque>
+#include <vector>
 
 class QTextStream;
-class QTimer;
 class Subject;
 
 /**
  * This class provides a framework for creating HTTP micro servers in Qt.
+ *
+ * Connections are serviced by a pool of network threads, so a request is
+ * dispatched as soon as it arrives and a slow request does not prevent other
+ * connections from being read. By default, postRequest() and getRequest() are
+ * called on the main application thread so they may safely access the GUI and
+ * the data model. Requests which are safe to process from any thread can be
+ * identified by overriding isThreadSafeRequest(). These requests are processed
+ * directly on the network thread and never wait for the main thread.
  */
 class MuHttpServer : public QObject, public EHS
 {
@@ -53,6 +63,8 @@ public:
        * Additional HTTP headers to attach to the response message.
        *
        * The key is the name of the header and the value is the header data.
+       * If an "etag" header is set and the request contains a matching
+       * If-None-Match header, a 304 Not Modified response is sent without a body.
        */
       QMap<QString,QString> mHeaders;
 
@@ -88,6 +100,47 @@ public:
       Response() : mCode(HTTPRESPONSECODE_INVALID), mEncoding(ASCII) {}
    };
 
+   /**
+    * This structure contains request latency statistics for a server.
+    *
+    * Latency is measured from the time a complete request has been received
+    * until the response is ready to be sent, and includes any time spent
+    * waiting for the main application thread. Percentiles are computed from
+    * the most recent requests.
+    */
+   struct LatencyStatistics
+   {
+      /**
+       * The total number of requests processed since the server was created.
+       */
+      unsigned int mRequestCount;
+
+      /**
+       * The median latency in milliseconds.
+       */
+      double mMedian;
+
+      /**
+       * The 90th percentile latency in milliseconds.
+       */
+      double mPercentile90;
+
+      /**
+       * The 99th percentile latency in milliseconds.
+       */
+      double mPercentile99;
+
+      /**
+       * The maximum latency in milliseconds.
+       */
+      double mMaximum;
+
+      /**
+       * Create empty statistics.
+       */
+      LatencyStatistics() : mRequestCount(0), mMedian(0.0), mPercentile90(0.0), mPercentile99(0.0), mMaximum(0.0) {}
+   };
+
    /**
     * Initialize a MuHttpServer object.
     *
@@ -143,7 +196,65 @@ public:
     */
    void registerPath(const QString &path, EHS *pObj);
 
+   /**
+    * Get the latency statistics for requests handled by this object.
+    *
+    * Requests handled by objects attached with registerPath() are only
+    * included in the statistics of the attached object.
+    *
+    * This method may be called from any thread.
+    *
+    * @return The latency statistics.
+    */
+   LatencyStatistics getLatencyStatistics() const;
+
+   /**
+    * Query whether the server has been started.
+    *
+    * @return True if start() has been called and the server has not been stopped.
+    */
+   bool isServerRunning() const
+   {
+      return mServerIsRunning;
+   }
+
 protected:
+   /**
+    * A unit of work which must be performed on the main application thread.
+    *
+    * @see runOnMainThread()
+    */
+   class MainThreadTask
+   {
+   public:
+      /**
+       * Destroy the task.
+       */
+      virtual ~MainThreadTask() {}
+
+      /**
+       * Perform the work. This is called on the main application thread.
+       */
+      virtual void run() = 0;
+   };
+
+   /**
+    * Run a task on the main application thread and wait for it to complete.
+    *
+    * This allows an implementation of isThreadSafeRequest() to accept a
+    * request on a network thread and perform only the parts of the request
+    * which access the GUI or the data model on the main application thread.
+    * If this is called on the main application thread, the task is run
+    * immediately.
+    *
+    * @param task
+    *        The task to run.
+    *
+    * @return True if the task was run, false if the server is stopping and
+    *         the task was not run.
+    */
+   bool runOnMainThread(MainThreadTask& task);
+
    /**
     * This handles HTTP POST requests.
     *
@@ -187,21 +298,41 @@ protected:
    virtual Response getRequest(const QString& uri, const QString& contentType, const QString& body,
       const FormValueMap& form) = 0;
 
-protected slots:
    /**
-    * Handle new and existing connections.
+    * Determine whether a request may be processed on a network thread.
+    *
+    * If this method returns \c true, postRequest() or getRequest() is called
+    * directly on the network thread which received the request. Otherwise,
+    * the request is processed on the main application thread while the
+    * network thread waits for the response. Only requests which do not access
+    * the GUI or modify shared state should be processed on a network thread.
+    *
+    * This method is called on a network thread and must not access the GUI.
+    * The default implementation returns \c false for all requests.
+    *
+    * @param method
+    *        The HTTP method of the request.
+    * @param uri
+    *        The URI of the request, as it will be passed to postRequest() or
+    *        getRequest().
+    * @param contentType
+    *        The HTTP Content-type of the request.
+    * @param body
+    *        The body of the request.
     *
-    * This runs one cycle of the server's request loop.
-    * The default behavior of a MuHttpServer is to call this slot
-    * every 250ms.
+    * @return True if the request may be processed on a network thread,
+    *         false if it must be processed on the main application thread.
     */
-   void processServer();
+   virtual bool isThreadSafeRequest(RequestMethod method, const QString& uri, const QString& contentType,
+      const QString& body) const;
 
+protected slots:
    /**
     * This provides debugging information about an HttpRequest.
     *
     * The default behavior is to do nothing. If an implementation wants
     * to log all requests for debugging purposes, this method should be overridden.
+    * This method is called on the thread which processes the request.
     *
     * @param pHttpRequest
     *        The request object.
@@ -216,7 +347,7 @@ protected slots:
     * This method is called when the underlying HTTP server code throws an error
     * during socket setup, conntection, or processing. It is also called when
     * postRequest() or getRequest() return an HTTPRESPONSECODE_INVALID indicating
-    * an internal server error.
+    * an internal server error. It is always called on the main application thread.
     *
     * @param msg
     *        A user displayable warning message.
@@ -236,17 +367,34 @@ protected slots:
       mAllowNonLocal = val;
    }
 
+private slots:
+   void processPendingTasks();
+
 private:
+   class PendingTask;
+   class RequestTask;
+
    MuHttpServer(const MuHttpServer& rhs);
    MuHttpServer& operator=(const MuHttpServer& rhs);
    ResponseCode HandleRequest(HttpRequest *pHttpRequest, HttpResponse *pHttpResponse);
+   ResponseCode processRequest(HttpRequest* pHttpRequest, HttpResponse* pHttpResponse, const QString& uri,
+      const QString& contentType, const QString& body);
+   void reportWarning(const QString& msg);
+   void shutdown();
+   void setAcceptingRequests(bool accept);
+   void recordLatency(double latency);
 
    EHSServerParameters mParams;
-   QTimer* mpTimer;
    QMap<QString, EHS*> mRegistrations;
    bool mServerIsRunning;
    bool mAllowNonLocal;
    AttachmentPtr<SessionManager> mSession;
+
+   mutable mta::DMutex mMutex;
+   bool mAcceptingRequests;
+   std::deque<PendingTask*> mPendingTasks;
+   std::vector<double> mLatencies;
+   unsigned int mRequestCount;
 };
 
 #endif
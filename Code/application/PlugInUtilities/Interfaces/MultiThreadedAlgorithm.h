@@ -258,15 +258,18 @@ private:
    Result signalMainThread(ThreadCommand& reportStatus, ReportType type);
 };
 
-// this pragma shushes a compiler warning regarding the initialization
-// of the mThreadHandle with 'this'
-#if defined(WIN_API)
-#pragma warning (push)
-#pragma warning (disable: 4355)
-#endif
+class RangeScheduler;
 
 /**
  * Base class for an algorithm thread.
+ *
+ * Threads are run on the application's thread pool, so an algorithm does not
+ * create a new system thread each time it is executed.  The pool has one
+ * thread for each processor, so a thread may not start until others have
+ * finished.  Threads which claim their items with getNextRange() take over
+ * the items of the threads which have not started.
+ *
+ * @see UtilityServices::runInThreadPool()
  */
 class AlgorithmThread : public ThreadCommand
 {
@@ -281,9 +284,11 @@ public:
     */
    AlgorithmThread(int threadIndex, ThreadReporter& reporter) : 
       mpAlgorithmMutex(NULL),
+      mpRangeScheduler(NULL),
       mReporter(reporter), 
-      mThreadHandle(static_cast<void*>(this),  reinterpret_cast<void*>(AlgorithmThread::threadFunction)), 
-      mThreadIndex(threadIndex) {}
+      mThreadIndex(threadIndex),
+      mPoolTask(0),
+      mRangeTaken(false) {}
 
    /**
     * Destructor.
@@ -298,9 +303,11 @@ public:
     */
    AlgorithmThread(const AlgorithmThread& thread) : 
       mpAlgorithmMutex(thread.mpAlgorithmMutex),
+      mpRangeScheduler(thread.mpRangeScheduler),
       mReporter(thread.mReporter), 
-      mThreadHandle(static_cast<void*>(this),  reinterpret_cast<void*>(AlgorithmThread::threadFunction)),
-      mThreadIndex(thread.mThreadIndex) {}
+      mThreadIndex(thread.mThreadIndex),
+      mPoolTask(0),
+      mRangeTaken(false) {}
 
    /**
     * The function executed by the underlying threading system.
@@ -318,13 +325,17 @@ public:
    /**
     * Launch the thread.
     *
-    * @return False if there was an error.
+    * @return False if there was an error or the thread has been launched
+    *         and wait() has not been called.
     */
    bool launch();
 
    /**
     * Wait for thread compltion.
     *
+    * This returns after the thread pool has returned from run(), so the
+    * thread may be destroyed and its module unloaded.
+    *
     * @return False if there was an error.
     */
    bool wait();
@@ -356,6 +367,17 @@ public:
     */
    void waitForAlgorithmLoop();
 
+   /**
+    * Set the scheduler which divides the items to process between the threads
+    * in an algorithm cluster.
+    *
+    * This should be the same object for all threads in the algorithm cluster.
+    *
+    * @param pScheduler
+    *        The scheduler used by getNextRange().
+    */
+   void setRangeScheduler(RangeScheduler* pScheduler);
+
    /**
     * Represents a range in integers.
     */
@@ -404,6 +426,26 @@ protected:
     */
    Range getThreadRange(int threadCount, int dataSize) const;
 
+   /**
+    * Claim the next range of values to be processed by this thread.
+    *
+    * Call this in a loop from run() instead of calling getThreadRange(). Items
+    * are claimed in small chunks, and a thread which has processed its own
+    * share of the items takes over half of the largest share left to another
+    * thread, so threads whose items are processed quickly help the others.
+    * Progress is reported for each range claimed.
+    *
+    * @param threadCount
+    *        The total number of threads in an algorithm cluster.
+    * @param dataSize
+    *        The total number of items which need to be processed.
+    * @param range
+    *        Set to the range of items which this thread should process next.
+    * @return False if there are no items left or if any thread in the
+    *         algorithm cluster has reported an error.
+    */
+   bool getNextRange(int threadCount, int dataSize, Range& range);
+
    /**
     * Get the id of this thread.
     *
@@ -419,15 +461,78 @@ protected:
    ThreadReporter& getReporter() const;
 
 private:
+   static void poolFunction(void* pThreadData);
+
    DMutex* mpAlgorithmMutex;
+   RangeScheduler* mpRangeScheduler;
    ThreadReporter& mReporter;
-   BThread mThreadHandle;
    int mThreadIndex;
+   unsigned int mPoolTask;
+   bool mRangeTaken;
 };
 
-#if defined(WIN_API)
-#pragma warning (pop)
-#endif
+/**
+ * Divides the items processed by an algorithm cluster between its threads.
+ *
+ * Each thread starts with the share of the items given by
+ * AlgorithmThread::getThreadRange() and claims it in chunks. When its share is
+ * gone, the thread takes the upper half of the largest remaining share.
+ *
+ * @see AlgorithmThread::getNextRange()
+ */
+class RangeScheduler
+{
+public:
+   /**
+    * Constructor.
+    */
+   RangeScheduler();
+
+   /**
+    * Claim the next range of values for a thread.
+    *
+    * The shares of the threads are computed by the first call after the
+    * scheduler is created or reset.
+    *
+    * @param threadIndex
+    *        The ID of the thread claiming the range.
+    * @param threadCount
+    *        The total number of threads in the algorithm cluster.
+    * @param dataSize
+    *        The total number of items which need to be processed.
+    * @param range
+    *        Set to the range of items which the thread should process next.
+    * @param percentClaimed
+    *        Set to the percentage of all items which have been claimed before
+    *        this range.
+    * @return False if there are no items left or if cancel() has been called.
+    */
+   bool getNextRange(int threadIndex, int threadCount, int dataSize, AlgorithmThread::Range& range,
+      int& percentClaimed);
+
+   /**
+    * Stop handing out ranges.
+    */
+   void cancel();
+
+   /**
+    * Forget the shares and claimed ranges so the algorithm cluster can be run again.
+    *
+    * This must not be called while threads are claiming ranges.
+    */
+   void reset();
+
+private:
+   RangeScheduler(const RangeScheduler& rhs);
+   RangeScheduler& operator=(const RangeScheduler& rhs);
+
+   DMutex mMutex;
+   std::vector<AlgorithmThread::Range> mShares;
+   int mDataSize;
+   int mClaimed;
+   int mChunkSize;
+   bool mCanceled;
+};
 
 /** \page multithreadedhowto Writing a multi-threaded algorithm
  * Use this template to make a thread class.
@@ -452,6 +557,18 @@ private:
  *    // put per-thread information into member data here
  * };
  * @endcode
+ * When the time taken to process an item varies, have run() claim its items
+ * in chunks so that the threads share the work evenly.
+ * @code
+ * void MyAlgorithmThread::run()
+ * {
+ *    Range range;
+ *    while (getNextRange(mThreadCount, mDataSize, range))
+ *    {
+ *       // process the items from range.mFirst to range.mLast
+ *    }
+ * }
+ * @endcode
  */
 
 /**
@@ -689,6 +806,7 @@ private:
    std::vector<AlgThread*> mThreads;
    MultiThreadReporter* mpThreadReporter;
    ProgressReporter* mpProgressReporter;
+   RangeScheduler mRangeScheduler;
    DMutex mMutexA;
    DThreadSignal mSignalA;
    DMutex mMutexB;
@@ -737,6 +855,7 @@ Result MultiThreadedAlgorithm<AlgInput, AlgOutput, AlgThread>::createThreads(int
       if (pThread != NULL)
       {
          pThread->setAlgorithmMutex(&mMutexA);
+         pThread->setRangeScheduler(&mRangeScheduler);
          mThreads.push_back(pThread);
       }
    }
@@ -751,6 +870,8 @@ Result MultiThreadedAlgorithm<AlgInput, AlgOutput, AlgThread>::startAllThreads()
    mMutexA.MutexLock();
    mMutexB.MutexLock();
 
+   // The threads of the previous run have been waited for, so the ranges can be handed out again
+   mRangeScheduler.reset();
    for (iter = mThreads.begin(); iter != mThreads.end(); ++iter)
    {
       (*iter)->launch();
@@ -592,4 +592,91 @@ public:
    }
 };
 
+/**
+ * The %PageBufferObject is a trait object for use with the %Resource template.
+ *
+ * The %PageBufferObject is a trait object for use with the %Resource template.
+ * It provides capability for getting and releasing page buffers from ModelServices.
+ *
+ * @see PageBufferResource
+ */
+class PageBufferObject
+{
+public:
+   /**
+    * This is an implementation detail of the %PageBufferObject class.
+    *
+    * This is an implementation detail of the %PageBufferObject class. It is used
+    * for passing the size parameter required by ModelServices::getPageBuffer().
+    */
+   class Args
+   {
+   public:
+      Args(size_t size = 0) :
+         mSize(size)
+      {
+      }
+
+      size_t mSize;
+   };
+
+   char* obtainResource(const Args& args) const
+   {
+      return Service<ModelServices>()->getPageBuffer(args.mSize);
+   }
+
+   void releaseResource(const Args& args, char* pBuffer) const
+   {
+      if (pBuffer != NULL)
+      {
+         Service<ModelServices>()->releasePageBuffer(pBuffer);
+      }
+   }
+};
+
+/**
+ *  This is a %Resource class that wraps a page buffer from ModelServices.
+ *
+ *  This is a %Resource class that wraps a page buffer from ModelServices.
+ *  Pagers should use it in place of an %ArrayResource for the pages they
+ *  read, so that the buffers of released pages are reused. A released
+ *  buffer can be passed to a CachedPage::CacheUnit created as a page buffer
+ *  unit, which returns it to ModelServices when the unit is destroyed.
+ *
+ *  @code
+ *  PageBufferResource pBuffer(pageSize);
+ *  if (pBuffer.get() != NULL)
+ *  {
+ *     // read the page into pBuffer.get()
+ *  }
+ *  @endcode
+ *
+ *  @see ModelServices::getPageBuffer()
+ */
+class PageBufferResource : public Resource<char, PageBufferObject>
+{
+public:
+   /**
+    *  Constructs the %Resource object with a new page buffer.
+    *
+    *  @param   size
+    *           The minimum size of the buffer in bytes. If the buffer cannot
+    *           be allocated, get() returns \c NULL.
+    */
+   explicit PageBufferResource(size_t size) :
+      Resource<char, PageBufferObject>(Args(size))
+   {
+   }
+
+   /**
+    *  Returns the size requested for the buffer.
+    *
+    *  @return   The size requested for the buffer in bytes.
+    */
+   size_t size() const
+   {
+      return getArgs().mSize;
+   }
+};
+
 #endif
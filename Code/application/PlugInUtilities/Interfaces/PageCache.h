@@ -10,13 +10,17 @@
 #ifndef PAGECACHE_H
 #define PAGECACHE_H
 
+#include <deque>
 #include <list>
+#include <map>
+#include <utility>
 
 #include <boost/shared_array.hpp>
 #include <boost/shared_ptr.hpp>
 #include "CachedPage.h"
 #include "DimensionDescriptor.h"
 #include "LocationType.h"
+#include "PagerStatistics.h"
 
 #include "TypesFile.h"
 
@@ -35,6 +39,12 @@ class DataRequest;
  * shared_ptrs, the actual memory will not be released until the last page
  * is destroyed.  This does, however, allow duplicate units -- one that the cache
  * knows about, and one that a lingering CachedPage references.
+ *
+ * While the page buffers of all pagers exceed their shared budget, the oldest
+ * units with page buffers which are not referenced by a CachedPage are also
+ * removed, until the excess has been released.
+ *
+ * @see ModelServices::getPageBufferBudgetExcess()
  */
 class PageCache
 {
@@ -109,6 +119,18 @@ public:
    CachedPage *createPage(CachedPage::UnitPtr pUnit, InterleaveFormatType requestedFormat,
       DimensionDescriptor startRow, DimensionDescriptor startColumn, DimensionDescriptor startBand);
 
+   /**
+    * Gets the hit, miss, eviction and refetch counts of the cache.
+    *
+    * A miss for rows which were in a unit removed from the cache is also counted
+    * as a refetch, so many refetches mean the cache is too small for the way the
+    * data is accessed.
+    *
+    * @return The counters since the cache was created.  Only the cache counters
+    *         of the statistics are set.
+    */
+   const PagerStatistics& getStatistics() const;
+
 protected:
    const size_t MAX_CACHE_SIZE;
    UnitList mUnits;
@@ -117,11 +139,20 @@ protected:
    int mBytesPerBand;
    int mColumnCount;
    int mBandCount;
+   PagerStatistics mStatistics;
 
    void enforceCacheSize();
+   UnitList::iterator evictUnit(UnitList::iterator ppUnit);
 
 private:
    PageCache& operator=(const PageCache& rhs);
+
+   // The rows of each unit removed from the cache, keyed by band and start row, in the order they were removed
+   typedef std::map<std::pair<unsigned int, unsigned int>, unsigned int> EvictedUnitMap;
+   EvictedUnitMap mEvictedUnits;
+   std::deque<EvictedUnitMap::key_type> mEvictedOrder;
+
+   static unsigned int getBandKey(DimensionDescriptor band);
 };
 
 #endif
@@ -0,0 +1,191 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2007 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#ifndef POINTCLOUDOCTREE_H
+#define POINTCLOUDOCTREE_H
+
+#include "AppConfig.h"
+
+#include <string>
+#include <vector>
+
+class DynamicObject;
+class PointCloudDataDescriptor;
+
+/**
+ * An octree index of a point cloud stored in octree order.
+ *
+ * The bounding box of the point cloud is divided into a regular grid of
+ * 2<sup>depth</sup> cells along each axis. Each grid cell is a leaf of the
+ * octree and is identified by a Morton code, which interleaves the bits of
+ * the cell's x, y and z numbers. When the points are sorted by the Morton
+ * code of the cell containing them, the points in every node of the octree
+ * occupy a single contiguous range of point indices. Only the first point
+ * index of each non-empty leaf is stored, so the index is small enough to
+ * keep in the element's metadata.
+ *
+ * Point clouds using this index have the ::POINT_OCTREE_ARRAY arrangement
+ * and the index is stored in the metadata under getMetadataName(). All
+ * coordinates are raw point coordinates before the scale and offset in the
+ * PointCloudDataDescriptor are applied.
+ */
+class PointCloudOctree
+{
+public:
+   /**
+    * The maximum depth of an octree.
+    */
+   static const unsigned int MAX_DEPTH = 10;
+
+   /**
+    * A node in the octree.
+    */
+   struct Node
+   {
+      unsigned int mLevel;    /**< The level of the node. The root node is level 0. */
+      uint32_t mCode;         /**< The Morton code of the node within its level. */
+      uint32_t mFirstPoint;   /**< The index of the first point in the node. */
+      uint32_t mPointCount;   /**< The number of points in the node. */
+      double mMinX;           /**< The minimum x coordinate of the node. */
+      double mMinY;           /**< The minimum y coordinate of the node. */
+      double mMinZ;           /**< The minimum z coordinate of the node. */
+      double mMaxX;           /**< The maximum x coordinate of the node. */
+      double mMaxY;           /**< The maximum y coordinate of the node. */
+      double mMaxZ;           /**< The maximum z coordinate of the node. */
+   };
+
+   /**
+    * Creates an octree with no leaves for building a new index.
+    *
+    * Call getLeafCode() to sort the points and setLeaves() to complete the index.
+    *
+    * @param depth
+    *        The depth of the octree, which is clamped to #MAX_DEPTH.
+    * @param minX
+    *        The minimum x coordinate of the point cloud.
+    * @param minY
+    *        The minimum y coordinate of the point cloud.
+    * @param minZ
+    *        The minimum z coordinate of the point cloud.
+    * @param maxX
+    *        The maximum x coordinate of the point cloud.
+    * @param maxY
+    *        The maximum y coordinate of the point cloud.
+    * @param maxZ
+    *        The maximum z coordinate of the point cloud.
+    */
+   PointCloudOctree(unsigned int depth, double minX, double minY, double minZ, double maxX, double maxY, double maxZ);
+
+   /**
+    * Reads the octree index of a point cloud.
+    *
+    * @param pDescriptor
+    *        The descriptor of the point cloud. The bounding box is read from
+    *        the descriptor and the leaves are read from its metadata.
+    */
+   explicit PointCloudOctree(const PointCloudDataDescriptor* pDescriptor);
+
+   /**
+    * Queries whether the octree contains a usable index.
+    *
+    * @return \c True if the octree has at least one leaf, \c false otherwise.
+    */
+   bool isValid() const;
+
+   /**
+    * Returns the depth of the octree.
+    *
+    * @return The level of the leaf nodes.
+    */
+   unsigned int getDepth() const;
+
+   /**
+    * Returns the root node of the octree, which contains every point.
+    *
+    * @return The root node.
+    */
+   Node getRoot() const;
+
+   /**
+    * Returns the non-empty children of a node.
+    *
+    * @param node
+    *        The parent node.
+    * @param children
+    *        Populated with up to eight children. This is empty if \em node is a leaf.
+    */
+   void getChildren(const Node& node, std::vector<Node>& children) const;
+
+   /**
+    * Returns the Morton code of the leaf containing a point.
+    *
+    * @param x
+    *        The raw x coordinate of the point.
+    * @param y
+    *        The raw y coordinate of the point.
+    * @param z
+    *        The raw z coordinate of the point.
+    *
+    * @return The code of the leaf containing the point. Points outside of
+    *         the bounding box are placed in the nearest leaf.
+    */
+   uint32_t getLeafCode(double x, double y, double z) const;
+
+   /**
+    * Sets the leaves of the octree.
+    *
+    * @param codes
+    *        The Morton codes of the non-empty leaves in increasing order.
+    * @param offsets
+    *        The index of the first point in each leaf, followed by the total
+    *        number of points. This must contain one more value than \em codes.
+    *
+    * @return \c True if the leaves are valid, \c false otherwise.
+    */
+   bool setLeaves(const std::vector<uint32_t>& codes, const std::vector<uint32_t>& offsets);
+
+   /**
+    * Stores the octree index in the metadata of a point cloud.
+    *
+    * @param pMetadata
+    *        The metadata to receive the index.
+    *
+    * @return \c True if the index was stored, \c false otherwise.
+    */
+   bool toMetadata(DynamicObject* pMetadata) const;
+
+   /**
+    * Returns the name of the metadata attribute containing the octree index.
+    *
+    * @return The metadata attribute name.
+    */
+   static const std::string& getMetadataName();
+
+   /**
+    * Returns a suitable octree depth for a number of points.
+    *
+    * @param pointCount
+    *        The number of points in the point cloud.
+    *
+    * @return An octree depth which leaves several thousand points in each leaf
+    *         of a uniformly distributed point cloud.
+    */
+   static unsigned int getDefaultDepth(uint64_t pointCount);
+
+private:
+   void getNodeBounds(unsigned int level, uint32_t code, Node& node) const;
+
+   unsigned int mDepth;
+   double mMin[3];
+   double mMax[3];
+   std::vector<uint32_t> mCodes;
+   std::vector<uint32_t> mOffsets;
+};
+
+#endif
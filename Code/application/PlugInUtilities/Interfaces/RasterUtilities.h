@@ -674,6 +674,36 @@ namespace RasterUtilities
       unsigned int bands, EncodingType encoding, ProcessingLocation location, InterleaveFormatType interleave = BIP,
       DataElement* pParent = NULL, void* pData = NULL, bool bOwner = true);
 
+   /** 
+    * Creates a RasterElement which stores its data compressed in memory.  This method should only
+    * be used by plug-ins that need to programmatically create a RasterElement to store results
+    * of an algorithm which compress well, such as masks or classification results.  The data
+    * initially contains zeros.  The created element will inherit the parent's classification unless
+    * the parent is \c NULL, in which case the classification will be set to the system's highest
+    * level of classification.
+    *
+    * @param name
+    *        The name for the new RasterDataDescriptor.
+    * @param rows
+    *        The number of rows for the new RasterDataDescriptor.
+    * @param columns
+    *        The number of columns for the new RasterDataDescriptor.
+    * @param bands
+    *        The number of bands for the new RasterDataDescriptor.
+    * @param encoding
+    *        The encoding for the new RasterDataDescriptor.
+    * @param interleave
+    *        The interleave for the new RasterDataDescriptor.
+    * @param pParent
+    *        The parent element for the new RasterDataDescriptor.
+    *
+    * @return A RasterElement created with the given parameters that requires no additional initialization.
+    *
+    * @see RasterElement::createCompressedPager()
+    */
+   RasterElement* createCompressedRasterElement(const std::string& name, unsigned int rows, unsigned int columns,
+      unsigned int bands, EncodingType encoding, InterleaveFormatType interleave = BIP, DataElement* pParent = NULL);
+
    /**
     * Determine the number of bytes in a single element of a
     * given EncodingType.
@@ -0,0 +1,73 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2007 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#ifndef SIGNALBATCH_H
+#define SIGNALBATCH_H
+
+#include "SafePtr.h"
+#include "Subject.h"
+#include "SubjectImp.h"
+
+/**
+ * SignalBatch is an RAII class which defers the signals of a Subject until
+ * the SignalBatch goes out of scope.
+ *
+ * A bulk change notifies Subject::signalModified() once, without data, when
+ * the batch ends, instead of once for every change. Signals without data are
+ * deferred until the batch ends, and a signal which repeats the previous
+ * deferred signal is only sent once. Signals with data are sent immediately,
+ * after any signals deferred before them, since the data may refer to objects
+ * which are destroyed before the batch ends. Every signal other than
+ * Subject::signalModified() is therefore sent in order.
+ * Subject::signalDeleted() is sent immediately.
+ *
+ * Signals are only batched for subjects implemented with SubjectImp. Other
+ * subjects notify as usual.
+ *
+ * @see SignalBlocker, Subject
+ */
+class SignalBatch
+{
+public:
+   /**
+    * Creates the RAII object and begins deferring the signals of the specified Subject.
+    *
+    * @param subject
+    *         The Subject whose signals should be deferred.
+    */
+   explicit SignalBatch(Subject& subject) :
+      mpSubject(&subject)
+   {
+      SubjectImp* pSubjectImp = dynamic_cast<SubjectImp*>(&subject);
+      if (pSubjectImp != NULL)
+      {
+         pSubjectImp->beginSignalBatch();
+      }
+   }
+
+   /**
+    * Destroys the SignalBatch, sending the deferred signals of the Subject.
+    */
+   ~SignalBatch()
+   {
+      SubjectImp* pSubjectImp = dynamic_cast<SubjectImp*>(mpSubject.get());
+      if (pSubjectImp != NULL)
+      {
+         pSubjectImp->endSignalBatch();
+      }
+   }
+
+private:
+   SignalBatch& operator=(const SignalBatch&); // prevents assignment
+   SignalBatch(const SignalBatch&); // prevents copying
+
+   SafePtr<Subject> mpSubject;
+};
+
+#endif
@@ -0,0 +1,106 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2007 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#ifndef SPECTRALMATCHING_H
+#define SPECTRALMATCHING_H
+
+#include "EnumWrapper.h"
+
+#include <string>
+
+class BitMask;
+class Progress;
+class RasterElement;
+class SignatureLibrary;
+
+/**
+ * This namespace contains functions which compare pixel spectra to the
+ * signatures in a SignatureLibrary.
+ */
+namespace SpectralMatching
+{
+   /**
+    * Specifies how a pixel is compared to a signature.
+    */
+   enum MatchMethodEnum
+   {
+      SPECTRAL_ANGLE,            /**< The angle between the pixel and the signature in degrees.
+                                      Smaller values are better matches. */
+      EUCLIDEAN_DISTANCE,        /**< The Euclidean distance between the pixel and the signature.
+                                      Smaller values are better matches. */
+      CORRELATION_COEFFICIENT    /**< The Pearson correlation coefficient of the pixel and the signature.
+                                      Larger values are better matches. */
+   };
+
+   /**
+    * @EnumWrapper SpectralMatching::MatchMethodEnum.
+    */
+   typedef EnumWrapper<MatchMethodEnum> MatchMethod;
+
+   /**
+    * Compares a single pixel to a single signature.
+    *
+    * matchLibrary() produces the same scores as this function.
+    *
+    * @param method
+    *        The comparison to perform.
+    * @param pPixel
+    *        The values of the pixel.
+    * @param pSignature
+    *        The values of the signature, sampled to the same wavelengths as \em pPixel.
+    * @param numValues
+    *        The number of values in \em pPixel and \em pSignature.
+    *
+    * @return The score of the pixel. A pixel or signature with no spectral
+    *         variation has an angle of 90 degrees and a correlation of zero.
+    */
+   double computeScore(MatchMethod method, const double* pPixel, const double* pSignature, unsigned int numValues);
+
+   /**
+    * Compares every pixel in a raster element to every signature in a library.
+    *
+    * The library is resampled once to the center wavelengths of the raster
+    * element. The pixels are then scored in blocks against blocks of signatures,
+    * in parallel over rows, and written to the result element as they are computed.
+    * The result element is created on disk if it would be too large to keep in memory.
+    *
+    * @param pRaster
+    *        The raster element to compare. The raster element must have
+    *        center wavelengths and must not contain complex data.
+    * @param pLibrary
+    *        The signatures to compare. The library is left resampled to the
+    *        wavelengths of \em pRaster.
+    * @param method
+    *        The comparison to perform.
+    * @param resultName
+    *        The name of the result element, which is created as a child of \em pRaster.
+    * @param pMask
+    *        If not \c NULL, only the selected pixels are compared. The mask
+    *        uses original pixel coordinates. The other pixels are given a
+    *        score of -1, or -2 for the correlation coefficient, which is set
+    *        as a bad value of the result element.
+    * @param pProgress
+    *        The progress object to update. This may be \c NULL.
+    * @param pAbortFlag
+    *        If not \c NULL, the comparison stops when this becomes \c true.
+    * @param errorMessage
+    *        Populated with the reason for a failure.
+    *
+    * @return A new raster element with the same rows and columns as \em pRaster
+    *         and a 4-byte floating point band of scores for each signature in
+    *         the library, or \c NULL if the comparison failed or was aborted. The
+    *         band names are the names of the signatures. The caller owns the
+    *         returned element.
+    */
+   RasterElement* matchLibrary(RasterElement* pRaster, SignatureLibrary* pLibrary, MatchMethod method,
+      const std::string& resultName, const BitMask* pMask, Progress* pProgress, const bool* pAbortFlag,
+      std::string& errorMessage);
+}
+
+#endif
@@ -28,6 +28,7 @@ class SubjectImpPrivate;
 class SubjectImp
 {
    friend class Signal::SignalValue;
+   friend class SignalBatch;
 
 public:
    SubjectImp();
@@ -86,6 +87,25 @@ protected:
     */
    void enableSignals(bool enabled);
 
+   /**
+    *  Defers notification until the matching call to endSignalBatch().
+    *
+    *  Calls may be nested, in which case the deferred signals are sent when
+    *  the outermost batch ends. Subject::signalDeleted() is never deferred.
+    *
+    *  @see     SignalBatch
+    */
+   void beginSignalBatch();
+
+   /**
+    *  Sends the signals deferred since the matching call to beginSignalBatch().
+    *
+    *  Signals without data are sent in the order they were notified, with
+    *  repeats of the same signal sent once. A single Subject::signalModified()
+    *  without data follows them. Signals with data are not deferred.
+    */
+   void endSignalBatch();
+
    SubjectImpPrivate* mpImpPrivate;
 };
 
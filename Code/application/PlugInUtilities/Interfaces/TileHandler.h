@@ -0,0 +1,173 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2007 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#ifndef TILEHANDLER_H
+#define TILEHANDLER_H
+
+#include "MuHttpServer.h"
+
+#include <QtCore/QByteArray>
+#include <QtCore/QString>
+
+#include <list>
+#include <map>
+#include <string>
+
+class RasterElement;
+class Subject;
+
+/**
+ * Publish raster element tiles via HTTP
+ *
+ * Tiles are produced directly from the raster data without using a view, so
+ * serving tiles never causes the desktop to redraw. Rendered tiles are
+ * stretched and optionally color mapped, and raw tiles contain the data
+ * values. Tiles are encoded on the network threads and kept in a
+ * byte-bounded least recently used cache. Each cached tile has an ETag so
+ * clients can revalidate tiles without transferring them again. Cached tiles
+ * for an element are discarded when the element's data is modified or the
+ * element is destroyed.
+ *
+ * Two kinds of request are supported. The element is identified by its
+ * SessionItem ID and the file extension specifies the tile format, which can
+ * be \c png, \c jpg or \c raw.
+ *
+ * <b>&lt;id&gt;/&lt;z&gt;/&lt;x&gt;/&lt;y&gt;.png</b> requests a 256 x 256
+ * tile in an XYZ tiling scheme in pixel coordinates. At the highest zoom
+ * level, one tile pixel is one raster pixel. Each lower zoom level halves the
+ * resolution, and zoom level 0 contains the entire raster in a single tile.
+ * Tile 0/0 at each zoom level is at the upper left corner of the raster.
+ *
+ * <b>&lt;id&gt;/window.png?x=&lt;column&gt;&amp;y=&lt;row&gt;&amp;width=&lt;columns&gt;&amp;height=&lt;rows&gt;</b>
+ * requests an arbitrary pixel window in active row and column numbers. The
+ * optional \c outwidth and \c outheight values resample the window to a
+ * different size.
+ *
+ * Both kinds of request accept these optional form values:
+ * - \c bands: A comma separated list of one or three active band numbers.
+ *   One band produces a grayscale or color mapped tile and three bands
+ *   produce a red, green, blue tile. Raw tiles may contain any number of
+ *   bands. The default is the first band.
+ * - \c stretch: The lower and upper percentiles of a linear stretch,
+ *   separated by a comma. The default is 2,98.
+ * - \c range: The lower and upper data values of a linear stretch, separated
+ *   by a comma. This overrides \c stretch.
+ * - \c colormap: The name of a color map in the ColorTables support files
+ *   directory to apply to a single band tile.
+ *
+ * Raw tiles contain 8-byte floating point values in native byte order and
+ * band interleaved by pixel order. Pixels outside of the raster are zero.
+ */
+class TileHandler : public MuHttpServer
+{
+   Q_OBJECT
+
+public:
+   /**
+    * The width and height of an XYZ tile in pixels.
+    */
+   static const int TILE_SIZE = 256;
+
+   /**
+    * Construct a new TileHandler.
+    *
+    * @param pParent
+    *        Qt parent object
+    */
+   TileHandler(QObject* pParent = NULL);
+
+   /**
+    * Construct a new TileHandler.
+    *
+    * @param port
+    *        TCP port where the server should listen. If this is 0, a server will
+    *        not be started. This is used to add the TileHandler to an existing
+    *        server using MuHttpServer::registerPath().
+    * @param pParent
+    *        Qt parent object
+    */
+   TileHandler(int port, QObject* pParent = NULL);
+
+   /**
+    * Destructor
+    */
+   ~TileHandler();
+
+   /**
+    * Set the maximum number of bytes of encoded tiles to cache.
+    *
+    * The least recently used tiles are discarded when the cache is full.
+    * The default is 64 MB.
+    *
+    * @param bytes
+    *        The maximum cache size in bytes. If this is 0, tiles are not cached.
+    */
+   void setMaximumCacheSize(size_t bytes);
+
+   /**
+    * Get the maximum number of bytes of encoded tiles to cache.
+    *
+    * @return The maximum cache size in bytes.
+    */
+   size_t getMaximumCacheSize() const;
+
+protected:
+   /**
+    * @copydoc MuHttpServer::getRequest()
+    *
+    * This method serves raster element tiles as described in the TileHandler
+    * class documentation.
+    */
+   MuHttpServer::Response getRequest(const QString& uri, const QString& contentType, const QString& body,
+      const FormValueMap& form);
+
+   /**
+    * @copydoc MuHttpServer::isThreadSafeRequest()
+    *
+    * Tile requests are accepted on the network threads. Only reading the
+    * raster data is performed on the main application thread.
+    */
+   bool isThreadSafeRequest(RequestMethod method, const QString& uri, const QString& contentType,
+      const QString& body) const;
+
+private:
+   TileHandler(const TileHandler& rhs);
+   TileHandler& operator=(const TileHandler& rhs);
+
+   class ReadTileTask;
+   friend class ReadTileTask;
+
+   struct CacheEntry
+   {
+      QByteArray mData;
+      QString mContentType;
+      QString mETag;
+      std::string mElementId;
+      std::list<QString>::iterator mLruPosition;
+   };
+
+   bool getCachedTile(const QString& key, Response& response);
+   void cacheTile(const QString& key, const std::string& elementId, unsigned int generation, const Response& response);
+   void trimCache();
+   unsigned int getGeneration(const std::string& elementId) const;
+   void attachElement(RasterElement* pElement);
+   void elementModified(Subject& subject, const std::string& signal, const boost::any& value);
+   void elementDeleted(Subject& subject, const std::string& signal, const boost::any& value);
+   void invalidateElement(const std::string& elementId);
+
+   std::map<QString, CacheEntry> mCache;
+   std::list<QString> mLru;
+   size_t mCacheBytes;
+   size_t mMaxCacheBytes;
+   std::map<std::string, unsigned int> mGenerations;
+   std::map<RasterElement*, std::string> mAttachedElements;
+   mutable mta::DMutex mCacheMutex;
+};
+
+#endif
@@ -11,35 +11,117 @@
 #include "Slot.h"
 #include <ehs.h>
 #include <QtCore/QDebug>
+#include <QtCore/QMetaObject>
 #include <QtCore/QString>
 #include <QtCore/QStringList>
-#include <QtCore/QTimer>
+#include <QtCore/QThread>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <algorithm>
+
+using namespace mta;
+
+namespace
+{
+   // The number of network threads which service connections
+   const int sNetworkThreadCount = 4;
+
+   // The HTTP response code for a conditional request whose response has not changed
+   const int sNotModified = 304;
+
+   // The number of recent requests used to compute latency percentiles
+   const std::vector<double>::size_type sMaxLatencySamples = 4096;
+
+   double getPercentile(std::vector<double>& values, double percentile)
+   {
+      std::vector<double>::size_type index = static_cast<std::vector<double>::size_type>(
+         percentile * (values.size() - 1) + 0.5);
+      std::nth_element(values.begin(), values.begin() + index, values.end());
+      return values[index];
+   }
+}
+
+/**
+ * A task which is waiting to be run on the main application thread.
+ */
+class MuHttpServer::PendingTask
+{
+public:
+   PendingTask(MainThreadTask& task) :
+      mTask(task),
+      mComplete(false),
+      mCancelled(false)
+   {
+   }
+
+   MainThreadTask& mTask;
+   bool mComplete;
+   bool mCancelled;
+   DThreadSignal mSignal;
+
+private:
+   PendingTask& operator=(const PendingTask& rhs);
+};
+
+/**
+ * Processes an entire request on the main application thread.
+ */
+class MuHttpServer::RequestTask : public MuHttpServer::MainThreadTask
+{
+public:
+   RequestTask(MuHttpServer& server, HttpRequest* pHttpRequest, HttpResponse* pHttpResponse, const QString& uri,
+      const QString& contentType, const QString& body) :
+      mServer(server),
+      mpHttpRequest(pHttpRequest),
+      mpHttpResponse(pHttpResponse),
+      mUri(uri),
+      mContentType(contentType),
+      mBody(body),
+      mCode(HTTPRESPONSECODE_INVALID)
+   {
+   }
+
+   void run()
+   {
+      mCode = mServer.processRequest(mpHttpRequest, mpHttpResponse, mUri, mContentType, mBody);
+   }
+
+   ResponseCode getResponseCode() const
+   {
+      return mCode;
+   }
+
+private:
+   RequestTask& operator=(const RequestTask& rhs);
+
+   MuHttpServer& mServer;
+   HttpRequest* mpHttpRequest;
+   HttpResponse* mpHttpResponse;
+   const QString& mUri;
+   const QString& mContentType;
+   const QString& mBody;
+   ResponseCode mCode;
+};
 
 MuHttpServer::MuHttpServer(int port, QObject *pParent) :
    QObject(pParent),
-   mpTimer(NULL),
    mServerIsRunning(false),
    mAllowNonLocal(false),
-   mSession(SIGNAL_NAME(SessionManager, Closed), Slot(this, &MuHttpServer::stop))
+   mSession(SIGNAL_NAME(SessionManager, Closed), Slot(this, &MuHttpServer::stop)),
+   mAcceptingRequests(true),
+   mRequestCount(0)
 {
    if (port > 0)
    {
       setObjectName("mu HTTP server");
       mParams["port"] = port;
-      mParams["mode"] = "singlethreaded";
-      mpTimer = new QTimer(this);
-      mpTimer->setSingleShot(false);
-      mpTimer->setInterval(250);
-      connect(mpTimer, SIGNAL(timeout()), this, SLOT(processServer()));
+      mParams["mode"] = "threadpool";
+      mParams["threadcount"] = sNetworkThreadCount;
    }
 }
 
 MuHttpServer::~MuHttpServer()
 {
-   if (mServerIsRunning)
-   {
-      StopServer();
-   }
+   shutdown();
 
    // Destroy registrations here before the EHS class destructor is called
    for (QMap<QString, EHS*>::iterator it = mRegistrations.begin(); it != mRegistrations.end(); ++it)
@@ -60,10 +142,10 @@ bool MuHttpServer::start()
       return true;
    }
 
+   setAcceptingRequests(true);
    try
    {
       StartServer(mParams);
-      mpTimer->start();
    }
    catch (...)
    {
@@ -83,10 +165,23 @@ bool MuHttpServer::start()
 
 void MuHttpServer::stop(Subject &subject, const std::string &signal, const boost::any &v)
 {
-   StopServer();
+   shutdown();
    mSession.reset(NULL);
+}
+
+void MuHttpServer::shutdown()
+{
+   if (!mServerIsRunning)
+   {
+      return;
+   }
+
+   // StopServer() joins the network threads, and this is the main thread which they may be waiting
+   // for in runOnMainThread(). Fail their pending tasks and refuse new ones first, so every network
+   // thread can finish its request before it is joined.
+   setAcceptingRequests(false);
+   StopServer();
    mServerIsRunning = false;
-   mpTimer->stop();
 }
 
 void MuHttpServer::registerPath(const QString &path, EHS *pObj)
@@ -95,18 +190,177 @@ void MuHttpServer::registerPath(const QString &path, EHS *pObj)
    {
       RegisterEHS(pObj, path.toAscii());
    }
+   mRegistrations[path] = pObj;
+}
+
+MuHttpServer::LatencyStatistics MuHttpServer::getLatencyStatistics() const
+{
+   LatencyStatistics statistics;
+   std::vector<double> latencies;
+   {
+      MutexLock lock(mMutex);
+      statistics.mRequestCount = mRequestCount;
+      latencies = mLatencies;
+   }
+
+   if (!latencies.empty())
+   {
+      statistics.mMaximum = *std::max_element(latencies.begin(), latencies.end());
+      statistics.mMedian = getPercentile(latencies, 0.5);
+      statistics.mPercentile90 = getPercentile(latencies, 0.9);
+      statistics.mPercentile99 = getPercentile(latencies, 0.99);
+   }
+
+   return statistics;
+}
+
+bool MuHttpServer::isThreadSafeRequest(RequestMethod method, const QString& uri, const QString& contentType,
+                                       const QString& body) const
+{
+   return false;
+}
+
+bool MuHttpServer::runOnMainThread(MainThreadTask& task)
+{
+   if (QThread::currentThread() == thread())
+   {
+      task.run();
+      return true;
+   }
+
+   PendingTask pendingTask(task);
+   {
+      MutexLock lock(mMutex);
+      if (!mAcceptingRequests)
+      {
+         return false;
+      }
+      mPendingTasks.push_back(&pendingTask);
+   }
+
+   QMetaObject::invokeMethod(this, "processPendingTasks", Qt::QueuedConnection);
+
+   MutexLock lock(mMutex);
+   while (!pendingTask.mComplete)
+   {
+      pendingTask.mSignal.ThreadSignalWait(&mMutex);
+   }
+   return !pendingTask.mCancelled;
+}
+
+void MuHttpServer::processPendingTasks()
+{
+   for (;;)
+   {
+      PendingTask* pPendingTask = NULL;
+      {
+         MutexLock lock(mMutex);
+         if (!mAcceptingRequests || mPendingTasks.empty())
+         {
+            return;
+         }
+         pPendingTask = mPendingTasks.front();
+         mPendingTasks.pop_front();
+      }
+
+      pPendingTask->mTask.run();
+
+      // The network thread destroys the task as soon as it is marked complete
+      MutexLock lock(mMutex);
+      pPendingTask->mComplete = true;
+      pPendingTask->mSignal.ThreadSignalActivate();
+   }
+}
+
+void MuHttpServer::setAcceptingRequests(bool accept)
+{
+   for (QMap<QString, EHS*>::iterator it = mRegistrations.begin(); it != mRegistrations.end(); ++it)
+   {
+      MuHttpServer* pServer = dynamic_cast<MuHttpServer*>(it.value());
+      if (pServer != NULL)
+      {
+         pServer->setAcceptingRequests(accept);
+      }
+   }
+
+   MutexLock lock(mMutex);
+   mAcceptingRequests = accept;
+   if (!accept)
+   {
+      // Cancel any tasks which are still waiting for the main thread
+      for (std::deque<PendingTask*>::iterator it = mPendingTasks.begin(); it != mPendingTasks.end(); ++it)
+      {
+         PendingTask* pPendingTask = *it;
+         pPendingTask->mCancelled = true;
+         pPendingTask->mComplete = true;
+         pPendingTask->mSignal.ThreadSignalActivate();
+      }
+      mPendingTasks.clear();
+   }
+}
+
+void MuHttpServer::recordLatency(double latency)
+{
+   MutexLock lock(mMutex);
+   if (mLatencies.size() < sMaxLatencySamples)
+   {
+      mLatencies.push_back(latency);
+   }
    else
    {
-      mRegistrations[path] = pObj;
+      mLatencies[mRequestCount % sMaxLatencySamples] = latency;
    }
+   ++mRequestCount;
 }
 
-void MuHttpServer::processServer()
+void MuHttpServer::reportWarning(const QString& msg)
 {
-   HandleData(0);
+   if (QThread::currentThread() == thread())
+   {
+      warning(msg);
+   }
+   else
+   {
+      QMetaObject::invokeMethod(this, "warning", Qt::QueuedConnection, Q_ARG(QString, msg));
+   }
 }
 
 ResponseCode MuHttpServer::HandleRequest(HttpRequest *pHttpRequest, HttpResponse *pHttpResponse)
+{
+   boost::posix_time::ptime startTime = boost::posix_time::microsec_clock::universal_time();
+
+   QString uri = QString::fromStdString(pHttpRequest->Uri()).split("?")[0];
+   QString contentType = pHttpRequest->Headers("content-type").c_str();
+   QString body = pHttpRequest->Body().c_str();
+
+   ResponseCode code = HTTPRESPONSECODE_INVALID;
+   if (isThreadSafeRequest(pHttpRequest->Method(), uri, contentType, body))
+   {
+      code = processRequest(pHttpRequest, pHttpResponse, uri, contentType, body);
+   }
+   else
+   {
+      RequestTask task(*this, pHttpRequest, pHttpResponse, uri, contentType, body);
+      if (runOnMainThread(task))
+      {
+         code = task.getResponseCode();
+      }
+      else
+      {
+         std::string errorString =
+            "<html><body><h1>Service unavailable</h1>The server is shutting down.</body></html>";
+         pHttpResponse->SetBody(errorString.c_str(), errorString.size());
+         code = HTTPRESPONSECODE_500_INTERNALSERVERERROR;
+      }
+   }
+
+   boost::posix_time::time_duration elapsed = boost::posix_time::microsec_clock::universal_time() - startTime;
+   recordLatency(elapsed.total_microseconds() / 1000.0);
+   return code;
+}
+
+ResponseCode MuHttpServer::processRequest(HttpRequest* pHttpRequest, HttpResponse* pHttpResponse,
+                                          const QString& uri, const QString& contentType, const QString& body)
 {
    debug(pHttpRequest);
 
@@ -116,20 +370,26 @@ ResponseCode MuHttpServer::HandleRequest(HttpRequest *pHttpRequest, HttpResponse
          "Connection from %1 has been blocked. Only localhost connections are allowed.</body></html>")
          .arg(QString::fromStdString(pHttpRequest->RemoteAddress()));
       pHttpResponse->SetBody(errorString.toAscii(), errorString.size());
-      warning(errorString);
+      reportWarning(errorString);
       return HTTPRESPONSECODE_403_FORBIDDEN;
    }
 
-   QString uri = QString::fromStdString(pHttpRequest->Uri()).split("?")[0];
    if (pHttpRequest->Method() == REQUESTMETHOD_GET || pHttpRequest->Method() == REQUESTMETHOD_POST)
    {
-      QString contentType = pHttpRequest->Headers("content-type").c_str();
-      QString body = pHttpRequest->Body().c_str();
       Response rsp = (pHttpRequest->Method() == REQUESTMETHOD_GET) ?
          getRequest(uri, contentType, body, pHttpRequest->FormValues()) :
          postRequest(uri, contentType, body, pHttpRequest->FormValues());
       if (rsp.mCode != HTTPRESPONSECODE_INVALID && rsp.mEncoding.isValid())
       {
+         QMap<QString, QString>::const_iterator etagIt = rsp.mHeaders.find("etag");
+         if (rsp.mCode == HTTPRESPONSECODE_200_OK && etagIt != rsp.mHeaders.end() &&
+            QString::fromStdString(pHttpRequest->Headers("if-none-match")) == etagIt.value())
+         {
+            // The client already has this response
+            pHttpResponse->SetHeader("etag", etagIt.value().toStdString());
+            return static_cast<ResponseCode>(sNotModified);
+         }
+
          switch (rsp.mEncoding)
          {
          case Response::ASCII:
@@ -154,7 +414,7 @@ ResponseCode MuHttpServer::HandleRequest(HttpRequest *pHttpRequest, HttpResponse
    // default to responding with an internal server error
    std::string errorString = "<html><body><h1>Internal server error</h1>An unknown error occured.</body></html>";
    pHttpResponse->SetBody(errorString.c_str(), errorString.size());
-   warning(QString::fromStdString(errorString));
+   reportWarning(QString::fromStdString(errorString));
    return HTTPRESPONSECODE_500_INTERNALSERVERERROR;
 }
 
@@ -11,6 +11,7 @@
 #include "MessageLogMgrImp.h"
 #include "Progress.h"
 #include "Units.h"
+#include "UtilityServices.h"
 
 using namespace mta;
 
@@ -268,15 +269,31 @@ void AlgorithmThread::threadFunction(AlgorithmThread *pThreadData)
    }
 }
 
+void AlgorithmThread::poolFunction(void* pThreadData)
+{
+   // Completion is signaled by the pool after this returns, since this module may be unloaded once wait() returns
+   threadFunction(static_cast<AlgorithmThread*>(pThreadData));
+}
+
 bool AlgorithmThread::launch()
 {
-   mThreadHandle.ThreadLaunch();
-   return true;
+   if (mPoolTask != 0)
+   {
+      return false;
+   }
+
+   mRangeTaken = false;
+   mPoolTask = Service<UtilityServices>()->startInThreadPool(AlgorithmThread::poolFunction, this);
+   return mPoolTask != 0;
 }
 
 bool AlgorithmThread::wait()
 {
-   mThreadHandle.ThreadWait();
+   if (mPoolTask != 0)
+   {
+      Service<UtilityServices>()->waitForThreadPool(mPoolTask);
+      mPoolTask = 0;
+   }
    return true;
 }
 
@@ -309,6 +326,43 @@ AlgorithmThread::Range AlgorithmThread::getThreadRange(int threadCount, int data
    return range;
 }
 
+bool AlgorithmThread::getNextRange(int threadCount, int dataSize, Range& range)
+{
+   if (getReporter().getErrorText().empty() == false)
+   {
+      if (mpRangeScheduler != NULL)
+      {
+         mpRangeScheduler->cancel();
+      }
+      return false;
+   }
+
+   if (mpRangeScheduler == NULL)
+   {
+      // Without a scheduler, process this thread's share as a single range
+      if (mRangeTaken)
+      {
+         return false;
+      }
+      mRangeTaken = true;
+      range = getThreadRange(threadCount, dataSize);
+      return range.mFirst <= range.mLast;
+   }
+
+   int percent = 0;
+   if (mpRangeScheduler->getNextRange(mThreadIndex, threadCount, dataSize, range, percent) == false)
+   {
+      return false;
+   }
+
+   if (getReporter().reportProgress(mThreadIndex, percent) != SUCCESS)
+   {
+      mpRangeScheduler->cancel();
+      return false;
+   }
+   return true;
+}
+
 int AlgorithmThread::getThreadIndex() const
 {
    return mThreadIndex;
@@ -337,6 +391,103 @@ void AlgorithmThread::waitForAlgorithmLoop()
    }
 }
 
+void AlgorithmThread::setRangeScheduler(RangeScheduler* pScheduler)
+{
+   mpRangeScheduler = pScheduler;
+}
+
+//------------ RangeScheduler ---------------//
+
+RangeScheduler::RangeScheduler() :
+   mDataSize(0),
+   mClaimed(0),
+   mChunkSize(1),
+   mCanceled(false)
+{
+}
+
+bool RangeScheduler::getNextRange(int threadIndex, int threadCount, int dataSize, AlgorithmThread::Range& range,
+   int& percentClaimed)
+{
+   MutexLock lock(mMutex);
+   if (mShares.empty())
+   {
+      if (threadCount <= 0 || dataSize <= 0)
+      {
+         return false;
+      }
+
+      // Start each thread with the share it would process without a scheduler
+      int countPerThread = static_cast<int>(ceil(static_cast<double>(dataSize) / static_cast<double>(threadCount)));
+      mShares.resize(threadCount);
+      for (int i = 0; i < threadCount; ++i)
+      {
+         mShares[i].mFirst = std::min(i * countPerThread, dataSize);
+         mShares[i].mLast = std::min(mShares[i].mFirst + countPerThread, dataSize) - 1;
+      }
+
+      mDataSize = dataSize;
+      mChunkSize = std::max(dataSize / (threadCount * 16), 1);
+   }
+
+   if (mCanceled || threadIndex < 0 || threadIndex >= static_cast<int>(mShares.size()))
+   {
+      return false;
+   }
+
+   AlgorithmThread::Range& share = mShares[threadIndex];
+   if (share.mFirst > share.mLast)
+   {
+      std::vector<AlgorithmThread::Range>::iterator pLargest = mShares.end();
+      int largestCount = 0;
+      for (std::vector<AlgorithmThread::Range>::iterator iter = mShares.begin(); iter != mShares.end(); ++iter)
+      {
+         int count = iter->mLast - iter->mFirst + 1;
+         if (count > largestCount)
+         {
+            pLargest = iter;
+            largestCount = count;
+         }
+      }
+
+      if (pLargest == mShares.end())
+      {
+         return false;
+      }
+
+      // Leave the lower half, which the other thread will claim next
+      int stolenCount = (largestCount <= mChunkSize) ? largestCount : largestCount / 2;
+      share.mLast = pLargest->mLast;
+      share.mFirst = share.mLast - stolenCount + 1;
+      pLargest->mLast = share.mFirst - 1;
+   }
+
+   range.mFirst = share.mFirst;
+   range.mLast = std::min(share.mFirst + mChunkSize - 1, share.mLast);
+   share.mFirst = range.mLast + 1;
+
+   // Report less than 100 percent, since the range has not been processed
+   percentClaimed = std::min(static_cast<int>((100.0 * mClaimed) / mDataSize), 99);
+   mClaimed += range.mLast - range.mFirst + 1;
+   return true;
+}
+
+void RangeScheduler::cancel()
+{
+   MutexLock lock(mMutex);
+   mCanceled = true;
+}
+
+void RangeScheduler::reset()
+{
+   MutexLock lock(mMutex);
+   mShares.clear();
+   mDataSize = 0;
+   mClaimed = 0;
+   mChunkSize = 1;
+   mCanceled = false;
+}
+
 //------------ ProgressObjectReporter ---------------//
 
 void ProgressObjectReporter::reportError(const std::string &text)
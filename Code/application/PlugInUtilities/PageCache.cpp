@@ -9,14 +9,22 @@
 
 #include "AppVerify.h"
 #include "DataRequest.h"
+#include "ModelServices.h"
 #include "PageCache.h"
 #include "TypesFile.h"
 
 #include <algorithm>
 #include <boost/bind.hpp>
+#include <limits>
 #include <sstream>
 using namespace std;
 
+namespace
+{
+   // The number of removed units remembered to count refetches
+   const size_t sMaxEvictedUnits = 1024;
+}
+
 PageCache::PageCache(const size_t maxCacheSize) :
    MAX_CACHE_SIZE(maxCacheSize),
    mCacheSize(0)
@@ -54,6 +62,24 @@ CachedPage::UnitPtr PageCache::getUnit(DataRequest *pOriginalRequest,
       // Remove from the list -- it will be re-added to the end in createPage()
       mUnits.erase(ppMatchingUnit);
       mCacheSize -= pUnit->getSize();
+      ++mStatistics.mCacheHits;
+   }
+   else
+   {
+      ++mStatistics.mCacheMisses;
+
+      // Check whether the row was in a unit which has already been removed from the cache
+      unsigned int bandKey = getBandKey(band);
+      unsigned int row = startRow.getActiveNumber();
+      EvictedUnitMap::const_iterator iter = mEvictedUnits.upper_bound(make_pair(bandKey, row));
+      if (iter != mEvictedUnits.begin())
+      {
+         --iter;
+         if (iter->first.first == bandKey && row < iter->first.second + iter->second)
+         {
+            ++mStatistics.mCacheRefetches;
+         }
+      }
    }
 
    return pUnit;
@@ -102,9 +128,63 @@ void PageCache::enforceCacheSize()
 {
    while (mCacheSize > MAX_CACHE_SIZE && !mUnits.empty())
    {
-      mCacheSize -= mUnits.front()->getSize();
-      mUnits.pop_front();
+      evictUnit(mUnits.begin());
    }
+
+   // The page buffers of all caches share a budget, so release the page buffer units which
+   // are only held by this cache until the excess is released, keeping the newest unit
+   size_t excess = Service<ModelServices>()->getPageBufferBudgetExcess();
+   UnitList::iterator ppUnit = mUnits.begin();
+   while (excess > 0 && ppUnit != mUnits.end() && *ppUnit != mUnits.back())
+   {
+      if ((*ppUnit)->isPageBuffer() && ppUnit->unique())
+      {
+         excess -= min(excess, (*ppUnit)->getSize());
+         ppUnit = evictUnit(ppUnit);
+      }
+      else
+      {
+         ++ppUnit;
+      }
+   }
+}
+
+PageCache::UnitList::iterator PageCache::evictUnit(UnitList::iterator ppUnit)
+{
+   CachedPage::UnitPtr pUnit = *ppUnit;
+   mCacheSize -= pUnit->getSize();
+
+   // Only the most recently removed units are remembered, so the map does not grow with the data
+   EvictedUnitMap::key_type key(getBandKey(pUnit->getBand()), pUnit->getStartRow().getActiveNumber());
+   pair<EvictedUnitMap::iterator, bool> evicted = mEvictedUnits.insert(EvictedUnitMap::value_type(key, 0));
+   evicted.first->second = max(evicted.first->second, pUnit->getConcurrentRows());
+   if (evicted.second)
+   {
+      mEvictedOrder.push_back(key);
+      if (mEvictedOrder.size() > sMaxEvictedUnits)
+      {
+         mEvictedUnits.erase(mEvictedOrder.front());
+         mEvictedOrder.pop_front();
+      }
+   }
+   ++mStatistics.mCacheEvictions;
+   return mUnits.erase(ppUnit);
+}
+
+const PagerStatistics& PageCache::getStatistics() const
+{
+   return mStatistics;
+}
+
+unsigned int PageCache::getBandKey(DimensionDescriptor band)
+{
+   if (band.isActiveNumberValid() == false)
+   {
+      // ALL_BANDS
+      return numeric_limits<unsigned int>::max();
+   }
+
+   return band.getActiveNumber();
 }
 
 void PageCache::initialize(int bytesPerBand, int columnCount, int bandCount)
@@ -0,0 +1,247 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2007 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#include "DataVariant.h"
+#include "DynamicObject.h"
+#include "PointCloudDataDescriptor.h"
+#include "PointCloudOctree.h"
+
+#include <algorithm>
+#include <math.h>
+
+using namespace std;
+
+namespace
+{
+   // Spread the low 10 bits of a value so that there are two zero bits between each bit
+   uint32_t spreadBits(uint32_t value)
+   {
+      value &= 0x000003ff;
+      value = (value | (value << 16)) & 0xff0000ff;
+      value = (value | (value << 8)) & 0x0300f00f;
+      value = (value | (value << 4)) & 0x030c30c3;
+      value = (value | (value << 2)) & 0x09249249;
+      return value;
+   }
+
+   uint32_t compactBits(uint32_t value)
+   {
+      value &= 0x09249249;
+      value = (value | (value >> 2)) & 0x030c30c3;
+      value = (value | (value >> 4)) & 0x0300f00f;
+      value = (value | (value >> 8)) & 0xff0000ff;
+      value = (value | (value >> 16)) & 0x000003ff;
+      return value;
+   }
+}
+
+PointCloudOctree::PointCloudOctree(unsigned int depth, double minX, double minY, double minZ,
+                                   double maxX, double maxY, double maxZ) :
+   mDepth(depth < MAX_DEPTH ? depth : MAX_DEPTH)
+{
+   mMin[0] = minX;
+   mMin[1] = minY;
+   mMin[2] = minZ;
+   mMax[0] = maxX;
+   mMax[1] = maxY;
+   mMax[2] = maxZ;
+}
+
+PointCloudOctree::PointCloudOctree(const PointCloudDataDescriptor* pDescriptor) :
+   mDepth(0)
+{
+   mMin[0] = mMin[1] = mMin[2] = 0.0;
+   mMax[0] = mMax[1] = mMax[2] = 0.0;
+   if (pDescriptor == NULL || pDescriptor->getArrangement() != POINT_OCTREE_ARRAY)
+   {
+      return;
+   }
+
+   mMin[0] = pDescriptor->getXMin();
+   mMin[1] = pDescriptor->getYMin();
+   mMin[2] = pDescriptor->getZMin();
+   mMax[0] = pDescriptor->getXMax();
+   mMax[1] = pDescriptor->getYMax();
+   mMax[2] = pDescriptor->getZMax();
+
+   const DynamicObject* pMetadata = pDescriptor->getMetadata();
+   if (pMetadata == NULL)
+   {
+      return;
+   }
+
+   const DataVariant& depth = pMetadata->getAttributeByPath(getMetadataName() + "/Depth");
+   const vector<unsigned int>* pCodes = pMetadata->getAttributeByPath(
+      getMetadataName() + "/Leaf Codes").getPointerToValue<vector<unsigned int> >();
+   const vector<unsigned int>* pOffsets = pMetadata->getAttributeByPath(
+      getMetadataName() + "/Leaf Offsets").getPointerToValue<vector<unsigned int> >();
+   if (depth.isValid() == false || pCodes == NULL || pOffsets == NULL)
+   {
+      return;
+   }
+
+   mDepth = dv_cast<unsigned int>(depth);
+   mDepth = mDepth < MAX_DEPTH ? mDepth : MAX_DEPTH;
+   setLeaves(vector<uint32_t>(pCodes->begin(), pCodes->end()), vector<uint32_t>(pOffsets->begin(), pOffsets->end()));
+}
+
+bool PointCloudOctree::isValid() const
+{
+   return mCodes.empty() == false;
+}
+
+unsigned int PointCloudOctree::getDepth() const
+{
+   return mDepth;
+}
+
+PointCloudOctree::Node PointCloudOctree::getRoot() const
+{
+   Node root;
+   getNodeBounds(0, 0, root);
+   root.mFirstPoint = 0;
+   root.mPointCount = mOffsets.empty() ? 0 : mOffsets.back();
+   return root;
+}
+
+void PointCloudOctree::getChildren(const Node& node, vector<Node>& children) const
+{
+   children.clear();
+   if (node.mLevel >= mDepth || node.mPointCount == 0)
+   {
+      return;
+   }
+
+   const unsigned int childLevel = node.mLevel + 1;
+   const unsigned int shift = 3 * (mDepth - childLevel);
+   for (uint32_t child = 0; child < 8; ++child)
+   {
+      uint32_t code = (node.mCode << 3) | child;
+
+      // The leaves of the child are the contiguous range of leaf codes sharing its prefix
+      vector<uint32_t>::const_iterator first = lower_bound(mCodes.begin(), mCodes.end(), code << shift);
+      vector<uint32_t>::const_iterator last = lower_bound(first, mCodes.end(), (code + 1) << shift);
+      if (first == last)
+      {
+         continue;
+      }
+
+      Node childNode;
+      getNodeBounds(childLevel, code, childNode);
+      childNode.mFirstPoint = mOffsets[first - mCodes.begin()];
+      childNode.mPointCount = mOffsets[last - mCodes.begin()] - childNode.mFirstPoint;
+      children.push_back(childNode);
+   }
+}
+
+uint32_t PointCloudOctree::getLeafCode(double x, double y, double z) const
+{
+   const double values[3] = { x, y, z };
+   const uint32_t cellCount = 1 << mDepth;
+
+   uint32_t cells[3];
+   for (int axis = 0; axis < 3; ++axis)
+   {
+      double span = mMax[axis] - mMin[axis];
+      double cell = 0.0;
+      if (span > 0.0)
+      {
+         cell = floor((values[axis] - mMin[axis]) / span * cellCount);
+      }
+
+      cells[axis] = static_cast<uint32_t>(max(0.0, min(cell, static_cast<double>(cellCount - 1))));
+   }
+
+   return spreadBits(cells[0]) | (spreadBits(cells[1]) << 1) | (spreadBits(cells[2]) << 2);
+}
+
+bool PointCloudOctree::setLeaves(const vector<uint32_t>& codes, const vector<uint32_t>& offsets)
+{
+   mCodes.clear();
+   mOffsets.clear();
+   if (codes.empty() || offsets.size() != codes.size() + 1)
+   {
+      return false;
+   }
+
+   for (vector<uint32_t>::size_type i = 1; i < codes.size(); ++i)
+   {
+      if (codes[i] <= codes[i - 1] || offsets[i] < offsets[i - 1])
+      {
+         return false;
+      }
+   }
+
+   if (offsets.back() < offsets[offsets.size() - 2])
+   {
+      return false;
+   }
+
+   mCodes = codes;
+   mOffsets = offsets;
+   return true;
+}
+
+bool PointCloudOctree::toMetadata(DynamicObject* pMetadata) const
+{
+   if (pMetadata == NULL || isValid() == false)
+   {
+      return false;
+   }
+
+   return pMetadata->setAttributeByPath(getMetadataName() + "/Depth", mDepth) &&
+      pMetadata->setAttributeByPath(getMetadataName() + "/Leaf Codes",
+         vector<unsigned int>(mCodes.begin(), mCodes.end())) &&
+      pMetadata->setAttributeByPath(getMetadataName() + "/Leaf Offsets",
+         vector<unsigned int>(mOffsets.begin(), mOffsets.end()));
+}
+
+const string& PointCloudOctree::getMetadataName()
+{
+   static string sName("Octree");
+   return sName;
+}
+
+unsigned int PointCloudOctree::getDefaultDepth(uint64_t pointCount)
+{
+   // Each level multiplies the number of leaves by eight
+   const uint64_t pointsPerLeaf = 8192;
+   unsigned int depth = 0;
+   while (depth < MAX_DEPTH && pointCount > pointsPerLeaf)
+   {
+      pointCount /= 8;
+      ++depth;
+   }
+
+   return depth;
+}
+
+void PointCloudOctree::getNodeBounds(unsigned int level, uint32_t code, Node& node) const
+{
+   node.mLevel = level;
+   node.mCode = code;
+
+   const uint32_t cells[3] = { compactBits(code), compactBits(code >> 1), compactBits(code >> 2) };
+   const double cellCount = static_cast<double>(1 << level);
+   double minimum[3];
+   double maximum[3];
+   for (int axis = 0; axis < 3; ++axis)
+   {
+      double size = (mMax[axis] - mMin[axis]) / cellCount;
+      minimum[axis] = mMin[axis] + cells[axis] * size;
+      maximum[axis] = minimum[axis] + size;
+   }
+
+   node.mMinX = minimum[0];
+   node.mMinY = minimum[1];
+   node.mMinZ = minimum[2];
+   node.mMaxX = maximum[0];
+   node.mMaxY = maximum[1];
+   node.mMaxZ = maximum[2];
+}
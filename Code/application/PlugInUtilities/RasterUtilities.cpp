@@ -681,6 +681,22 @@ RasterElement* RasterUtilities::createRasterElement(const std::string& name, uns
    return pRasterElement.release();
 }
 
+RasterElement* RasterUtilities::createCompressedRasterElement(const std::string& name, unsigned int rows,
+   unsigned int columns, unsigned int bands, EncodingType encoding, InterleaveFormatType interleave,
+   DataElement* pParent)
+{
+   RasterDataDescriptor* pDd = generateRasterDataDescriptor(name, pParent, rows, columns, bands, interleave,
+      encoding, IN_MEMORY);
+
+   ModelResource<RasterElement> pRasterElement(pDd);
+   if (pRasterElement.get() == NULL || pRasterElement->createCompressedPager() == false)
+   {
+      return NULL;
+   }
+
+   return pRasterElement.release();
+}
+
 RasterElement* RasterUtilities::createRasterElement(const std::string& name, unsigned int rows, unsigned int columns,
    EncodingType encoding, bool inMemory, DataElement* pParent)
 {
@@ -0,0 +1,529 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2007 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#include "AppConfig.h"
+#include "AppVerify.h"
+#include "BadValues.h"
+#include "BitMask.h"
+#include "DataAccessor.h"
+#include "DataAccessorImpl.h"
+#include "DataRequest.h"
+#include "DynamicObject.h"
+#include "MultiThreadedAlgorithm.h"
+#include "ObjectResource.h"
+#include "Progress.h"
+#include "RasterDataDescriptor.h"
+#include "RasterElement.h"
+#include "RasterUtilities.h"
+#include "SignatureLibrary.h"
+#include "SpecialMetadata.h"
+#include "SpectralMatching.h"
+#include "switchOnEncoding.h"
+#include "UtilityServices.h"
+#include "Wavelengths.h"
+
+#include <algorithm>
+#include <math.h>
+#include <vector>
+
+using namespace std;
+
+namespace
+{
+   // The number of pixels and signatures compared at a time. A block of signatures
+   // for a few dozen bands fits in the L2 cache and is reused for every pixel in a block.
+   const unsigned int sPixelBlock = 32;
+   const unsigned int sSignatureBlock = 256;
+   const unsigned int sBandBlock = 64;
+
+   // Pixels outside of the mask are given a score which no comparison can produce
+   float getMaskedScore(SpectralMatching::MatchMethod method)
+   {
+      return (method == SpectralMatching::CORRELATION_COEFFICIENT) ? -2.0f : -1.0f;
+   }
+
+   double angleScore(double dot, double pixelSquares, double signatureSquares)
+   {
+      double magnitudes = sqrt(pixelSquares * signatureSquares);
+      if (magnitudes <= 0.0)
+      {
+         return 90.0;
+      }
+
+      double cosine = max(-1.0, min(1.0, dot / magnitudes));
+      return acos(cosine) * 180.0 / PI;
+   }
+
+   double correlationScore(unsigned int numValues, double dot, double pixelSum, double pixelSquares,
+      double signatureSum, double signatureSquares)
+   {
+      double pixelVariance = numValues * pixelSquares - pixelSum * pixelSum;
+      double signatureVariance = numValues * signatureSquares - signatureSum * signatureSum;
+      double denominator = sqrt(pixelVariance * signatureVariance);
+      if (denominator <= 0.0)
+      {
+         return 0.0;
+      }
+
+      return (numValues * dot - pixelSum * signatureSum) / denominator;
+   }
+
+   void computeSums(const double* pValues, unsigned int numValues, double& sum, double& squares)
+   {
+      sum = 0.0;
+      squares = 0.0;
+      for (unsigned int i = 0; i < numValues; ++i)
+      {
+         sum += pValues[i];
+         squares += pValues[i] * pValues[i];
+      }
+   }
+
+   struct MatchInput
+   {
+      MatchInput() :
+         mpRaster(NULL),
+         mpResult(NULL),
+         mpMask(NULL),
+         mpAbortFlag(NULL),
+         mNumBands(0),
+         mNumSignatures(0)
+      {}
+
+      const RasterElement* mpRaster;
+      RasterElement* mpResult;
+      const BitMask* mpMask;
+      const bool* mpAbortFlag;
+      SpectralMatching::MatchMethod mMethod;
+      unsigned int mNumBands;
+      unsigned int mNumSignatures;
+      vector<double> mSignatures;         // numBands x numSignatures
+      vector<double> mSignatureSums;
+      vector<double> mSignatureSquares;
+      vector<int> mOriginalRows;          // The mask uses original pixel coordinates
+      vector<int> mOriginalColumns;
+   };
+
+   class MatchThread : public mta::AlgorithmThread
+   {
+   public:
+      MatchThread(const MatchInput& input, int threadCount, int threadIndex, mta::ThreadReporter& reporter) :
+         mta::AlgorithmThread(threadIndex, reporter),
+         mInput(input),
+         mThreadCount(threadCount),
+         mRowCount(static_cast<int>(static_cast<const RasterDataDescriptor*>(
+            input.mpRaster->getDataDescriptor())->getRowCount())),
+         mComplete(false)
+      {}
+
+      void run()
+      {
+         const RasterDataDescriptor* pDescriptor =
+            dynamic_cast<const RasterDataDescriptor*>(mInput.mpRaster->getDataDescriptor());
+         if (pDescriptor != NULL)
+         {
+            switchOnEncoding(pDescriptor->getDataType(), matchRows, NULL, pDescriptor);
+         }
+      }
+
+      bool isComplete() const
+      {
+         return mComplete;
+      }
+
+   private:
+      MatchThread& operator=(const MatchThread& rhs);
+
+      template<class T>
+      void matchRows(T* pDummy, const RasterDataDescriptor* pDescriptor)
+      {
+         const RasterDataDescriptor* pResultDescriptor =
+            dynamic_cast<const RasterDataDescriptor*>(mInput.mpResult->getDataDescriptor());
+         if (pResultDescriptor == NULL)
+         {
+            return;
+         }
+
+         // Rows are claimed in chunks, so threads whose rows are mostly outside
+         // of the mask go on to help the other threads
+         mta::AlgorithmThread::Range range;
+         while (getNextRange(mThreadCount, mRowCount, range))
+         {
+            if (mInput.mpAbortFlag != NULL && *mInput.mpAbortFlag)
+            {
+               return;
+            }
+
+            if (matchRange(pDummy, pDescriptor, pResultDescriptor, range) == false)
+            {
+               return;
+            }
+         }
+
+         mComplete = true;
+      }
+
+      template<class T>
+      bool matchRange(T*, const RasterDataDescriptor* pDescriptor, const RasterDataDescriptor* pResultDescriptor,
+         const mta::AlgorithmThread::Range& range)
+      {
+         FactoryResource<DataRequest> pRequest;
+         pRequest->setInterleaveFormat(BIP);
+         pRequest->setRows(pDescriptor->getActiveRow(range.mFirst), pDescriptor->getActiveRow(range.mLast));
+         DataAccessor accessor = mInput.mpRaster->getDataAccessor(pRequest.release());
+
+         FactoryResource<DataRequest> pResultRequest;
+         pResultRequest->setInterleaveFormat(BIP);
+         pResultRequest->setRows(pResultDescriptor->getActiveRow(range.mFirst),
+            pResultDescriptor->getActiveRow(range.mLast));
+         pResultRequest->setWritable(true);
+         DataAccessor resultAccessor = mInput.mpResult->getDataAccessor(pResultRequest.release());
+         if (!accessor.isValid() || !resultAccessor.isValid())
+         {
+            return false;
+         }
+
+         const unsigned int numBands = mInput.mNumBands;
+         const unsigned int numSignatures = mInput.mNumSignatures;
+         const unsigned int numColumns = pDescriptor->getColumnCount();
+         vector<double> pixels(sPixelBlock * numBands);
+         vector<double> pixelSums(sPixelBlock);
+         vector<double> pixelSquares(sPixelBlock);
+         vector<double> accumulators(sPixelBlock * sSignatureBlock);
+         vector<unsigned int> columns;
+         columns.reserve(sPixelBlock);
+
+         const float maskedScore = getMaskedScore(mInput.mMethod);
+         for (int row = range.mFirst; row <= range.mLast; ++row)
+         {
+            accessor->toPixel(row, 0);
+            resultAccessor->toPixel(row, 0);
+            if (!accessor.isValid() || !resultAccessor.isValid())
+            {
+               return false;
+            }
+            const T* pRow = reinterpret_cast<const T*>(accessor->getColumn());
+            float* pResultRow = reinterpret_cast<float*>(resultAccessor->getColumn());
+
+            for (unsigned int firstColumn = 0; firstColumn < numColumns; firstColumn += sPixelBlock)
+            {
+               // Gather the selected pixels of the block and clear the scores of the others
+               const unsigned int lastColumn = min(firstColumn + sPixelBlock, numColumns);
+               columns.clear();
+               for (unsigned int column = firstColumn; column < lastColumn; ++column)
+               {
+                  if (mInput.mpMask != NULL &&
+                     !mInput.mpMask->getPixel(mInput.mOriginalColumns[column], mInput.mOriginalRows[row]))
+                  {
+                     fill(pResultRow + static_cast<size_t>(column) * numSignatures,
+                        pResultRow + static_cast<size_t>(column + 1) * numSignatures, maskedScore);
+                     continue;
+                  }
+
+                  const unsigned int pixel = static_cast<unsigned int>(columns.size());
+                  const T* pData = pRow + static_cast<size_t>(column) * numBands;
+                  double* pPixel = &pixels[pixel * numBands];
+                  for (unsigned int band = 0; band < numBands; ++band)
+                  {
+                     pPixel[band] = static_cast<double>(pData[band]);
+                  }
+                  computeSums(pPixel, numBands, pixelSums[pixel], pixelSquares[pixel]);
+                  columns.push_back(column);
+               }
+               if (columns.empty())
+               {
+                  continue;
+               }
+
+               for (unsigned int firstSignature = 0; firstSignature < numSignatures;
+                  firstSignature += sSignatureBlock)
+               {
+                  const unsigned int signatureCount = min(sSignatureBlock, numSignatures - firstSignature);
+                  accumulateBlock(static_cast<unsigned int>(columns.size()), firstSignature, signatureCount,
+                     &pixels.front(), &accumulators.front());
+                  storeBlock(columns, firstSignature, signatureCount, &pixelSums.front(), &pixelSquares.front(),
+                     &accumulators.front(), pResultRow);
+               }
+            }
+         }
+
+         return true;
+      }
+
+      // Accumulates the dot products, or the squared differences for Euclidean distance,
+      // of a block of pixels with a block of signatures. Every accumulator adds the bands
+      // in order, so the sums are the same as those in computeScore().
+      void accumulateBlock(unsigned int pixelCount, unsigned int firstSignature, unsigned int signatureCount,
+         const double* pPixels, double* pAccumulators) const
+      {
+         const unsigned int numBands = mInput.mNumBands;
+         const unsigned int numSignatures = mInput.mNumSignatures;
+         const bool distance = (mInput.mMethod == SpectralMatching::EUCLIDEAN_DISTANCE);
+         fill(pAccumulators, pAccumulators + pixelCount * signatureCount, 0.0);
+         for (unsigned int firstBand = 0; firstBand < numBands; firstBand += sBandBlock)
+         {
+            const unsigned int lastBand = min(firstBand + sBandBlock, numBands);
+            for (unsigned int pixel = 0; pixel < pixelCount; ++pixel)
+            {
+               const double* pPixel = pPixels + pixel * numBands;
+               double* const pAccumulator = pAccumulators + pixel * signatureCount;
+               for (unsigned int band = firstBand; band < lastBand; ++band)
+               {
+                  const double value = pPixel[band];
+                  const double* const pSignature =
+                     &mInput.mSignatures[static_cast<size_t>(band) * numSignatures + firstSignature];
+                  if (distance)
+                  {
+                     for (unsigned int signature = 0; signature < signatureCount; ++signature)
+                     {
+                        const double difference = value - pSignature[signature];
+                        pAccumulator[signature] += difference * difference;
+                     }
+                  }
+                  else
+                  {
+                     for (unsigned int signature = 0; signature < signatureCount; ++signature)
+                     {
+                        pAccumulator[signature] += value * pSignature[signature];
+                     }
+                  }
+               }
+            }
+         }
+      }
+
+      void storeBlock(const vector<unsigned int>& columns, unsigned int firstSignature, unsigned int signatureCount,
+         const double* pPixelSums, const double* pPixelSquares, const double* pAccumulators, float* pResultRow) const
+      {
+         const unsigned int numSignatures = mInput.mNumSignatures;
+         for (vector<unsigned int>::size_type pixel = 0; pixel < columns.size(); ++pixel)
+         {
+            const double* pAccumulator = pAccumulators + pixel * signatureCount;
+            float* pScores = pResultRow + static_cast<size_t>(columns[pixel]) * numSignatures + firstSignature;
+            for (unsigned int signature = 0; signature < signatureCount; ++signature)
+            {
+               const unsigned int index = firstSignature + signature;
+               double score = 0.0;
+               switch (mInput.mMethod)
+               {
+               case SpectralMatching::SPECTRAL_ANGLE:
+                  score = angleScore(pAccumulator[signature], pPixelSquares[pixel],
+                     mInput.mSignatureSquares[index]);
+                  break;
+               case SpectralMatching::EUCLIDEAN_DISTANCE:
+                  score = sqrt(pAccumulator[signature]);
+                  break;
+               case SpectralMatching::CORRELATION_COEFFICIENT:
+                  score = correlationScore(mInput.mNumBands, pAccumulator[signature], pPixelSums[pixel],
+                     pPixelSquares[pixel], mInput.mSignatureSums[index], mInput.mSignatureSquares[index]);
+                  break;
+               default:
+                  break;
+               }
+               pScores[signature] = static_cast<float>(score);
+            }
+         }
+      }
+
+      const MatchInput& mInput;
+      int mThreadCount;
+      int mRowCount;
+      bool mComplete;
+   };
+
+   struct MatchOutput
+   {
+      bool compileOverallResults(const vector<MatchThread*>& threads)
+      {
+         for (vector<MatchThread*>::const_iterator thread = threads.begin(); thread != threads.end(); ++thread)
+         {
+            if ((*thread)->isComplete() == false)
+            {
+               return false;
+            }
+         }
+         return true;
+      }
+   };
+}
+
+double SpectralMatching::computeScore(MatchMethod method, const double* pPixel, const double* pSignature,
+                                      unsigned int numValues)
+{
+   if (pPixel == NULL || pSignature == NULL)
+   {
+      return 0.0;
+   }
+
+   double pixelSum = 0.0;
+   double pixelSquares = 0.0;
+   double signatureSum = 0.0;
+   double signatureSquares = 0.0;
+   computeSums(pPixel, numValues, pixelSum, pixelSquares);
+   computeSums(pSignature, numValues, signatureSum, signatureSquares);
+
+   double accumulator = 0.0;
+   for (unsigned int i = 0; i < numValues; ++i)
+   {
+      if (method == EUCLIDEAN_DISTANCE)
+      {
+         const double difference = pPixel[i] - pSignature[i];
+         accumulator += difference * difference;
+      }
+      else
+      {
+         accumulator += pPixel[i] * pSignature[i];
+      }
+   }
+
+   switch (method)
+   {
+   case SPECTRAL_ANGLE:
+      return angleScore(accumulator, pixelSquares, signatureSquares);
+   case EUCLIDEAN_DISTANCE:
+      return sqrt(accumulator);
+   case CORRELATION_COEFFICIENT:
+      return correlationScore(numValues, accumulator, pixelSum, pixelSquares, signatureSum, signatureSquares);
+   default:
+      return 0.0;
+   }
+}
+
+RasterElement* SpectralMatching::matchLibrary(RasterElement* pRaster, SignatureLibrary* pLibrary, MatchMethod method,
+                                              const string& resultName, const BitMask* pMask, Progress* pProgress,
+                                              const bool* pAbortFlag, string& errorMessage)
+{
+   if (pRaster == NULL || pLibrary == NULL || method.isValid() == false)
+   {
+      errorMessage = "Invalid input to spectral matching.";
+      return NULL;
+   }
+
+   const RasterDataDescriptor* pDescriptor = dynamic_cast<const RasterDataDescriptor*>(pRaster->getDataDescriptor());
+   if (pDescriptor == NULL)
+   {
+      errorMessage = "The raster element has no data descriptor.";
+      return NULL;
+   }
+
+   EncodingType dataType = pDescriptor->getDataType();
+   if (dataType == INT4SCOMPLEX || dataType == FLT8COMPLEX)
+   {
+      errorMessage = "Spectral matching cannot be performed on complex data.";
+      return NULL;
+   }
+
+   // Resample the whole library once to the wavelengths of the raster element
+   FactoryResource<Wavelengths> pWavelengths;
+   pWavelengths->initializeFromDynamicObject(pRaster->getMetadata(), false);
+   const vector<double>& centerValues = pWavelengths->getCenterValues();
+   const unsigned int numBands = pDescriptor->getBandCount();
+   if (centerValues.size() != numBands)
+   {
+      errorMessage = "The raster element does not have a center wavelength for each band.";
+      return NULL;
+   }
+
+   if (pLibrary->resample(centerValues) == false || pLibrary->getOrdinateData() == NULL ||
+      pLibrary->getAbscissa().size() != numBands)
+   {
+      errorMessage = "The signature library could not be resampled to the wavelengths of the raster element.";
+      return NULL;
+   }
+
+   const unsigned int numSignatures = pLibrary->getNumSignatures();
+   if (numSignatures == 0)
+   {
+      errorMessage = "The signature library is empty.";
+      return NULL;
+   }
+
+   MatchInput input;
+   input.mpRaster = pRaster;
+   input.mpMask = pMask;
+   input.mpAbortFlag = pAbortFlag;
+   input.mMethod = method;
+   input.mNumBands = numBands;
+   input.mNumSignatures = numSignatures;
+   input.mSignatures.resize(static_cast<size_t>(numBands) * numSignatures);
+   input.mSignatureSums.resize(numSignatures);
+   input.mSignatureSquares.resize(numSignatures);
+   vector<string> signatureNames(numSignatures);
+   const double* pOrdinateData = pLibrary->getOrdinateData();
+   for (unsigned int signature = 0; signature < numSignatures; ++signature)
+   {
+      const double* pSignature = pOrdinateData + static_cast<size_t>(signature) * numBands;
+      for (unsigned int band = 0; band < numBands; ++band)
+      {
+         input.mSignatures[static_cast<size_t>(band) * numSignatures + signature] = pSignature[band];
+      }
+      computeSums(pSignature, numBands, input.mSignatureSums[signature], input.mSignatureSquares[signature]);
+      signatureNames[signature] = pLibrary->getSignatureName(signature);
+   }
+
+   if (pMask != NULL)
+   {
+      input.mOriginalRows.resize(pDescriptor->getRowCount());
+      for (unsigned int row = 0; row < pDescriptor->getRowCount(); ++row)
+      {
+         input.mOriginalRows[row] = static_cast<int>(pDescriptor->getActiveRow(row).getOriginalNumber());
+      }
+      input.mOriginalColumns.resize(pDescriptor->getColumnCount());
+      for (unsigned int column = 0; column < pDescriptor->getColumnCount(); ++column)
+      {
+         input.mOriginalColumns[column] =
+            static_cast<int>(pDescriptor->getActiveColumn(column).getOriginalNumber());
+      }
+   }
+
+   // The result has a band for every signature, so it can be much larger than the
+   // raster element and is only kept in memory when it fits comfortably
+   uint64_t resultSize = static_cast<uint64_t>(pDescriptor->getRowCount()) * pDescriptor->getColumnCount() *
+      numSignatures * sizeof(float);
+   Service<UtilityServices> pUtilities;
+   uint64_t maxMemory = pUtilities->getMaxMemoryBlockSize();
+#if PTR_SIZE > 4
+   maxMemory = min(maxMemory, static_cast<uint64_t>(pUtilities->getTotalPhysicalMemory() / 4));
+#endif
+   bool inMemory = (pDescriptor->getProcessingLocation() == IN_MEMORY && resultSize <= maxMemory);
+
+   ModelResource<RasterElement> pResult(RasterUtilities::createRasterElement(resultName,
+      pDescriptor->getRowCount(), pDescriptor->getColumnCount(), numSignatures, FLT4BYTES, BIP,
+      inMemory, pRaster));
+   if (pResult.get() == NULL)
+   {
+      errorMessage = "Unable to create the result raster element.";
+      return NULL;
+   }
+   pResult->getMetadata()->setAttributeByPath(BAND_NAMES_METADATA_PATH, signatureNames);
+   input.mpResult = pResult.get();
+
+   if (pMask != NULL)
+   {
+      RasterDataDescriptor* pResultDescriptor = dynamic_cast<RasterDataDescriptor*>(pResult->getDataDescriptor());
+      VERIFYRV(pResultDescriptor != NULL, NULL);
+
+      FactoryResource<BadValues> pBadValues;
+      pBadValues->addBadValue(method == CORRELATION_COEFFICIENT ? "-2" : "-1");
+      pResultDescriptor->setBadValues(pBadValues.get());
+   }
+
+   MatchOutput output;
+   mta::ProgressObjectReporter reporter("Matching signatures", pProgress);
+   mta::MultiThreadedAlgorithm<MatchInput, MatchOutput, MatchThread>
+      alg(mta::getNumRequiredThreads(pDescriptor->getRowCount()), input, output, &reporter);
+   if (alg.run() != mta::SUCCESS || (pAbortFlag != NULL && *pAbortFlag))
+   {
+      errorMessage = (pAbortFlag != NULL && *pAbortFlag) ? "Spectral matching was aborted." :
+         "Unable to access the raster data.";
+      return NULL;
+   }
+
+   return pResult.release();
+}
@@ -734,6 +734,7 @@ BEGIN_ENUM_MAPPING(PointCloudArrangement)
 ADD_ENUM_MAPPING(POINT_ARRAY, "Unsorted Array", "POINT_ARRAY")
 ADD_ENUM_MAPPING(POINT_KDTREE_XY_ARRAY, "Sorted KD Tree - XY - Array", "POINT_KDTREE_XY_ARRAY")
 ADD_ENUM_MAPPING(POINT_KDTREE_XYZ_ARRAY, "Sorted KD Tree - XYZ - Array", "POINT_KDTREE_XYZ_ARRAY")
+ADD_ENUM_MAPPING(POINT_OCTREE_ARRAY, "Sorted Octree - Array", "POINT_OCTREE_ARRAY")
 END_ENUM_MAPPING()
 
 BEGIN_ENUM_MAPPING(PositionType)
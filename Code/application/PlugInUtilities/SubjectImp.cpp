@@ -120,6 +120,28 @@ void SubjectImp::enableSignals(bool enabled)
    mpImpPrivate->enableSignals(enabled);
 }
 
+void SubjectImp::beginSignalBatch()
+{
+   Subject* pSubject = dynamic_cast<Subject*>(this);
+   if (pSubject == NULL)
+   {
+      return;
+   }
+
+   mpImpPrivate->beginBatch();
+}
+
+void SubjectImp::endSignalBatch()
+{
+   Subject* pSubject = dynamic_cast<Subject*>(this);
+   if (pSubject == NULL)
+   {
+      return;
+   }
+
+   mpImpPrivate->endBatch(*pSubject);
+}
+
 bool SubjectImp::signalsEnabled() const
 {
    const Subject* pSubject = dynamic_cast<const Subject*>(this);
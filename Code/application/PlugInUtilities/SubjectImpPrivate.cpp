@@ -18,12 +18,36 @@
 
 using namespace std;
 
-SubjectImpPrivate::SubjectImpPrivate() : mpSubject(NULL), mSignalsEnabled(true)
+namespace
+{
+   // FNV-1a, which reads each character once, so finding a signal costs one pass over its name
+   size_t hashSignal(const string& signal)
+   {
+      size_t hash = 2166136261U;
+      for (string::const_iterator iter = signal.begin(); iter != signal.end(); ++iter)
+      {
+         hash = (hash ^ static_cast<unsigned char>(*iter)) * 16777619U;
+      }
+
+      return hash;
+   }
+}
+
+SubjectImpPrivate::SubjectImpPrivate() :
+   mModifiedId(-1),
+   mpSubject(NULL),
+   mSignalsEnabled(true),
+   mBatchDepth(0),
+   mPendingModified(false)
 {
 }
 
 SubjectImpPrivate::~SubjectImpPrivate()
 {
+   for (vector<SignalSlots*>::iterator iter = mSignals.begin(); iter != mSignals.end(); ++iter)
+   {
+      delete *iter;
+   }
 }
 
 bool SubjectImpPrivate::attach(Subject& subject, const string& signal, const Slot& slot)
@@ -38,10 +62,10 @@ bool SubjectImpPrivate::attach(Subject& subject, const string& signal, const Slo
       mpSubject = &subject;
    }
 
-   MapType::iterator pSlotVec = mSlots.find(signal);
-   if (pSlotVec != mSlots.end())
+   int signalId = findSignal(signal);
+   if (signalId >= 0)
    {
-      list<SafeSlot>& slotVec = pSlotVec->second;
+      list<SafeSlot>& slotVec = mSignals[signalId]->mSlots;
       list<SafeSlot>::iterator pSlot;
       for (pSlot = slotVec.begin(); pSlot != slotVec.end(); ++pSlot)
       {
@@ -51,9 +75,14 @@ bool SubjectImpPrivate::attach(Subject& subject, const string& signal, const Slo
          }
       }
    }
+   else
+   {
+      signalId = addSignal(signal);
+   }
 
-   mSlots[signal].push_back(slot);
-   SafeSlot& mappedSlot(mSlots[signal].back());
+   list<SafeSlot>& slotVec = mSignals[signalId]->mSlots;
+   slotVec.push_back(slot);
+   SafeSlot& mappedSlot(slotVec.back());
    SlotInvalidator* pInvalidator = mappedSlot.getInvalidator();
    if (pInvalidator)
    {
@@ -76,10 +105,10 @@ bool SubjectImpPrivate::attach(Subject& subject, const string& signal, const Slo
 bool SubjectImpPrivate::detach(Subject& subject, const string& signal, const Slot& slot)
 {
    bool success = true;
-   MapType::iterator pSlotVec = mSlots.find(signal);
-   if (pSlotVec != mSlots.end())
+   int signalId = findSignal(signal);
+   if (signalId >= 0)
    {
-      list<SafeSlot>& slotVec = pSlotVec->second;
+      list<SafeSlot>& slotVec = mSignals[signalId]->mSlots;
       if (slot == SafeSlot())
       {
          bool shouldCallDetachMethod = true;
@@ -138,27 +167,27 @@ bool SubjectImpPrivate::detach(Subject& subject, const string& signal, const Slo
          }
       }
 
-      removeEmptySlots(signal, slotVec);
+      removeEmptySlots(*mSignals[signalId]);
    }
 
    return success;
 }
 
-class PopRecursion
+class NotifyDepth
 {
 public:
-   PopRecursion(vector<string>& recursions, const string& recursion) : mRecursions(recursions) 
+   NotifyDepth(unsigned int& depth) : mDepth(depth)
    {
-      mRecursions.push_back(recursion);
+      ++mDepth;
    }
-   ~PopRecursion() 
-   { 
-      mRecursions.pop_back();
+   ~NotifyDepth()
+   {
+      --mDepth;
    }
 private:
-   PopRecursion& operator=(const PopRecursion& rhs);
+   NotifyDepth& operator=(const NotifyDepth& rhs);
 
-   vector<string>& mRecursions;
+   unsigned int& mDepth;
 };
 
 void SubjectImpPrivate::notify(Subject& subject, const string& signal, const string& originalSignal,
@@ -169,62 +198,157 @@ void SubjectImpPrivate::notify(Subject& subject, const string& signal, const str
       return;
    }
 
-   bool signalIsDeleted = false;
-   bool deletedFlagSet = false; // only want to do the signal name check if necessary
-   if (!mSignalsEnabled)
+   // Compare the addresses first, since most notifications use the signal names of this module
+   const string& modifiedSignal = SIGNAL_NAME(Subject, Modified);
+   const string& deletedSignal = SIGNAL_NAME(Subject, Deleted);
+   const bool signalIsModified = (&signal == &modifiedSignal || signal == modifiedSignal);
+   const bool signalIsDeleted = (signalIsModified == false && (&signal == &deletedSignal || signal == deletedSignal));
+   if (!mSignalsEnabled && !signalIsDeleted)
    {
-      signalIsDeleted = (signal == SIGNAL_NAME(Subject, Deleted));
-      if (!signalIsDeleted)
+      return;
+   }
+
+   // Deleted is never deferred since the subject is about to go away
+   // Find the signal once, so it is dispatched by its id from here on
+   const int signalId = signalIsModified ? mModifiedId : findSignal(signal);
+   if (mBatchDepth > 0 && !signalIsDeleted)
+   {
+      // Every signal is followed by Modified, so a single Modified is sent when the batch ends
+      mPendingModified = true;
+      if (signalIsModified)
       {
          return;
       }
-      deletedFlagSet = true;
+
+      if (data.empty())
+      {
+         deferNotify(signalId, originalSignal);
+         return;
+      }
+
+      // The data may not outlive the batch, so send the signal now, after the signals deferred before it
+      notifyPendingSignals(subject);
+      notifySlots(subject, signalId, originalSignal, false, data);
+      return;
    }
 
    // notify slots attached to signal
-   MapType::iterator pSlotVec = mSlots.find(signal);
-   if (pSlotVec != mSlots.end())
+   bool success = notifySlots(subject, signalId, originalSignal, false, data);
+
+   if (success && !signalIsModified && !signalIsDeleted)
    {
-      list<SafeSlot>& slotVec = pSlotVec->second;
+      notifySlots(subject, mModifiedId, originalSignal, true, data);
+   }
+}
 
-      if (!slotVec.empty())
+bool SubjectImpPrivate::notifySlots(Subject& subject, int signalId, const string& originalSignal, bool asModified,
+                                    const boost::any& data)
+{
+   if (signalId < 0)
+   {
+      return true;
+   }
+
+   SignalSlots& signalSlots = *mSignals[signalId];
+   list<SafeSlot>& slotVec = signalSlots.mSlots;
+   if (!slotVec.empty())
+   {
+      NotifyDepth depth(signalSlots.mNotifyDepth);
+
+      // Keep a (unique) vector of Slots which have been notified to ensure that no Slot is notified more than once
+      // For efficiency, only check the vector when Slots have been added during notification
+      // This prevents an infinite loop when a Slot does a detach/attach to a signal
+      unsigned int slotNum = 0;
+      const unsigned int numOriginalSlots = slotVec.size();
+      vector<SafeSlot> notifiedSlots;
+      notifiedSlots.reserve(numOriginalSlots);
+      for (list<SafeSlot>::iterator pSlot = slotVec.begin(); pSlot != slotVec.end(); ++pSlot, ++slotNum)
       {
-         PopRecursion popper(mRecursions, signal);
-
-         // Keep a (unique) vector of Slots which have been notified to ensure that no Slot is notified more than once
-         // For efficiency, only check the vector when Slots have been added during notification
-         // This prevents an infinite loop when a Slot does a detach/attach to a signal
-         unsigned int slotNum = 0;
-         const unsigned int numOriginalSlots = slotVec.size();
-         vector<SafeSlot> notifiedSlots;
-         notifiedSlots.reserve(numOriginalSlots);
-         for (list<SafeSlot>::iterator pSlot = slotVec.begin(); pSlot != slotVec.end(); ++pSlot, ++slotNum)
+         try
          {
-            try
+            SafeSlot slotCopy = *pSlot;
+            if (slotNum < numOriginalSlots ||
+               find(notifiedSlots.begin(), notifiedSlots.end(), slotCopy) == notifiedSlots.end())
             {
-               SafeSlot slotCopy = *pSlot;
-               if (slotNum < numOriginalSlots ||
-                  find(notifiedSlots.begin(), notifiedSlots.end(), slotCopy) == notifiedSlots.end())
-               {
-                  notifiedSlots.push_back(slotCopy);
-                  slotCopy.update(subject, signal, data);
-               }
+               notifiedSlots.push_back(slotCopy);
+               slotCopy.update(subject, signalSlots.mSignal, data);
             }
-            catch (boost::bad_any_cast &exc)
+         }
+         catch (boost::bad_any_cast &exc)
+         {
+            string msg = "Bad cast while calling processing signal " + originalSignal;
+            if (asModified)
             {
-               string msg = "Bad cast while calling processing signal " + originalSignal + "\n" + exc.what();
-               VERIFYNRV_MSG(false, msg.c_str());
+               msg += " as " + SIGNAL_NAME(Subject, Modified);
             }
+            msg += "\n";
+            msg += exc.what();
+            VERIFYRV_MSG(false, false, msg.c_str());
          }
       }
+   }
+
+   removeEmptySlots(signalSlots);
+   return true;
+}
 
-      removeEmptySlots(signal, slotVec);
+void SubjectImpPrivate::deferNotify(int signalId, const string& originalSignal)
+{
+   // Slots attached after a signal was sent are not notified of it, so a signal without slots is not kept
+   if (signalId < 0)
+   {
+      return;
    }
 
-   if (signal != SIGNAL_NAME(Subject, Modified) && signal != SIGNAL_NAME(Subject, Deleted))
+   // A signal which repeats the previous one carries nothing new, so only one of them is sent
+   if (mPendingSignals.empty() == false && mPendingSignals.back().mSignalId == signalId &&
+      mPendingSignals.back().mOriginalSignal == originalSignal)
+   {
+      return;
+   }
+
+   PendingSignal pending;
+   pending.mSignalId = signalId;
+   pending.mOriginalSignal = originalSignal;
+   mPendingSignals.push_back(pending);
+}
+
+void SubjectImpPrivate::notifyPendingSignals(Subject& subject)
+{
+   // Slots may notify again, so take the pending signals before sending them
+   vector<PendingSignal> pendingSignals;
+   pendingSignals.swap(mPendingSignals);
+   for (vector<PendingSignal>::const_iterator iter = pendingSignals.begin(); iter != pendingSignals.end(); ++iter)
    {
-      string effectiveSignal = originalSignal + " as " + SIGNAL_NAME(Subject, Modified);
-      notify(subject, SIGNAL_NAME(Subject, Modified), effectiveSignal, data);
+      notifySlots(subject, iter->mSignalId, iter->mOriginalSignal, false, boost::any());
+   }
+}
+
+void SubjectImpPrivate::beginBatch()
+{
+   ++mBatchDepth;
+}
+
+void SubjectImpPrivate::endBatch(Subject& subject)
+{
+   if (mBatchDepth == 0 || --mBatchDepth > 0)
+   {
+      return;
+   }
+
+   bool pendingModified = mPendingModified;
+   mPendingModified = false;
+   if (!mSignalsEnabled)
+   {
+      mPendingSignals.clear();
+      return;
+   }
+
+   notifyPendingSignals(subject);
+   if (pendingModified)
+   {
+      // The Modified signal stands for every change in the batch, so it is sent without data
+      notifySlots(subject, mModifiedId, SIGNAL_NAME(Subject, Modified), false, boost::any());
    }
 }
 
@@ -237,12 +361,12 @@ const list<SafeSlot>& SubjectImpPrivate::getSlots(const string& signal)
       return emptyList;
    }
 
-   MapType::iterator pSlotVec = mSlots.find(signal);
-   if (pSlotVec != mSlots.end())
+   int signalId = findSignal(signal);
+   if (signalId >= 0)
    {
-      list<SafeSlot>& slotVec = pSlotVec->second;
-      removeEmptySlots(signal, slotVec);
-      return slotVec;
+      SignalSlots& signalSlots = *mSignals[signalId];
+      removeEmptySlots(signalSlots);
+      return signalSlots.mSlots;
    }
    else
    {
@@ -250,10 +374,39 @@ const list<SafeSlot>& SubjectImpPrivate::getSlots(const string& signal)
    }
 }
 
-void SubjectImpPrivate::removeEmptySlots(const string& recursion, list<SafeSlot>& slotVec)
+int SubjectImpPrivate::findSignal(const string& signal) const
+{
+   // A subject has few distinct signals, so comparing their hashes is faster than a tree lookup.  The name is
+   // only compared for the signal whose hash matches.
+   const size_t hash = hashSignal(signal);
+   for (vector<SignalSlots*>::size_type i = 0; i < mSignals.size(); ++i)
+   {
+      if (mSignals[i]->mHash == hash && mSignals[i]->mSignal == signal)
+      {
+         return static_cast<int>(i);
+      }
+   }
+
+   return -1;
+}
+
+int SubjectImpPrivate::addSignal(const string& signal)
+{
+   int signalId = static_cast<int>(mSignals.size());
+   mSignals.push_back(new SignalSlots(signal, hashSignal(signal)));
+   if (signal == SIGNAL_NAME(Subject, Modified))
+   {
+      mModifiedId = signalId;
+   }
+
+   return signalId;
+}
+
+void SubjectImpPrivate::removeEmptySlots(SignalSlots& signalSlots)
 {
-   if (count(mRecursions.begin(), mRecursions.end(), recursion) == 0)
+   if (signalSlots.mNotifyDepth == 0)
    {
+      list<SafeSlot>& slotVec = signalSlots.mSlots;
       for (list<SafeSlot>::iterator pSlot = slotVec.begin(); pSlot != slotVec.end(); )
       {
          if (pSlot->isValid() == false)
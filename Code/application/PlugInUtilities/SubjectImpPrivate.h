@@ -14,7 +14,6 @@
 
 #include <boost/any.hpp>
 #include <list>
-#include <map>
 #include <string>
 #include <vector>
 
@@ -24,8 +23,6 @@ class Subject;
 
 class SubjectImpPrivate
 {
-   typedef std::map<std::string,std::list<SafeSlot> > MapType;
-
 public:
    SubjectImpPrivate();
    virtual ~SubjectImpPrivate();
@@ -34,15 +31,55 @@ public:
    void notify(Subject& subject, const std::string& signal, const std::string& originalSignal,
       const boost::any& data = boost::any());
    const std::list<SafeSlot>& getSlots(const std::string& signal);
-   void removeEmptySlots(const std::string& recursion, std::list<SafeSlot>& slotVec);
    void enableSignals(bool enabled);
    bool signalsEnabled() const;
+   virtual void beginBatch();
+   virtual void endBatch(Subject& subject);
 
 private:
-   MapType mSlots;
-   std::vector<std::string> mRecursions;
+   // The slots attached to one signal. The index of a signal in mSignals is its id for this subject.
+   // The name is interned when the first slot is attached, and its hash is compared when the signal is looked up.
+   struct SignalSlots
+   {
+      SignalSlots(const std::string& signal, size_t hash) :
+         mSignal(signal),
+         mHash(hash),
+         mNotifyDepth(0)
+      {
+      }
+
+      std::string mSignal;
+      size_t mHash;
+      std::list<SafeSlot> mSlots;
+      unsigned int mNotifyDepth;
+   };
+
+   // Only signals without data are deferred, so a pending signal never refers to an object destroyed in the batch
+   struct PendingSignal
+   {
+      int mSignalId;
+      std::string mOriginalSignal;
+   };
+
+   int findSignal(const std::string& signal) const;
+   int addSignal(const std::string& signal);
+   bool notifySlots(Subject& subject, int signalId, const std::string& originalSignal, bool asModified,
+      const boost::any& data);
+   void deferNotify(int signalId, const std::string& originalSignal);
+   void notifyPendingSignals(Subject& subject);
+   void removeEmptySlots(SignalSlots& signalSlots);
+
+   std::vector<SignalSlots*> mSignals;
+   int mModifiedId;
    Subject* mpSubject;
    bool mSignalsEnabled;
+
+   unsigned int mBatchDepth;
+   std::vector<PendingSignal> mPendingSignals;
+   bool mPendingModified;
+
+   SubjectImpPrivate(const SubjectImpPrivate& rhs);
+   SubjectImpPrivate& operator=(const SubjectImpPrivate& rhs);
 };
 
 #endif
@@ -0,0 +1,784 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2007 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#include "BadValues.h"
+#include "ColorMap.h"
+#include "ConfigurationSettings.h"
+#include "DataAccessor.h"
+#include "DataAccessorImpl.h"
+#include "DataRequest.h"
+#include "DimensionDescriptor.h"
+#include "Filename.h"
+#include "ModelServices.h"
+#include "ObjectResource.h"
+#include "RasterDataDescriptor.h"
+#include "RasterElement.h"
+#include "SessionManager.h"
+#include "Slot.h"
+#include "Statistics.h"
+#include "TileHandler.h"
+
+#include <QtCore/QBuffer>
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QStringList>
+#include <QtCore/QUrl>
+#include <QtGui/QImage>
+#include <QtGui/QImageWriter>
+
+#include <algorithm>
+#include <vector>
+
+using namespace mta;
+
+namespace
+{
+   // The default number of bytes of encoded tiles to cache
+   const size_t sDefaultCacheSize = 64 * 1024 * 1024;
+
+   // The largest window which can be requested in a single tile
+   const int sMaxOutputSize = 4096;
+
+   // The largest source window which can be sampled for a single tile
+   const int64_t sMaxWindowSize = 65536;
+
+   // The deepest zoom level which can be requested, which keeps the tile span within 64 bits
+   const int sMaxZoom = 30;
+
+   /**
+    * A parsed tile request.
+    */
+   struct TileRequest
+   {
+      TileRequest() :
+         mIsXyz(false),
+         mZoom(0),
+         mTileX(0),
+         mTileY(0),
+         mX(0),
+         mY(0),
+         mWidth(0),
+         mHeight(0),
+         mOutWidth(0),
+         mOutHeight(0),
+         mLowerPercentile(2.0),
+         mUpperPercentile(98.0),
+         mHasRange(false),
+         mLower(0.0),
+         mUpper(0.0)
+      {}
+
+      std::string mElementId;
+      QString mFormat;
+      bool mIsXyz;
+      int mZoom;
+      int mTileX;
+      int mTileY;
+      int64_t mX;
+      int64_t mY;
+      int64_t mWidth;
+      int64_t mHeight;
+      int mOutWidth;
+      int mOutHeight;
+      std::vector<unsigned int> mBands;
+      double mLowerPercentile;
+      double mUpperPercentile;
+      bool mHasRange;
+      double mLower;
+      double mUpper;
+      QString mColorMap;
+   };
+
+   QString getFormValue(const FormValueMap& form, const std::string& name)
+   {
+      FormValueMap::const_iterator it = form.find(name);
+      if (it == form.end())
+      {
+         return QString();
+      }
+
+      return QString::fromStdString(it->second.m_sBody);
+   }
+
+   bool getIntFormValue(const FormValueMap& form, const std::string& name, int& value)
+   {
+      QString str = getFormValue(form, name);
+      if (str.isEmpty())
+      {
+         return true;
+      }
+
+      bool ok = false;
+      value = str.toInt(&ok);
+      return ok;
+   }
+
+   bool getInt64FormValue(const FormValueMap& form, const std::string& name, int64_t& value)
+   {
+      QString str = getFormValue(form, name);
+      if (str.isEmpty())
+      {
+         return true;
+      }
+
+      bool ok = false;
+      value = str.toLongLong(&ok);
+      return ok;
+   }
+
+   bool getPairFormValue(const FormValueMap& form, const std::string& name, double& first, double& second,
+      bool& present)
+   {
+      QString str = getFormValue(form, name);
+      present = !str.isEmpty();
+      if (!present)
+      {
+         return true;
+      }
+
+      QStringList values = str.split(",");
+      if (values.size() != 2)
+      {
+         return false;
+      }
+
+      bool firstOk = false;
+      bool secondOk = false;
+      first = values[0].toDouble(&firstOk);
+      second = values[1].toDouble(&secondOk);
+      return firstOk && secondOk;
+   }
+
+   bool parseRequest(const QString& uri, const FormValueMap& form, TileRequest& request)
+   {
+      QStringList path = uri.split("/", QString::SkipEmptyParts);
+      if (path.size() != 2 && path.size() != 4)
+      {
+         return false;
+      }
+
+      QString last = path.back();
+      int extension = last.lastIndexOf(".");
+      if (extension < 0)
+      {
+         return false;
+      }
+
+      request.mFormat = last.mid(extension + 1).toUpper();
+      if (request.mFormat == "JPG")
+      {
+         request.mFormat = "JPEG";
+      }
+      if (request.mFormat != "PNG" && request.mFormat != "JPEG" && request.mFormat != "RAW")
+      {
+         return false;
+      }
+
+      path.back() = last.left(extension);
+      request.mElementId = QUrl::fromPercentEncoding(path[0].toAscii()).toStdString();
+      if (path.size() == 4)
+      {
+         bool zoomOk = false;
+         bool xOk = false;
+         bool yOk = false;
+         request.mIsXyz = true;
+         request.mZoom = path[1].toInt(&zoomOk);
+         request.mTileX = path[2].toInt(&xOk);
+         request.mTileY = path[3].toInt(&yOk);
+         if (!zoomOk || !xOk || !yOk || request.mZoom < 0 || request.mZoom > sMaxZoom ||
+            request.mTileX < 0 || request.mTileY < 0)
+         {
+            return false;
+         }
+      }
+      else
+      {
+         if (path[1] != "window" ||
+            !getInt64FormValue(form, "x", request.mX) || !getInt64FormValue(form, "y", request.mY) ||
+            !getInt64FormValue(form, "width", request.mWidth) || !getInt64FormValue(form, "height", request.mHeight))
+         {
+            return false;
+         }
+
+         if (request.mWidth <= 0 || request.mHeight <= 0 ||
+            request.mWidth > sMaxWindowSize || request.mHeight > sMaxWindowSize)
+         {
+            return false;
+         }
+
+         request.mOutWidth = static_cast<int>(request.mWidth);
+         request.mOutHeight = static_cast<int>(request.mHeight);
+         if (!getIntFormValue(form, "outwidth", request.mOutWidth) ||
+            !getIntFormValue(form, "outheight", request.mOutHeight))
+         {
+            return false;
+         }
+
+         if (request.mX < 0 || request.mY < 0 || request.mOutWidth <= 0 || request.mOutHeight <= 0 ||
+            request.mOutWidth > sMaxOutputSize || request.mOutHeight > sMaxOutputSize)
+         {
+            return false;
+         }
+      }
+
+      QString bands = getFormValue(form, "bands");
+      if (bands.isEmpty())
+      {
+         request.mBands.push_back(0);
+      }
+      else
+      {
+         QStringList bandList = bands.split(",");
+         for (QStringList::const_iterator it = bandList.begin(); it != bandList.end(); ++it)
+         {
+            bool ok = false;
+            request.mBands.push_back(it->toUInt(&ok));
+            if (!ok)
+            {
+               return false;
+            }
+         }
+      }
+
+      if (request.mFormat != "RAW" && request.mBands.size() != 1 && request.mBands.size() != 3)
+      {
+         return false;
+      }
+
+      bool present = false;
+      if (!getPairFormValue(form, "stretch", request.mLowerPercentile, request.mUpperPercentile, present) ||
+         request.mLowerPercentile < 0.0 || request.mUpperPercentile > 100.0 ||
+         request.mLowerPercentile > request.mUpperPercentile)
+      {
+         return false;
+      }
+
+      if (!getPairFormValue(form, "range", request.mLower, request.mUpper, request.mHasRange))
+      {
+         return false;
+      }
+
+      // Color map names are looked up in the support files directory, so do not allow paths
+      request.mColorMap = getFormValue(form, "colormap");
+      if (request.mColorMap.contains("/") || request.mColorMap.contains("\\") || request.mColorMap.contains(".."))
+      {
+         return false;
+      }
+
+      return true;
+   }
+
+   QString getCacheKey(const TileRequest& request)
+   {
+      QStringList bands;
+      for (std::vector<unsigned int>::const_iterator it = request.mBands.begin(); it != request.mBands.end(); ++it)
+      {
+         bands.append(QString::number(*it));
+      }
+
+      QString key = QString::fromStdString(request.mElementId) + "|" + request.mFormat + "|" + bands.join(",") + "|";
+      if (request.mIsXyz)
+      {
+         key += QString("%1/%2/%3").arg(request.mZoom).arg(request.mTileX).arg(request.mTileY);
+      }
+      else
+      {
+         key += QString("%1,%2,%3,%4,%5,%6").arg(static_cast<qlonglong>(request.mX))
+            .arg(static_cast<qlonglong>(request.mY)).arg(static_cast<qlonglong>(request.mWidth))
+            .arg(static_cast<qlonglong>(request.mHeight)).arg(request.mOutWidth).arg(request.mOutHeight);
+      }
+
+      if (request.mFormat != "RAW")
+      {
+         if (request.mHasRange)
+         {
+            key += QString("|range%1,%2").arg(request.mLower).arg(request.mUpper);
+         }
+         else
+         {
+            key += QString("|stretch%1,%2").arg(request.mLowerPercentile).arg(request.mUpperPercentile);
+         }
+         key += "|" + request.mColorMap;
+      }
+
+      return key;
+   }
+
+   MuHttpServer::Response notFound()
+   {
+      MuHttpServer::Response r;
+      r.mCode = HTTPRESPONSECODE_404_NOTFOUND;
+      r.mHeaders["content-type"] = "text/html";
+      r.mBody = "<html><body><h1>Not found</h1>The requested tile can not be located or the request is "
+                "not valid.</body></html>";
+      return r;
+   }
+}
+
+/**
+ * Reads the data values for a tile on the main application thread.
+ */
+class TileHandler::ReadTileTask : public MainThreadTask
+{
+public:
+   ReadTileTask(TileHandler& handler, TileRequest& request) :
+      mHandler(handler),
+      mRequest(request),
+      mSuccess(false),
+      mGeneration(0)
+   {
+   }
+
+   void run()
+   {
+      RasterElement* pElement =
+         dynamic_cast<RasterElement*>(Service<SessionManager>()->getSessionItem(mRequest.mElementId));
+      if (pElement == NULL)
+      {
+         return;
+      }
+
+      const RasterDataDescriptor* pDescriptor =
+         dynamic_cast<const RasterDataDescriptor*>(pElement->getDataDescriptor());
+      if (pDescriptor == NULL)
+      {
+         return;
+      }
+
+      int64_t rows = pDescriptor->getRowCount();
+      int64_t columns = pDescriptor->getColumnCount();
+      for (std::vector<unsigned int>::const_iterator it = mRequest.mBands.begin(); it != mRequest.mBands.end(); ++it)
+      {
+         if (*it >= pDescriptor->getBandCount())
+         {
+            return;
+         }
+      }
+
+      if (mRequest.mIsXyz)
+      {
+         // Find the zoom level at which the raster fits in one tile
+         int maxZoom = 0;
+         while ((static_cast<int64_t>(TILE_SIZE) << maxZoom) < std::max(rows, columns))
+         {
+            ++maxZoom;
+         }
+         if (mRequest.mZoom > maxZoom)
+         {
+            return;
+         }
+
+         // Reject tiles outside the raster before computing their position, so the position can not overflow
+         int64_t tileSpan = static_cast<int64_t>(TILE_SIZE) << (maxZoom - mRequest.mZoom);
+         if (mRequest.mTileX >= (columns + tileSpan - 1) / tileSpan ||
+            mRequest.mTileY >= (rows + tileSpan - 1) / tileSpan)
+         {
+            return;
+         }
+
+         mRequest.mX = mRequest.mTileX * tileSpan;
+         mRequest.mY = mRequest.mTileY * tileSpan;
+         mRequest.mWidth = tileSpan;
+         mRequest.mHeight = tileSpan;
+         mRequest.mOutWidth = TILE_SIZE;
+         mRequest.mOutHeight = TILE_SIZE;
+      }
+
+      if (mRequest.mX >= columns || mRequest.mY >= rows)
+      {
+         return;
+      }
+
+      mGeneration = mHandler.getGeneration(mRequest.mElementId);
+      mHandler.attachElement(pElement);
+
+      // Sample the window at the center of each output pixel
+      std::vector<int64_t> sourceRows(mRequest.mOutHeight);
+      for (int row = 0; row < mRequest.mOutHeight; ++row)
+      {
+         sourceRows[row] =
+            mRequest.mY + static_cast<int64_t>((row + 0.5) * mRequest.mHeight / mRequest.mOutHeight);
+      }
+
+      std::vector<int64_t> sourceColumns(mRequest.mOutWidth);
+      for (int column = 0; column < mRequest.mOutWidth; ++column)
+      {
+         sourceColumns[column] =
+            mRequest.mX + static_cast<int64_t>((column + 0.5) * mRequest.mWidth / mRequest.mOutWidth);
+      }
+
+      unsigned int lastRow = static_cast<unsigned int>(std::min(rows, mRequest.mY + mRequest.mHeight) - 1);
+      unsigned int lastColumn = static_cast<unsigned int>(std::min(columns, mRequest.mX + mRequest.mWidth) - 1);
+      unsigned int bandCount = mRequest.mBands.size();
+      size_t pixelCount = static_cast<size_t>(mRequest.mOutWidth) * mRequest.mOutHeight;
+      mValues.assign(pixelCount * bandCount, 0.0);
+      mValid.assign(pixelCount, 1);
+
+      EncodingType encoding = pDescriptor->getDataType();
+      const BadValues* pBadValues = pDescriptor->getBadValues();
+      for (unsigned int band = 0; band < bandCount; ++band)
+      {
+         DimensionDescriptor bandDescriptor = pDescriptor->getActiveBand(mRequest.mBands[band]);
+         FactoryResource<DataRequest> pRequest;
+         unsigned int firstColumn = static_cast<unsigned int>(mRequest.mX);
+         pRequest->setRows(pDescriptor->getActiveRow(static_cast<unsigned int>(mRequest.mY)),
+            pDescriptor->getActiveRow(lastRow), 1);
+         pRequest->setColumns(pDescriptor->getActiveColumn(firstColumn), pDescriptor->getActiveColumn(lastColumn));
+         pRequest->setBands(bandDescriptor, bandDescriptor);
+         pRequest->setInterleaveFormat(BSQ);
+         DataAccessor accessor = pElement->getDataAccessor(pRequest.release());
+         if (!accessor.isValid())
+         {
+            return;
+         }
+
+         // Read each sampled row once and index its columns directly, since the single band BSQ request
+         // stores the columns of a row contiguously
+         for (int row = 0; row < mRequest.mOutHeight; ++row)
+         {
+            const void* pRow = NULL;
+            if (sourceRows[row] < rows)
+            {
+               accessor->toPixel(static_cast<int>(sourceRows[row]), static_cast<int>(firstColumn));
+               if (!accessor.isValid())
+               {
+                  return;
+               }
+               pRow = accessor->getColumn();
+            }
+
+            for (int column = 0; column < mRequest.mOutWidth; ++column)
+            {
+               size_t pixel = static_cast<size_t>(row) * mRequest.mOutWidth + column;
+               if (pRow == NULL || sourceColumns[column] >= columns)
+               {
+                  mValid[pixel] = 0;
+                  continue;
+               }
+
+               double value = ModelServices::getDataValue(encoding, pRow,
+                  static_cast<int>(sourceColumns[column] - firstColumn));
+               if (pBadValues != NULL && pBadValues->isBadValue(value))
+               {
+                  mValid[pixel] = 0;
+                  continue;
+               }
+               mValues[pixel * bandCount + band] = value;
+            }
+         }
+
+         if (mRequest.mFormat != "RAW")
+         {
+            double lower = mRequest.mLower;
+            double upper = mRequest.mUpper;
+            if (!mRequest.mHasRange)
+            {
+               Statistics* pStatistics = pElement->getStatistics(bandDescriptor);
+               if (pStatistics == NULL)
+               {
+                  return;
+               }
+
+               const double* pPercentiles = pStatistics->getPercentiles();
+               if (pPercentiles != NULL)
+               {
+                  lower = pPercentiles[static_cast<int>(mRequest.mLowerPercentile * 10.0 + 0.5)];
+                  upper = pPercentiles[static_cast<int>(mRequest.mUpperPercentile * 10.0 + 0.5)];
+               }
+               else
+               {
+                  lower = pStatistics->getMin();
+                  upper = pStatistics->getMax();
+               }
+            }
+            mLower.push_back(lower);
+            mUpper.push_back(upper);
+         }
+      }
+
+      if (!mRequest.mColorMap.isEmpty() && bandCount == 1)
+      {
+         const Filename* pSupportFiles = ConfigurationSettings::getSettingSupportFilesPath();
+         if (pSupportFiles == NULL)
+         {
+            return;
+         }
+
+         std::string mapDir = pSupportFiles->getFullPathAndName() + SLASH + "ColorTables" + SLASH;
+         std::string name = mRequest.mColorMap.toStdString();
+         ColorMap colorMap;
+         if (!colorMap.loadFromFile(mapDir + name + ".clu") && !colorMap.loadFromFile(mapDir + name + ".cgr"))
+         {
+            return;
+         }
+         mColorTable = colorMap.getTable();
+      }
+
+      mSuccess = true;
+   }
+
+   TileHandler& mHandler;
+   TileRequest& mRequest;
+   bool mSuccess;
+   unsigned int mGeneration;
+   std::vector<double> mValues;
+   std::vector<unsigned char> mValid;
+   std::vector<double> mLower;
+   std::vector<double> mUpper;
+   std::vector<ColorType> mColorTable;
+
+private:
+   ReadTileTask& operator=(const ReadTileTask& rhs);
+};
+
+TileHandler::TileHandler(QObject* pParent) :
+   MuHttpServer(0, pParent),
+   mCacheBytes(0),
+   mMaxCacheBytes(sDefaultCacheSize)
+{}
+
+TileHandler::TileHandler(int port, QObject* pParent) :
+   MuHttpServer(port, pParent),
+   mCacheBytes(0),
+   mMaxCacheBytes(sDefaultCacheSize)
+{}
+
+TileHandler::~TileHandler()
+{
+   for (std::map<RasterElement*, std::string>::iterator it = mAttachedElements.begin();
+      it != mAttachedElements.end(); ++it)
+   {
+      it->first->detach(SIGNAL_NAME(RasterElement, DataModified), Slot(this, &TileHandler::elementModified));
+      it->first->detach(SIGNAL_NAME(Subject, Deleted), Slot(this, &TileHandler::elementDeleted));
+   }
+}
+
+void TileHandler::setMaximumCacheSize(size_t bytes)
+{
+   MutexLock lock(mCacheMutex);
+   mMaxCacheBytes = bytes;
+   trimCache();
+}
+
+size_t TileHandler::getMaximumCacheSize() const
+{
+   MutexLock lock(mCacheMutex);
+   return mMaxCacheBytes;
+}
+
+bool TileHandler::isThreadSafeRequest(RequestMethod method, const QString& uri, const QString& contentType,
+                                      const QString& body) const
+{
+   return method == REQUESTMETHOD_GET;
+}
+
+MuHttpServer::Response TileHandler::getRequest(const QString& uri, const QString& contentType,
+                                               const QString& body, const FormValueMap& form)
+{
+   TileRequest request;
+   if (!parseRequest(uri, form, request))
+   {
+      return notFound();
+   }
+
+   Response r;
+   QString key = getCacheKey(request);
+   if (getCachedTile(key, r))
+   {
+      return r;
+   }
+
+   ReadTileTask task(*this, request);
+   if (!runOnMainThread(task) || !task.mSuccess)
+   {
+      return notFound();
+   }
+
+   // Stretch and encode the tile on this network thread
+   unsigned int bandCount = request.mBands.size();
+   if (request.mFormat == "RAW")
+   {
+      r.mOctets = QByteArray(reinterpret_cast<const char*>(&task.mValues.front()),
+         static_cast<int>(task.mValues.size() * sizeof(double)));
+      r.mHeaders["content-type"] = "application/octet-stream";
+      r.mHeaders["x-columns"] = QString::number(request.mOutWidth);
+      r.mHeaders["x-rows"] = QString::number(request.mOutHeight);
+      r.mHeaders["x-bands"] = QString::number(bandCount);
+   }
+   else
+   {
+      QImage image(request.mOutWidth, request.mOutHeight, QImage::Format_ARGB32);
+      for (int row = 0; row < request.mOutHeight; ++row)
+      {
+         QRgb* pScanLine = reinterpret_cast<QRgb*>(image.scanLine(row));
+         for (int column = 0; column < request.mOutWidth; ++column)
+         {
+            size_t pixel = static_cast<size_t>(row) * request.mOutWidth + column;
+            if (task.mValid[pixel] == 0)
+            {
+               pScanLine[column] = qRgba(0, 0, 0, 0);
+               continue;
+            }
+
+            int levels[3] = {0, 0, 0};
+            for (unsigned int band = 0; band < bandCount; ++band)
+            {
+               double range = task.mUpper[band] - task.mLower[band];
+               double value = (range == 0.0) ? 0.0 : (task.mValues[pixel * bandCount + band] - task.mLower[band]) / range;
+               levels[band] = static_cast<int>(std::min(std::max(value, 0.0), 1.0) * 255.0 + 0.5);
+            }
+
+            if (bandCount == 3)
+            {
+               pScanLine[column] = qRgb(levels[0], levels[1], levels[2]);
+            }
+            else if (!task.mColorTable.empty())
+            {
+               const ColorType& color = task.mColorTable[levels[0] * (task.mColorTable.size() - 1) / 255];
+               pScanLine[column] = qRgba(color.mRed, color.mGreen, color.mBlue, color.mAlpha);
+            }
+            else
+            {
+               pScanLine[column] = qRgb(levels[0], levels[0], levels[0]);
+            }
+         }
+      }
+
+      QBuffer buffer(&r.mOctets);
+      buffer.open(QIODevice::WriteOnly);
+      QImageWriter writer(&buffer, request.mFormat.toAscii());
+      if (!writer.write(image))
+      {
+         return notFound();
+      }
+      r.mHeaders["content-type"] = QString("image/%1").arg(request.mFormat.toLower());
+   }
+
+   r.mCode = HTTPRESPONSECODE_200_OK;
+   r.mEncoding = Response::OCTET;
+   r.mHeaders["etag"] = QString("\"%1\"").arg(
+      QString(QCryptographicHash::hash(r.mOctets, QCryptographicHash::Md5).toHex()));
+   cacheTile(key, request.mElementId, task.mGeneration, r);
+   return r;
+}
+
+bool TileHandler::getCachedTile(const QString& key, Response& response)
+{
+   MutexLock lock(mCacheMutex);
+   std::map<QString, CacheEntry>::iterator it = mCache.find(key);
+   if (it == mCache.end())
+   {
+      return false;
+   }
+
+   // Move the tile to the front of the least recently used list
+   mLru.splice(mLru.begin(), mLru, it->second.mLruPosition);
+
+   response.mCode = HTTPRESPONSECODE_200_OK;
+   response.mEncoding = Response::OCTET;
+   response.mOctets = it->second.mData;
+   response.mHeaders["content-type"] = it->second.mContentType;
+   response.mHeaders["etag"] = it->second.mETag;
+   return true;
+}
+
+void TileHandler::cacheTile(const QString& key, const std::string& elementId, unsigned int generation,
+                            const Response& response)
+{
+   MutexLock lock(mCacheMutex);
+
+   // Do not cache the tile if the element was modified while the tile was being produced
+   std::map<std::string, unsigned int>::const_iterator generationIt = mGenerations.find(elementId);
+   unsigned int currentGeneration = (generationIt == mGenerations.end()) ? 0 : generationIt->second;
+   if (currentGeneration != generation || static_cast<size_t>(response.mOctets.size()) > mMaxCacheBytes ||
+      mCache.find(key) != mCache.end())
+   {
+      return;
+   }
+
+   CacheEntry& entry = mCache[key];
+   entry.mData = response.mOctets;
+   entry.mContentType = response.mHeaders.value("content-type");
+   entry.mETag = response.mHeaders.value("etag");
+   entry.mElementId = elementId;
+   entry.mLruPosition = mLru.insert(mLru.begin(), key);
+   mCacheBytes += entry.mData.size();
+   trimCache();
+}
+
+void TileHandler::trimCache()
+{
+   while (mCacheBytes > mMaxCacheBytes && !mLru.empty())
+   {
+      std::map<QString, CacheEntry>::iterator it = mCache.find(mLru.back());
+      mCacheBytes -= it->second.mData.size();
+      mCache.erase(it);
+      mLru.pop_back();
+   }
+}
+
+unsigned int TileHandler::getGeneration(const std::string& elementId) const
+{
+   MutexLock lock(mCacheMutex);
+   std::map<std::string, unsigned int>::const_iterator it = mGenerations.find(elementId);
+   return (it == mGenerations.end()) ? 0 : it->second;
+}
+
+void TileHandler::attachElement(RasterElement* pElement)
+{
+   if (pElement == NULL || mAttachedElements.find(pElement) != mAttachedElements.end())
+   {
+      return;
+   }
+
+   pElement->attach(SIGNAL_NAME(RasterElement, DataModified), Slot(this, &TileHandler::elementModified));
+   pElement->attach(SIGNAL_NAME(Subject, Deleted), Slot(this, &TileHandler::elementDeleted));
+   mAttachedElements[pElement] = pElement->getId();
+}
+
+void TileHandler::elementModified(Subject& subject, const std::string& signal, const boost::any& value)
+{
+   std::map<RasterElement*, std::string>::iterator it =
+      mAttachedElements.find(dynamic_cast<RasterElement*>(&subject));
+   if (it != mAttachedElements.end())
+   {
+      invalidateElement(it->second);
+   }
+}
+
+void TileHandler::elementDeleted(Subject& subject, const std::string& signal, const boost::any& value)
+{
+   std::map<RasterElement*, std::string>::iterator it =
+      mAttachedElements.find(dynamic_cast<RasterElement*>(&subject));
+   if (it != mAttachedElements.end())
+   {
+      invalidateElement(it->second);
+      mAttachedElements.erase(it);
+   }
+}
+
+void TileHandler::invalidateElement(const std::string& elementId)
+{
+   MutexLock lock(mCacheMutex);
+   ++mGenerations[elementId];
+
+   std::map<QString, CacheEntry>::iterator it = mCache.begin();
+   while (it != mCache.end())
+   {
+      if (it->second.mElementId == elementId)
+      {
+         mCacheBytes -= it->second.mData.size();
+         mLru.erase(it->second.mLruPosition);
+         mCache.erase(it++);
+      }
+      else
+      {
+         ++it;
+      }
+   }
+}
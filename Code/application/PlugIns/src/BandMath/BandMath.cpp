@@ -19,6 +19,7 @@
 #include "PlugInArg.h"
 #include "PlugInArgList.h"
 #include "PlugInRegistration.h"
+#include "PlugInResource.h"
 #include "Progress.h"
 #include "RasterDataDescriptor.h"
 #include "RasterFileDescriptor.h"
@@ -32,6 +33,7 @@
 #include <boost/bind.hpp>
 
 REGISTER_PLUGIN_BASIC(OpticksBandMath, BandMath);
+REGISTER_PLUGIN_BASIC(OpticksBandMath, BandMathPager);
 
 using namespace std;
 
@@ -238,6 +240,10 @@ bool BandMath::getInputSpecification(PlugInArgList*& pArgList)
       VERIFY(pArgList->addArg<bool>("Overlay Results", mbAsLayerOnExistingView, "Flag for whether "
          "the results should be added to the original view or a new view.  A new view is created "
          "by default if results are displayed."));
+      VERIFY(pArgList->addArg<bool>("Compute On Demand", mbOnDemand, "Flag for whether the results "
+         "should be computed as they are read instead of being stored.  The results are read-only and "
+         "are destroyed with the source element.  Expressions which use other elements are always "
+         "computed immediately."));
    }
 
    return true;
@@ -284,6 +290,7 @@ bool BandMath::initialize()
    mbGuiIsNeeded = false;
    mbDegrees = false;
    mbAsLayerOnExistingView = false;
+   mbOnDemand = false;
 
    // Other necessary things
    mstrProgressString = "";
@@ -375,6 +382,24 @@ bool BandMath::execute(PlugInArgList* pInputArgList, PlugInArgList* pOutputArgLi
          mbCubeMath = true;
       }
    }
+
+   // Cube math reads several elements, so it is always computed immediately
+   mbOnDemand = mbOnDemand && !mbCubeMath;
+   if (mbOnDemand)
+   {
+      vector<char> expression(mExpression.begin(), mExpression.end());
+      expression.push_back('\0');
+      DataNode* pTree = buildExpressionTree(&expression[0], mCubeBands, 0, mbDegrees, errorVal);
+      if (pTree == NULL)
+      {
+         mstrProgressString = errorVal;
+         meGabbiness = ERRORS;
+         displayErrorMessage();
+         return false;
+      }
+      delete pTree;
+   }
+
    if (!createReturnValue(mExpression))
    {
       mstrProgressString = "Could not allocate space for results.";
@@ -382,6 +407,7 @@ bool BandMath::execute(PlugInArgList* pInputArgList, PlugInArgList* pOutputArgLi
       displayErrorMessage();
       return false;
    }
+   if (!mbOnDemand)
    {
       StepResource pResultStep("Compute result", "app", "CDCC12AC-32DD-4831-BC6B-225538C92053");
       mpStep = pResultStep.get();
@@ -656,6 +682,9 @@ bool BandMath::parse(PlugInArgList* pArgInList, PlugInArgList* pArgOutList)
 
       // Overlay results
       VERIFY(pArgInList->getPlugInArgValue("Overlay Results", mbAsLayerOnExistingView));
+
+      // Compute on demand
+      VERIFY(pArgInList->getPlugInArgValue("Compute On Demand", mbOnDemand));
    }
 
    return true;
@@ -708,8 +737,22 @@ bool BandMath::createReturnValue(string partialResultsName)
    {
       pParent = mpCube;
    }
-   RasterElement* pRaster = RasterUtilities::createRasterElement(mResultsName, origRows.size(),
-      origColumns.size(), bandCount, FLT4BYTES, BIP, pOrigDescriptor->getProcessingLocation() == IN_MEMORY, pParent);
+   RasterElement* pRaster = NULL;
+   if (mbOnDemand)
+   {
+      // The result is computed from the cube as it is read, so it must not outlive the cube
+      ExecutableResource pPager("Band Math Pager");
+      pPager->getInArgList().setPlugInArgValue("Source Element", mpCube);
+      pPager->getInArgList().setPlugInArgValue("Expression", &mExpression);
+      pPager->getInArgList().setPlugInArgValue("Degrees", &mbDegrees);
+      pRaster = ComputedPager::createElement(mResultsName, mpCube, origRows.size(), origColumns.size(), bandCount,
+         FLT4BYTES, pPager);
+   }
+   else
+   {
+      pRaster = RasterUtilities::createRasterElement(mResultsName, origRows.size(), origColumns.size(), bandCount,
+         FLT4BYTES, BIP, pOrigDescriptor->getProcessingLocation() == IN_MEMORY, pParent);
+   }
 
    if (pRaster == NULL)
    {
@@ -831,3 +874,107 @@ bool BandMath::createReturnGuiElement()
    }
    return bSuccess;
 }
+
+BandMathPager::BandMathPager() :
+   mpSource(NULL),
+   mpTree(NULL)
+{
+   setName("Band Math Pager");
+   setCopyright(APP_COPYRIGHT);
+   setCreator("Ball Aerospace & Technologies Corp.");
+   setDescription("Evaluates a band math expression as the result is read");
+   setDescriptorId("{5f0d7a3e-91c4-4b2e-8d6f-2a9e0c1b7354}");
+   setVersion(APP_VERSION_NUMBER);
+   setProductionStatus(APP_IS_PRODUCTION_RELEASE);
+   setShortDescription("Band math pager");
+}
+
+BandMathPager::~BandMathPager()
+{
+   delete mpTree;
+}
+
+bool BandMathPager::getInputSpecification(PlugInArgList*& pArgList)
+{
+   if (!ComputedPager::getInputSpecification(pArgList))
+   {
+      return false;
+   }
+   VERIFY(pArgList->addArg<RasterElement>("Source Element", NULL, "Element on which band math will be performed."));
+   VERIFY(pArgList->addArg<string>("Expression", string(), "Expression for band math to evaluate."));
+   VERIFY(pArgList->addArg<bool>("Degrees", false, "True causes band math to use degrees; false uses radians."));
+   return true;
+}
+
+bool BandMathPager::parseInputArgs(PlugInArgList* pInputArgList)
+{
+   if (!ComputedPager::parseInputArgs(pInputArgList))
+   {
+      return false;
+   }
+
+   mpSource = pInputArgList->getPlugInArgValue<RasterElement>("Source Element");
+   string expression;
+   bool degrees = false;
+   if (mpSource == NULL || getBandCount() != 1 ||
+      !pInputArgList->getPlugInArgValue("Expression", expression) ||
+      !pInputArgList->getPlugInArgValue("Degrees", degrees))
+   {
+      return false;
+   }
+
+   const RasterDataDescriptor* pDescriptor = dynamic_cast<const RasterDataDescriptor*>(mpSource->getDataDescriptor());
+   VERIFY(pDescriptor != NULL);
+
+   vector<char> mutableExpression(expression.begin(), expression.end());
+   mutableExpression.push_back('\0');
+   char errorVal[80];
+   delete mpTree;
+   mpTree = buildExpressionTree(&mutableExpression[0], pDescriptor->getBandCount(), 0, degrees, errorVal);
+   return mpTree != NULL;
+}
+
+bool BandMathPager::computeRows(unsigned int startRow, unsigned int rowCount, unsigned int band, char* pData)
+{
+   VERIFY(mpSource != NULL && mpTree != NULL && band == 0);
+   const RasterDataDescriptor* pDescriptor = static_cast<const RasterDataDescriptor*>(mpSource->getDataDescriptor());
+
+   FactoryResource<DataRequest> pRequest;
+   pRequest->setInterleaveFormat(BIP);
+   pRequest->setRows(pDescriptor->getActiveRow(startRow), pDescriptor->getActiveRow(startRow + rowCount - 1));
+   DataAccessor accessor = mpSource->getDataAccessor(pRequest.release());
+   if (!accessor.isValid())
+   {
+      return false;
+   }
+
+   // Values which cannot be computed are set to 0 as in an immediate evaluation
+   vector<void*> values(1);
+   const vector<EncodingType> types(1, pDescriptor->getDataType());
+   float* pValue = reinterpret_cast<float*>(pData);
+   const unsigned int columnCount = getColumnCount();
+   for (unsigned int row = 0; row < rowCount; ++row)
+   {
+      for (unsigned int column = 0; column < columnCount; ++column)
+      {
+         VERIFY(accessor.isValid());
+         values[0] = accessor->getColumn();
+         try
+         {
+            *pValue = static_cast<float>(mpTree->eval(values, 0, types));
+            if (RasterUtilities::isBad(*pValue))
+            {
+               *pValue = 0.0f;
+            }
+         }
+         catch (...)
+         {
+            *pValue = 0.0f;
+         }
+         ++pValue;
+         accessor->nextColumn();
+      }
+      accessor->nextRow();
+   }
+   return true;
+}
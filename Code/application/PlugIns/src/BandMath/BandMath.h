@@ -21,6 +21,7 @@
 
 #include "AlgorithmShell.h"
 #include "ApplicationServices.h"
+#include "ComputedPager.h"
 #include "DataDescriptor.h"
 #include "DesktopServices.h"
 #include "ModelServices.h"
@@ -63,6 +64,7 @@ private:
    bool mbDegrees;
    bool mbCubeMath;
    bool mbAsLayerOnExistingView;
+   bool mbOnDemand;
 
    std::vector<RasterElement*> mCubesList;
 
@@ -94,4 +96,26 @@ private:
    bool createReturnGuiElement();
 };
 
+/**
+ * Evaluates a band math expression a block of rows at a time as the result is read.
+ */
+class BandMathPager : public ComputedPager
+{
+public:
+   BandMathPager();
+   ~BandMathPager();
+
+   bool getInputSpecification(PlugInArgList*& pArgList);
+   bool parseInputArgs(PlugInArgList* pInputArgList);
+
+protected:
+   bool computeRows(unsigned int startRow, unsigned int rowCount, unsigned int band, char* pData);
+
+private:
+   BandMathPager& operator=(const BandMathPager& rhs);
+
+   const RasterElement* mpSource;
+   DataNode* mpTree;
+};
+
 #endif
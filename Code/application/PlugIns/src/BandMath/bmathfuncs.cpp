@@ -934,9 +934,7 @@ int OpParams(char* ops, char* val)
    return retval;
 }
 
-int eval(Progress* pProgress, vector<DataAccessor>& dataCubes, const vector<EncodingType>& types,
-         int rows, int columns, int bands, char* exp, DataAccessor returnAccessor, bool degrees, char* error,
-         bool cubeMath, bool interactive)
+DataNode* buildExpressionTree(char* exp, int bands, int cubes, bool degrees, char* error)
 {
    int stringSize = strlen(exp)*2;
    if (stringSize < 80)
@@ -946,11 +944,12 @@ int eval(Progress* pProgress, vector<DataAccessor>& dataCubes, const vector<Enco
 
    char* pString = new char[stringSize];
 
-   int iError = ParseExp(exp, bands, pString, stringSize, dataCubes.size());
+   int iError = ParseExp(exp, bands, pString, stringSize, cubes);
    if (iError)
    {
       strcpy(error, pString);
-      return -1;
+      delete [] pString;
+      return NULL;
    }
 
    bool lastCharSep = false;
@@ -1000,13 +999,29 @@ int eval(Progress* pProgress, vector<DataAccessor>& dataCubes, const vector<Enco
    DataNode* pTree = BuildTreeFromInfix(ops, pString, pItems, itemsCount, degrees);
    delete [] pItems;
    delete [] pString;
-   pItems = NULL;
-   pString = NULL;
+   if (pTree == NULL)
+   {
+      strcpy(error, "The band math expression could not be parsed.");
+   }
+
+   return pTree;
+}
+
+int eval(Progress* pProgress, vector<DataAccessor>& dataCubes, const vector<EncodingType>& types,
+         int rows, int columns, int bands, char* exp, DataAccessor returnAccessor, bool degrees, char* error,
+         bool cubeMath, bool interactive)
+{
+   DataNode* pTree = buildExpressionTree(exp, bands, dataCubes.size(), degrees, error);
+   if (pTree == NULL)
+   {
+      return -1;
+   }
 
    bool dispDZMes = true;
    bool dispUDMes = true;
    bool dispCMMes = true;
 
+   int i;
    int j;
 
    srand(time(NULL));
@@ -97,6 +97,10 @@ private:
 
 DataNode* BuildTreeFromInfix(char* ops, char* exp, int* offsetTable, int NumElems, bool degrees);
 
+// Parses the expression and returns its evaluation tree, which the caller deletes.
+// Returns NULL and copies a message to error if the expression is not valid.
+DataNode* buildExpressionTree(char* exp, int bands, int cubes, bool degrees, char* error);
+
 int eval(Progress* pProgress, std::vector<DataAccessor>& dataCubes,
          const std::vector<EncodingType>& types, int rows, int columns,
          int bands, char* exp, DataAccessor returnAccessor, bool degrees,
@@ -22,6 +22,7 @@
 #include "PlugInArgList.h"
 #include "PlugInManagerServices.h"
 #include "PlugInRegistration.h"
+#include "PlugInResource.h"
 #include "RasterDataDescriptor.h"
 #include "RasterElement.h"
 #include "RasterLayer.h"
@@ -42,9 +43,18 @@ namespace
    {
       *pPixel = static_cast<T>(value);
    }
+
+   template<typename T>
+   void assignRow(T* pRow, const std::vector<double>& values, double offset)
+   {
+      for (std::vector<double>::const_iterator value = values.begin(); value != values.end(); ++value)
+      {
+         *pRow++ = static_cast<T>(*value + offset);
+      }
+   }
 }
 
-ConvolutionFilterShell::ConvolutionFilterShell() : mpAoi(NULL)
+ConvolutionFilterShell::ConvolutionFilterShell() : mpAoi(NULL), mOnDemand(false)
 {
    setSubtype("Convolution Filter");
    setAbortSupported(true);
@@ -68,6 +78,9 @@ bool ConvolutionFilterShell::getInputSpecification(PlugInArgList*& pInArgList)
       "Defaults to the name of the input raster element with ' Convolved' appended."));
    VERIFY(pInArgList->addArg<double>("Offset", 0.0, "Optional offset value to add to each output pixel"));
    VERIFY(pInArgList->addArg<bool>("Force Float", false, "Optional flag to force output image to be 8-byte floating point."));
+   VERIFY(pInArgList->addArg<bool>("Compute On Demand", false, "If true, the convolution is computed as the new "
+      "raster element is read instead of being stored. The new raster element is read-only and is destroyed with "
+      "the data element. An AOI cannot be used."));
    return true;
 }
 
@@ -126,10 +139,16 @@ bool ConvolutionFilterShell::execute(PlugInArgList* pInArgList, PlugInArgList* p
    }
    mProgress.report("Begin convolution matrix execution.", 0, NORMAL);
 
-   ModelResource<RasterElement> pResult(RasterUtilities::createRasterElement(
-      mResultName, iterChecker.getNumSelectedRows(), iterChecker.getNumSelectedColumns(),
-      mInput.mBands.size(), resultType, mInput.mpDescriptor->getInterleaveFormat(),
-      mInput.mpDescriptor->getProcessingLocation() == IN_MEMORY));
+   ModelResource<RasterElement> pResult(mOnDemand ?
+      createComputedResult(iterChecker.getNumSelectedRows(), iterChecker.getNumSelectedColumns(), resultType) :
+      RasterUtilities::createRasterElement(mResultName, iterChecker.getNumSelectedRows(),
+      iterChecker.getNumSelectedColumns(), mInput.mBands.size(), resultType,
+      mInput.mpDescriptor->getInterleaveFormat(), mInput.mpDescriptor->getProcessingLocation() == IN_MEMORY));
+   if (pResult.get() == NULL)
+   {
+      mProgress.report("Unable to create result data set.", 0, ERRORS, true);
+      return false;
+   }
    pResult->copyClassification(mInput.mpRaster);
    pResult->getMetadata()->merge(mInput.mpDescriptor->getMetadata()); //copy original metadata
    //chip metadata by bands
@@ -160,7 +179,10 @@ bool ConvolutionFilterShell::execute(PlugInArgList* pInArgList, PlugInArgList* p
                                ConvolutionFilterThreadOutput,
                                ConvolutionFilterThread>
           alg(mta::getNumRequiredThreads(iterChecker.getNumSelectedRows()), mInput, outputData, &reporter);
-   switch(alg.run())
+
+   // A computed result is convolved by its pager as it is read
+   mta::Result result = mOnDemand ? mta::Result(mta::SUCCESS) : alg.run();
+   switch(result)
    {
    case mta::SUCCESS:
       if (!isAborted())
@@ -172,6 +194,7 @@ bool ConvolutionFilterShell::execute(PlugInArgList* pInArgList, PlugInArgList* p
             return false;
          }
          pOutArgList->setPlugInArgValue("View", pView);
+         pOutArgList->setPlugInArgValue("Data Element", pResult.get());
 
          pResult.release();
          mProgress.upALevel();
@@ -274,9 +297,35 @@ bool ConvolutionFilterShell::extractInputArgs(PlugInArgList* pInArgList)
       mProgress.report("Error getting float output.", 0, ERRORS, true);
       return false;
    }
+
+   if (!pInArgList->getPlugInArgValue("Compute On Demand", mOnDemand))
+   {
+      mProgress.report("Error getting compute on demand.", 0, ERRORS, true);
+      return false;
+   }
+
+   if (mOnDemand && mpAoi != NULL)
+   {
+      mProgress.report("An AOI cannot be used when computing on demand.", 0, ERRORS, true);
+      return false;
+   }
    return true;
 }
 
+RasterElement* ConvolutionFilterShell::createComputedResult(unsigned int rows, unsigned int columns,
+                                                            EncodingType resultType)
+{
+   // The result is a child of the data it reads so that it is destroyed first
+   RasterElement* pSource = const_cast<RasterElement*>(mInput.mpRaster);
+   ExecutableResource pPager("Convolution Pager");
+   pPager->getInArgList().setPlugInArgValue("Source Element", pSource);
+   pPager->getInArgList().setPlugInArgValueLoose("Kernel", &mInput.mKernel);
+   pPager->getInArgList().setPlugInArgValue("Band Numbers", &mInput.mBands);
+   pPager->getInArgList().setPlugInArgValue("Offset", &mInput.mOffset);
+   return ComputedPager::createElement(mResultName, pSource, rows, columns, mInput.mBands.size(), resultType,
+      pPager);
+}
+
 SpatialDataView* ConvolutionFilterShell::displayResult()
 {
    VERIFY(mInput.mpResult != NULL);
@@ -505,3 +554,141 @@ bool GenericConvolution::populateKernel()
    // already did this in extractInputArgs()
    return true;
 }
+
+REGISTER_PLUGIN_BASIC(OpticksConvolutionFilter, ConvolutionPager);
+
+ConvolutionPager::ConvolutionPager() :
+   mpSource(NULL),
+   mOffset(0.0)
+{
+   setName("Convolution Pager");
+   setCopyright(APP_COPYRIGHT);
+   setCreator("Ball Aerospace & Technologies Corp.");
+   setDescription("Computes a convolution as the result is read");
+   setDescriptorId("{2b7e8f0c-5d3a-4f69-9e1b-6c0a7d45e812}");
+   setVersion(APP_VERSION_NUMBER);
+   setProductionStatus(APP_IS_PRODUCTION_RELEASE);
+   setShortDescription("Convolution pager");
+}
+
+ConvolutionPager::~ConvolutionPager()
+{
+}
+
+bool ConvolutionPager::getInputSpecification(PlugInArgList*& pArgList)
+{
+   if (!ComputedPager::getInputSpecification(pArgList))
+   {
+      return false;
+   }
+   VERIFY(pArgList->addArg<RasterElement>("Source Element", NULL, "The data element to be convolved."));
+   VERIFY(pArgList->addArg<std::vector<unsigned int> >("Band Numbers", "The band numbers to convolve, one for "
+      "each band of the paged element."));
+   VERIFY(pArgList->addArg<double>("Offset", 0.0, "Offset value to add to each output pixel."));
+   PlugInArg* pArg = Service<PlugInManagerServices>()->getPlugInArg();
+   VERIFY(pArg != NULL);
+   pArg->setName("Kernel");
+   pArg->setDescription("The convolution kernel as an ossim NEWMAT::Matrix.");
+   pArg->setType("NEWMAT::Matrix");
+   pArgList->addArg(*pArg);
+   return true;
+}
+
+bool ConvolutionPager::parseInputArgs(PlugInArgList* pInputArgList)
+{
+   if (!ComputedPager::parseInputArgs(pInputArgList))
+   {
+      return false;
+   }
+   mpSource = pInputArgList->getPlugInArgValue<RasterElement>("Source Element");
+   NEWMAT::Matrix* pKernel = pInputArgList->getPlugInArgValueUnsafe<NEWMAT::Matrix>("Kernel");
+   if (mpSource == NULL || pKernel == NULL || pKernel->Storage() <= 0 ||
+      !pInputArgList->getPlugInArgValue("Band Numbers", mBands) ||
+      !pInputArgList->getPlugInArgValue("Offset", mOffset))
+   {
+      return false;
+   }
+   mKernel = *pKernel;
+   return mBands.size() == static_cast<unsigned int>(getBandCount());
+}
+
+bool ConvolutionPager::computeRows(unsigned int startRow, unsigned int rowCount, unsigned int band, char* pData)
+{
+   VERIFY(mpSource != NULL && band < mBands.size());
+   const RasterDataDescriptor* pDescriptor = static_cast<const RasterDataDescriptor*>(mpSource->getDataDescriptor());
+   const int maxRowNum = static_cast<int>(pDescriptor->getRowCount()) - 1;
+   const int columnCount = static_cast<int>(pDescriptor->getColumnCount());
+   const int yshift = (mKernel.Nrows() - 1) / 2;
+   const int xshift = (mKernel.Ncols() - 1) / 2;
+
+   // Read the source rows covered by the kernel for this block
+   const int firstSrcRow = std::max(0, static_cast<int>(startRow) - yshift);
+   const int lastSrcRow = std::min(maxRowNum, static_cast<int>(startRow + rowCount) - 1 + mKernel.Nrows() - 1 - yshift);
+   FactoryResource<DataRequest> pRequest;
+   pRequest->setInterleaveFormat(BSQ);
+   pRequest->setRows(pDescriptor->getActiveRow(firstSrcRow), pDescriptor->getActiveRow(lastSrcRow));
+   pRequest->setBands(pDescriptor->getActiveBand(mBands[band]), pDescriptor->getActiveBand(mBands[band]));
+   DataAccessor accessor = mpSource->getDataAccessor(pRequest.release());
+   if (!accessor.isValid())
+   {
+      return false;
+   }
+
+   std::vector<double> srcValues;
+   switchOnComplexEncoding(pDescriptor->getDataType(), readRows, NULL, accessor,
+      lastSrcRow - firstSrcRow + 1, columnCount, srcValues);
+   if (srcValues.size() != static_cast<size_t>(lastSrcRow - firstSrcRow + 1) * columnCount)
+   {
+      return false;
+   }
+
+   const RasterDataDescriptor* pResultDescriptor = static_cast<const RasterDataDescriptor*>(
+      getRasterElement()->getDataDescriptor());
+   const EncodingType resultType = pResultDescriptor->getDataType();
+   const size_t rowBytes = static_cast<size_t>(getColumnCount()) * getBytesPerBand();
+   std::vector<double> rowValues(columnCount);
+   for (unsigned int row = 0; row < rowCount; ++row)
+   {
+      const int rowIndex = static_cast<int>(startRow + row);
+      for (int col = 0; col < columnCount; ++col)
+      {
+         double accum = 0.0;
+         for (int kernelrow = 0; kernelrow < mKernel.Nrows(); ++kernelrow)
+         {
+            const int realRow = std::min(std::max(0, rowIndex - yshift + kernelrow), maxRowNum);
+            const double* pSrcRow = &srcValues[static_cast<size_t>(realRow - firstSrcRow) * columnCount];
+            for (int kernelcol = 0; kernelcol < mKernel.Ncols(); ++kernelcol)
+            {
+               const int realCol = std::min(std::max(0, col - xshift + kernelcol), columnCount - 1);
+               accum += mKernel(kernelrow + 1, kernelcol + 1) * pSrcRow[realCol] / mKernel.Storage();
+            }
+         }
+         rowValues[col] = accum;
+      }
+      switchOnEncoding(resultType, assignRow, pData + row * rowBytes, rowValues, mOffset);
+   }
+   return true;
+}
+
+template<typename T>
+void ConvolutionPager::readRows(T*, DataAccessor& accessor, unsigned int rowCount, unsigned int columnCount,
+                                std::vector<double>& values)
+{
+   Service<ModelServices> pModel;
+   values.reserve(static_cast<size_t>(rowCount) * columnCount);
+   for (unsigned int row = 0; row < rowCount; ++row)
+   {
+      for (unsigned int col = 0; col < columnCount; ++col)
+      {
+         if (!accessor.isValid())
+         {
+            return;
+         }
+         double value = 0.0;
+         pModel->getDataValue<T>(reinterpret_cast<T*>(accessor->getColumn()), COMPLEX_MAGNITUDE, 0, value);
+         values.push_back(value);
+         accessor->nextColumn();
+      }
+      accessor->nextRow();
+   }
+}
@@ -11,6 +11,7 @@
 #define CONVOLUTIONFILTERSHELL_H
 
 #include "AlgorithmShell.h"
+#include "ComputedPager.h"
 #include "MultiThreadedAlgorithm.h"
 #include "ProgressTracker.h"
 
@@ -18,6 +19,7 @@
 
 class AoiElement;
 class BitMaskIterator;
+class DataAccessor;
 class RasterDataDescriptor;
 class RasterElement;
 
@@ -42,6 +44,7 @@ protected:
     */
    virtual bool populateKernel() = 0;
    virtual SpatialDataView* displayResult();
+   RasterElement* createComputedResult(unsigned int rows, unsigned int columns, EncodingType resultType);
 
    struct ConvolutionFilterThreadInput
    {
@@ -68,6 +71,7 @@ protected:
    ConvolutionFilterThreadInput mInput;
    AoiElement* mpAoi;
    std::string mResultName;
+   bool mOnDemand;
 
    class ConvolutionFilterThread : public mta::AlgorithmThread
    {
@@ -104,4 +108,31 @@ protected:
    virtual bool populateKernel();
 };
 
+/**
+ * Computes a convolution a block of rows at a time as the result is read.
+ */
+class ConvolutionPager : public ComputedPager
+{
+public:
+   ConvolutionPager();
+   virtual ~ConvolutionPager();
+
+   virtual bool getInputSpecification(PlugInArgList*& pArgList);
+   virtual bool parseInputArgs(PlugInArgList* pInputArgList);
+
+protected:
+   virtual bool computeRows(unsigned int startRow, unsigned int rowCount, unsigned int band, char* pData);
+
+private:
+   ConvolutionPager& operator=(const ConvolutionPager& rhs);
+
+   template<typename T> void readRows(T*, DataAccessor& accessor, unsigned int rowCount, unsigned int columnCount,
+      std::vector<double>& values);
+
+   const RasterElement* mpSource;
+   std::vector<unsigned int> mBands;
+   NEWMAT::Matrix mKernel;
+   double mOffset;
+};
+
 #endif
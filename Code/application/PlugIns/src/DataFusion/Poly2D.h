@@ -13,9 +13,11 @@
 #include "AppAssert.h"
 #include "DataAccessor.h"
 #include "DataAccessorImpl.h"
+#include "DataFusionTools.h"
 #include "FusionException.h"
 #include "DimensionDescriptor.h"
 #include "ModelServices.h"
+#include "MultiThreadedAlgorithm.h"
 #include "ProgressTracker.h"
 #include "RasterDataDescriptor.h"
 #include "RasterElement.h"
@@ -23,8 +25,348 @@
 #include "Statistics.h"
 #include "Vector.h"
 
+#include <algorithm>
+#include <limits>
 #include <math.h>
+#include <string.h>
 #include <string>
+#include <vector>
+
+namespace Poly2DDetail
+{
+   struct WarpInput
+   {
+      WarpInput() :
+         mpSource(NULL),
+         mpResult(NULL),
+         mpKX(NULL),
+         mpKY(NULL),
+         mXOffset(0),
+         mYOffset(0)
+      {}
+
+      const RasterElement* mpSource;
+      RasterElement* mpResult;
+      const Vector<double>* mpKX;
+      const Vector<double>* mpKY;
+      int mXOffset;        // zoomFactor * xoff
+      int mYOffset;        // zoomFactor * yoff
+   };
+
+   /**
+    * Warps a range of rows of the result.
+    *
+    * The rows are processed in tiles. The warp is bilinear, so the source
+    * pixels used by a tile lie within the bounding box of the tile's corners.
+    * Only that footprint of the source is read for each tile.
+    */
+   template<class T>
+   class WarpThread : public mta::AlgorithmThread
+   {
+   public:
+      WarpThread(const WarpInput& input, int threadCount, int threadIndex, mta::ThreadReporter& reporter) :
+         mta::AlgorithmThread(threadIndex, reporter),
+         mInput(input),
+         mRange(getThreadRange(threadCount, static_cast<int>(static_cast<const RasterDataDescriptor*>(
+            input.mpResult->getDataDescriptor())->getRowCount()))),
+         mBadValues(0),
+         mComplete(false)
+      {}
+
+      void run()
+      {
+         static const int sMaxTileRows = 64;
+         static const size_t sMaxFootprint = 4 * 1024 * 1024;
+
+         const RasterDataDescriptor* pSrcDesc =
+            dynamic_cast<const RasterDataDescriptor*>(mInput.mpSource->getDataDescriptor());
+         const RasterDataDescriptor* pDestDesc =
+            dynamic_cast<const RasterDataDescriptor*>(mInput.mpResult->getDataDescriptor());
+         if (pSrcDesc == NULL || pDestDesc == NULL)
+         {
+            return;
+         }
+         if (mRange.mFirst > mRange.mLast)
+         {
+            mComplete = true;
+            return;
+         }
+
+         const int dimX = static_cast<int>(pDestDesc->getColumnCount());
+         FactoryResource<DataRequest> pDestRequest;
+         pDestRequest->setRows(pDestDesc->getActiveRow(mRange.mFirst), pDestDesc->getActiveRow(mRange.mLast));
+         pDestRequest->setWritable(true);
+         DataAccessor destAccessor = mInput.mpResult->getDataAccessor(pDestRequest.release());
+         if (!destAccessor.isValid())
+         {
+            return;
+         }
+
+         int oldPercent = -1;
+         int firstRow = mRange.mFirst;
+         int tileRows = sMaxTileRows;
+         while (firstRow <= mRange.mLast)
+         {
+            if (DataFusionTools::getAbortFlag())
+            {
+               return;
+            }
+
+            int lastRow = std::min(firstRow + tileRows - 1, mRange.mLast);
+            Footprint footprint = getFootprint(firstRow, lastRow, dimX, pSrcDesc);
+            if (footprint.getSize() > sMaxFootprint && lastRow > firstRow)
+            {
+               tileRows = std::max(1, (lastRow - firstRow + 1) / 2);
+               continue;
+            }
+
+            if (!readFootprint(footprint, pSrcDesc))
+            {
+               return;
+            }
+
+            for (int row = firstRow; row <= lastRow; ++row)
+            {
+               destAccessor->toPixel(row, 0);
+               if (!destAccessor.isValid())
+               {
+                  return;
+               }
+               warpRow(row, dimX, footprint, pSrcDesc, reinterpret_cast<T*>(destAccessor->getRow()));
+
+               int percent = mRange.computePercent(row);
+               if (percent != oldPercent)
+               {
+                  getReporter().reportProgress(getThreadIndex(), percent);
+                  oldPercent = percent;
+               }
+            }
+
+            firstRow = lastRow + 1;
+            tileRows = sMaxTileRows;
+         }
+
+         mComplete = true;
+      }
+
+      double getBadValues() const
+      {
+         return mBadValues;
+      }
+
+      bool isComplete() const
+      {
+         return mComplete;
+      }
+
+   private:
+      WarpThread& operator=(const WarpThread& rhs);
+
+      struct Footprint
+      {
+         int mFirstRow;
+         int mLastRow;
+         int mFirstColumn;
+         int mLastColumn;
+
+         bool isEmpty() const
+         {
+            return mFirstRow > mLastRow || mFirstColumn > mLastColumn;
+         }
+
+         size_t getSize() const
+         {
+            return isEmpty() ? 0 : static_cast<size_t>(mLastRow - mFirstRow + 1) * (mLastColumn - mFirstColumn + 1);
+         }
+      };
+
+      void getCoefficients(int row, double& xStart, double& xSlope, double& yStart, double& ySlope) const
+      {
+         // Along a row of the result, the warp is linear in the column
+         const Vector<double>& KX = *mInput.mpKX;
+         const Vector<double>& KY = *mInput.mpKY;
+         const double YNEW = row + mInput.mYOffset;
+         xStart = KX[0] + KX[1] * YNEW;
+         xSlope = KX[2] + KX[3] * YNEW;
+         yStart = KY[0] + KY[1] * YNEW;
+         ySlope = KY[2] + KY[3] * YNEW;
+      }
+
+      Footprint getFootprint(int firstRow, int lastRow, int dimX, const RasterDataDescriptor* pSrcDesc) const
+      {
+         double minX = std::numeric_limits<double>::max();
+         double maxX = -minX;
+         double minY = minX;
+         double maxY = -minX;
+         const int rows[] = { firstRow, lastRow };
+         const int columns[] = { mInput.mXOffset, mInput.mXOffset + dimX - 1 };
+         for (int i = 0; i < 2; ++i)
+         {
+            double xStart;
+            double xSlope;
+            double yStart;
+            double ySlope;
+            getCoefficients(rows[i], xStart, xSlope, yStart, ySlope);
+            for (int j = 0; j < 2; ++j)
+            {
+               const double x = xStart + xSlope * columns[j];
+               const double y = yStart + ySlope * columns[j];
+               minX = std::min(minX, x);
+               maxX = std::max(maxX, x);
+               minY = std::min(minY, y);
+               maxY = std::max(maxY, y);
+            }
+         }
+
+         // Allow for the second row and column of the bilinear interpolation, and a
+         // pixel on each side for rounding differences between the corners and the rows
+         const double lastColumn = static_cast<double>(pSrcDesc->getColumnCount()) - 1;
+         const double lastSrcRow = static_cast<double>(pSrcDesc->getRowCount()) - 1;
+         Footprint footprint;
+         footprint.mFirstColumn = static_cast<int>(std::max(0.0, std::min(floor(minX) - 1, lastColumn + 1)));
+         footprint.mLastColumn = static_cast<int>(std::max(-1.0, std::min(floor(maxX) + 2, lastColumn)));
+         footprint.mFirstRow = static_cast<int>(std::max(0.0, std::min(floor(minY) - 1, lastSrcRow + 1)));
+         footprint.mLastRow = static_cast<int>(std::max(-1.0, std::min(floor(maxY) + 2, lastSrcRow)));
+         return footprint;
+      }
+
+      bool readFootprint(const Footprint& footprint, const RasterDataDescriptor* pSrcDesc)
+      {
+         mWindow.clear();
+         if (footprint.isEmpty())
+         {
+            return true;
+         }
+
+         FactoryResource<DataRequest> pRequest;
+         pRequest->setInterleaveFormat(BSQ);
+         pRequest->setRows(pSrcDesc->getActiveRow(footprint.mFirstRow), pSrcDesc->getActiveRow(footprint.mLastRow));
+         pRequest->setColumns(pSrcDesc->getActiveColumn(footprint.mFirstColumn),
+            pSrcDesc->getActiveColumn(footprint.mLastColumn));
+         pRequest->setBands(pSrcDesc->getActiveBand(0), pSrcDesc->getActiveBand(0));
+         DataAccessor accessor = mInput.mpSource->getDataAccessor(pRequest.release());
+
+         const size_t columns = footprint.mLastColumn - footprint.mFirstColumn + 1;
+         mWindow.resize(footprint.getSize());
+         for (int row = footprint.mFirstRow; row <= footprint.mLastRow; ++row)
+         {
+            accessor->toPixel(row, footprint.mFirstColumn);
+            if (!accessor.isValid())
+            {
+               return false;
+            }
+            memcpy(&mWindow[(row - footprint.mFirstRow) * columns], accessor->getColumn(), columns * sizeof(T));
+         }
+
+         return true;
+      }
+
+      void warpRow(int row, int dimX, const Footprint& footprint, const RasterDataDescriptor* pSrcDesc, T* pResults)
+      {
+         const T BAD_VALUE = 0;
+         const unsigned int nx = pSrcDesc->getColumnCount();
+         const unsigned int ny = pSrcDesc->getRowCount();
+         const size_t windowColumns = footprint.mLastColumn - footprint.mFirstColumn + 1;
+
+         double xStart;
+         double xSlope;
+         double yStart;
+         double ySlope;
+         getCoefficients(row, xStart, xSlope, yStart, ySlope);
+         for (int x = 0; x < dimX; ++x)
+         {
+            const int XNEW = x + mInput.mXOffset;
+            const double x_prime = xStart + xSlope * XNEW;
+            const double y_prime = yStart + ySlope * XNEW;
+            const double x1 = floor(x_prime);
+            const double y1 = floor(y_prime);
+
+            // Handle out of bounds case
+            if ((x1 > (nx - 1)) || (y1 > (ny - 1)) || (x1 < 0) || (y1 < 0) ||
+               x1 < footprint.mFirstColumn || x1 > footprint.mLastColumn ||
+               y1 < footprint.mFirstRow || y1 > footprint.mLastRow)
+            {
+               ++mBadValues;
+               pResults[x] = BAD_VALUE;
+               continue;
+            }
+
+            // bilinear interpolation
+            const int col1 = static_cast<int>(x1);
+            const int row1 = static_cast<int>(y1);
+            const int col2 = std::min(col1 + 1, footprint.mLastColumn);
+            const int row2 = std::min(row1 + 1, footprint.mLastRow);
+            const double u = x_prime - x1;
+            const double v = y_prime - y1;
+
+            // Index the window with offsets from its first row and column, which are never negative
+            const size_t offset1 = (row1 - footprint.mFirstRow) * windowColumns;
+            const size_t offset2 = (row2 - footprint.mFirstRow) * windowColumns;
+            const size_t column1 = col1 - footprint.mFirstColumn;
+            const size_t column2 = col2 - footprint.mFirstColumn;
+            pResults[x] = static_cast<T>((mWindow[offset1 + column1] * ((1.0 - u) * (1.0 - v))
+                                        + mWindow[offset1 + column2] * (u * (1.0 - v))
+                                        + mWindow[offset2 + column1] * ((1.0 - u) * v)
+                                        + mWindow[offset2 + column2] * (u * v)));
+         }
+      }
+
+      const WarpInput& mInput;
+      mta::AlgorithmThread::Range mRange;
+      double mBadValues;
+      bool mComplete;
+      std::vector<T> mWindow;
+   };
+
+   template<class T>
+   struct WarpOutput
+   {
+      WarpOutput() :
+         mBadValues(0)
+      {}
+
+      bool compileOverallResults(const std::vector<WarpThread<T>*>& threads)
+      {
+         for (typename std::vector<WarpThread<T>*>::const_iterator thread = threads.begin();
+            thread != threads.end(); ++thread)
+         {
+            if ((*thread)->isComplete() == false)
+            {
+               return false;
+            }
+            mBadValues += (*thread)->getBadValues();
+         }
+         return true;
+      }
+
+      double mBadValues;
+   };
+
+   class WarpProgressReporter : public mta::ProgressReporter
+   {
+   public:
+      WarpProgressReporter(const std::string& message, ProgressTracker& progressTracker) :
+         mMessage(message),
+         mProgressTracker(progressTracker)
+      {}
+
+      void reportProgress(int percent)
+      {
+         mProgressTracker.report(mMessage, percent, NORMAL);
+      }
+
+      void reportError(const std::string& text)
+      {
+         mProgressTracker.report(text, 0, ERRORS);
+      }
+
+   private:
+      WarpProgressReporter& operator=(const WarpProgressReporter& rhs);
+
+      std::string mMessage;
+      ProgressTracker& mProgressTracker;
+   };
+}
 
 /**
  * Poly2D
@@ -89,15 +431,9 @@ RasterElement* poly_2D(T* pDummy, RasterElement* pRasterElement,
                      unsigned int xoff, unsigned int yoff, int zoomFactor,
                      ProgressTracker& progressTracker, bool inMemory = true)
 {
-   double x1 = 0, y1 = 0;
-   double x_prime = 0, y_prime = 0;
-   double u = 0, v = 0;
-
    const T BAD_VALUE = 0;
    const double THRESHOLD = 0.10; // if 10% of pixels are 'bad', throw up a warning later
 
-   double badValues = 0;
-
    REQUIRE(pRasterElement != NULL);
 
    const RasterDataDescriptor* pOrigDescriptor =
@@ -135,96 +471,40 @@ RasterElement* poly_2D(T* pDummy, RasterElement* pRasterElement,
 
    pNewDescriptor = NULL; // ModelResource deletes it
 
-   FactoryResource<DataRequest> pNewRequest;
-   pNewRequest->setWritable(true);
-   DataAccessor rmda = pNewRaster->getDataAccessor(pNewRequest.release());
-   REQUIRE(rmda.isValid() == true);
-
-   DataAccessor originalData = pRasterElement->getDataAccessor();
-   REQUIRE(originalData.isValid() == true);
-
-   unsigned int x2 = 0, y2 = 0;
-   float rowProgress = 100.0f/dimY;
-   for (unsigned int y = 0; y < dimY; y++)
+   /* Let xoff = offset of ROI in primary image
+      x2=x+xoff;
+      Let yoff = offset of ROI in primary
+      y2=y+yoff
+      x_prime = KX[0] + KX[1]*y2 + KX[2]*x2 + KX[3]*x2*y2
+      y_prime = KY[0] + KY[1]*y2 + KY[2]*x2 + KY[3]*x2*y2
+
+      Each thread warps a range of rows in tiles, reading only the part of
+      the secondary image which the tile maps to.
+    */
+   Poly2DDetail::WarpInput input;
+   input.mpSource = pRasterElement;
+   input.mpResult = pNewRaster.get();
+   input.mpKX = &KX;
+   input.mpKY = &KY;
+   input.mXOffset = zoomFactor * static_cast<int>(xoff);
+   input.mYOffset = zoomFactor * static_cast<int>(yoff);
+
+   Poly2DDetail::WarpOutput<T> output;
+   Poly2DDetail::WarpProgressReporter reporter(msg, progressTracker);
+   mta::MultiThreadedAlgorithm<Poly2DDetail::WarpInput, Poly2DDetail::WarpOutput<T>, Poly2DDetail::WarpThread<T> >
+      alg(mta::getNumRequiredThreads(dimY), input, output, &reporter);
+   mta::Result result = alg.run();
+   if (DataFusionTools::getAbortFlag())
    {
-      if (DataFusionTools::getAbortFlag())
-      {
-         return NULL;
-      }
-
-      T* results = (T*) rmda->getRow();
-      for (unsigned int x = 0; x < dimX; ++x) // for every column in s'
-      {
-         /* Let xoff = offset of ROI in primary image
-            x2=x+xoff;
-            Let yoff = offset of ROI in primary
-            y2=y+yoff
-            x_prime = KX[0] + KX[1]*y2 + KX[2]*x2 + KX[3]*x2*y2
-            y_prime = KY[0] + KY[1]*y2 + KY[2]*x2 + KY[3]*x2*y2
-          */
-
-         const int XNEW = x+(zoomFactor*xoff), YNEW = y+(zoomFactor*yoff);
-
-         x_prime = KX[0] + KX[1]*YNEW + KX[2]*XNEW + KX[3]*XNEW*YNEW;
-         y_prime = KY[0] + KY[1]*YNEW + KY[2]*XNEW + KY[3]*XNEW*YNEW;
-
-         x1 = floor(x_prime);
-         y1 = floor(y_prime);
-
-         // Handle out of bounds case
-         if ((x1 > (nx-1)) || (y1 > (ny-1)) || (x1 < 0) || (y1 < 0))
-         {
-            badValues++;
-            results[x] = BAD_VALUE;
-         }
-         else
-         {
-            // bilinear interpolation 
-            if ((x1+1) > (double(nx)-1))
-            {
-               x2 = nx-1;
-            }
-            else
-            {
-               x2 = static_cast<unsigned int>(x1+1);
-            }
-            if ((y1+1) > (double(ny)-1))
-            {
-               y2 = ny-1;
-            }
-            else
-            {
-               y2 = static_cast<unsigned int>(y1+1);
-            }
-            u = x_prime - x1;
-            v = y_prime - y1;
-
-            // the "out of bounds case" above guarnatees that the toPixel() operations will succeed
-
-            originalData->toPixel(static_cast<int>(y1), static_cast<int>(x1));
-            const T minXminY = *reinterpret_cast<T*>(originalData->getColumn());
-
-            originalData->toPixel(static_cast<int>(y1), static_cast<int>(x2));
-            const T maxXminY = *reinterpret_cast<T*>(originalData->getColumn());
-
-            originalData->toPixel(static_cast<int>(y2), static_cast<int>(x1));
-            const T minXmaxY = *reinterpret_cast<T*>(originalData->getColumn());
-            
-            originalData->toPixel(static_cast<int>(y2), static_cast<int>(x2));
-            const T maxXmaxY = *reinterpret_cast<T*>(originalData->getColumn());
-
-            results[x] = static_cast<T>((minXminY * ((1.0 - u) * (1.0 - v))
-                                       + maxXminY * (u * (1.0 - v))
-                                       + minXmaxY * ((1.0 - u) * v)
-                                       + maxXmaxY * (u * v)));
-         }
-      }
-      rmda->nextRow();
-      // report 1 row's worth of progress
-      int workDone = static_cast<int>(rowProgress * (y + 1));
-      progressTracker.report(msg.c_str(), workDone, NORMAL);
+      return NULL;
+   }
+   if (result != mta::SUCCESS)
+   {
+      throw FusionException("Unable to warp the secondary image!", __LINE__, __FILE__);
    }
 
+   const double badValues = output.mBadValues;
+
    if ((badValues / (dimX * dimY)) > THRESHOLD) 
    {
       std::string txt = "Warning: Too many values in the primary data set are not in the secondary data set! "
@@ -936,7 +936,7 @@ CachedPage::UnitPtr FitsRasterPager::fetchUnit(DataRequest* pOriginalRequest)
    int status = 0;
 
    size_t bufsize = pixcnt * pDesc->getBytesPerElement();
-   ArrayResource<char> pBuffer(bufsize, true);
+   PageBufferResource pBuffer(bufsize);
    if (pBuffer.get() == NULL)
    {
       return CachedPage::UnitPtr();
@@ -952,5 +952,6 @@ CachedPage::UnitPtr FitsRasterPager::fetchUnit(DataRequest* pOriginalRequest)
       }
    }
    return CachedPage::UnitPtr(new CachedPage::CacheUnit(
-      pBuffer.release(), pOriginalRequest->getStartRow(), maxInRow, bufsize, pOriginalRequest->getStartBand()));
+      pBuffer.release(), pOriginalRequest->getStartRow(), maxInRow, bufsize, pOriginalRequest->getStartBand(), 0,
+      true));
 }
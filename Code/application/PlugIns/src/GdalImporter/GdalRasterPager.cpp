@@ -163,7 +163,7 @@ CachedPage::UnitPtr GdalRasterPager::fetchUnit(DataRequest* pOriginalRequest)
    }
 
    size_t bufSize = numCols * numRows * pDesc->getBytesPerElement();
-   ArrayResource<char> pBuffer(bufSize, true);
+   PageBufferResource pBuffer(bufSize);
    if (pBuffer.get() == NULL)
    {
       return CachedPage::UnitPtr();
@@ -226,5 +226,6 @@ CachedPage::UnitPtr GdalRasterPager::fetchUnit(DataRequest* pOriginalRequest)
    }
 
    return CachedPage::UnitPtr(new CachedPage::CacheUnit(
-      pBuffer.release(), pOriginalRequest->getStartRow(), numRows, bufSize, pOriginalRequest->getStartBand()));
+      pBuffer.release(), pOriginalRequest->getStartRow(), numRows, bufSize, pOriginalRequest->getStartBand(), 0,
+      true));
 }
@@ -20,6 +20,7 @@
 #include "GeoPoint.h"
 #include "GeoreferenceDescriptor.h"
 #include "GeoreferenceUtilities.h"
+#include "GridConversions.h"
 #include "GraphicObject.h"
 #include "Layer.h"
 #include "LayerList.h"
@@ -588,9 +589,10 @@ LocationType IgmGeoreference::pixelToGeo(LocationType pixel, bool* pAccurate) co
       hemisphere = 'S';
       northing = -northing;
    }
-   UtmPoint uPoint(mpIgmRaster->getPixelValue(column, row, firstBand), northing, mZone, hemisphere);
-   return LocationType(uPoint.getLatLonCoordinates().getLatitude().getValue(),
-      uPoint.getLatLonCoordinates().getLongitude().getValue());
+   LocationType latLon;
+   GridConversions::utmToLatLon(GridConversions::UtmCoordinate(mpIgmRaster->getPixelValue(column, row, firstBand),
+      northing, mZone, hemisphere), latLon);
+   return latLon;
 }
 
 LocationType IgmGeoreference::geoToPixel(LocationType geo, bool* pAccurate) const
@@ -27,6 +27,7 @@
 #include "RasterLayer.h"
 #include "SpatialDataWindow.h"
 #include "SpatialDataView.h"
+#include "TileHandler.h"
 #include "Window.h"
 #include "xmlwriter.h"
 
@@ -60,6 +61,9 @@ KMLServer::KMLServer() : MuHttpServer(hasSettingKmlServerPort() ? getSettingKmlS
 
    ImageHandler* pImageHandler = new ImageHandler(0, this);
    registerPath("images", pImageHandler);
+
+   TileHandler* pTileHandler = new TileHandler(0, this);
+   registerPath("tiles", pTileHandler);
 }
 
 KMLServer::~KMLServer()
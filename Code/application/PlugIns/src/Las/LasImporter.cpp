@@ -25,6 +25,7 @@
 #include "PointCloudAccessorImpl.h"
 #include "PointCloudDataDescriptor.h"
 #include "PointCloudFileDescriptor.h"
+#include "PointCloudOctree.h"
 #include "PointCloudView.h"
 #include "PointCloudWindow.h"
 #include "ProgressTracker.h"
@@ -39,6 +40,7 @@
 #include <liblas/iterator.hpp>
 
 #include <boost/atomic.hpp>
+#include <map>
 #include <math.h>
 #include <QtCore/QString>
 #include <QtGui/QComboBox>
@@ -124,7 +126,14 @@ std::vector<ImportDescriptor*> LasImporter::getImportDescriptors(const std::stri
       pDesc->setXScale(xScale);
       pDesc->setYScale(yScale);
       pDesc->setZScale(zScale);
-      pDesc->setProcessingLocation(IN_MEMORY);
+      // Large point clouds are paged from disk instead of failing to load
+      ProcessingLocation location = IN_MEMORY;
+      if (static_cast<uint64_t>(pDesc->getPointSizeInBytes()) * numPoints >
+         Service<UtilityServices>()->getMaxMemoryBlockSize())
+      {
+         location = ON_DISK;
+      }
+      pDesc->setProcessingLocation(location);
 
       VERIFYRV(pDesc, descriptors);
       descZ->setDataDescriptor(pDesc);
@@ -148,7 +157,7 @@ std::vector<ImportDescriptor*> LasImporter::getImportDescriptors(const std::stri
 
       if ( !pMetadataZ->getAttributeByPath("LAS/Thinning Options/Algorithm").isValid() )
       {
-          pMetadataZ->setAttributeByPath("LAS/Thinning Options/Algorithm", static_cast<int>(THIN_NONE));
+          pMetadataZ->setAttributeByPath("LAS/Thinning Options/Algorithm", static_cast<int>(THIN_OCTREE));
           pMetadataZ->setAttributeByPath("LAS/Thinning Options/Max Points", 100000);
           pMetadataZ->setAttributeByPath("LAS/Thinning Options/Grid Size", 1.0);
       }
@@ -279,6 +288,12 @@ bool LasImporter::execute( PlugInArgList* pInArgList, PlugInArgList* pOutArgList
            }
            pDesc->setPointCount(totPoints);
            break;
+       case THIN_OCTREE:
+           if (octreeImport(pDesc, reader, header, pData, progress, &mAborted) < 0)
+           {
+              return false;
+           }
+           break;
        default:
            break;
    }      
@@ -432,6 +447,111 @@ int LasImporter::maxPointsThinning(const unsigned int maxPoints,
    return totPoints;
 }
 
+int LasImporter::octreeImport(PointCloudDataDescriptor* pDesc,
+                              liblas::Reader& reader,
+                              liblas::Header const& header,
+                              PointCloudElement* pElement,
+                              ProgressTracker& progress,
+                              bool* pAborted)
+{
+   VERIFYRV(pDesc != NULL && pElement != NULL, -1);
+   VERIFYRV(pDesc->getSpatialDataType() == INT4SBYTES && pDesc->getIntensityDataType() == INT2UBYTES &&
+      pDesc->getClassificationDataType() == INT1UBYTE, -1);
+
+   const unsigned int total = header.GetPointRecordsCount();
+   if (total == 0)
+   {
+      return 0;
+   }
+
+   PointCloudOctree octree(PointCloudOctree::getDefaultDepth(total), pDesc->getXMin(), pDesc->getYMin(),
+      pDesc->getZMin(), pDesc->getXMax(), pDesc->getYMax(), pDesc->getZMax());
+
+   // The first pass counts the points in each leaf so every leaf can be given a contiguous range of indices
+   std::map<uint32_t, uint32_t> leafCounts;
+   unsigned int cur = 0;
+   int oldPercent = 0;
+   while (cur < total && reader.ReadNextPoint())
+   {
+      const liblas::Point& point = reader.GetPoint();
+      ++leafCounts[octree.getLeafCode(point.GetRawX(), point.GetRawY(), point.GetRawZ())];
+
+      int curPercent = static_cast<int>(static_cast<uint64_t>(++cur) * 49 / total);
+      if (curPercent > oldPercent)
+      {
+         if (pAborted != NULL && *pAborted)
+         {
+            progress.report("Import canceled", 0, ABORT);
+            return -1;
+         }
+         progress.report("Indexing LAS data...", curPercent, NORMAL);
+         oldPercent = curPercent;
+      }
+   }
+
+   const unsigned int indexed = cur;
+   std::vector<uint32_t> codes;
+   std::vector<uint32_t> offsets;
+   codes.reserve(leafCounts.size());
+   offsets.reserve(leafCounts.size() + 1);
+   uint32_t offset = 0;
+   for (std::map<uint32_t, uint32_t>::iterator leaf = leafCounts.begin(); leaf != leafCounts.end(); ++leaf)
+   {
+      codes.push_back(leaf->first);
+      offsets.push_back(offset);
+      offset += leaf->second;
+
+      // Reuse the count as the index of the next point written to the leaf
+      leaf->second = offsets.back();
+   }
+   offsets.push_back(offset);
+
+   // The second pass writes each point into the next free index of its leaf
+   reader.Reset();
+   FactoryResource<PointCloudDataRequest> pReq;
+   pReq->setWritable(true);
+   PointCloudAccessor accessor(pElement->getPointCloudAccessor(pReq.release()));
+   VERIFYRV(accessor.isValid(), -1);
+
+   cur = 0;
+   while (cur < indexed && reader.ReadNextPoint())
+   {
+      const liblas::Point& point = reader.GetPoint();
+      uint32_t& index = leafCounts[octree.getLeafCode(point.GetRawX(), point.GetRawY(), point.GetRawZ())];
+      accessor->toIndex(index++);
+      *reinterpret_cast<int32_t*>(accessor->getRawX()) = point.GetRawX();
+      *reinterpret_cast<int32_t*>(accessor->getRawY()) = point.GetRawY();
+      *reinterpret_cast<int32_t*>(accessor->getRawZ()) = point.GetRawZ();
+      *reinterpret_cast<uint16_t*>(accessor->getRawIntensity()) = point.GetIntensity();
+      *reinterpret_cast<unsigned char*>(accessor->getRawClassification()) = point.GetClassification().GetClass();
+      accessor->setPointValid(true);
+
+      int curPercent = 49 + static_cast<int>(static_cast<uint64_t>(++cur) * 50 / indexed);
+      if (curPercent > oldPercent)
+      {
+         if (pAborted != NULL && *pAborted)
+         {
+            progress.report("Import canceled", 0, ABORT);
+            return -1;
+         }
+         progress.report("Loading LAS data...", curPercent, NORMAL);
+         oldPercent = curPercent;
+      }
+   }
+
+   if (cur != indexed)
+   {
+      progress.report("Unable to read all of the LAS points.", 0, ERRORS, true);
+      return -1;
+   }
+
+   VERIFYRV(octree.setLeaves(codes, offsets), -1);
+   VERIFYRV(octree.toMetadata(pDesc->getMetadata()), -1);
+   pDesc->setPointCount(indexed);
+   pDesc->setArrangement(POINT_OCTREE_ARRAY);
+   return static_cast<int>(indexed);
+}
+
 PointCloudDataDescriptor* LasImporter::generatePointCloudDataDescriptor(const std::string& name, DataElement* pParent,
                                                                         InterleaveFormatType interleave,
                                                                         EncodingType encoding,
@@ -45,7 +45,8 @@ public:
    enum ThinningMethod
    {
       THIN_NONE,
-      THIN_MAX_POINTS
+      THIN_MAX_POINTS,
+      THIN_OCTREE
    };
 
 protected:
@@ -56,6 +57,12 @@ protected:
                          PointCloudElement* pElement,
                          ProgressTracker& progress,
                          bool* pAborted);
+   int octreeImport(PointCloudDataDescriptor* pDesc,
+                    liblas::Reader& reader,
+                    liblas::Header const& header,
+                    PointCloudElement* pElement,
+                    ProgressTracker& progress,
+                    bool* pAborted);
    PointCloudDataDescriptor* generatePointCloudDataDescriptor(const std::string& name, DataElement* pParent,
                                                               InterleaveFormatType interleave, EncodingType encoding,
                                                               EncodingType intensityEncoding, EncodingType classEncoding,
@@ -22,6 +22,7 @@ OptionLasImporter::OptionLasImporter()
     mpDropDown = new QComboBox( mpWidget );
     mpDropDown->addItem( "Import all points (no thinning)" );
     mpDropDown->addItem( "Set max points to import" );
+    mpDropDown->addItem( "Import all points in octree order (level of detail)" );
 
     mpInputMaxPoints = new QLineEdit( mpWidget );
     mpInputMaxPoints->setValidator( new QIntValidator( 1, 999999999, mpInputMaxPoints ) );
@@ -85,6 +86,7 @@ void OptionLasImporter::indexChangedEvent( int newIndex )
     switch ( newIndex )
     {
     case LasImporter::THIN_NONE:
+    case LasImporter::THIN_OCTREE:
         mpInputMaxPoints->setDisabled( true );
         mpInputGridSize->setDisabled( true );
         mpMaxPointsLabel->setDisabled( true );
@@ -15,6 +15,7 @@
 #include "AppVersion.h"
 #include "BitrateWidget.h"
 #include "ColorType.h"
+#include "DMutex.h"
 #include "FileDescriptor.h"
 #include "FramerateWidget.h"
 #include "MovieExporter.h"
@@ -24,6 +25,7 @@
 #include "PlugInArgList.h"
 #include "PlugInManagerServices.h"
 #include "Progress.h"
+#include "bthread.h"
 #include "SpatialDataView.h"
 #include "StringUtilities.h"
 #include "View.h"
@@ -33,6 +35,8 @@
 #include <QtGui/QImage>
 #include <QtGui/QPainter>
 
+#include <algorithm>
+#include <deque>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -104,6 +108,183 @@ extern "C" static void av_log_callback(void* pPtr, int level, const char* pFmt,
    logBuffer.vsprintf(pFmt, vl);
 }
 
+/**
+ * Converts and encodes captured frames on a separate thread so that the
+ * next frame can be rendered while the previous one is encoded.
+ *
+ * The view is rendered into a free RGBA picture from a small pool on the
+ * main thread, and the picture is then queued for conversion and encoding
+ * in the order it was submitted.
+ */
+class MovieExporter::FrameEncoder
+{
+public:
+   FrameEncoder(MovieExporter& exporter, AVFormatContext* pFormat, AVStream* pVideoStream) :
+      mExporter(exporter),
+      mpFormat(pFormat),
+      mpVideoStream(pVideoStream),
+      mRunning(false),
+      mStopping(false),
+      mDiscard(false),
+      mFailed(false),
+      mThread(static_cast<void*>(this), reinterpret_cast<void*>(FrameEncoder::threadFunction))
+   {
+   }
+
+   ~FrameEncoder()
+   {
+      cancel();
+      for (vector<AVFrame*>::iterator iter = mFrames.begin(); iter != mFrames.end(); ++iter)
+      {
+         free((*iter)->data[0]);
+         av_free(*iter);
+      }
+   }
+
+   bool start(unsigned int frameCount)
+   {
+      AVCodecContext* pCodecContext = mpVideoStream->codec;
+      for (unsigned int i = 0; i < frameCount; ++i)
+      {
+         AVFrame* pFrame = mExporter.alloc_picture(PIX_FMT_RGBA32, pCodecContext->width, pCodecContext->height);
+         if (pFrame == NULL)
+         {
+            return false;
+         }
+         mFrames.push_back(pFrame);
+         mFreeFrames.push_back(pFrame);
+      }
+
+      mRunning = mThread.ThreadLaunch();
+      return mRunning;
+   }
+
+   /**
+    * Waits for a picture which is not queued for encoding.
+    *
+    * @return The picture, or \c NULL if a frame could not be encoded.
+    */
+   AVFrame* acquireFrame()
+   {
+      mta::MutexLock lock(mMutex);
+      while (mFreeFrames.empty() && !mFailed)
+      {
+         mFrameFreed.ThreadSignalWait(&mMutex);
+      }
+      if (mFailed)
+      {
+         return NULL;
+      }
+
+      AVFrame* pFrame = mFreeFrames.front();
+      mFreeFrames.pop_front();
+      return pFrame;
+   }
+
+   void submitFrame(AVFrame* pFrame)
+   {
+      mta::MutexLock lock(mMutex);
+      mPendingFrames.push_back(pFrame);
+      mFrameQueued.ThreadSignalActivate();
+   }
+
+   /**
+    * Encodes the queued frames and stops the encoding thread.
+    *
+    * @return \c True if every submitted frame was written.
+    */
+   bool finish()
+   {
+      stop(false);
+      return !mFailed;
+   }
+
+   /**
+    * Stops the encoding thread without encoding the queued frames.
+    */
+   void cancel()
+   {
+      stop(true);
+   }
+
+private:
+   FrameEncoder& operator=(const FrameEncoder& rhs);
+
+   static void threadFunction(FrameEncoder* pEncoder)
+   {
+      pEncoder->run();
+   }
+
+   void run()
+   {
+      AVCodecContext* pCodecContext = mpVideoStream->codec;
+      for (;;)
+      {
+         AVFrame* pFrame = NULL;
+         {
+            mta::MutexLock lock(mMutex);
+            while (mPendingFrames.empty() && !mStopping)
+            {
+               mFrameQueued.ThreadSignalWait(&mMutex);
+            }
+            if (mPendingFrames.empty() || mDiscard)
+            {
+               return;
+            }
+            pFrame = mPendingFrames.front();
+            mPendingFrames.pop_front();
+         }
+
+         img_convert(reinterpret_cast<AVPicture*>(mExporter.mpPicture),
+            pCodecContext->pix_fmt,
+            reinterpret_cast<AVPicture*>(pFrame),
+            PIX_FMT_RGBA32,
+            pCodecContext->width,
+            pCodecContext->height);
+         bool success = mExporter.write_video_frame(mpFormat, mpVideoStream);
+
+         mta::MutexLock lock(mMutex);
+         mFreeFrames.push_back(pFrame);
+         mFailed = mFailed || !success;
+         mFrameFreed.ThreadSignalActivate();
+         if (mFailed)
+         {
+            return;
+         }
+      }
+   }
+
+   void stop(bool discardPending)
+   {
+      {
+         mta::MutexLock lock(mMutex);
+         mStopping = true;
+         mDiscard = mDiscard || discardPending;
+         mFrameQueued.ThreadSignalActivate();
+      }
+      if (mRunning)
+      {
+         mThread.ThreadWait();
+         mRunning = false;
+      }
+   }
+
+   MovieExporter& mExporter;
+   AVFormatContext* mpFormat;
+   AVStream* mpVideoStream;
+   vector<AVFrame*> mFrames;
+   deque<AVFrame*> mFreeFrames;
+   deque<AVFrame*> mPendingFrames;
+   bool mRunning;
+   bool mStopping;
+   bool mDiscard;
+   bool mFailed;
+   mta::DMutex mMutex;
+   mta::DThreadSignal mFrameQueued;
+   mta::DThreadSignal mFrameFreed;
+   BThread mThread;
+};
+
 MovieExporter::MovieExporter() :
    mpProgress(NULL),
    mpStep(NULL),
@@ -512,6 +693,9 @@ bool MovieExporter::execute(PlugInArgList* pInArgList, PlugInArgList* pOutArgLis
       log_error("Unable to initialize CODEC options");
       return false;
    }
+   // let CODECs which support it encode each frame with multiple threads
+   // this fails harmlessly if libavcodec was built without thread support
+   avcodec_thread_init(pCodecContext, max(1U, ConfigurationSettings::getSettingThreadCount()));
    // set time_base, width, height, and bitrate here since
    // they can be passed in via the input args
    pCodecContext->width = resolutionX;
@@ -550,14 +734,15 @@ bool MovieExporter::execute(PlugInArgList* pInArgList, PlugInArgList* pOutArgLis
    double interval = pController->getIntervalMultiplier() * framerate.denominator() / framerate.numerator();
 
    // export the frames
-   AVFrame* pTmpPicture = alloc_picture(PIX_FMT_RGBA32, pCodecContext->width, pCodecContext->height);
-   if (pTmpPicture == NULL)
+   // frames are rendered on this thread while the previous frames are converted and encoded,
+   // full resolution frames can be very large so only buffer one frame ahead for those
+   FrameEncoder encoder(*this, pFormat, pVideoStream);
+   if (!encoder.start(fullResolution ? 2 : 4))
    {
       QString msg("Unable to allocate frame buffer of size %1 x %2");
       log_error(msg.arg(pCodecContext->width).arg(pCodecContext->height).toStdString());
       return false;
    }
-   QImage image(pTmpPicture->data[0], pCodecContext->width, pCodecContext->height, QImage::Format_ARGB32);
 
    // For frame id based animation, each band of the data set fills one second of animation. 
    // If the requested frame rate for export is 15 fps, then each band is replicated 15 times. The execution
@@ -631,6 +816,7 @@ bool MovieExporter::execute(PlugInArgList* pInArgList, PlugInArgList* pOutArgLis
       if (isAborted() == true)
       {
          // reset resources to close output file so it can be deleted
+         encoder.cancel();
          pVideoStream = AvStreamResource();
          pFormat = AvFormatContextResource(NULL);
          mpPicture = NULL;
@@ -647,6 +833,13 @@ bool MovieExporter::execute(PlugInArgList* pInArgList, PlugInArgList* pOutArgLis
          return false;
       }
 
+      AVFrame* pFrame = encoder.acquireFrame();
+      if (pFrame == NULL)
+      {
+         break;
+      }
+      QImage image(pFrame->data[0], pCodecContext->width, pCodecContext->height, QImage::Format_ARGB32);
+
       // generate the next frame
       pController->setCurrentFrame(video_pts);
       if (mpProgress != NULL)
@@ -746,26 +939,21 @@ bool MovieExporter::execute(PlugInArgList* pInArgList, PlugInArgList* pOutArgLis
       {
          pView->getCurrentImage(image);
       }
-      img_convert(reinterpret_cast<AVPicture*>(mpPicture),
-         pCodecContext->pix_fmt,
-         reinterpret_cast<AVPicture*>(pTmpPicture),
-         PIX_FMT_RGBA32,
-         pCodecContext->width,
-         pCodecContext->height);
-      if (!write_video_frame(pFormat, pVideoStream))
-      {
-         // reset resources to close output file so it can be deleted
-         pVideoStream = AvStreamResource();
-         pFormat = AvFormatContextResource(NULL);
-         mpPicture = NULL;
-         free(mpVideoOutbuf);
-         mpVideoOutbuf = NULL;
-         remove(filename.c_str());
-         string msg = "Can't write frame.";
-         log_error(msg.c_str());
-         pController->setAnimationState(savedAnimationState);
-         return false;
-      }
+      encoder.submitFrame(pFrame);
+   }
+   if (!encoder.finish())
+   {
+      // reset resources to close output file so it can be deleted
+      pVideoStream = AvStreamResource();
+      pFormat = AvFormatContextResource(NULL);
+      mpPicture = NULL;
+      free(mpVideoOutbuf);
+      mpVideoOutbuf = NULL;
+      remove(filename.c_str());
+      string msg = "Can't write frame.";
+      log_error(msg.c_str());
+      pController->setAnimationState(savedAnimationState);
+      return false;
    }
    for (int frame = 0; frame < pCodecContext->delay; ++frame)
    {
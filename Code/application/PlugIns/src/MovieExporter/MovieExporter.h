@@ -201,6 +201,8 @@ protected:
    virtual bool convertToValidResolution(int& resolutionX, int& resolutionY) const;
 
 private:
+   class FrameEncoder;
+
    void log_error(const std::string& msg);
 
    Progress* mpProgress;
@@ -115,7 +115,7 @@ CachedPage::UnitPtr Nitf::Pager::fetchUnit(DataRequest *pOriginalRequest)
                      colNumber + minx + concurrentColumns-1, rowNumber + miny + concurrentRows-1);
 
    const int dstSize = concurrentRows * concurrentColumns * concurrentBands * getBytesPerBand();
-   ArrayResource<char> pData(dstSize, true);
+   PageBufferResource pData(dstSize);
    if (pData.get() == NULL)
    {
       return CachedPage::UnitPtr();
@@ -169,5 +169,5 @@ CachedPage::UnitPtr Nitf::Pager::fetchUnit(DataRequest *pOriginalRequest)
    }
 
    return CachedPage::UnitPtr(new CachedPage::CacheUnit(pData.release(), startRow, concurrentRows,
-      dstSize, concurrentBands == 1 ? startBand : CachedPage::CacheUnit::ALL_BANDS));
+      dstSize, concurrentBands == 1 ? startBand : CachedPage::CacheUnit::ALL_BANDS, 0, true));
 }
@@ -25,53 +25,224 @@
 #include "RasterUtilities.h"
 #include "SpatialDataView.h"
 #include "StringUtilities.h"
-#include "UtilityServices.h"
 
-#include <opencv2/imgproc/imgproc.hpp>
+#include "MultiThreadedAlgorithm.h"
+
+#include <algorithm>
+#include <limits>
+#include <string.h>
+#include <vector>
 
 REGISTER_PLUGIN_BASIC(OpticksObjectFinding, ConnectedComponents);
 
 namespace
 {
-   void fillContours(cv::Mat labels,
-                     const std::vector<std::vector<cv::Point> >& contours,
-                     const std::vector<cv::Vec4i>& hierarchy,
-                     unsigned short& label,
-                     unsigned short parentLabel, // or 0 for an external
-                     int contourIdx)
+   // A horizontal span of selected pixels in the label element
+   struct Run
+   {
+      Run(unsigned int row, unsigned int start, unsigned int end) : mRow(row), mStart(start), mEnd(end) {}
+
+      unsigned int mRow;
+      unsigned int mStart;
+      unsigned int mEnd;
+   };
+
+   unsigned int findRoot(std::vector<unsigned int>& parents, unsigned int run)
+   {
+      while (parents[run] != run)
+      {
+         parents[run] = parents[parents[run]];
+         run = parents[run];
+      }
+      return run;
+   }
+
+   // The earliest run becomes the root so labels are assigned in raster order
+   void unite(std::vector<unsigned int>& parents, unsigned int first, unsigned int second)
+   {
+      first = findRoot(parents, first);
+      second = findRoot(parents, second);
+      if (first < second)
+      {
+         parents[second] = first;
+      }
+      else if (second < first)
+      {
+         parents[first] = second;
+      }
+   }
+
+   // Runs in the same row, or in adjacent rows and overlapping or touching diagonally, are 8-connected
+   void uniteRows(const std::vector<Run>& runs, std::vector<unsigned int>& parents,
+      unsigned int previousBegin, unsigned int previousEnd, unsigned int currentBegin, unsigned int currentEnd)
    {
-      if (static_cast<int>(hierarchy.size()) <= contourIdx)
+      unsigned int previous = previousBegin;
+      for (unsigned int current = currentBegin; current < currentEnd; ++current)
       {
-         return;
+         while (previous < previousEnd && runs[previous].mEnd + 1 < runs[current].mStart)
+         {
+            ++previous;
+         }
+         for (unsigned int candidate = previous;
+            candidate < previousEnd && runs[candidate].mStart <= runs[current].mEnd + 1; ++candidate)
+         {
+            unite(parents, current, candidate);
+         }
       }
-      // Loop all contours at this level of the tree
-      while (contourIdx != -1)
+   }
+
+   struct LabelInput
+   {
+      LabelInput() :
+         mpBitMask(NULL),
+         mXOffset(0),
+         mYOffset(0),
+         mFirstX(0),
+         mLastX(0),
+         mWidth(0),
+         mHeight(0),
+         mpLabels(NULL),
+         mpAbortFlag(NULL)
+      {}
+
+      const BitMask* mpBitMask;
+      int mXOffset;
+      int mYOffset;
+      int mFirstX;
+      int mLastX;
+      unsigned int mWidth;
+      unsigned int mHeight;
+      unsigned short* mpLabels;
+      const bool* mpAbortFlag;
+   };
+
+   // The runs of a tile of rows, connected within the tile
+   struct LabelTile
+   {
+      std::vector<Run> mRuns;
+      std::vector<unsigned int> mParents;
+   };
+
+   class LabelThread : public mta::AlgorithmThread
+   {
+   public:
+      LabelThread(const LabelInput& input, int threadCount, int threadIndex, mta::ThreadReporter& reporter) :
+         mta::AlgorithmThread(threadIndex, reporter),
+         mInput(input),
+         mRowRange(getThreadRange(threadCount, input.mHeight))
+      {}
+
+      void run()
       {
-         if (parentLabel > 0)
+         unsigned int previousBegin = 0;
+         unsigned int previousEnd = 0;
+         int oldPercent = -1;
+         for (int row = mRowRange.mFirst; row <= mRowRange.mLast; ++row)
          {
-            // Internal contours include the edge of object, not the edge of the hole
-            // So we blank out the internal contour then redraw the contour line
-            cv::drawContours(labels, contours, contourIdx, cv::Scalar(0), CV_FILLED, 8, hierarchy, 0);
-            cv::drawContours(labels, contours, contourIdx, cv::Scalar(parentLabel), 1, 8, hierarchy, 0);
-            if (hierarchy[contourIdx][2] != -1)
+            int percent = mRowRange.computePercent(row);
+            if (percent != oldPercent)
+            {
+               if (mInput.mpAbortFlag != NULL && *mInput.mpAbortFlag)
+               {
+                  break;
+               }
+               getReporter().reportProgress(getThreadIndex(), percent);
+               oldPercent = percent;
+            }
+
+            memset(mInput.mpLabels + row * mInput.mWidth, 0, mInput.mWidth * sizeof(unsigned short));
+            unsigned int currentBegin = static_cast<unsigned int>(mTile.mRuns.size());
+            findRuns(row);
+            unsigned int currentEnd = static_cast<unsigned int>(mTile.mRuns.size());
+            for (unsigned int run = currentBegin; run < currentEnd; ++run)
+            {
+               mTile.mParents.push_back(run);
+            }
+            if (previousEnd > previousBegin && mTile.mRuns[previousBegin].mRow + 1 == static_cast<unsigned int>(row))
+            {
+               uniteRows(mTile.mRuns, mTile.mParents, previousBegin, previousEnd, currentBegin, currentEnd);
+            }
+            if (currentEnd > currentBegin)
             {
-               // If there are nested contours, draw them as well
-               fillContours(labels, contours, hierarchy, label, 0, hierarchy[contourIdx][2]);
+               previousBegin = currentBegin;
+               previousEnd = currentEnd;
             }
          }
-         else
+      }
+
+      LabelTile& getTile()
+      {
+         return mTile;
+      }
+
+   private:
+      LabelThread& operator=(const LabelThread& rhs);
+
+      // Reads the AOI 32 pixels at a time and records the selected spans
+      void findRuns(int row)
+      {
+         const int y = row + mInput.mYOffset;
+         const int firstX = mInput.mFirstX;
+         const int lastX = mInput.mLastX;
+         int runStart = -1;
+         for (int wordX = firstX - (firstX & 0x1f); wordX <= lastX; wordX += 32)
          {
-            // Fill the entire contour poly
-            cv::drawContours(labels, contours, contourIdx, cv::Scalar(++label), CV_FILLED, 8, hierarchy, 0);
-            if (hierarchy[contourIdx][2] != -1)
+            unsigned int bits = mInput.mpBitMask->getPixels(wordX, y);
+            bool inside = wordX >= firstX && wordX + 31 <= lastX;
+            if (inside && ((bits == 0 && runStart < 0) || (bits == 0xffffffff && runStart >= 0)))
+            {
+               continue;
+            }
+            for (int bit = 0; bit < 32; ++bit)
             {
-               // If there are nested contours, draw them as well
-               fillContours(labels, contours, hierarchy, label, label, hierarchy[contourIdx][2]);
+               int x = wordX + bit;
+               bool selected = (bits & (0x80000000 >> bit)) != 0 && x >= firstX && x <= lastX;
+               if (selected && runStart < 0)
+               {
+                  runStart = x;
+               }
+               else if (!selected && runStart >= 0)
+               {
+                  addRun(row, runStart, x - 1);
+                  runStart = -1;
+               }
             }
          }
-         contourIdx = hierarchy[contourIdx][0];
+         if (runStart >= 0)
+         {
+            addRun(row, runStart, lastX);
+         }
       }
-   }
+
+      void addRun(int row, int start, int end)
+      {
+         mTile.mRuns.push_back(Run(row, start - mInput.mXOffset, end - mInput.mXOffset));
+      }
+
+      const LabelInput& mInput;
+      mta::AlgorithmThread::Range mRowRange;
+      LabelTile mTile;
+   };
+
+   struct LabelOutput
+   {
+      bool compileOverallResults(const std::vector<LabelThread*>& threads)
+      {
+         mTiles.resize(threads.size());
+         for (std::vector<LabelThread*>::size_type idx = 0; idx < threads.size(); ++idx)
+         {
+            if (threads[idx] == NULL)
+            {
+               return false;
+            }
+            std::swap(mTiles[idx].mRuns, threads[idx]->getTile().mRuns);
+            std::swap(mTiles[idx].mParents, threads[idx]->getTile().mParents);
+         }
+         return true;
+      }
+
+      std::vector<LabelTile> mTiles;
+   };
 }
 
 ConnectedComponents::ConnectedComponents() : mpView(NULL), mpLabels(NULL), mXOffset(0), mYOffset(0)
@@ -84,7 +255,6 @@ ConnectedComponents::ConnectedComponents() : mpView(NULL), mpLabels(NULL), mXOff
    setProductionStatus(APP_IS_PRODUCTION_RELEASE);
    setAbortSupported(true);
    setMenuLocation("[General Algorithms]/Connected Components");
-   addDependencyCopyright("OpenCV", Service<UtilityServices>()->getTextFromFile(":/licenses/opencv"));
 }
 
 ConnectedComponents::~ConnectedComponents()
@@ -204,63 +374,172 @@ bool ConnectedComponents::execute(PlugInArgList* pInArgList, PlugInArgList* pOut
    }
    ModelResource<RasterElement> pLabels(mpLabels);
 
-   try
+   /**********
+    * Label the runs of each tile of rows in parallel
+    **********/
+   LabelInput input;
+   input.mpBitMask = mpBitmask;
+   input.mXOffset = mXOffset;
+   input.mYOffset = mYOffset;
+   input.mFirstX = x1 + 1;
+   input.mLastX = x2 - 1;
+   input.mWidth = width;
+   input.mHeight = height;
+   input.mpLabels = reinterpret_cast<unsigned short*>(mpLabels->getRawData());
+   input.mpAbortFlag = &mAborted;
+   VERIFY(input.mpLabels != NULL);
+   LabelOutput output;
    {
-      cv::Mat data(height, width, CV_8UC1, cv::Scalar(0));
-      for (unsigned int y = 0; y < height; ++y)
+      mta::ProgressObjectReporter reporter("Finding blobs", mProgress.getCurrentProgress());
+      mta::MultiThreadedAlgorithm<LabelInput, LabelOutput, LabelThread>
+         alg(mta::getNumRequiredThreads(height), input, output, &reporter);
+      if (alg.run() != mta::SUCCESS)
       {
-         mProgress.report("Reading AOI data", 10 * y / height, NORMAL);
-         for (unsigned int x = 0; x < width; ++x)
-         {
-            if (mpBitmask->getPixel(x + mXOffset, y + mYOffset))
-            {
-               data.at<unsigned char>(y, x) = 255;
-            }
-         }
+         mProgress.report("Unable to label blobs.", 0, ERRORS, true);
+         return false;
+      }
+   }
+   if (isAborted())
+   {
+      mProgress.report("User aborted", 0, ABORT, true);
+      return false;
+   }
+
+   /**********
+    * Merge the labels across tile borders
+    **********/
+   mProgress.report("Merging blobs", 80, NORMAL);
+   std::vector<Run> runs;
+   std::vector<unsigned int> parents;
+   unsigned int previousBegin = 0;
+   unsigned int previousEnd = 0;
+   for (std::vector<LabelTile>::iterator tile = output.mTiles.begin(); tile != output.mTiles.end(); ++tile)
+   {
+      if (tile->mRuns.empty())
+      {
+         continue;
       }
-      mProgress.report("Finding contours", 15, NORMAL);
-      std::vector<std::vector<cv::Point> > contours;
-      std::vector<cv::Vec4i> hierarchy;
-      cv::findContours(data, contours, hierarchy, CV_RETR_TREE, CV_CHAIN_APPROX_SIMPLE);
-      cv::Mat labels(height, width, CV_16UC1, mpLabels->getRawData());
-      mProgress.report("Filling blobs", 50, NORMAL);
-      unsigned short lastLabel = 0;
-      fillContours(labels, contours, hierarchy, lastLabel, 0, 0);
-
-      // create a pseudocolor layer for display
-      mProgress.report("Displaying results", 90, NORMAL);
-      mpLabels->updateData();
-      if (!createPseudocolor(lastLabel))
+      unsigned int offset = static_cast<unsigned int>(runs.size());
+      runs.insert(runs.end(), tile->mRuns.begin(), tile->mRuns.end());
+      for (std::vector<unsigned int>::const_iterator parent = tile->mParents.begin();
+         parent != tile->mParents.end(); ++parent)
       {
-         mProgress.report("Unable to create blob layer", 0, ERRORS, true);
-         return false;
+         parents.push_back(*parent + offset);
+      }
+      std::vector<Run>().swap(tile->mRuns);
+      std::vector<unsigned int>().swap(tile->mParents);
+
+      unsigned int currentEnd = offset;
+      while (currentEnd < runs.size() && runs[currentEnd].mRow == runs[offset].mRow)
+      {
+         ++currentEnd;
       }
+      if (previousEnd > previousBegin && runs[previousBegin].mRow + 1 == runs[offset].mRow)
+      {
+         uniteRows(runs, parents, previousBegin, previousEnd, offset, currentEnd);
+      }
+      previousBegin = static_cast<unsigned int>(runs.size());
+      while (previousBegin > offset && runs[previousBegin - 1].mRow == runs.back().mRow)
+      {
+         --previousBegin;
+      }
+      previousEnd = static_cast<unsigned int>(runs.size());
+   }
 
-      // add blob count to the metadata
-      DynamicObject* pMeta = pLabels->getMetadata();
-      VERIFY(pMeta);
-      unsigned int numBlobs = static_cast<unsigned int>(lastLabel);
-      pMeta->setAttribute("BlobCount", numBlobs);
-      if (numBlobs == 0 && !isBatch())
+   /**********
+    * Assign labels in raster order and collect the blob statistics
+    **********/
+   mProgress.report("Filling blobs", 85, NORMAL);
+   std::vector<unsigned int> labels(runs.size(), 0);
+   std::vector<unsigned int> areas;
+   std::vector<double> centroidX;
+   std::vector<double> centroidY;
+   std::vector<int> minX;
+   std::vector<int> minY;
+   std::vector<int> maxX;
+   std::vector<int> maxY;
+   for (std::vector<Run>::size_type idx = 0; idx < runs.size(); ++idx)
+   {
+      unsigned int root = findRoot(parents, static_cast<unsigned int>(idx));
+      if (root == idx)
       {
-         // Inform the user that there were no blobs so they don't think there was an
-         // error running the algorithm. No need to do this in batch since this is
-         // represented in the metadata already.
-         mProgress.report("No blobs were found.", 95, WARNING);
+         if (areas.size() >= std::numeric_limits<unsigned short>::max())
+         {
+            mProgress.report("More than 65535 blobs were found.", 0, ERRORS, true);
+            return false;
+         }
+         areas.push_back(0);
+         centroidX.push_back(0.0);
+         centroidY.push_back(0.0);
+         minX.push_back(std::numeric_limits<int>::max());
+         minY.push_back(std::numeric_limits<int>::max());
+         maxX.push_back(std::numeric_limits<int>::min());
+         maxY.push_back(std::numeric_limits<int>::min());
+         labels[idx] = static_cast<unsigned int>(areas.size());
       }
-      // update the output arg list
-      if (pOutArgList != NULL)
+      else
       {
-         pOutArgList->setPlugInArgValue("Blobs", pLabels.get());
-         pOutArgList->setPlugInArgValue("Number of Blobs", &numBlobs);
+         labels[idx] = labels[root];
       }
+
+      const Run& run = runs[idx];
+      unsigned short label = static_cast<unsigned short>(labels[idx]);
+      unsigned int length = run.mEnd - run.mStart + 1;
+      std::fill_n(input.mpLabels + run.mRow * width + run.mStart, length, label);
+
+      unsigned int blob = labels[idx] - 1;
+      int x = static_cast<int>(run.mStart) + mXOffset;
+      int y = static_cast<int>(run.mRow) + mYOffset;
+      areas[blob] += length;
+      centroidX[blob] += length * (x + (length - 1) / 2.0);
+      centroidY[blob] += static_cast<double>(length) * y;
+      minX[blob] = std::min(minX[blob], x);
+      maxX[blob] = std::max(maxX[blob], x + static_cast<int>(length) - 1);
+      minY[blob] = std::min(minY[blob], y);
+      maxY[blob] = std::max(maxY[blob], y);
+   }
+   for (std::vector<unsigned int>::size_type blob = 0; blob < areas.size(); ++blob)
+   {
+      centroidX[blob] /= areas[blob];
+      centroidY[blob] /= areas[blob];
    }
-   catch(const cv::Exception& exc)
+
+   // create a pseudocolor layer for display
+   mProgress.report("Displaying results", 90, NORMAL);
+   mpLabels->updateData();
+   unsigned short lastLabel = static_cast<unsigned short>(areas.size());
+   if (!createPseudocolor(lastLabel))
    {
-      mProgress.report(exc.what(), 0, ERRORS, true);
+      mProgress.report("Unable to create blob layer", 0, ERRORS, true);
       return false;
    }
 
+   // add blob count and statistics to the metadata
+   DynamicObject* pMeta = pLabels->getMetadata();
+   VERIFY(pMeta);
+   unsigned int numBlobs = static_cast<unsigned int>(lastLabel);
+   pMeta->setAttribute("BlobCount", numBlobs);
+   pMeta->setAttributeByPath("Blob Statistics/Area", areas);
+   pMeta->setAttributeByPath("Blob Statistics/Centroid X", centroidX);
+   pMeta->setAttributeByPath("Blob Statistics/Centroid Y", centroidY);
+   pMeta->setAttributeByPath("Blob Statistics/Min X", minX);
+   pMeta->setAttributeByPath("Blob Statistics/Min Y", minY);
+   pMeta->setAttributeByPath("Blob Statistics/Max X", maxX);
+   pMeta->setAttributeByPath("Blob Statistics/Max Y", maxY);
+   if (numBlobs == 0 && !isBatch())
+   {
+      // Inform the user that there were no blobs so they don't think there was an
+      // error running the algorithm. No need to do this in batch since this is
+      // represented in the metadata already.
+      mProgress.report("No blobs were found.", 95, WARNING);
+   }
+   // update the output arg list
+   if (pOutArgList != NULL)
+   {
+      pOutArgList->setPlugInArgValue("Blobs", pLabels.get());
+      pOutArgList->setPlugInArgValue("Number of Blobs", &numBlobs);
+   }
+
    pLabels.release();
    mProgress.report("Labeling connected components", 100, NORMAL);
    mProgress.upALevel();
@@ -22,6 +22,7 @@
 #include "LayerList.h"
 #include "LocationType.h"
 #include "ModelServices.h"
+#include "MultiThreadedAlgorithm.h"
 #include "ObjectFactory.h"
 #include "PlugInArgList.h"
 #include "PlugInManagerServices.h"
@@ -38,24 +39,167 @@
 #include <QtCore/QList>
 #include <QtCore/QPoint>
 #include <QtGui/QApplication>
+#include <algorithm>
 #include <limits>
 #include <math.h>
-#if !defined(DEBUG)
-// boost optimizations on
-#define NDEBUG
-#endif
-#include <boost/numeric/ublas/matrix.hpp>
-#include <boost/numeric/ublas/matrix_proxy.hpp>
-#include <boost/numeric/ublas/symmetric.hpp>
-
-using namespace boost::numeric;
+#include <set>
+#include <utility>
+#include <vector>
 
 REGISTER_PLUGIN_BASIC(OpticksObjectFinding, QtCluster);
 
 namespace
 {
 typedef QList<QPoint> PointsType;
-typedef ublas::symmetric_matrix<int> MatrixType;
+
+/**
+ * Uniform grid over the points with cells at least as large as the cluster size,
+ * so every point in range of another point is in the same or an adjacent cell.
+ */
+class PointGrid
+{
+public:
+   PointGrid(const PointsType& points, double clusterSize) :
+      mPoints(points),
+      mClusterSize(clusterSize),
+      mCellSize(getCellSize(clusterSize))
+   {
+      mCells.reserve(points.size());
+      for (int idx = 0; idx < points.size(); ++idx)
+      {
+         mCells.push_back(std::make_pair(getCell(points[idx]), idx));
+      }
+      std::sort(mCells.begin(), mCells.end());
+   }
+
+   /**
+    * Locates every point in range of a point, including the point itself.
+    */
+   void getNeighbors(int index, std::vector<int>& neighbors) const
+   {
+      neighbors.clear();
+      const QPoint& a = mPoints[index];
+      CellType cell = getCell(a);
+      for (int cellX = cell.first - 1; cellX <= cell.first + 1; ++cellX)
+      {
+         for (int cellY = cell.second - 1; cellY <= cell.second + 1; ++cellY)
+         {
+            std::vector<EntryType>::const_iterator entry = std::lower_bound(mCells.begin(), mCells.end(),
+               std::make_pair(std::make_pair(cellX, cellY), -1));
+            for (; entry != mCells.end() && entry->first.first == cellX && entry->first.second == cellY; ++entry)
+            {
+               if (entry->second == index)
+               {
+                  neighbors.push_back(index);
+                  continue;
+               }
+               QPoint b = mPoints[entry->second];
+               QPoint c = b - a;
+               double distance = sqrt(static_cast<double>(c.x()) * c.x() + c.y() * c.y());
+               if (distance <= mClusterSize)
+               {
+                  neighbors.push_back(entry->second);
+               }
+            }
+         }
+      }
+   }
+
+private:
+   typedef std::pair<int, int> CellType;
+   typedef std::pair<CellType, int> EntryType;
+
+   // Clamp the cell size to the range of an int, since the cluster size comes from the user
+   static int getCellSize(double clusterSize)
+   {
+      double cellSize = ceil(clusterSize);
+      if (!(cellSize >= 1.0))
+      {
+         return 1;
+      }
+      if (cellSize >= static_cast<double>(std::numeric_limits<int>::max()))
+      {
+         return std::numeric_limits<int>::max();
+      }
+      return static_cast<int>(cellSize);
+   }
+
+   CellType getCell(const QPoint& point) const
+   {
+      return std::make_pair(floorDivide(point.x()), floorDivide(point.y()));
+   }
+
+   int floorDivide(int value) const
+   {
+      return value >= 0 ? value / mCellSize : -((-value - 1) / mCellSize) - 1;
+   }
+
+   const PointsType& mPoints;
+   double mClusterSize;
+   int mCellSize;
+   std::vector<EntryType> mCells;
+};
+
+struct NeighborCountInput
+{
+   NeighborCountInput() :
+      mpGrid(NULL),
+      mpCounts(NULL),
+      mpAbortFlag(NULL)
+   {}
+
+   const PointGrid* mpGrid;
+   std::vector<int>* mpCounts;
+   const bool* mpAbortFlag;
+};
+
+class NeighborCountThread : public mta::AlgorithmThread
+{
+public:
+   NeighborCountThread(const NeighborCountInput& input, int threadCount, int threadIndex,
+      mta::ThreadReporter& reporter) :
+      mta::AlgorithmThread(threadIndex, reporter),
+      mInput(input),
+      mThreadCount(threadCount),
+      mPointCount(static_cast<int>(input.mpCounts->size()))
+   {}
+
+   void run()
+   {
+      // Points in dense areas have more neighbors, so points are claimed in chunks and
+      // threads which finish first go on to help the other threads
+      std::vector<int> neighbors;
+      mta::AlgorithmThread::Range range;
+      while (getNextRange(mThreadCount, mPointCount, range))
+      {
+         if (mInput.mpAbortFlag != NULL && *mInput.mpAbortFlag)
+         {
+            break;
+         }
+
+         for (int idx = range.mFirst; idx <= range.mLast; ++idx)
+         {
+            mInput.mpGrid->getNeighbors(idx, neighbors);
+            (*mInput.mpCounts)[idx] = static_cast<int>(neighbors.size());
+         }
+      }
+   }
+
+private:
+   NeighborCountThread& operator=(const NeighborCountThread& rhs);
+
+   const NeighborCountInput& mInput;
+   int mThreadCount;
+   int mPointCount;
+};
+
+struct NeighborCountOutput
+{
+   bool compileOverallResults(const std::vector<NeighborCountThread*>& threads)
+   {
+      return true;
+   }
+};
 }
 
 QtCluster::QtCluster()
@@ -179,11 +323,6 @@ bool QtCluster::execute(PlugInArgList* pInArgList, PlugInArgList* pOutArgList)
          progress.report("No points in the AOI.", 0, ERRORS, true);
          return false;
       }
-      if (pOrigMaskIt->getCount() > sqrt(static_cast<double>(std::numeric_limits<unsigned int>::max())))
-      {
-         progress.report("Too many points in the AOI.", 0, ERRORS, true);
-         return false;
-      }
    }
    else
    {
@@ -192,11 +331,6 @@ bool QtCluster::execute(PlugInArgList* pInArgList, PlugInArgList* pOutArgList)
          progress.report("No points in the AOI.", 0, ERRORS, true);
          return false;
       }
-      if (pOrigMask->getCount() > sqrt(static_cast<double>(std::numeric_limits<unsigned int>::max())))
-      {
-         progress.report("Too many points in the AOI.", 0, ERRORS, true);
-         return false;
-      }
    }
    if (!isBatch() && pOrigMask->getCount() > 10000)
    {
@@ -301,7 +435,7 @@ bool QtCluster::execute(PlugInArgList* pInArgList, PlugInArgList* pOutArgList)
    }
 
    /**********
-    * Calculate pairwise distances
+    * Collect the AOI points
     **********/
    PointsType points;
    int bx1, bx2, by1, by2;
@@ -346,50 +480,52 @@ bool QtCluster::execute(PlugInArgList* pInArgList, PlugInArgList* pOutArgList)
    }
    delete pOrigMaskIt;
    /**********
-    * Calculate in range points
+    * Count the in range points of each point
     **********/
-   MatrixType inRange(points.size(), points.size());
-   numToIncPercentage = points.size() / 99;
-   if (numToIncPercentage <= 0)
+   PointGrid grid(points, clusterSize);
+   std::vector<int> counts(points.size(), 0);
+   if (points.empty() == false)
    {
-      numToIncPercentage = 1;
+      NeighborCountInput countInput;
+      countInput.mpGrid = &grid;
+      countInput.mpCounts = &counts;
+      countInput.mpAbortFlag = &mAborted;
+      NeighborCountOutput countOutput;
+      mta::ProgressObjectReporter reporter("Calculating distances", progress.getCurrentProgress());
+      mta::MultiThreadedAlgorithm<NeighborCountInput, NeighborCountOutput, NeighborCountThread>
+         alg(mta::getNumRequiredThreads(points.size()), countInput, countOutput, &reporter);
+      if (alg.run() != mta::SUCCESS)
+      {
+         progress.report("Unable to calculate distances.", 0, ERRORS, true);
+         return false;
+      }
    }
-   else if (numToIncPercentage > 100)
+   if (isAborted())
    {
-      numToIncPercentage = 100;
+      progress.report("User aborted", 0, ABORT, true);
+      return false;
    }
-   progress.report("Calculating distance matrix", 0, NORMAL);
-   for (int start = 0; start < points.size(); ++start)
+
+   // Ordered by decreasing count then increasing index so the first candidate is the next cluster seed
+   std::set<std::pair<int, int> > candidates;
+   for (int idx = 0; idx < points.size(); ++idx)
    {
-      inRange(start, start) = 1;
-      if (start % numToIncPercentage == 0)
-      {
-         if (isAborted())
-         {
-            progress.report("User aborted", 0, ABORT, true);
-            return false;
-         }
-         progress.report("Calculating distance matrix", 99 * start / points.size(), NORMAL);
-      }
-      for (int end = start+1; end < points.size(); ++end)
-      {
-         QPoint a = points[start];
-         QPoint b = points[end];
-         QPoint c = b - a;
-         double distance = sqrt(static_cast<double>(c.x()) * c.x() + c.y() * c.y());
-         // if the pairwise distance is larger than the cluster size,
-         // these two points will never be in a cluster together so
-         // we throw them out
-         inRange(start,end) = (distance <= clusterSize) ? 1 : 0;
-      }
+      candidates.insert(std::make_pair(-counts[idx], idx));
    }
 
    /**********
     * iterate until everything is clustered
     **********/
+   // This loop is serial. Each seed is the unclustered point with the most unclustered neighbors after the
+   // previous cluster has been removed, so a cluster cannot be located until the previous one is complete.
+   // Only the neighbor counting above runs on multiple threads; here each point is clustered once and each of
+   // its unclustered neighbors is updated once in the candidate set.
    int total = points.size();
    int pointsChosen = 0;
    int clusterNumber = 1;
+   std::vector<bool> clustered(points.size(), false);
+   std::vector<int> cluster;
+   std::vector<int> neighbors;
    progress.report("Locating clusters", 0, NORMAL);
    while (pointsChosen < total)
    {
@@ -402,64 +538,62 @@ bool QtCluster::execute(PlugInArgList* pInArgList, PlugInArgList* pOutArgList)
          .arg(clusterNumber-1).arg(total - pointsChosen).toStdString(),
          99 * pointsChosen / total, NORMAL);
 
-      int largest = -1;
-      int largestCount = 0;
-      for (int row = 0; row < points.size(); ++row)
-      {
-         int tmpCount = sum(ublas::matrix_row<MatrixType>(inRange, row));
-         if (tmpCount > largestCount)
-         {
-            largest = row;
-            largestCount = tmpCount;
-         }
-      }
-      if (largestCount == 0)
+      if (candidates.empty())
       {
          break;
       }
+      int largest = candidates.begin()->second;
+      int largestCount = counts[largest];
 
-      LocationType centroid(0, 0);
-
-      ublas::vector<int> row(inRange.size1());
-      for (size_t col = 0; col < inRange.size1(); ++col)
+      // The cluster is every unclustered point in range of the seed
+      grid.getNeighbors(largest, neighbors);
+      cluster.clear();
+      for (std::vector<int>::const_iterator neighbor = neighbors.begin(); neighbor != neighbors.end(); ++neighbor)
       {
-         row(col) = inRange(largest, col);
+         if (!clustered[*neighbor])
+         {
+            clustered[*neighbor] = true;
+            candidates.erase(std::make_pair(-counts[*neighbor], *neighbor));
+            cluster.push_back(*neighbor);
+         }
       }
-      for (size_t col = 0; col < row.size(); ++col)
+
+      LocationType centroid(0, 0);
+      for (std::vector<int>::size_type idx = 0; idx < cluster.size(); ++idx)
       {
-         if (col % 100 == 0)
+         if (idx % 100 == 0)
          {
             QApplication::processEvents();
          }
-         if (row(col) != 0)
-         {
-            ++pointsChosen;
-            centroid.mX += points[col].x();
-            centroid.mY += points[col].y();
+         int col = cluster[idx];
+         ++pointsChosen;
+         centroid.mX += points[col].x();
+         centroid.mY += points[col].y();
 
-            for (size_t idx = 0; idx < inRange.size1(); ++idx)
+         // The clustered point is no longer in range of its unclustered neighbors
+         grid.getNeighbors(col, neighbors);
+         for (std::vector<int>::const_iterator neighbor = neighbors.begin(); neighbor != neighbors.end(); ++neighbor)
+         {
+            if (!clustered[*neighbor])
             {
-               inRange(col, idx) = 0;
+               candidates.erase(std::make_pair(-counts[*neighbor], *neighbor));
+               candidates.insert(std::make_pair(-(--counts[*neighbor]), *neighbor));
             }
+         }
 
-            if (displayType == PSEUDO)
+         if (displayType == PSEUDO)
+         {
+            pPseudoAcc->toPixel(points[col].y(), points[col].x());
+            if (!pPseudoAcc.isValid())
             {
-               pPseudoAcc->toPixel(points[col].y(), points[col].x());
-               if (!pPseudoAcc.isValid())
-               {
-                  progress.report("Unable to access pseudocolor layer.", 0, ERRORS, true);
-                  return false;
-               }
-               *reinterpret_cast<unsigned char*>(pPseudoAcc->getColumn()) = clusterNumber;
+               progress.report("Unable to access pseudocolor layer.", 0, ERRORS, true);
+               return false;
             }
+            *reinterpret_cast<unsigned char*>(pPseudoAcc->getColumn()) = clusterNumber;
          }
       }
       centroid.mX /= largestCount;
       centroid.mY /= largestCount;
-      for (size_t idx = 0; idx < inRange.size1(); ++idx)
-      {
-         inRange(largest, idx) = 0;
-      }
 
       // adjust the centroid to the center of a pixel
       centroid.mX += 0.5;
@@ -25,6 +25,7 @@
 #include "FileResource.h"
 #include "MatrixFunctions.h"
 #include "MessageLogResource.h"
+#include "MultiThreadedAlgorithm.h"
 #include "ObjectResource.h"
 #include "PCA.h"
 #include "PcaDlg.h"
@@ -42,6 +43,7 @@
 #include "switchOnEncoding.h"
 #include "Undo.h"
 
+#include <algorithm>
 #include <fstream>
 #include <limits>
 #include <math.h>
@@ -355,111 +357,330 @@ void ComputeMaskedCov(T* pData, MaskInput* pInput)
    }
 }
 
-template<class T>
-void ComputePcaValue(T *pData, double* pPcaValue, double *pCoefficients, unsigned int numBands)
+// Intended for use with integer data types -- adds 0.5 for rounding.
+template <class T>
+void StorePcaValue(T* pPcaData, const double* pValue, const double* pMinVal, const double* pScaleFactor,
+   const int* pMinOutputVal)
 {
-   T* pInput = pData;
-   double* pCoef = pCoefficients;
-   *pPcaValue = 0.0;
+   *pPcaData = static_cast<T>(static_cast<int64_t>((*pValue - *pMinVal) * (*pScaleFactor) + 0.5) + *pMinOutputVal);
+}
 
-   for (unsigned int i = 0; i < numBands; ++i)
-   {
-      *pPcaValue += static_cast<double>(*pInput) * (*pCoef);
-      ++pInput;
-      ++pCoef;
-   }
+template <>
+void StorePcaValue<float>(float* pPcaData, const double* pValue, const double* pMinVal, const double* pScaleFactor,
+   const int* pMinOutputVal)
+{
+   *pPcaData = static_cast<float>((*pValue - *pMinVal) * (*pScaleFactor) + *pMinOutputVal);
 }
 
-template <class T>
-void ComputePcaRow(T* pData, double* pPcaData,  double* pCoefficients, unsigned int numCols, unsigned int numBands,
-                   double* pMinValue, double* pMaxValue)
+template <>
+void StorePcaValue<double>(double* pPcaData, const double* pValue, const double* pMinVal, const double* pScaleFactor,
+   const int* pMinOutputVal)
 {
-   T* pColumn = pData;
-   T* pInput = NULL;
-   double* pValue = pPcaData;
-   double* pCoef = NULL;
+   *pPcaData = static_cast<double>((*pValue - *pMinVal) * (*pScaleFactor) + *pMinOutputVal);
+}
 
-   for (unsigned int col = 0; col < numCols; ++col)
+// Scales the component values of a block of pixels and stores them in a BIP row of the PCA cube.
+template <class T>
+void StorePcaPixels(T* pPcaRow, const double* pValues, const vector<unsigned int>& columns,
+   unsigned int numComponents, const double* pMinValues, const double* pScaleFactors, const int* pMinOutputVal)
+{
+   for (vector<unsigned int>::size_type pixel = 0; pixel < columns.size(); ++pixel)
    {
-      *pValue = 0.0;
-      pInput = pColumn;
-      pCoef = pCoefficients;
-      for (unsigned int band = 0; band < numBands; ++band)
+      T* pPcaData = pPcaRow + static_cast<size_t>(columns[pixel]) * numComponents;
+      for (unsigned int comp = 0; comp < numComponents; ++comp)
       {
-         *pValue += (*pCoef * static_cast<double>(*pInput));
-         ++pCoef;
-         ++pInput;
+         StorePcaValue(pPcaData + comp, pValues + comp, pMinValues + comp, pScaleFactors + comp, pMinOutputVal);
       }
-      if (*pValue > *pMaxValue)
+      pValues += numComponents;
+   }
+}
+
+// Computes pResults = pPixels * pCoefficients, where pPixels is a pixelCount x numBands matrix
+// and pCoefficients is a numBands x numComponents matrix. The bands are processed in blocks
+// so that the coefficients being used stay in cache while every pixel in the block is projected.
+void ProjectPcaPixels(const double* pPixels, unsigned int pixelCount, const double* pCoefficients,
+   unsigned int numBands, unsigned int numComponents, double* pResults)
+{
+   const unsigned int bandBlock = max(1U, 16384U / numComponents);
+   fill(pResults, pResults + static_cast<size_t>(pixelCount) * numComponents, 0.0);
+   for (unsigned int firstBand = 0; firstBand < numBands; firstBand += bandBlock)
+   {
+      const unsigned int lastBand = min(firstBand + bandBlock, numBands);
+      for (unsigned int pixel = 0; pixel < pixelCount; ++pixel)
       {
-         *pMaxValue = *pValue;
+         const double* pPixel = pPixels + static_cast<size_t>(pixel) * numBands;
+         double* const pResult = pResults + static_cast<size_t>(pixel) * numComponents;
+         for (unsigned int band = firstBand; band < lastBand; ++band)
+         {
+            const double value = pPixel[band];
+            const double* const pCoef = pCoefficients + static_cast<size_t>(band) * numComponents;
+            for (unsigned int comp = 0; comp < numComponents; ++comp)
+            {
+               pResult[comp] += value * pCoef[comp];
+            }
+         }
       }
+   }
+}
 
-      if (*pValue < *pMinValue)
+struct PcaProjectionInput
+{
+   PcaProjectionInput() :
+      mpRaster(NULL),
+      mpPcaRaster(NULL),
+      mpMask(NULL),
+      mpAbortFlag(NULL),
+      mFirstRow(0),
+      mLastRow(-1),
+      mFirstColumn(0),
+      mLastColumn(-1),
+      mNumBands(0),
+      mNumComponents(0),
+      mMinOutputValue(0)
+   {}
+
+   const RasterElement* mpRaster;
+   RasterElement* mpPcaRaster;      // NULL when only computing the range of each component
+   const BitMaskIterator* mpMask;   // NULL when projecting every pixel
+   const bool* mpAbortFlag;
+   int mFirstRow;
+   int mLastRow;
+   int mFirstColumn;
+   int mLastColumn;
+   unsigned int mNumBands;
+   unsigned int mNumComponents;
+   vector<double> mCoefficients;    // numBands x numComponents
+   vector<double> mMinValues;
+   vector<double> mScaleFactors;
+   int mMinOutputValue;
+};
+
+class PcaProjectionThread : public mta::AlgorithmThread
+{
+public:
+   PcaProjectionThread(const PcaProjectionInput& input, int threadCount, int threadIndex,
+      mta::ThreadReporter& reporter) :
+      mta::AlgorithmThread(threadIndex, reporter),
+      mInput(input),
+      mThreadCount(threadCount),
+      mRowCount(input.mLastRow - input.mFirstRow + 1),
+      mComplete(false),
+      mMinValues(input.mNumComponents, numeric_limits<double>::max()),
+      mMaxValues(input.mNumComponents, -numeric_limits<double>::max())
+   {}
+
+   void run()
+   {
+      const RasterDataDescriptor* pDescriptor =
+         dynamic_cast<const RasterDataDescriptor*>(mInput.mpRaster->getDataDescriptor());
+      if (pDescriptor != NULL)
       {
-         *pMinValue = *pValue;
+         switchOnEncoding(pDescriptor->getDataType(), projectRows, NULL, pDescriptor);
       }
+   }
 
-      ++pValue;
-      pColumn += numBands;
+   bool isComplete() const
+   {
+      return mComplete;
    }
-}
 
-// Intended for use with integer data types -- adds 0.5 for rounding.
-template <class T>
-void StorePcaRow(T* pPcaData, double* pCompValues, unsigned int numCols, unsigned int numComponents,
-   double minVal, double scaleFactor, int minOutputVal)
-{
-   for (unsigned int col = 0; col < numCols; ++col)
+   const vector<double>& getMinValues() const
    {
-      *pPcaData = static_cast<T>(static_cast<int64_t>((*pCompValues - minVal) * scaleFactor + 0.5) + minOutputVal);
-      ++pCompValues;
-      pPcaData += numComponents;
+      return mMinValues;
    }
-}
 
-template <>
-void StorePcaRow<float>(float* pPcaData, double* pCompValues, unsigned int numCols, unsigned int numComponents,
-   double minVal, double scaleFactor, int minOutputVal)
-{
-   for (unsigned int col = 0; col < numCols; ++col)
+   const vector<double>& getMaxValues() const
    {
-      *pPcaData = static_cast<float>((*pCompValues - minVal) * scaleFactor + minOutputVal);
-      ++pCompValues;
-      pPcaData += numComponents;
+      return mMaxValues;
    }
-}
 
-template <>
-void StorePcaRow<double>(double* pPcaData, double* pCompValues, unsigned int numCols, unsigned int numComponents,
-   double minVal, double scaleFactor, int minOutputVal)
-{
-   for (unsigned int col = 0; col < numCols; ++col)
+private:
+   PcaProjectionThread& operator=(const PcaProjectionThread& rhs);
+
+   template<class T>
+   void projectRows(T* pDummy, const RasterDataDescriptor* pDescriptor)
    {
-      *pPcaData = static_cast<double>((*pCompValues - minVal) * scaleFactor + minOutputVal);
-      ++pCompValues;
-      pPcaData += numComponents;
+      // Rows are claimed in chunks, so threads whose rows are mostly outside
+      // of the mask go on to help the other threads
+      mta::AlgorithmThread::Range range;
+      while (getNextRange(mThreadCount, mRowCount, range))
+      {
+         if (mInput.mpAbortFlag != NULL && *mInput.mpAbortFlag)
+         {
+            return;
+         }
+
+         if (projectRange(pDummy, pDescriptor, range) == false)
+         {
+            return;
+         }
+      }
+
+      mComplete = true;
    }
-}
 
-// Intended for use with integer data types -- adds 0.5 for rounding.
-template <class T>
-void StorePcaValue(T* pPcaData, double* pValue, double* pMinVal, double* pScaleFactor, int* pMinOutputVal)
-{
-   *pPcaData = static_cast<T>(static_cast<int64_t>((*pValue - *pMinVal) * (*pScaleFactor) + 0.5) + *pMinOutputVal);
-}
+   template<class T>
+   bool projectRange(T*, const RasterDataDescriptor* pDescriptor, const mta::AlgorithmThread::Range& range)
+   {
+      static const unsigned int sPixelBlock = 64;
+      const int firstRow = mInput.mFirstRow + range.mFirst;
+      const int lastRow = mInput.mFirstRow + range.mLast;
+      const unsigned int numBands = mInput.mNumBands;
+      const unsigned int numComponents = mInput.mNumComponents;
 
-template <>
-void StorePcaValue<float>(float* pPcaData, double* pValue, double* pMinVal, double* pScaleFactor, int* pMinOutputVal)
-{
-   *pPcaData = static_cast<float>((*pValue - *pMinVal) * (*pScaleFactor) + *pMinOutputVal);
-}
+      FactoryResource<DataRequest> pRequest;
+      pRequest->setInterleaveFormat(BIP);
+      pRequest->setRows(pDescriptor->getActiveRow(firstRow), pDescriptor->getActiveRow(lastRow));
+      pRequest->setColumns(pDescriptor->getActiveColumn(mInput.mFirstColumn),
+         pDescriptor->getActiveColumn(mInput.mLastColumn));
+      DataAccessor accessor = mInput.mpRaster->getDataAccessor(pRequest.release());
+      if (!accessor.isValid())
+      {
+         return false;
+      }
 
-template <>
-void StorePcaValue<double>(double* pPcaData, double* pValue, double* pMinVal, double* pScaleFactor, int* pMinOutputVal)
+      DataAccessor pcaAccessor(NULL, NULL);
+      EncodingType pcaDataType;
+      if (mInput.mpPcaRaster != NULL)
+      {
+         const RasterDataDescriptor* pPcaDescriptor =
+            dynamic_cast<const RasterDataDescriptor*>(mInput.mpPcaRaster->getDataDescriptor());
+         if (pPcaDescriptor == NULL)
+         {
+            return false;
+         }
+
+         pcaDataType = pPcaDescriptor->getDataType();
+         FactoryResource<DataRequest> pPcaRequest;
+         pPcaRequest->setInterleaveFormat(BIP);
+         pPcaRequest->setRows(pPcaDescriptor->getActiveRow(firstRow), pPcaDescriptor->getActiveRow(lastRow));
+         pPcaRequest->setColumns(pPcaDescriptor->getActiveColumn(mInput.mFirstColumn),
+            pPcaDescriptor->getActiveColumn(mInput.mLastColumn));
+         pPcaRequest->setWritable(true);
+         pcaAccessor = mInput.mpPcaRaster->getDataAccessor(pPcaRequest.release());
+         if (!pcaAccessor.isValid())
+         {
+            return false;
+         }
+      }
+
+      vector<double> pixels(sPixelBlock * numBands);
+      vector<double> results(sPixelBlock * numComponents);
+      vector<unsigned int> columns;
+      columns.reserve(sPixelBlock);
+      const unsigned int numColumns = static_cast<unsigned int>(mInput.mLastColumn - mInput.mFirstColumn + 1);
+      for (int row = firstRow; row <= lastRow; ++row)
+      {
+         accessor->toPixel(row, mInput.mFirstColumn);
+         if (!accessor.isValid())
+         {
+            return false;
+         }
+         const T* pRow = reinterpret_cast<const T*>(accessor->getColumn());
+
+         void* pPcaRow = NULL;
+         if (mInput.mpPcaRaster != NULL)
+         {
+            pcaAccessor->toPixel(row, mInput.mFirstColumn);
+            if (!pcaAccessor.isValid())
+            {
+               return false;
+            }
+            pPcaRow = pcaAccessor->getColumn();
+         }
+
+         for (unsigned int firstColumn = 0; firstColumn < numColumns; firstColumn += sPixelBlock)
+         {
+            // Gather the selected pixels of the block as doubles
+            const unsigned int lastColumn = min(firstColumn + sPixelBlock, numColumns);
+            columns.clear();
+            double* pPixel = &pixels.front();
+            for (unsigned int column = firstColumn; column < lastColumn; ++column)
+            {
+               if (mInput.mpMask != NULL &&
+                  !mInput.mpMask->getPixel(mInput.mFirstColumn + static_cast<int>(column), row))
+               {
+                  continue;
+               }
+
+               const T* pData = pRow + static_cast<size_t>(column) * numBands;
+               for (unsigned int band = 0; band < numBands; ++band)
+               {
+                  *pPixel++ = static_cast<double>(pData[band]);
+               }
+               columns.push_back(column);
+            }
+            if (columns.empty())
+            {
+               continue;
+            }
+
+            const unsigned int pixelCount = static_cast<unsigned int>(columns.size());
+            ProjectPcaPixels(&pixels.front(), pixelCount, &mInput.mCoefficients.front(),
+               numBands, numComponents, &results.front());
+            if (pPcaRow == NULL)
+            {
+               const double* pResult = &results.front();
+               for (unsigned int pixel = 0; pixel < pixelCount; ++pixel)
+               {
+                  for (unsigned int comp = 0; comp < numComponents; ++comp, ++pResult)
+                  {
+                     mMinValues[comp] = min(mMinValues[comp], *pResult);
+                     mMaxValues[comp] = max(mMaxValues[comp], *pResult);
+                  }
+               }
+            }
+            else
+            {
+               switchOnEncoding(pcaDataType, StorePcaPixels, pPcaRow, &results.front(), columns, numComponents,
+                  &mInput.mMinValues.front(), &mInput.mScaleFactors.front(), &mInput.mMinOutputValue);
+            }
+         }
+      }
+
+      return true;
+   }
+
+   const PcaProjectionInput& mInput;
+   int mThreadCount;
+   int mRowCount;
+   bool mComplete;
+   vector<double> mMinValues;
+   vector<double> mMaxValues;
+};
+
+struct PcaProjectionOutput
 {
-   *pPcaData = static_cast<double>((*pValue - *pMinVal) * (*pScaleFactor) + *pMinOutputVal);
-}
+   bool compileOverallResults(const vector<PcaProjectionThread*>& threads)
+   {
+      for (vector<PcaProjectionThread*>::const_iterator thread = threads.begin(); thread != threads.end(); ++thread)
+      {
+         if ((*thread)->isComplete() == false)
+         {
+            return false;
+         }
+
+         const vector<double>& minValues = (*thread)->getMinValues();
+         const vector<double>& maxValues = (*thread)->getMaxValues();
+         if (mMinValues.empty())
+         {
+            mMinValues = minValues;
+            mMaxValues = maxValues;
+            continue;
+         }
+
+         for (vector<double>::size_type comp = 0; comp < mMinValues.size(); ++comp)
+         {
+            mMinValues[comp] = min(mMinValues[comp], minValues[comp]);
+            mMaxValues[comp] = max(mMaxValues[comp], maxValues[comp]);
+         }
+      }
+      return true;
+   }
+
+   vector<double> mMinValues;
+   vector<double> mMaxValues;
+};
 
 REGISTER_PLUGIN_BASIC(OpticksPCA, PCA);
 
@@ -1223,10 +1444,8 @@ bool PCA::createPCACube()
 
 bool PCA::computePCAwhole()
 {
-   QString message;
-
    const RasterDataDescriptor* pPcaDesc = dynamic_cast<RasterDataDescriptor*>(mpPCARaster->getDataDescriptor());
-   EncodingType pcaDataType = pPcaDesc->getDataType();
+   VERIFY(pPcaDesc != NULL);
    unsigned int pcaNumRows = pPcaDesc->getRowCount();
    unsigned int pcaNumCols = pPcaDesc->getColumnCount();
    unsigned int pcaNumBands = pPcaDesc->getBandCount();
@@ -1242,198 +1461,15 @@ bool PCA::computePCAwhole()
       return false;
    }
 
-   FactoryResource<DataRequest> pBipRequest;
-   pBipRequest->setInterleaveFormat(BIP);
-   DataAccessor pcaAccessor = mpPCARaster->getDataAccessor(pBipRequest->copy());
-   if (!pcaAccessor.isValid())
-   {
-      mMessage = "PCA could not obtain an accessor the PCA RasterElement";
-      if (mpProgress != NULL)
-      {
-         mpProgress->updateProgress(mMessage, 0, ERRORS);
-      }
-
-      mpStep->finalize(Message::Failure, mMessage);
-      return false;
-   }
-
-   const RasterDataDescriptor* pOrigDescriptor = dynamic_cast<const RasterDataDescriptor*>
-      (mpRaster->getDataDescriptor());
-   if (pOrigDescriptor == NULL)
-   {
-      mMessage = "PCA received null pointer to the source data descriptor";
-      if (mpProgress != NULL)
-      {
-         mpProgress->updateProgress(mMessage, 0, ERRORS);
-      }
-
-      mpStep->finalize(Message::Failure, mMessage);
-      return false;
-   }
-
-   EncodingType eDataType = pOrigDescriptor->getDataType();
-   if (!eDataType.isValid())
-   {
-      mMessage = "PCA received invalid value for source data encoding type";
-      if (mpProgress != NULL)
-      {
-         mpProgress->updateProgress(mMessage, 0, ERRORS);
-      }
-
-      mpStep->finalize(Message::Failure, mMessage);
-      return false;
-   }
-
-   // Initialize progress bar variables
-   int currentProgress = 0;
-
-   void* pPCAData = NULL;
-   void* pOrigData = NULL;
-
-   DataAccessor origAccessor = mpRaster->getDataAccessor(pBipRequest->copy());
-   if (!origAccessor.isValid())
-   {
-      mMessage = "Could not get the pixels in the original cube!";
-      if (mpProgress != NULL)
-      {
-         mpProgress->updateProgress(mMessage, currentProgress, ERRORS);
-      }
-
-      mpStep->finalize(Message::Failure, mMessage);
-      return false;
-   }
-
-   // Set the PCA cube data values
-   double min = 0.0;
-   double max = 0.0;
-   double scalefactor = 0.0;
-
-   string compValuesName = "PcaComponentValues";
-   RasterElement* pOldComponentValues = dynamic_cast<RasterElement*>(
-      Service<ModelServices>()->getElement(compValuesName, TypeConverter::toString<RasterElement>(), mpRaster));
-   if (pOldComponentValues != NULL)
-   {
-      VERIFY(Service<ModelServices>()->destroyElement(pOldComponentValues));
-   }
-
-   ModelResource<RasterElement> pComponentValues(RasterUtilities::createRasterElement(compValuesName,
-      mNumRows, mNumColumns, FLT8BYTES, true, mpRaster));
-   if (pComponentValues.get() == NULL)
-   {
-      mMessage = "Out of memory";
-      if (mpProgress != NULL)
-      {
-         mpProgress->updateProgress(mMessage, 0, ERRORS);
-      }
-
-      mpStep->finalize(Message::Failure, mMessage);
-      return false;
-   }
-
-   FactoryResource<DataRequest> pBipWritableRequest;
-   pBipWritableRequest->setWritable(true);
-   pBipWritableRequest->setInterleaveFormat(BIP);
-
-   unsigned int comp = 0;
-   unsigned int row = 0;
-   unsigned int band = 0;
-   double* pValues = NULL;
-   vector<double> coefficients(mNumBands, 0);
-   double* pCoefficients = &coefficients.front();
-   int progSave = 0;
-   for (comp = 0; comp < mNumComponentsToUse; ++comp)
-   {
-      origAccessor = mpRaster->getDataAccessor(pBipRequest->copy());
-
-      DataAccessor compValAccessor = pComponentValues->getDataAccessor(pBipWritableRequest->copy());
-      for (band = 0; band < mNumBands; ++band)
-      {
-         pCoefficients[band] = mpMatrixValues[band][comp];
-      }
-      min = numeric_limits<double>::max();
-      max = numeric_limits<double>::min();
-      for (row = 0; row < mNumRows; ++row)
-      {
-         VERIFY(origAccessor.isValid());
-         pOrigData = origAccessor->getRow();
-         VERIFY(compValAccessor.isValid());
-         pValues = reinterpret_cast<double*>(compValAccessor->getRow());
-         switchOnEncoding(eDataType, ComputePcaRow, pOrigData, pValues,
-            pCoefficients, mNumColumns, mNumBands, &min, &max);
-         origAccessor->nextRow();
-         compValAccessor->nextRow();
-      }
-
-      // check if aborted
-      if (!isAborted())
-      {
-         // scale component values and save in pPCACube -- need the int64_t cast to prevent overflow/underflow
-         scalefactor = static_cast<double>(static_cast<int64_t>(mMaxScaleValue) - mMinScaleValue) / (max - min);
-
-         FactoryResource<DataRequest> pPcaRequest;
-         pPcaRequest->setBands(pPcaDesc->getActiveBand(comp), pPcaDesc->getActiveBand(comp));
-         pPcaRequest->setWritable(true);
-         DataAccessor pcaAccessor = mpPCARaster->getDataAccessor(pPcaRequest.release());
-         if (!pcaAccessor.isValid())
-         {
-            mMessage = "Could not get the pixels in the PCA cube!";
-            if (mpProgress != NULL)
-            {
-               mpProgress->updateProgress(mMessage, currentProgress, ERRORS);
-            }
-
-            mpStep->finalize(Message::Failure, mMessage);
-            return false;
-         }
-
-         compValAccessor = pComponentValues->getDataAccessor(pBipRequest->copy());
-         for (row = 0; row < mNumRows; ++row)
-         {
-            VERIFY(pcaAccessor.isValid());
-            pPCAData = pcaAccessor->getRow();
-            VERIFY(compValAccessor.isValid());
-            pValues = reinterpret_cast<double*>(compValAccessor->getRow());
-            switchOnEncoding(mOutputDataType, StorePcaRow, pPCAData, pValues, pcaNumCols, pcaNumBands,
-               min, scalefactor, mMinScaleValue);
-            pcaAccessor->nextRow();
-            compValAccessor->nextRow();
-
-            if (isAborted())
-            {
-               break;
-            }
-         }
-
-         currentProgress = 100 * (comp + 1) / mNumComponentsToUse;
-         if (mpProgress != NULL && currentProgress != progSave)
-         {
-            progSave = currentProgress;
-            mpProgress->updateProgress("Generating scaled PCA data cube...", currentProgress, NORMAL);
-         }
-      }
-   }
-
-   if (isAborted())
-   {
-      mpProgress->updateProgress("PCA aborted!", currentProgress, ABORT);
-      mpStep->finalize(Message::Abort);
-      return false;
-   }
-   if (mpProgress != NULL)
-   {
-      mpProgress->updateProgress("PCA computations complete!", 100, NORMAL);
-   }
-
-   return true;
+   return projectComponents(NULL, 0, 0, static_cast<int>(mNumColumns) - 1, static_cast<int>(mNumRows) - 1);
 }
 
 bool PCA::computePCAaoi()
 {
-   const RasterDataDescriptor* pPcaDescriptor = dynamic_cast<const RasterDataDescriptor*>(
-      mpPCARaster->getDataDescriptor());
-   if (pPcaDescriptor == NULL)
+   BitMaskIterator it(mpAoiBitMask, mpRaster);
+   if (it.getCount() == 0)
    {
-      mMessage = "PCA received null pointer to the PCA data RaterElement";
+      mMessage = "No pixels are selected in the AOI!";
       if (mpProgress != NULL)
       {
          mpProgress->updateProgress(mMessage, 0, ERRORS);
@@ -1443,11 +1479,21 @@ bool PCA::computePCAaoi()
       return false;
    }
 
+   int x1 = 0;
+   int y1 = 0;
+   int x2 = 0;
+   int y2 = 0;
+   it.getBoundingBox(x1, y1, x2, y2);
+   return projectComponents(&it, x1, y1, x2, y2);
+}
+
+bool PCA::projectComponents(const BitMaskIterator* pMask, int x1, int y1, int x2, int y2)
+{
    const RasterDataDescriptor* pOrigDescriptor = dynamic_cast<const RasterDataDescriptor*>
       (mpRaster->getDataDescriptor());
    if (pOrigDescriptor == NULL)
    {
-      mMessage = "PCA received null pointer to the source data RasterElement";
+      mMessage = "PCA received null pointer to the source data descriptor";
       if (mpProgress != NULL)
       {
          mpProgress->updateProgress(mMessage, 0, ERRORS);
@@ -1458,7 +1504,7 @@ bool PCA::computePCAaoi()
    }
 
    EncodingType eDataType = pOrigDescriptor->getDataType();
-   if (!eDataType.isValid())
+   if (!eDataType.isValid() || eDataType == INT4SCOMPLEX || eDataType == FLT8COMPLEX)
    {
       mMessage = "PCA received invalid value for source data encoding type";
       if (mpProgress != NULL)
@@ -1470,201 +1516,90 @@ bool PCA::computePCAaoi()
       return false;
    }
 
-   // Initialize progress bar variables
-   int currentProgress = 0;
-
-   void* pPCAData = NULL;
-   void* pOrigData = NULL;
-
-   // Set the PCA cube data values
-   double min = 0.0;
-   double max = 0.0;
-   double scalefactor = 0.0;
-   int x1 = 0;
-   int y1 = 0;
-   int x2 = 0;
-   int y2 = 0;
-   BitMaskIterator it(mpAoiBitMask, mpRaster);
-   it.getBoundingBox(x1, y1, x2, y2);
-
-   int numRows = y2 - y1 + 1;
-   int numCols = x2 - x1 + 1;
-
-   string compValuesName = "PcaComponentValues";
-   RasterElement* pOldComponentValues = dynamic_cast<RasterElement*>(
-      Service<ModelServices>()->getElement(compValuesName, TypeConverter::toString<RasterElement>(), mpRaster));
-   if (pOldComponentValues != NULL)
+   // Only the coefficients of the components being kept are used in the projection
+   PcaProjectionInput input;
+   input.mpRaster = mpRaster;
+   input.mpMask = pMask;
+   input.mpAbortFlag = &mAborted;
+   input.mFirstRow = y1;
+   input.mLastRow = y2;
+   input.mFirstColumn = x1;
+   input.mLastColumn = x2;
+   input.mNumBands = mNumBands;
+   input.mNumComponents = mNumComponentsToUse;
+   input.mMinOutputValue = mMinScaleValue;
+   input.mCoefficients.resize(static_cast<size_t>(mNumBands) * mNumComponentsToUse);
+   for (unsigned int band = 0; band < mNumBands; ++band)
    {
-      VERIFY(Service<ModelServices>()->destroyElement(pOldComponentValues));
-   }
-
-   ModelResource<RasterElement> pComponentValues(RasterUtilities::createRasterElement(compValuesName,
-      numRows, numCols, FLT8BYTES, true, mpRaster));
-   if (pComponentValues.get() == NULL)
-   {
-      mMessage = "Out of memory";
-      if (mpProgress != NULL)
+      for (unsigned int comp = 0; comp < mNumComponentsToUse; ++comp)
       {
-         mpProgress->updateProgress(mMessage, currentProgress, ERRORS);
+         input.mCoefficients[band * mNumComponentsToUse + comp] = mpMatrixValues[band][comp];
       }
-
-      mpStep->finalize(Message::Failure, mMessage);
-      return false;
    }
 
-   int comp = 0;
-   int band = 0;
-   vector<double> coefficients(mNumBands, 0);
-   double* pCoefficients = &coefficients.front();
-   double* pTempVal = NULL;
-   int progSave = 0;
-   for (comp = 0; comp < static_cast<int>(mNumComponentsToUse); ++comp)
+   // The first pass finds the range of each component so that the second pass
+   // can scale the components as they are written to the PCA cube
+   PcaProjectionOutput rangeOutput;
    {
-      FactoryResource<DataRequest> pRequest;
-      pRequest->setInterleaveFormat(BIP);
-      pRequest->setRows(pOrigDescriptor->getActiveRow(y1), pOrigDescriptor->getActiveRow(y2));
-      pRequest->setColumns(pOrigDescriptor->getActiveColumn(x1), pOrigDescriptor->getActiveColumn(x2));
-      pRequest->setBands(pOrigDescriptor->getActiveBand(comp), pOrigDescriptor->getActiveBand(comp));
-      DataAccessor accessor = mpRaster->getDataAccessor(pRequest.release());
-      if (!accessor.isValid())
+      mta::ProgressObjectReporter reporter("Computing PCA component ranges...", mpProgress);
+      mta::MultiThreadedAlgorithm<PcaProjectionInput, PcaProjectionOutput, PcaProjectionThread>
+         alg(mta::getNumRequiredThreads(y2 - y1 + 1), input, rangeOutput, &reporter);
+      if (alg.run() != mta::SUCCESS && !isAborted())
       {
          mMessage = "Could not get the pixels in the original cube!";
          if (mpProgress != NULL)
          {
-            mpProgress->updateProgress(mMessage, currentProgress, ERRORS);
+            mpProgress->updateProgress(mMessage, 0, ERRORS);
          }
 
          mpStep->finalize(Message::Failure, mMessage);
          return false;
       }
+   }
 
-      FactoryResource<DataRequest> pWritableRequest;
-      pWritableRequest->setWritable(true);
-      DataAccessor compValAccessor = pComponentValues->getDataAccessor(pWritableRequest.release());
-
-      for (band = 0; band < static_cast<int>(mNumBands); ++band)
-      {
-         pCoefficients[band] = mpMatrixValues[band][comp];
-      }
-      min = numeric_limits<double>::max();
-      max = numeric_limits<double>::min();
-
-      it.firstPixel();
-      LocationType loc;
-
-      while (it != it.end())
+   if (!isAborted())
+   {
+      input.mpPcaRaster = mpPCARaster;
+      input.mMinValues = rangeOutput.mMinValues;
+      input.mScaleFactors.resize(mNumComponentsToUse);
+      for (unsigned int comp = 0; comp < mNumComponentsToUse; ++comp)
       {
-         it.getPixelLocation(loc);
-         accessor->toPixel(loc.mY, loc.mX);
-         compValAccessor->toPixel(loc.mY - y1, loc.mX - x1);
-         VERIFY(accessor.isValid());
-         VERIFY(compValAccessor.isValid());
-
-         pTempVal = reinterpret_cast<double*>(compValAccessor->getColumn());
-         pOrigData = accessor->getColumn();
-         if (pOrigData == NULL)
-         {
-               mMessage = "Could not get the pixels in the Original cube!";
-            if (mpProgress != NULL)
-            {
-               mpProgress->updateProgress(mMessage, currentProgress, ERRORS);
-            }
-
-            mpStep->finalize(Message::Failure, mMessage);
-            return false;
-         }
-
-         switchOnEncoding(eDataType, ComputePcaValue, pOrigData, pTempVal, pCoefficients, mNumBands);
-
-         if (*pTempVal > max)
-         {
-            max = *pTempVal;
-         }
-         if (*pTempVal < min)
-         {
-            min = *pTempVal;
-         }
-         if (isAborted())
-         {
-            break;
-         }
-          ++it;
+         // need the int64_t cast to prevent overflow/underflow
+         input.mScaleFactors[comp] = static_cast<double>(static_cast<int64_t>(mMaxScaleValue) - mMinScaleValue) /
+            (rangeOutput.mMaxValues[comp] - rangeOutput.mMinValues[comp]);
       }
 
-      if (!isAborted())
+      PcaProjectionOutput pcaOutput;
+      mta::ProgressObjectReporter reporter("Generating scaled PCA data cube...", mpProgress);
+      mta::MultiThreadedAlgorithm<PcaProjectionInput, PcaProjectionOutput, PcaProjectionThread>
+         alg(mta::getNumRequiredThreads(y2 - y1 + 1), input, pcaOutput, &reporter);
+      if (alg.run() != mta::SUCCESS && !isAborted())
       {
-         // scale component values and save in pPCACube -- need the int64_t cast to prevent overflow/underflow
-         scalefactor = static_cast<double>(static_cast<int64_t>(mMaxScaleValue) - mMinScaleValue) / (max - min);
-
-         FactoryResource<DataRequest> pPcaRequest;
-         pPcaRequest->setRows(pPcaDescriptor->getActiveRow(y1), pPcaDescriptor->getActiveRow(y2));
-         pPcaRequest->setColumns(pPcaDescriptor->getActiveColumn(x1), pPcaDescriptor->getActiveColumn(x2));
-         pPcaRequest->setBands(pPcaDescriptor->getActiveBand(comp), pPcaDescriptor->getActiveBand(comp));
-         pPcaRequest->setWritable(true);
-         DataAccessor pcaAccessor = mpPCARaster->getDataAccessor(pPcaRequest.release());
-
-         if (!pcaAccessor.isValid())
-         {
-            mMessage = "Could not get the pixels in the PCA cube!";
-            if (mpProgress != NULL)
-            {
-               mpProgress->updateProgress(mMessage, currentProgress, ERRORS);
-            }
-
-            mpStep->finalize(Message::Failure, mMessage);
-            return false;
-         }
-
-         it.firstPixel();
-         compValAccessor = pComponentValues->getDataAccessor();
-         while (it != it.end())
-         {
-            it.getPixelLocation(loc);
-            pcaAccessor->toPixel(loc.mY, loc.mX);
-            compValAccessor->toPixel(loc.mY - y1, loc.mX - x1);
-            VERIFY(pcaAccessor.isValid());
-            VERIFY(compValAccessor.isValid());
-            pPCAData = pcaAccessor->getColumn();
-            pTempVal = reinterpret_cast<double*>(compValAccessor->getColumn());
-            if (pPCAData == NULL)
-            {
-               mMessage = "Could not get the pixels in the PCA cube!";
-               if (mpProgress != NULL)
-               {
-                  mpProgress->updateProgress(mMessage, currentProgress, ERRORS);
-               }
-
-               mpStep->finalize(Message::Failure, mMessage);
-               return false;
-            }
-
-            switchOnEncoding(mOutputDataType, StorePcaValue, pPCAData, pTempVal, &min, &scalefactor, &mMinScaleValue);
-            ++it;
-         }
-         if (isAborted())
+         mMessage = "Could not get the pixels in the PCA cube!";
+         if (mpProgress != NULL)
          {
-            break;
+            mpProgress->updateProgress(mMessage, 0, ERRORS);
          }
-      }
 
-      currentProgress = 100 * (comp + 1) / mNumComponentsToUse;
-      if (mpProgress != NULL && currentProgress != progSave)
-      {
-         progSave = currentProgress;
-         mpProgress->updateProgress("Generating scaled PCA data cube...", currentProgress, NORMAL);
+         mpStep->finalize(Message::Failure, mMessage);
+         return false;
       }
    }
 
    if (isAborted())
    {
-      mpProgress->updateProgress("PCA aborted!", currentProgress, ABORT);
+      if (mpProgress != NULL)
+      {
+         mpProgress->updateProgress("PCA aborted!", 0, ABORT);
+      }
+
       mpStep->finalize(Message::Abort);
       return false;
    }
 
    if (mpProgress != NULL)
    {
-      mpProgress->updateProgress("PCA computations complete!", 99, NORMAL);
+      mpProgress->updateProgress("PCA computations complete!", 100, NORMAL);
    }
 
    return true;
@@ -32,6 +32,7 @@
 class AlgorithmResource;
 class AoiElement;
 class ApplicationServices;
+class BitMaskIterator;
 class SpatialDataView;
 class Step;
 
@@ -67,6 +68,7 @@ private:
    bool readInPCAtransform(QString filename);
    bool computeCovarianceMatrix(QString aoiName = "", int rowSkip = 1, int colSkip = 1);
    bool getStatistics(std::vector<std::string> aoiList);
+   bool projectComponents(const BitMaskIterator* pMask, int x1, int y1, int x2, int y2);
    BitMask* mpAoiBitMask;
    bool mUseAoi;
    bool mDisplayResults;
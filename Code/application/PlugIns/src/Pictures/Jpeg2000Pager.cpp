@@ -11,8 +11,10 @@
 #include "AppVersion.h"
 #include "DataRequest.h"
 #include "DimensionDescriptor.h"
+#include "FileResource.h"
 #include "Jpeg2000Pager.h"
 #include "Jpeg2000Utilities.h"
+#include "MultiThreadedAlgorithm.h"
 #include "ObjectResource.h"
 #include "PlugInArgList.h"
 #include "PlugInRegistration.h"
@@ -24,18 +26,154 @@
 #include <QtCore/QString>
 #include <QtCore/QStringList>
 
+#include <algorithm>
 #include <limits>
 
 REGISTER_PLUGIN_BASIC(OpticksPictures, Jpeg2000Pager);
 
 size_t Jpeg2000Pager::msMaxCacheSize = 1024 * 1024 * 50; // Specify a cache size (50MB) larger than the default
                                                          // to minimize the number of calls to decode the image
+size_t Jpeg2000Pager::msMaxTileCacheSize = 1024 * 1024 * 64;
+
+namespace
+{
+   // The JPEG2000 data may be embedded in a larger file (e.g. a NITF image segment), so the
+   // stream positions used by OpenJPEG are relative to the offset of the JPEG2000 data
+   struct StreamData
+   {
+      LargeFileResource mFile;
+      int64_t mOffset;
+   };
+
+   OPJ_SIZE_T readStream(void* pBuffer, OPJ_SIZE_T numBytes, void* pUserData)
+   {
+      StreamData* pData = static_cast<StreamData*>(pUserData);
+      int64_t count = pData->mFile.read(pBuffer, static_cast<int64_t>(numBytes));
+      return (count > 0) ? static_cast<OPJ_SIZE_T>(count) : static_cast<OPJ_SIZE_T>(-1);
+   }
+
+   OPJ_OFF_T skipStream(OPJ_OFF_T numBytes, void* pUserData)
+   {
+      StreamData* pData = static_cast<StreamData*>(pUserData);
+      if (pData->mFile.seek(static_cast<int64_t>(numBytes), SEEK_CUR) < 0)
+      {
+         return -1;
+      }
+
+      return numBytes;
+   }
+
+   OPJ_BOOL seekStream(OPJ_OFF_T numBytes, void* pUserData)
+   {
+      StreamData* pData = static_cast<StreamData*>(pUserData);
+      int64_t position = pData->mOffset + static_cast<int64_t>(numBytes);
+      return (pData->mFile.seek(position, SEEK_SET) == position) ? OPJ_TRUE : OPJ_FALSE;
+   }
+
+   // The shared file handle is passed to OpenJPEG as a FILE*, so seek it with the 64-bit stdio functions
+   int seekFile(FILE* pFile, int64_t offset, int origin)
+   {
+#if defined(WIN_API)
+      return _fseeki64(pFile, offset, origin);
+#else
+      return fseeko64(pFile, offset, origin);
+#endif
+   }
+
+   int64_t tellFile(FILE* pFile)
+   {
+#if defined(WIN_API)
+      return _ftelli64(pFile);
+#else
+      return ftello64(pFile);
+#endif
+   }
+}
+
+/**
+ *  A codec and stream which have read the code stream header.
+ *
+ *  Each decoder is only used by one thread at a time.
+ */
+struct Jpeg2000Pager::Decoder
+{
+   StreamData mStreamData;
+   opj_stream_t* mpStream;
+   opj_codec_t* mpCodec;
+   opj_image_t* mpImage;
+   bool mValid;
+};
+
+/**
+ *  The decoded samples of one tile.
+ */
+struct Jpeg2000Pager::DecodedTile
+{
+   struct Component
+   {
+      unsigned int mX0;
+      unsigned int mY0;
+      unsigned int mWidth;
+      unsigned int mHeight;
+      unsigned int mDx;
+      unsigned int mDy;
+      std::vector<OPJ_INT32> mData;
+   };
+
+   std::vector<Component> mComponents;
+   size_t mBytes;
+};
+
+struct Jpeg2000Pager::TileDecodeInput
+{
+   std::vector<Decoder*>* mpDecoders;
+   const std::vector<unsigned int>* mpTiles;
+   std::vector<DecodedTile*>* mpResults;
+};
+
+class Jpeg2000Pager::TileDecodeThread : public mta::AlgorithmThread
+{
+public:
+   TileDecodeThread(const TileDecodeInput& input, int threadCount, int threadIndex, mta::ThreadReporter& reporter) :
+      mta::AlgorithmThread(threadIndex, reporter),
+      mInput(input),
+      mTileRange(getThreadRange(threadCount, static_cast<int>(input.mpTiles->size())))
+   {}
+
+   virtual void run()
+   {
+      Decoder* pDecoder = mInput.mpDecoders->at(getThreadIndex());
+      for (int i = mTileRange.mFirst; i <= mTileRange.mLast && pDecoder->mValid; ++i)
+      {
+         mInput.mpResults->at(i) = Jpeg2000Pager::decodeTile(pDecoder, mInput.mpTiles->at(i));
+      }
+   }
+
+private:
+   TileDecodeThread& operator=(const TileDecodeThread& rhs);
+
+   const TileDecodeInput& mInput;
+   Range mTileRange;
+};
 
 Jpeg2000Pager::Jpeg2000Pager() :
    CachedPager(msMaxCacheSize),
    mpFile(NULL),
    mOffset(0),
-   mSize(0)
+   mSize(0),
+   mTilesInitialized(false),
+   mDecoderType(-1),
+   mImageX0(0),
+   mImageY0(0),
+   mImageX1(0),
+   mImageY1(0),
+   mTileX0(0),
+   mTileY0(0),
+   mTileWidth(0),
+   mTileHeight(0),
+   mTilesAcross(0),
+   mTilesDown(0),
+   mTileCacheBytes(0)
 {
    setName("JPEG2000 Pager");
    setCopyright(APP_COPYRIGHT);
@@ -49,6 +187,12 @@ Jpeg2000Pager::Jpeg2000Pager() :
 
 Jpeg2000Pager::~Jpeg2000Pager()
 {
+   clearTiles();
+   for (std::vector<Decoder*>::iterator iter = mDecoders.begin(); iter != mDecoders.end(); ++iter)
+   {
+      destroyDecoder(*iter);
+   }
+
    if (mpFile != NULL)
    {
       fclose(mpFile);
@@ -108,6 +252,7 @@ bool Jpeg2000Pager::openFile(const std::string& filename)
    }
 
    mpFile = fopen(filename.c_str(), "rb");
+   mFilename = filename;
    return (mpFile != NULL);
 }
 
@@ -221,7 +366,7 @@ double Jpeg2000Pager::getChunkSize() const
 template <typename Out>
 CachedPage::UnitPtr Jpeg2000Pager::populateImageData(const DimensionDescriptor& startRow,
                                                      const DimensionDescriptor& startColumn,
-                                                     unsigned int concurrentRows, unsigned int concurrentColumns) const
+                                                     unsigned int concurrentRows, unsigned int concurrentColumns)
 {
    VERIFYRV(startRow.isOnDiskNumberValid() == true, CachedPage::UnitPtr());
    VERIFYRV(startColumn.isOnDiskNumberValid() == true, CachedPage::UnitPtr());
@@ -267,23 +412,8 @@ CachedPage::UnitPtr Jpeg2000Pager::populateImageData(const DimensionDescriptor&
       return CachedPage::UnitPtr();
    }
 
-   memset(pDest, 0, numPixels);
-
-   // Decode the image from the file, first trying the codestream format then the file format
-   opj_image_t* pImage = decodeImage(onDiskStartRow, onDiskStartColumn, onDiskStopRow, onDiskStopColumn,
-      Jpeg2000Utilities::J2K_CFMT);
-   if (pImage == NULL)
-   {
-      pImage = decodeImage(onDiskStartRow, onDiskStartColumn, onDiskStopRow, onDiskStopColumn,
-         Jpeg2000Utilities::JP2_CFMT);
-   }
-
-   if (pImage == NULL)
-   {
-      return CachedPage::UnitPtr();
-   }
+   memset(pDest, 0, numBytes);
 
-   // Populate the output image data
    int bandFactor = 1;
 
    std::string filename = pRaster->getFilename();
@@ -308,6 +438,36 @@ CachedPage::UnitPtr Jpeg2000Pager::populateImageData(const DimensionDescriptor&
 
    const size_t copySize = pDescriptor->getBytesPerElement() / bandFactor;
 
+   // Copy from the decoded tiles if the code stream is tiled
+   if (initializeTiles() == true)
+   {
+      if (copyFromTiles(pDest, onDiskStartRow, onDiskStartColumn, concurrentRows, concurrentColumns,
+         static_cast<unsigned int>(allBands.size()) * bandFactor, copySize) == true)
+      {
+         // Transfer ownership of the resulting data into a new page which will be owned by the caller
+         return CachedPage::UnitPtr(new CachedPage::CacheUnit(reinterpret_cast<char*>(pDestination.release()),
+            startRow, static_cast<int>(concurrentRows), numBytes));
+      }
+
+      // Decode the requested area instead
+      memset(pDest, 0, numBytes);
+   }
+
+   // Decode the image from the file, first trying the codestream format then the file format
+   opj_image_t* pImage = decodeImage(onDiskStartRow, onDiskStartColumn, onDiskStopRow, onDiskStopColumn,
+      Jpeg2000Utilities::J2K_CFMT);
+   if (pImage == NULL)
+   {
+      pImage = decodeImage(onDiskStartRow, onDiskStartColumn, onDiskStopRow, onDiskStopColumn,
+         Jpeg2000Utilities::JP2_CFMT);
+   }
+
+   if (pImage == NULL)
+   {
+      return CachedPage::UnitPtr();
+   }
+
+   // Populate the output image data
    for (unsigned int r = 0; r < concurrentRows; ++r)
    {
       for (unsigned int c = 0; c < concurrentColumns; ++c)
@@ -368,15 +528,15 @@ opj_image_t* Jpeg2000Pager::decodeImage(unsigned int originalStartRow, unsigned
    }
    else
    {
-      fseek(mpFile, 0, SEEK_END);
+      seekFile(mpFile, 0, SEEK_END);
 
-      size_t fileSize = static_cast<size_t>(ftell(mpFile));
-      if (fileSize <= mOffset)
+      int64_t fileSize = tellFile(mpFile);
+      if (fileSize < 0 || static_cast<uint64_t>(fileSize) <= mOffset)
       {
          return NULL;
       }
 
-      fileLength = fileSize - static_cast<size_t>(mOffset);
+      fileLength = static_cast<size_t>(fileSize - static_cast<int64_t>(mOffset));
    }
 
    opj_stream_t* pStream = opj_stream_create_file_stream(mpFile, fileLength, true);
@@ -388,7 +548,7 @@ opj_image_t* Jpeg2000Pager::decodeImage(unsigned int originalStartRow, unsigned
    opj_stream_set_user_data_length(pStream, fileLength);
 
    // Seek to the required position in the file
-   fseek(mpFile, static_cast<long>(mOffset), SEEK_SET);
+   seekFile(mpFile, static_cast<int64_t>(mOffset), SEEK_SET);
 
    // Create the appropriate codec
    opj_codec_t* pCodec = NULL;
@@ -456,3 +616,418 @@ opj_image_t* Jpeg2000Pager::decodeImage(unsigned int originalStartRow, unsigned
 
    return pImage;
 }
+
+Jpeg2000Pager::Decoder* Jpeg2000Pager::createDecoder(int decoderType) const
+{
+   if (mFilename.empty() == true)
+   {
+      return NULL;
+   }
+
+   Decoder* pDecoder = new Decoder;
+   pDecoder->mStreamData.mOffset = static_cast<int64_t>(mOffset);
+   pDecoder->mpStream = NULL;
+   pDecoder->mpCodec = NULL;
+   pDecoder->mpImage = NULL;
+   pDecoder->mValid = false;
+
+   // Each decoder has its own file handle since the stream position is part of the decoder state
+   if (pDecoder->mStreamData.mFile.open(mFilename, O_RDONLY | O_BINARY, S_IREAD) == false)
+   {
+      destroyDecoder(pDecoder);
+      return NULL;
+   }
+
+   size_t fileLength = 0;
+   if (mSize > 0)
+   {
+      fileLength = static_cast<size_t>(mSize);
+   }
+   else
+   {
+      int64_t fileSize = pDecoder->mStreamData.mFile.fileLength();
+      if (fileSize < 0 || static_cast<uint64_t>(fileSize) <= mOffset)
+      {
+         destroyDecoder(pDecoder);
+         return NULL;
+      }
+
+      fileLength = static_cast<size_t>(fileSize - pDecoder->mStreamData.mOffset);
+   }
+
+   if (pDecoder->mStreamData.mFile.seek(pDecoder->mStreamData.mOffset, SEEK_SET) != pDecoder->mStreamData.mOffset)
+   {
+      destroyDecoder(pDecoder);
+      return NULL;
+   }
+
+   pDecoder->mpStream = opj_stream_create(OPJ_J2K_STREAM_CHUNK_SIZE, OPJ_TRUE);
+   if (pDecoder->mpStream == NULL)
+   {
+      destroyDecoder(pDecoder);
+      return NULL;
+   }
+
+   opj_stream_set_user_data(pDecoder->mpStream, &pDecoder->mStreamData);
+   opj_stream_set_user_data_length(pDecoder->mpStream, fileLength);
+   opj_stream_set_read_function(pDecoder->mpStream, readStream);
+   opj_stream_set_skip_function(pDecoder->mpStream, skipStream);
+   opj_stream_set_seek_function(pDecoder->mpStream, seekStream);
+
+   switch (decoderType)
+   {
+   case Jpeg2000Utilities::J2K_CFMT:
+      pDecoder->mpCodec = opj_create_decompress(OPJ_CODEC_J2K);
+      break;
+
+   case Jpeg2000Utilities::JP2_CFMT:
+      pDecoder->mpCodec = opj_create_decompress(OPJ_CODEC_JP2);
+      break;
+
+   default:
+      break;
+   }
+
+   if (pDecoder->mpCodec == NULL)
+   {
+      destroyDecoder(pDecoder);
+      return NULL;
+   }
+
+   opj_dparameters_t parameters;
+   opj_set_default_decoder_parameters(&parameters);
+   if (opj_setup_decoder(pDecoder->mpCodec, &parameters) == OPJ_FALSE ||
+      opj_read_header(pDecoder->mpStream, pDecoder->mpCodec, &pDecoder->mpImage) == OPJ_FALSE)
+   {
+      destroyDecoder(pDecoder);
+      return NULL;
+   }
+
+   pDecoder->mValid = true;
+   return pDecoder;
+}
+
+void Jpeg2000Pager::destroyDecoder(Decoder* pDecoder)
+{
+   if (pDecoder == NULL)
+   {
+      return;
+   }
+
+   if (pDecoder->mpImage != NULL)
+   {
+      opj_image_destroy(pDecoder->mpImage);
+   }
+
+   if (pDecoder->mpCodec != NULL)
+   {
+      opj_destroy_codec(pDecoder->mpCodec);
+   }
+
+   if (pDecoder->mpStream != NULL)
+   {
+      opj_stream_destroy(pDecoder->mpStream);
+   }
+
+   // The file handle is closed when the stream data is destroyed
+   delete pDecoder;
+}
+
+Jpeg2000Pager::DecodedTile* Jpeg2000Pager::decodeTile(Decoder* pDecoder, unsigned int tileIndex)
+{
+   if (pDecoder == NULL || pDecoder->mValid == false)
+   {
+      return NULL;
+   }
+
+   // The decoder seeks to the tile using the code stream index, so tiles can be decoded in any order
+   opj_image_t* pImage = pDecoder->mpImage;
+   if (opj_get_decoded_tile(pDecoder->mpCodec, pDecoder->mpStream, pImage, tileIndex) == OPJ_FALSE)
+   {
+      // The decoder state is unknown after a failure, so it will be replaced
+      pDecoder->mValid = false;
+      return NULL;
+   }
+
+   DecodedTile* pTile = new DecodedTile;
+   pTile->mBytes = 0;
+   pTile->mComponents.resize(pImage->numcomps);
+   for (OPJ_UINT32 i = 0; i < pImage->numcomps; ++i)
+   {
+      const opj_image_comp_t& component = pImage->comps[i];
+      DecodedTile::Component& tileComponent = pTile->mComponents[i];
+      tileComponent.mX0 = component.x0;
+      tileComponent.mY0 = component.y0;
+      tileComponent.mWidth = component.w;
+      tileComponent.mHeight = component.h;
+      tileComponent.mDx = std::max<OPJ_UINT32>(component.dx, 1);
+      tileComponent.mDy = std::max<OPJ_UINT32>(component.dy, 1);
+      if (component.data != NULL)
+      {
+         tileComponent.mData.assign(component.data, component.data + component.w * component.h);
+      }
+
+      pTile->mBytes += tileComponent.mData.size() * sizeof(OPJ_INT32);
+   }
+
+   return pTile;
+}
+
+bool Jpeg2000Pager::initializeTiles()
+{
+   if (mTilesInitialized == true)
+   {
+      return mTilesAcross > 0;
+   }
+
+   mTilesInitialized = true;
+
+   // Read the header, first trying the codestream format then the file format
+   Decoder* pDecoder = createDecoder(Jpeg2000Utilities::J2K_CFMT);
+   mDecoderType = Jpeg2000Utilities::J2K_CFMT;
+   if (pDecoder == NULL)
+   {
+      pDecoder = createDecoder(Jpeg2000Utilities::JP2_CFMT);
+      mDecoderType = Jpeg2000Utilities::JP2_CFMT;
+   }
+
+   if (pDecoder == NULL)
+   {
+      return false;
+   }
+
+   opj_codestream_info_v2_t* pInfo = opj_get_cstr_info(pDecoder->mpCodec);
+   if (pInfo == NULL)
+   {
+      destroyDecoder(pDecoder);
+      return false;
+   }
+
+   const opj_image_t* pImage = pDecoder->mpImage;
+   mImageX0 = pImage->x0;
+   mImageY0 = pImage->y0;
+   mImageX1 = pImage->x1;
+   mImageY1 = pImage->y1;
+   mTileX0 = pInfo->tx0;
+   mTileY0 = pInfo->ty0;
+   mTileWidth = pInfo->tdx;
+   mTileHeight = pInfo->tdy;
+   unsigned int tilesAcross = pInfo->tw;
+   unsigned int tilesDown = pInfo->th;
+   opj_destroy_cstr_info(&pInfo);
+
+   // Decoding a single tile is the same as decoding the entire image, so only use tiles when there
+   // are several of them and a reasonable number of decoded tiles fit in the cache
+   double tileBytes = static_cast<double>(mTileWidth) * mTileHeight * pImage->numcomps * sizeof(OPJ_INT32);
+   if (tilesAcross * tilesDown <= 1 || mTileWidth == 0 || mTileHeight == 0 ||
+      tileBytes * 4 > static_cast<double>(msMaxTileCacheSize))
+   {
+      destroyDecoder(pDecoder);
+      return false;
+   }
+
+   mTilesAcross = tilesAcross;
+   mTilesDown = tilesDown;
+   mDecoders.push_back(pDecoder);
+   return true;
+}
+
+bool Jpeg2000Pager::decodeTiles(const std::vector<unsigned int>& tiles)
+{
+   if (tiles.empty() == true)
+   {
+      return true;
+   }
+
+   unsigned int threadCount = mta::getNumRequiredThreads(static_cast<unsigned int>(tiles.size()));
+   while (mDecoders.size() < threadCount)
+   {
+      Decoder* pDecoder = createDecoder(mDecoderType);
+      if (pDecoder == NULL)
+      {
+         break;
+      }
+
+      mDecoders.push_back(pDecoder);
+   }
+
+   if (mDecoders.empty() == true)
+   {
+      return false;
+   }
+
+   threadCount = std::min(threadCount, static_cast<unsigned int>(mDecoders.size()));
+
+   std::vector<DecodedTile*> decodedTiles(tiles.size(), static_cast<DecodedTile*>(NULL));
+   TileDecodeInput input;
+   input.mpDecoders = &mDecoders;
+   input.mpTiles = &tiles;
+   input.mpResults = &decodedTiles;
+
+   if (threadCount > 1)
+   {
+      mta::MultiThreadedAlgorithm<TileDecodeInput, std::vector<DecodedTile*>, TileDecodeThread>
+         alg(threadCount, input, decodedTiles, NULL);
+      alg.run();
+   }
+   else
+   {
+      for (std::vector<unsigned int>::size_type i = 0; i < tiles.size(); ++i)
+      {
+         decodedTiles[i] = decodeTile(mDecoders.front(), tiles[i]);
+      }
+   }
+
+   // Replace any decoders which failed
+   for (std::vector<Decoder*>::iterator iter = mDecoders.begin(); iter != mDecoders.end(); )
+   {
+      if ((*iter)->mValid == false)
+      {
+         destroyDecoder(*iter);
+         iter = mDecoders.erase(iter);
+      }
+      else
+      {
+         ++iter;
+      }
+   }
+
+   bool success = true;
+   for (std::vector<unsigned int>::size_type i = 0; i < tiles.size(); ++i)
+   {
+      if (decodedTiles[i] == NULL)
+      {
+         success = false;
+      }
+      else
+      {
+         cacheTile(tiles[i], decodedTiles[i]);
+      }
+   }
+
+   return success;
+}
+
+void Jpeg2000Pager::cacheTile(unsigned int tileIndex, DecodedTile* pTile)
+{
+   std::map<unsigned int, DecodedTile*>::iterator iter = mTiles.find(tileIndex);
+   if (iter != mTiles.end())
+   {
+      mTileCacheBytes -= iter->second->mBytes;
+      delete iter->second;
+      mTileLru.remove(tileIndex);
+   }
+
+   mTiles[tileIndex] = pTile;
+   mTileLru.push_front(tileIndex);
+   mTileCacheBytes += pTile->mBytes;
+}
+
+void Jpeg2000Pager::clearTiles()
+{
+   for (std::map<unsigned int, DecodedTile*>::iterator iter = mTiles.begin(); iter != mTiles.end(); ++iter)
+   {
+      delete iter->second;
+   }
+
+   mTiles.clear();
+   mTileLru.clear();
+   mTileCacheBytes = 0;
+}
+
+bool Jpeg2000Pager::copyFromTiles(char* pDest, unsigned int onDiskStartRow, unsigned int onDiskStartColumn,
+                                  unsigned int concurrentRows, unsigned int concurrentColumns,
+                                  unsigned int componentCount, size_t copySize)
+{
+   // Convert the requested area to the reference grid
+   const unsigned int startX = mImageX0 + onDiskStartColumn;
+   const unsigned int startY = mImageY0 + onDiskStartRow;
+   const unsigned int stopX = std::min(startX + concurrentColumns, mImageX1);
+   const unsigned int stopY = std::min(startY + concurrentRows, mImageY1);
+   if (startX >= stopX || startY >= stopY || startX < mTileX0 || startY < mTileY0)
+   {
+      return false;
+   }
+
+   const unsigned int firstTileColumn = (startX - mTileX0) / mTileWidth;
+   const unsigned int lastTileColumn = std::min((stopX - 1 - mTileX0) / mTileWidth, mTilesAcross - 1);
+   const unsigned int firstTileRow = (startY - mTileY0) / mTileHeight;
+   const unsigned int lastTileRow = std::min((stopY - 1 - mTileY0) / mTileHeight, mTilesDown - 1);
+
+   // Work through one row of tiles at a time so that the tiles being copied fit in the cache
+   for (unsigned int tileRow = firstTileRow; tileRow <= lastTileRow; ++tileRow)
+   {
+      std::vector<unsigned int> missingTiles;
+      for (unsigned int tileColumn = firstTileColumn; tileColumn <= lastTileColumn; ++tileColumn)
+      {
+         unsigned int tileIndex = tileRow * mTilesAcross + tileColumn;
+         if (mTiles.find(tileIndex) == mTiles.end())
+         {
+            missingTiles.push_back(tileIndex);
+         }
+      }
+
+      if (decodeTiles(missingTiles) == false)
+      {
+         return false;
+      }
+
+      const unsigned int rowStartY = std::max(startY, mTileY0 + tileRow * mTileHeight);
+      const unsigned int rowStopY = std::min(stopY, mTileY0 + (tileRow + 1) * mTileHeight);
+      for (unsigned int tileColumn = firstTileColumn; tileColumn <= lastTileColumn; ++tileColumn)
+      {
+         unsigned int tileIndex = tileRow * mTilesAcross + tileColumn;
+         std::map<unsigned int, DecodedTile*>::const_iterator tileIter = mTiles.find(tileIndex);
+         VERIFY(tileIter != mTiles.end());
+
+         const DecodedTile* pTile = tileIter->second;
+         VERIFY(pTile->mComponents.size() >= componentCount);
+
+         mTileLru.remove(tileIndex);
+         mTileLru.push_front(tileIndex);
+
+         const unsigned int tileStartX = std::max(startX, mTileX0 + tileColumn * mTileWidth);
+         const unsigned int tileStopX = std::min(stopX, mTileX0 + (tileColumn + 1) * mTileWidth);
+         for (unsigned int y = rowStartY; y < rowStopY; ++y)
+         {
+            for (unsigned int x = tileStartX; x < tileStopX; ++x)
+            {
+               char* pPixel = pDest + ((y - startY) * concurrentColumns + (x - startX)) * componentCount * copySize;
+               for (unsigned int componentIndex = 0; componentIndex < componentCount; ++componentIndex)
+               {
+                  const DecodedTile::Component& component = pTile->mComponents[componentIndex];
+                  unsigned int componentX = x / component.mDx;
+                  unsigned int componentY = y / component.mDy;
+                  if (componentX >= component.mX0 && componentY >= component.mY0)
+                  {
+                     componentX -= component.mX0;
+                     componentY -= component.mY0;
+                     if (componentX < component.mWidth && componentY < component.mHeight)
+                     {
+                        memcpy(pPixel + componentIndex * copySize,
+                           &component.mData[componentY * component.mWidth + componentX], copySize);
+                     }
+                  }
+               }
+            }
+         }
+      }
+
+      // Discard the least recently used tiles, keeping at least the current row of tiles
+      size_t keepCount = lastTileColumn - firstTileColumn + 1;
+      while (mTileCacheBytes > msMaxTileCacheSize && mTileLru.size() > keepCount)
+      {
+         std::map<unsigned int, DecodedTile*>::iterator iter = mTiles.find(mTileLru.back());
+         if (iter != mTiles.end())
+         {
+            mTileCacheBytes -= iter->second->mBytes;
+            delete iter->second;
+            mTiles.erase(iter);
+         }
+
+         mTileLru.pop_back();
+      }
+   }
+
+   return true;
+}
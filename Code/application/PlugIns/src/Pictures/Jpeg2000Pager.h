@@ -14,8 +14,21 @@
 
 #include <openjpeg.h>
 #include <stdio.h>
+#include <list>
+#include <map>
 #include <string>
+#include <vector>
 
+/**
+ *  Provides on-disk access to JPEG2000 data.
+ *
+ *  Tiled code streams are decoded one tile at a time and the decoded tiles
+ *  are kept in a least recently used cache, so requests that share a tile
+ *  only decode it once. Each decoding thread keeps its own codec and stream
+ *  with the code stream header already read, and the tiles needed by a
+ *  request are decoded concurrently. Code streams with a single tile, or with
+ *  tiles too large to cache, are decoded one requested area at a time.
+ */
 class Jpeg2000Pager : public CachedPager
 {
 public:
@@ -36,17 +49,55 @@ protected:
 
    template <typename Out>
    CachedPage::UnitPtr populateImageData(const DimensionDescriptor& startRow, const DimensionDescriptor& startColumn,
-      unsigned int concurrentRows, unsigned int concurrentColumns) const;
+      unsigned int concurrentRows, unsigned int concurrentColumns);
 
    opj_image_t* decodeImage(unsigned int originalStartRow, unsigned int originalStartColumn,
       unsigned int originalStopRow, unsigned int originalStopColumn, int decoderType) const;
 
 private:
+   Jpeg2000Pager(const Jpeg2000Pager& rhs);
+   Jpeg2000Pager& operator=(const Jpeg2000Pager& rhs);
+
+   struct Decoder;
+   struct DecodedTile;
+   struct TileDecodeInput;
+   class TileDecodeThread;
+   friend class TileDecodeThread;
+
+   Decoder* createDecoder(int decoderType) const;
+   static void destroyDecoder(Decoder* pDecoder);
+   static DecodedTile* decodeTile(Decoder* pDecoder, unsigned int tileIndex);
+   bool initializeTiles();
+   bool decodeTiles(const std::vector<unsigned int>& tiles);
+   void cacheTile(unsigned int tileIndex, DecodedTile* pTile);
+   void clearTiles();
+   bool copyFromTiles(char* pDest, unsigned int onDiskStartRow, unsigned int onDiskStartColumn,
+      unsigned int concurrentRows, unsigned int concurrentColumns, unsigned int componentCount, size_t copySize);
+
    static size_t msMaxCacheSize;
+   static size_t msMaxTileCacheSize;
 
    FILE* mpFile;
+   std::string mFilename;
    uint64_t mOffset;
    uint64_t mSize;
+
+   bool mTilesInitialized;
+   int mDecoderType;
+   std::vector<Decoder*> mDecoders;
+   unsigned int mImageX0;
+   unsigned int mImageY0;
+   unsigned int mImageX1;
+   unsigned int mImageY1;
+   unsigned int mTileX0;
+   unsigned int mTileY0;
+   unsigned int mTileWidth;
+   unsigned int mTileHeight;
+   unsigned int mTilesAcross;
+   unsigned int mTilesDown;
+   std::map<unsigned int, DecodedTile*> mTiles;
+   std::list<unsigned int> mTileLru;
+   size_t mTileCacheBytes;
 };
 
 #endif
@@ -0,0 +1,82 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2007 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from   
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#include "GridConversions.h"
+#include "GridConversionTimingTest.h"
+#include "PlugInRegistration.h"
+
+#include <string>
+#include <vector>
+
+REGISTER_PLUGIN_BASIC(OpticksPlugInSampler, GridConversionTimingTest);
+
+GridConversionTimingTest::GridConversionTimingTest() :
+   TimingTest("Grid Conversion Timing Test",
+      "Measures the coordinates converted per second by per-coordinate and batched UTM and MGRS conversions.",
+      "{6A1F0C53-2B7E-4D19-9E4A-7C3B85D0E2F6}")
+{
+   addResult("Per Coordinate UTM Rate");
+   addResult("Batched UTM Rate");
+   addResult("Per Coordinate MGRS Rate");
+   addResult("Batched MGRS Rate");
+}
+
+GridConversionTimingTest::~GridConversionTimingTest()
+{
+}
+
+bool GridConversionTimingTest::runTest(PlugInArgList* pInArgList, std::vector<double>& results)
+{
+   // Generate a grid of easting/northing values in a single zone, which is typical of an IGM raster
+   const unsigned int gridSize = 1000;
+   const unsigned int count = gridSize * gridSize;
+   const int zone = 13;
+   const char hemisphere = 'N';
+
+   std::vector<LocationType> eastingNorthing(count);
+   for (unsigned int row = 0; row < gridSize; ++row)
+   {
+      for (unsigned int column = 0; column < gridSize; ++column)
+      {
+         eastingNorthing[row * gridSize + column] = LocationType(400000.0 + column * 10.0, 4300000.0 + row * 10.0);
+      }
+   }
+
+   // UTM to geodetic, one coordinate at a time
+   std::vector<LocationType> latLon(count);
+   Stopwatch stopwatch;
+   for (unsigned int i = 0; i < count; ++i)
+   {
+      GridConversions::UtmCoordinate utm(eastingNorthing[i].mX, eastingNorthing[i].mY, zone, hemisphere);
+      GridConversions::utmToLatLon(utm, latLon[i]);
+   }
+   results[0] = getRate(count, stopwatch.getSeconds());
+
+   // UTM to geodetic, batched
+   stopwatch.restart();
+   GridConversions::utmToLatLon(zone, hemisphere, &eastingNorthing.front(), &latLon.front(), count);
+   results[1] = getRate(count, stopwatch.getSeconds());
+
+   // Geodetic to MGRS, one coordinate at a time
+   const unsigned int mgrsCount = count / 10;
+   std::vector<std::string> mgrs(mgrsCount);
+   stopwatch.restart();
+   for (unsigned int i = 0; i < mgrsCount; ++i)
+   {
+      GridConversions::latLonToMgrs(latLon[i], mgrs[i]);
+   }
+   results[2] = getRate(mgrsCount, stopwatch.getSeconds());
+
+   // Geodetic to MGRS, batched
+   stopwatch.restart();
+   GridConversions::latLonToMgrs(&latLon.front(), &mgrs.front(), mgrsCount);
+   results[3] = getRate(mgrsCount, stopwatch.getSeconds());
+
+   return true;
+}
@@ -0,0 +1,25 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2007 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from   
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#ifndef GRIDCONVERSIONTIMINGTEST_H
+#define GRIDCONVERSIONTIMINGTEST_H
+
+#include "TimingTest.h"
+
+class GridConversionTimingTest : public TimingTest
+{
+public:
+   GridConversionTimingTest();
+   ~GridConversionTimingTest();
+
+protected:
+   bool runTest(PlugInArgList* pInArgList, std::vector<double>& results);
+};
+
+#endif
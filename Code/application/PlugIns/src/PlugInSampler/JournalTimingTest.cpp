@@ -0,0 +1,116 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2007 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#include "AppVerify.h"
+#include "JournalTimingTest.h"
+#include "MessageLog.h"
+#include "MessageLogMgr.h"
+#include "PlugInRegistration.h"
+
+#include <string>
+#include <vector>
+
+REGISTER_PLUGIN_BASIC(OpticksPlugInSampler, JournalTimingTest);
+
+namespace
+{
+   const unsigned int sNumMessages = 1000000;
+   const unsigned int sNumSteps = 100000;
+   const unsigned int sNumWarnings = 1000;
+   const std::string sLogName = "Journal Timing Test";
+   const std::string sComponent = "app";
+   const std::string sKey = "0F1C6E8A-5B2D-4F0E-9A71-3D6C2B84E95F";
+
+   // Each message has one property, so a million messages stay within the memory of the log
+   void logMessages(MessageLog* pLog)
+   {
+      for (unsigned int i = 0; i < sNumMessages; ++i)
+      {
+         Message* pMessage = pLog->createMessage("Journal timing message", sComponent, sKey);
+         if (pMessage != NULL)
+         {
+            pMessage->addProperty("Index", i);
+            pMessage->finalize();
+         }
+      }
+   }
+
+   // Each step holds one message, which is the nesting written when plug-ins execute
+   void logSteps(MessageLog* pLog)
+   {
+      for (unsigned int i = 0; i < sNumSteps; ++i)
+      {
+         Step* pStep = pLog->createStep("Journal timing step", sComponent, sKey);
+         if (pStep != NULL)
+         {
+            pStep->addProperty("Index", i);
+            Message* pMessage = pStep->addMessage("Journal timing message", sComponent, sKey);
+            if (pMessage != NULL)
+            {
+               pMessage->addProperty("Index", i);
+               pMessage->finalize();
+            }
+            pStep->finalize(Message::Success);
+         }
+      }
+   }
+
+   // Warnings are written to the journal before logging continues
+   void logWarnings(MessageLog* pLog)
+   {
+      for (unsigned int i = 0; i < sNumWarnings; ++i)
+      {
+         Message* pMessage = pLog->createMessage("Warning", sComponent, sKey);
+         if (pMessage != NULL)
+         {
+            pMessage->finalize();
+         }
+      }
+   }
+}
+
+JournalTimingTest::JournalTimingTest() :
+   TimingTest("Journal Timing Test",
+      "Measures how quickly messages and steps can be logged, which includes writing them to the "
+      "message log journal.",
+      "{DD35DBDE-B7D5-4B63-8C9D-3A42A42C3843}")
+{
+   addResult("Messages Per Second");
+   addResult("Steps Per Second");
+   addResult("Warnings Per Second");
+}
+
+JournalTimingTest::~JournalTimingTest()
+{
+}
+
+bool JournalTimingTest::runTest(PlugInArgList* pInArgList, std::vector<double>& results)
+{
+   // Log to a separate log so the timed entries do not fill the session log
+   Service<MessageLogMgr> pLogMgr;
+   MessageLog* pLog = pLogMgr->getLog(sLogName);
+   if (pLog == NULL)
+   {
+      pLog = pLogMgr->createLog(sLogName);
+   }
+   VERIFY(pLog != NULL);
+
+   Stopwatch stopwatch;
+   logMessages(pLog);
+   results[0] = getRate(sNumMessages, stopwatch.getSeconds());
+
+   stopwatch.restart();
+   logSteps(pLog);
+   results[1] = getRate(sNumSteps, stopwatch.getSeconds());
+
+   stopwatch.restart();
+   logWarnings(pLog);
+   results[2] = getRate(sNumWarnings, stopwatch.getSeconds());
+   return true;
+}
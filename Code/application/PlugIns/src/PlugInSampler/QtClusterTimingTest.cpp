@@ -0,0 +1,117 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2007 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from   
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#include "AoiElement.h"
+#include "LocationType.h"
+#include "ModelServices.h"
+#include "ObjectResource.h"
+#include "PlugInArgList.h"
+#include "PlugInRegistration.h"
+#include "PlugInResource.h"
+#include "QtClusterTimingTest.h"
+#include "StringUtilities.h"
+
+#include <string>
+#include <vector>
+
+REGISTER_PLUGIN_BASIC(OpticksPlugInSampler, QtClusterTimingTest);
+
+namespace
+{
+   // Each point count is four times the previous one, from about a thousand to about a million points,
+   // which makes linear and quadratic scaling easy to tell apart
+   const unsigned int sPointCounts[] = { 1000, 4000, 16000, 64000, 256000, 1024000 };
+   const unsigned int sNumPointCounts = sizeof(sPointCounts) / sizeof(sPointCounts[0]);
+   const unsigned int sAoiSize = 4096;
+   const double sClusterSize = 15.0;
+   const std::string sResultName = "QT Cluster Timing Test Result";
+
+   // Runs QT Cluster over randomly placed points, returning the elapsed time or a negative value on failure
+   double timeClustering(unsigned int pointCount)
+   {
+      // Use a fixed linear congruential generator so every run clusters the same points
+      unsigned int seed = 12345;
+      std::vector<LocationType> points(pointCount);
+      for (unsigned int i = 0; i < pointCount; ++i)
+      {
+         seed = seed * 1103515245 + 12345;
+         unsigned int x = (seed >> 8) % sAoiSize;
+         seed = seed * 1103515245 + 12345;
+         unsigned int y = (seed >> 8) % sAoiSize;
+         points[i] = LocationType(x, y);
+      }
+
+      ModelResource<AoiElement> pAoi("QT Cluster Timing Test AOI");
+      if (pAoi.get() == NULL)
+      {
+         return -1.0;
+      }
+      pAoi->addPoints(points);
+
+      ExecutableResource pCluster("QT Cluster", std::string(), NULL, true);
+      if (pCluster->getPlugIn() == NULL)
+      {
+         return -1.0;
+      }
+
+      std::string resultName = sResultName;
+      PlugInArgList& inArgList = pCluster->getInArgList();
+      inArgList.setPlugInArgValue(Executable::DataElementArg(), pAoi.get());
+      inArgList.setPlugInArgValue<std::string>("Result Name", &resultName);
+      double clusterSize = sClusterSize;
+      inArgList.setPlugInArgValue<double>("Cluster Size", &clusterSize);
+
+      Stopwatch stopwatch;
+      bool success = pCluster->execute();
+      double seconds = stopwatch.getSeconds();
+
+      Service<ModelServices> pModel;
+      DataElement* pResult = pModel->getElement(resultName, std::string(), NULL);
+      if (pResult != NULL)
+      {
+         pModel->destroyElement(pResult);
+      }
+
+      if (success == false)
+      {
+         return -1.0;
+      }
+
+      return seconds;
+   }
+}
+
+QtClusterTimingTest::QtClusterTimingTest() :
+   TimingTest("QT Cluster Timing Test",
+      "Measures how the run time of QT Cluster scales with the number of points in the AOI.",
+      "{3C8E5A27-71D4-4B0F-A6E2-9D15F4B7C083}")
+{
+   for (unsigned int i = 0; i < sNumPointCounts; ++i)
+   {
+      addResult("Seconds For " + StringUtilities::toDisplayString(sPointCounts[i]) + " Points");
+   }
+}
+
+QtClusterTimingTest::~QtClusterTimingTest()
+{
+}
+
+bool QtClusterTimingTest::runTest(PlugInArgList* pInArgList, std::vector<double>& results)
+{
+   for (unsigned int i = 0; i < sNumPointCounts; ++i)
+   {
+      results[i] = timeClustering(sPointCounts[i]);
+      if (results[i] < 0.0)
+      {
+         return false;
+      }
+   }
+
+   return true;
+}
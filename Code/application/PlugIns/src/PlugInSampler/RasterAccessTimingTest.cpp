@@ -0,0 +1,337 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2007 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#include "AppVerify.h"
+#include "DataAccessor.h"
+#include "DataAccessorImpl.h"
+#include "DataRequest.h"
+#include "MessageLog.h"
+#include "MessageLogMgr.h"
+#include "ModelServices.h"
+#include "ObjectResource.h"
+#include "PagerStatistics.h"
+#include "PlugInArgList.h"
+#include "PlugInManagerServices.h"
+#include "PlugInRegistration.h"
+#include "RasterAccessTimingTest.h"
+#include "RasterDataDescriptor.h"
+#include "RasterElement.h"
+#include "RasterUtilities.h"
+#include "StringUtilities.h"
+#include "UInt64.h"
+
+#include <algorithm>
+#include <string.h>
+#include <vector>
+
+REGISTER_PLUGIN_BASIC(OpticksPlugInSampler, RasterAccessTimingTest);
+
+namespace
+{
+   enum AccessPattern
+   {
+      SEQUENTIAL = 0,
+      STRIDED,
+      RANDOM_WINDOW,
+      TRANSPOSED,
+      PATTERN_COUNT
+   };
+
+   const char* const sPatternNames[PATTERN_COUNT] = { "Sequential", "Strided", "Random Window", "Transposed" };
+   const unsigned int sRowStride = 8;
+   const unsigned int sWindowSize = 64;
+
+   class AccessTimer
+   {
+   public:
+      AccessTimer() :
+         mBytes(0),
+         mChecksum(0)
+      {
+      }
+
+      // Copies a row of the page so the read cannot be optimized away
+      void readRow(DataAccessor& accessor, size_t rowBytes)
+      {
+         if (mRow.size() < rowBytes)
+         {
+            mRow.resize(rowBytes);
+         }
+
+         memcpy(&mRow.front(), accessor->getRow(), rowBytes);
+         mChecksum += mRow[rowBytes - 1];
+         mBytes += rowBytes;
+      }
+
+      uint64_t mBytes;
+      unsigned int mChecksum;
+
+   private:
+      std::vector<unsigned char> mRow;
+   };
+
+   DataAccessor getAccessor(RasterElement* pElement, InterleaveFormatType interleave, unsigned int startRow,
+      unsigned int stopRow, unsigned int startColumn, unsigned int stopColumn, unsigned int band, bool writable)
+   {
+      const RasterDataDescriptor* pDescriptor =
+         static_cast<const RasterDataDescriptor*>(pElement->getDataDescriptor());
+
+      FactoryResource<DataRequest> pRequest;
+      pRequest->setInterleaveFormat(interleave);
+      pRequest->setRows(pDescriptor->getActiveRow(startRow), pDescriptor->getActiveRow(stopRow), 1);
+      pRequest->setColumns(pDescriptor->getActiveColumn(startColumn), pDescriptor->getActiveColumn(stopColumn));
+      if (interleave == BSQ)
+      {
+         pRequest->setBands(pDescriptor->getActiveBand(band), pDescriptor->getActiveBand(band), 1);
+      }
+      pRequest->setWritable(writable);
+      return pElement->getDataAccessor(pRequest.release());
+   }
+
+   size_t getRowBytes(const RasterDataDescriptor* pDescriptor, InterleaveFormatType interleave, unsigned int columns)
+   {
+      size_t bands = (interleave == BSQ) ? 1 : pDescriptor->getBandCount();
+      return columns * bands * pDescriptor->getBytesPerElement();
+   }
+
+   bool fillCube(RasterElement* pElement)
+   {
+      const RasterDataDescriptor* pDescriptor =
+         static_cast<const RasterDataDescriptor*>(pElement->getDataDescriptor());
+      InterleaveFormatType interleave = pDescriptor->getInterleaveFormat();
+      unsigned int rows = pDescriptor->getRowCount();
+      unsigned int columns = pDescriptor->getColumnCount();
+      size_t rowBytes = getRowBytes(pDescriptor, interleave, columns);
+      unsigned int accessorCount = (interleave == BSQ) ? pDescriptor->getBandCount() : 1;
+
+      for (unsigned int band = 0; band < accessorCount; ++band)
+      {
+         DataAccessor accessor = getAccessor(pElement, interleave, 0, rows - 1, 0, columns - 1, band, true);
+         for (unsigned int row = 0; row < rows; ++row)
+         {
+            if (!accessor.isValid())
+            {
+               return false;
+            }
+
+            unsigned char* pRow = static_cast<unsigned char*>(accessor->getRow());
+            for (size_t i = 0; i < rowBytes; ++i)
+            {
+               pRow[i] = static_cast<unsigned char>(row + band + i);
+            }
+            accessor->nextRow();
+         }
+      }
+
+      return true;
+   }
+
+   // Reads one row in every rowStride rows of each band
+   bool readRows(RasterElement* pElement, InterleaveFormatType interleave, unsigned int rowStride,
+      AccessTimer& timer)
+   {
+      const RasterDataDescriptor* pDescriptor =
+         static_cast<const RasterDataDescriptor*>(pElement->getDataDescriptor());
+      unsigned int rows = pDescriptor->getRowCount();
+      unsigned int columns = pDescriptor->getColumnCount();
+      size_t rowBytes = getRowBytes(pDescriptor, interleave, columns);
+      unsigned int accessorCount = (interleave == BSQ) ? pDescriptor->getBandCount() : 1;
+
+      for (unsigned int band = 0; band < accessorCount; ++band)
+      {
+         DataAccessor accessor = getAccessor(pElement, interleave, 0, rows - 1, 0, columns - 1, band, false);
+         for (unsigned int row = 0; row < rows; row += rowStride)
+         {
+            if (!accessor.isValid())
+            {
+               return false;
+            }
+
+            timer.readRow(accessor, rowBytes);
+            accessor->nextRow(static_cast<int>(rowStride));
+         }
+      }
+
+      return true;
+   }
+
+   // Reads square windows at pseudo-random locations, covering about the area of one band
+   bool readWindows(RasterElement* pElement, AccessTimer& timer)
+   {
+      const RasterDataDescriptor* pDescriptor =
+         static_cast<const RasterDataDescriptor*>(pElement->getDataDescriptor());
+      InterleaveFormatType interleave = pDescriptor->getInterleaveFormat();
+      unsigned int rows = pDescriptor->getRowCount();
+      unsigned int columns = pDescriptor->getColumnCount();
+      unsigned int bands = pDescriptor->getBandCount();
+      unsigned int windowRows = std::min(sWindowSize, rows);
+      unsigned int windowColumns = std::min(sWindowSize, columns);
+      size_t rowBytes = getRowBytes(pDescriptor, interleave, windowColumns);
+      unsigned int windowCount = (rows / windowRows) * (columns / windowColumns);
+
+      // A fixed linear congruential generator, so every run reads the same windows
+      unsigned int seed = 12345;
+      for (unsigned int window = 0; window < windowCount; ++window)
+      {
+         seed = seed * 1103515245 + 12345;
+         unsigned int startRow = (seed >> 8) % (rows - windowRows + 1);
+         seed = seed * 1103515245 + 12345;
+         unsigned int startColumn = (seed >> 8) % (columns - windowColumns + 1);
+         unsigned int band = (seed >> 4) % bands;
+
+         DataAccessor accessor = getAccessor(pElement, interleave, startRow, startRow + windowRows - 1,
+            startColumn, startColumn + windowColumns - 1, band, false);
+         for (unsigned int row = 0; row < windowRows; ++row)
+         {
+            if (!accessor.isValid())
+            {
+               return false;
+            }
+
+            timer.readRow(accessor, rowBytes);
+            accessor->nextRow();
+         }
+      }
+
+      return true;
+   }
+
+   bool readPattern(RasterElement* pElement, AccessPattern pattern, AccessTimer& timer)
+   {
+      const RasterDataDescriptor* pDescriptor =
+         static_cast<const RasterDataDescriptor*>(pElement->getDataDescriptor());
+      InterleaveFormatType interleave = pDescriptor->getInterleaveFormat();
+      switch (pattern)
+      {
+      case SEQUENTIAL:
+         return readRows(pElement, interleave, 1, timer);
+      case STRIDED:
+         return readRows(pElement, interleave, sRowStride, timer);
+      case RANDOM_WINDOW:
+         return readWindows(pElement, timer);
+      case TRANSPOSED:
+         return readRows(pElement, (interleave == BIP) ? BSQ : BIP, 1, timer);
+      default:
+         return false;
+      }
+   }
+
+   double getMegabytes(uint64_t bytes)
+   {
+      return bytes / (1024.0 * 1024.0);
+   }
+}
+
+RasterAccessTimingTest::RasterAccessTimingTest() :
+   TimingTest("Raster Access Timing Test",
+      "Measures the throughput in megabytes per second of sequential, strided, random window and transposed "
+      "DataAccessor reads from synthetic BIP, BSQ and BIL cubes.  The rate for each cube is in the message log.",
+      "{B3E5A0D7-4C21-4F8E-9A6B-2D7C18F05E93}")
+{
+   for (int pattern = 0; pattern < PATTERN_COUNT; ++pattern)
+   {
+      addResult(std::string(sPatternNames[pattern]) + " Rate");
+   }
+}
+
+RasterAccessTimingTest::~RasterAccessTimingTest()
+{
+}
+
+bool RasterAccessTimingTest::getInputSpecification(PlugInArgList*& pArgList)
+{
+   Service<PlugInManagerServices> pPlugInManager;
+   VERIFY(pArgList = pPlugInManager->getPlugInArgList());
+   VERIFY(pArgList->addArg<unsigned int>("Bands", 8, "The number of bands in each synthetic cube."));
+   VERIFY(pArgList->addArg<bool>("In Memory", true, "Whether the synthetic cubes are held in memory. "
+      "If false, they are paged from temporary files."));
+   return true;
+}
+
+bool RasterAccessTimingTest::runTest(PlugInArgList* pInArgList, std::vector<double>& results)
+{
+   VERIFY(pInArgList != NULL);
+   unsigned int bands = 8;
+   bool inMemory = true;
+   pInArgList->getPlugInArgValue("Bands", bands);
+   pInArgList->getPlugInArgValue("In Memory", inMemory);
+   if (bands == 0)
+   {
+      return false;
+   }
+
+   const InterleaveFormatType interleaves[] = { BIP, BSQ, BIL };
+   const EncodingType encodings[] = { INT1UBYTE, INT2SBYTES, FLT4BYTES, FLT8BYTES };
+   const unsigned int sizes[] = { 256, 1024 };
+
+   Service<ModelServices> pModel;
+   MessageLog* pLog = Service<MessageLogMgr>()->getLog();
+   uint64_t totalBytes[PATTERN_COUNT] = { 0 };
+   double totalSeconds[PATTERN_COUNT] = { 0.0 };
+
+   for (unsigned int interleaveIndex = 0; interleaveIndex < sizeof(interleaves) / sizeof(interleaves[0]);
+      ++interleaveIndex)
+   {
+      for (unsigned int encodingIndex = 0; encodingIndex < sizeof(encodings) / sizeof(encodings[0]);
+         ++encodingIndex)
+      {
+         for (unsigned int sizeIndex = 0; sizeIndex < sizeof(sizes) / sizeof(sizes[0]); ++sizeIndex)
+         {
+            InterleaveFormatType interleave = interleaves[interleaveIndex];
+            EncodingType encoding = encodings[encodingIndex];
+            unsigned int size = sizes[sizeIndex];
+            ModelResource<RasterElement> pElement(RasterUtilities::createRasterElement("Raster Access Timing Test",
+               size, size, bands, encoding, interleave, inMemory));
+            if (pElement.get() == NULL || fillCube(pElement.get()) == false)
+            {
+               return false;
+            }
+
+            for (int pattern = 0; pattern < PATTERN_COUNT; ++pattern)
+            {
+               AccessTimer timer;
+               pModel->resetPagerStatistics();
+               Stopwatch stopwatch;
+               if (readPattern(pElement.get(), static_cast<AccessPattern>(pattern), timer) == false)
+               {
+                  return false;
+               }
+
+               double seconds = stopwatch.getSeconds();
+               PagerStatistics statistics = pModel->getPagerStatistics();
+               totalBytes[pattern] += timer.mBytes;
+               totalSeconds[pattern] += seconds;
+
+               Message* pMessage = (pLog == NULL) ? NULL : pLog->createMessage("Raster Access Timing",
+                  "PlugInSampler", "A81F63C2-5E0B-4D94-B7A1-3F9C0E2D6B47");
+               if (pMessage != NULL)
+               {
+                  pMessage->addProperty("Interleave", StringUtilities::toDisplayString(interleave));
+                  pMessage->addProperty("Encoding", StringUtilities::toDisplayString(encoding));
+                  pMessage->addProperty("Size", StringUtilities::toDisplayString(size) + " x " +
+                     StringUtilities::toDisplayString(size) + " x " + StringUtilities::toDisplayString(bands));
+                  pMessage->addProperty("Access Pattern", std::string(sPatternNames[pattern]));
+                  pMessage->addProperty("Rate (MB/s)", getRate(getMegabytes(timer.mBytes), seconds));
+                  pMessage->addProperty("Page Requests", UInt64(statistics.mPageRequests));
+                  pMessage->addProperty("Accessor Refetches", UInt64(statistics.mAccessorRefetches));
+                  pMessage->addProperty("Checksum", timer.mChecksum);
+                  pMessage->finalize();
+               }
+            }
+         }
+      }
+   }
+
+   for (int pattern = 0; pattern < PATTERN_COUNT; ++pattern)
+   {
+      results[pattern] = getRate(getMegabytes(totalBytes[pattern]), totalSeconds[pattern]);
+   }
+
+   return true;
+}
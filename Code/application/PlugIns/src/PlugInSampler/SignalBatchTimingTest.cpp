@@ -0,0 +1,155 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2007 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#include "AppVerify.h"
+#include "DynamicObject.h"
+#include "ObjectResource.h"
+#include "PlugInRegistration.h"
+#include "SignalBatchTimingTest.h"
+#include "Slot.h"
+#include "StringUtilities.h"
+
+#include <string>
+#include <vector>
+
+REGISTER_PLUGIN_BASIC(OpticksPlugInSampler, SignalBatchTimingTest);
+
+namespace
+{
+   const unsigned int sNumAttributes = 100000;
+   const unsigned int sNumAttaches = 100000;
+   const unsigned int sNumNotifications = 1000000;
+
+   class ModifiedCounter
+   {
+   public:
+      ModifiedCounter() :
+         mCount(0)
+      {
+      }
+
+      virtual ~ModifiedCounter()
+      {
+      }
+
+      void modified(Subject& subject, const std::string& signal, const boost::any& value)
+      {
+         ++mCount;
+      }
+
+      unsigned int mCount;
+   };
+
+   // Each slot is attached to the signal and detached again, so the subject never has more than one slot
+   void attachSlots(DynamicObject* pObject, ModifiedCounter& counter)
+   {
+      for (unsigned int i = 0; i < sNumAttaches; ++i)
+      {
+         pObject->attach(SIGNAL_NAME(DynamicObject, AttributeModified),
+            Slot(&counter, &ModifiedCounter::modified));
+         pObject->detach(SIGNAL_NAME(DynamicObject, AttributeModified),
+            Slot(&counter, &ModifiedCounter::modified));
+      }
+   }
+
+   // Changing an attribute notifies AttributeModified and then Modified, so the subject finds a signal among
+   // all of the signals it has slots for on every change
+   void notifySlots(DynamicObject* pObject)
+   {
+      const std::string name = "Attribute";
+      for (unsigned int i = 0; i < sNumNotifications / 2; ++i)
+      {
+         pObject->setAttribute(name, i);
+      }
+   }
+}
+
+SignalBatchTimingTest::SignalBatchTimingTest() :
+   TimingTest("Signal Batch Timing Test",
+      "Measures how quickly slots are attached to and notified by a subject, and compares setting many "
+      "attributes of an observed dynamic object one at a time with merging them, which notifies the changes in a "
+      "single batch.",
+      "{F3C7290B-5580-4A33-9172-81C0DD5DC0B6}")
+{
+   addResult("Attaches Per Second");
+   addResult("Notifications Per Second");
+   addResult("Seconds For Individual Changes");
+   addResult("Seconds For Batched Merge");
+}
+
+SignalBatchTimingTest::~SignalBatchTimingTest()
+{
+}
+
+bool SignalBatchTimingTest::runTest(PlugInArgList* pInArgList, std::vector<double>& results)
+{
+   std::vector<std::string> names(sNumAttributes);
+   for (unsigned int i = 0; i < sNumAttributes; ++i)
+   {
+      names[i] = "Attribute " + StringUtilities::toDisplayString(i);
+   }
+
+   // The counters are declared first so they are still valid when the objects are destroyed
+   ModifiedCounter attachCounter;
+   ModifiedCounter notifyCounter;
+   ModifiedCounter individualCounter;
+   ModifiedCounter batchedCounter;
+
+   FactoryResource<DynamicObject> pNotifier;
+   FactoryResource<DynamicObject> pSource;
+   FactoryResource<DynamicObject> pIndividual;
+   FactoryResource<DynamicObject> pBatched;
+   VERIFY(pNotifier.get() != NULL && pSource.get() != NULL && pIndividual.get() != NULL && pBatched.get() != NULL);
+
+   Stopwatch stopwatch;
+   attachSlots(pNotifier.get(), attachCounter);
+   results[0] = getRate(sNumAttaches, stopwatch.getSeconds());
+
+   // Attach to every signal of the object so each notification finds its signal among all of them
+   pNotifier->attach(SIGNAL_NAME(DynamicObject, Cleared), Slot(&notifyCounter, &ModifiedCounter::modified));
+   pNotifier->attach(SIGNAL_NAME(DynamicObject, AttributeRemoved), Slot(&notifyCounter, &ModifiedCounter::modified));
+   pNotifier->attach(SIGNAL_NAME(DynamicObject, AttributeAdded), Slot(&notifyCounter, &ModifiedCounter::modified));
+   pNotifier->attach(SIGNAL_NAME(DynamicObject, AttributeModified),
+      Slot(&notifyCounter, &ModifiedCounter::modified));
+   pNotifier->attach(SIGNAL_NAME(Subject, Modified), Slot(&notifyCounter, &ModifiedCounter::modified));
+   pNotifier->setAttribute("Attribute", 0U);
+   notifyCounter.mCount = 0;
+
+   stopwatch.restart();
+   notifySlots(pNotifier.get());
+   results[1] = getRate(notifyCounter.mCount, stopwatch.getSeconds());
+
+   for (unsigned int i = 0; i < sNumAttributes; ++i)
+   {
+      pSource->setAttribute(names[i], i);
+   }
+
+   pIndividual->attach(SIGNAL_NAME(Subject, Modified), Slot(&individualCounter, &ModifiedCounter::modified));
+   pBatched->attach(SIGNAL_NAME(Subject, Modified), Slot(&batchedCounter, &ModifiedCounter::modified));
+
+   stopwatch.restart();
+   for (unsigned int i = 0; i < sNumAttributes; ++i)
+   {
+      pIndividual->setAttribute(names[i], i);
+   }
+   results[2] = stopwatch.getSeconds();
+
+   stopwatch.restart();
+   pBatched->merge(pSource.get());
+   results[3] = stopwatch.getSeconds();
+
+   pIndividual->detach(SIGNAL_NAME(Subject, Modified), Slot(&individualCounter, &ModifiedCounter::modified));
+   pBatched->detach(SIGNAL_NAME(Subject, Modified), Slot(&batchedCounter, &ModifiedCounter::modified));
+
+   // Each change notifies AttributeModified and Modified, and every change is notified on its own unless it is
+   // batched
+   return attachCounter.mCount == 0 && notifyCounter.mCount == sNumNotifications &&
+      individualCounter.mCount == sNumAttributes && batchedCounter.mCount == 1 &&
+      pBatched->getNumAttributes() == sNumAttributes;
+}
@@ -0,0 +1,213 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2007 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from   
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#include "DesktopServices.h"
+#include "DynamicObject.h"
+#include "ObjectResource.h"
+#include "PlugInRegistration.h"
+#include "RasterDataDescriptor.h"
+#include "RasterElement.h"
+#include "RasterUtilities.h"
+#include "Signature.h"
+#include "SignatureLibrary.h"
+#include "SpecialMetadata.h"
+#include "SpectralMatching.h"
+#include "SpectralMatchingTest.h"
+#include "StringUtilities.h"
+
+#include <algorithm>
+#include <math.h>
+#include <sstream>
+#include <string>
+#include <vector>
+
+REGISTER_PLUGIN_BASIC(OpticksPlugInSampler, SpectralMatchingTest);
+
+namespace
+{
+   // The cube is larger than one block of pixels, bands and signatures in matchLibrary(), so partial blocks
+   // are compared as well as whole ones
+   const unsigned int sNumRows = 5;
+   const unsigned int sNumColumns = 37;
+   const unsigned int sNumBands = 70;
+   const unsigned int sNumSignatures = 300;
+
+   // Use a fixed linear congruential generator so every run compares the same values
+   double nextValue(unsigned int& seed)
+   {
+      seed = seed * 1103515245 + 12345;
+      return static_cast<double>((seed >> 8) % 10000) / 100.0;
+   }
+
+   bool compareMethod(RasterElement* pRaster, SignatureLibrary* pLibrary, SpectralMatching::MatchMethod method,
+      const std::string& methodName, std::ostream& failure)
+   {
+      std::string errorMessage;
+      ModelResource<RasterElement> pResult(SpectralMatching::matchLibrary(pRaster, pLibrary, method,
+         "Spectral Matching Test Result", NULL, NULL, NULL, errorMessage));
+      if (pResult.get() == NULL)
+      {
+         failure << methodName << ": " << errorMessage << "\n";
+         return false;
+      }
+
+      const float* pScores = reinterpret_cast<const float*>(pResult->getRawData());
+      const double* pPixels = reinterpret_cast<const double*>(pRaster->getRawData());
+      if (pScores == NULL || pPixels == NULL)
+      {
+         failure << methodName << ": The scores are not in memory.\n";
+         return false;
+      }
+
+      // The library is left resampled to the wavelengths of the cube
+      for (unsigned int pixel = 0; pixel < sNumRows * sNumColumns; ++pixel)
+      {
+         for (unsigned int signature = 0; signature < sNumSignatures; ++signature)
+         {
+            double expected = SpectralMatching::computeScore(method, pPixels + pixel * sNumBands,
+               pLibrary->getOrdinateData(signature), sNumBands);
+            double actual = pScores[pixel * sNumSignatures + signature];
+            if (fabs(actual - expected) > 1e-4 * std::max(1.0, fabs(expected)))
+            {
+               failure << methodName << ": The score of pixel " << pixel << " for signature " <<
+                  signature << " is " << actual << " instead of " << expected << ".\n";
+               return false;
+            }
+         }
+      }
+
+      return true;
+   }
+}
+
+SpectralMatchingTest::SpectralMatchingTest()
+{
+   setCreator("Opticks Community");
+   setVersion("Sample");
+   setCopyright("Copyright (C) 2008, Ball Aerospace & Technologies Corp.");
+   setProductionStatus(false);
+   setName("Spectral Matching Test");
+   setDescription("Compares the scores of every batched library matching method with the single pixel scores.");
+   setMenuLocation("[Tests]\\Spectral Matching Test");
+   setDescriptorId("{8D2B6E41-3F95-4C07-B1A8-E56C0D7294F3}");
+   setWizardSupported(false);
+}
+
+SpectralMatchingTest::~SpectralMatchingTest()
+{
+}
+
+bool SpectralMatchingTest::getInputSpecification(PlugInArgList*& pArgList)
+{
+   pArgList = NULL;
+   return true;
+}
+
+bool SpectralMatchingTest::getOutputSpecification(PlugInArgList*& pArgList)
+{
+   pArgList = NULL;
+   return true;
+}
+
+bool SpectralMatchingTest::execute(PlugInArgList* pInArgList, PlugInArgList* pOutArgList)
+{
+   std::stringstream failure;
+   bool success = runAllTests(NULL, failure);
+   if (isBatch() == false)
+   {
+      Service<DesktopServices>()->showMessageBox(getName(), success ? "All methods match." : failure.str());
+   }
+
+   return success;
+}
+
+bool SpectralMatchingTest::runOperationalTests(Progress* pProgress, std::ostream& failure)
+{
+   return runAllTests(pProgress, failure);
+}
+
+bool SpectralMatchingTest::runAllTests(Progress* pProgress, std::ostream& failure)
+{
+   ModelResource<RasterElement> pRaster(RasterUtilities::createRasterElement("Spectral Matching Test Cube",
+      sNumRows, sNumColumns, sNumBands, FLT8BYTES, BIP, true, NULL));
+   if (pRaster.get() == NULL || pRaster->getRawData() == NULL)
+   {
+      failure << "Unable to create the test cube.\n";
+      return false;
+   }
+
+   std::vector<double> wavelengths(sNumBands);
+   for (unsigned int band = 0; band < sNumBands; ++band)
+   {
+      wavelengths[band] = 0.4 + 0.01 * band;
+   }
+   pRaster->getMetadata()->setAttributeByPath(CENTER_WAVELENGTHS_METADATA_PATH, wavelengths);
+
+   // The first pixel has no spectral variation and the second is zero, which have special scores
+   unsigned int seed = 12345;
+   double* pPixels = reinterpret_cast<double*>(pRaster->getRawData());
+   for (unsigned int value = 0; value < sNumRows * sNumColumns * sNumBands; ++value)
+   {
+      if (value < sNumBands)
+      {
+         pPixels[value] = 5.0;
+      }
+      else if (value < 2 * sNumBands)
+      {
+         pPixels[value] = 0.0;
+      }
+      else
+      {
+         pPixels[value] = nextValue(seed);
+      }
+   }
+
+   ModelResource<SignatureLibrary> pLibrary("Spectral Matching Test Library", NULL);
+   if (pLibrary.get() == NULL)
+   {
+      failure << "Unable to create the test library.\n";
+      return false;
+   }
+   pLibrary->getMetadata()->setAttributeByPath(CENTER_WAVELENGTHS_METADATA_PATH, wavelengths);
+
+   std::vector<Signature*> signatures;
+   for (unsigned int signature = 0; signature < sNumSignatures; ++signature)
+   {
+      std::vector<double> reflectances(sNumBands);
+      for (unsigned int band = 0; band < sNumBands; ++band)
+      {
+         reflectances[band] = nextValue(seed);
+      }
+
+      Signature* pSignature = ModelResource<Signature>("Signature " + StringUtilities::toDisplayString(signature),
+         pLibrary.get()).release();
+      if (pSignature == NULL)
+      {
+         failure << "Unable to create the test signatures.\n";
+         return false;
+      }
+      pSignature->setData("Reflectance", reflectances);
+      pSignature->setData("Wavelength", wavelengths);
+      signatures.push_back(pSignature);
+   }
+
+   if (pLibrary->insertSignatures(signatures) == false)
+   {
+      failure << "Unable to add the test signatures to the library.\n";
+      return false;
+   }
+
+   bool success = compareMethod(pRaster.get(), pLibrary.get(), SpectralMatching::SPECTRAL_ANGLE,
+      "Spectral Angle", failure);
+   success = compareMethod(pRaster.get(), pLibrary.get(), SpectralMatching::EUCLIDEAN_DISTANCE,
+      "Euclidean Distance", failure) && success;
+   success = compareMethod(pRaster.get(), pLibrary.get(), SpectralMatching::CORRELATION_COEFFICIENT,
+      "Correlation Coefficient", failure) && success;
+   return success;
+}
@@ -0,0 +1,30 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2007 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from   
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#ifndef SPECTRALMATCHINGTEST_H
+#define SPECTRALMATCHINGTEST_H
+
+#include "AlgorithmShell.h"
+#include "Testable.h"
+
+class SpectralMatchingTest : public AlgorithmShell, public Testable
+{
+public:
+   SpectralMatchingTest();
+   ~SpectralMatchingTest();
+
+   bool getInputSpecification(PlugInArgList*& pArgList);
+   bool getOutputSpecification(PlugInArgList*& pArgList);
+   bool execute(PlugInArgList* pInArgList, PlugInArgList* pOutArgList);
+
+   bool runOperationalTests(Progress* pProgress, std::ostream& failure);
+   bool runAllTests(Progress* pProgress, std::ostream& failure);
+};
+
+#endif
@@ -0,0 +1,118 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2007 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from   
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#include "AppVerify.h"
+#include "DesktopServices.h"
+#include "PlugInArgList.h"
+#include "PlugInManagerServices.h"
+#include "TimingTest.h"
+
+#include <sstream>
+
+Stopwatch::Stopwatch()
+{
+   restart();
+}
+
+void Stopwatch::restart()
+{
+   mStartTime = boost::posix_time::microsec_clock::universal_time();
+}
+
+double Stopwatch::getSeconds() const
+{
+   boost::posix_time::time_duration elapsed = boost::posix_time::microsec_clock::universal_time() - mStartTime;
+   return elapsed.total_microseconds() / 1000000.0;
+}
+
+TimingTest::TimingTest(const std::string& name, const std::string& description, const std::string& descriptorId)
+{
+   setCreator("Opticks Community");
+   setVersion("Sample");
+   setCopyright("Copyright (C) 2008, Ball Aerospace & Technologies Corp.");
+   setProductionStatus(false);
+   setName(name);
+   setDescription(description);
+   setMenuLocation("[Tests]\\" + name);
+   setDescriptorId(descriptorId);
+   setWizardSupported(false);
+}
+
+TimingTest::~TimingTest()
+{
+}
+
+bool TimingTest::getInputSpecification(PlugInArgList*& pArgList)
+{
+   pArgList = NULL;
+   return true;
+}
+
+bool TimingTest::getOutputSpecification(PlugInArgList*& pArgList)
+{
+   if (isBatch())
+   {
+      Service<PlugInManagerServices> pPlugInManager;
+      VERIFY(pArgList = pPlugInManager->getPlugInArgList());
+      for (std::vector<std::string>::const_iterator iter = mResultNames.begin(); iter != mResultNames.end(); ++iter)
+      {
+         VERIFY(pArgList->addArg<double>(*iter));
+      }
+   }
+   else
+   {
+      pArgList = NULL;
+   }
+
+   return true;
+}
+
+bool TimingTest::execute(PlugInArgList* pInArgList, PlugInArgList* pOutArgList)
+{
+   std::vector<double> results(mResultNames.size(), 0.0);
+   if (runTest(pInArgList, results) == false)
+   {
+      return false;
+   }
+
+   if (isBatch())
+   {
+      VERIFY(pOutArgList != NULL);
+      for (std::vector<std::string>::size_type i = 0; i < mResultNames.size(); ++i)
+      {
+         pOutArgList->setPlugInArgValue<double>(mResultNames[i], &results[i]);
+      }
+   }
+   else
+   {
+      std::stringstream message;
+      for (std::vector<std::string>::size_type i = 0; i < mResultNames.size(); ++i)
+      {
+         message << mResultNames[i] << ": " << results[i] << "\n";
+      }
+      Service<DesktopServices>()->showMessageBox(getName(), message.str());
+   }
+
+   return true;
+}
+
+double TimingTest::getRate(double count, double seconds)
+{
+   if (seconds <= 0.0)
+   {
+      return 0.0;
+   }
+
+   return count / seconds;
+}
+
+void TimingTest::addResult(const std::string& name)
+{
+   mResultNames.push_back(name);
+}
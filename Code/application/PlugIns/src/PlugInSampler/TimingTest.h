@@ -0,0 +1,63 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2007 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from   
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#ifndef TIMINGTEST_H
+#define TIMINGTEST_H
+
+#include "AlgorithmShell.h"
+
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+
+#include <string>
+#include <vector>
+
+/**
+ *  Measures elapsed wall-clock time, so multi-threaded code is timed by how
+ *  long it takes rather than by the processor time of all of its threads.
+ */
+class Stopwatch
+{
+public:
+   Stopwatch();
+
+   void restart();
+   double getSeconds() const;
+
+private:
+   boost::posix_time::ptime mStartTime;
+};
+
+/**
+ *  Base class of the sampler timing tests.
+ *
+ *  Each test adds the names of its results in its constructor and sets their
+ *  values in runTest().  In batch mode the results are output arguments, and
+ *  otherwise they are shown in a message box.
+ */
+class TimingTest : public AlgorithmShell
+{
+public:
+   TimingTest(const std::string& name, const std::string& description, const std::string& descriptorId);
+   ~TimingTest();
+
+   bool getInputSpecification(PlugInArgList*& pArgList);
+   bool getOutputSpecification(PlugInArgList*& pArgList);
+   bool execute(PlugInArgList* pInArgList, PlugInArgList* pOutArgList);
+
+   static double getRate(double count, double seconds);
+
+protected:
+   void addResult(const std::string& name);
+   virtual bool runTest(PlugInArgList* pInArgList, std::vector<double>& results) = 0;
+
+private:
+   std::vector<std::string> mResultNames;
+};
+
+#endif
@@ -7,101 +7,458 @@
  * http://www.gnu.org/licenses/lgpl.html
  */
 
+#include "AppVerify.h"
 #include "AppVersion.h"
+#include "DataAccessor.h"
 #include "DataAccessorImpl.h"
+#include "DataRequest.h"
 #include "DesktopServices.h"
+#include "ModelServices.h"
+#include "MultiThreadedAlgorithm.h"
+#include "ObjectResource.h"
 #include "PlugInArgList.h"
 #include "PlugInRegistration.h"
+#include "PlugInResource.h"
 #include "ProgressTracker.h"
 #include "RasterDataDescriptor.h"
+#include "RasterElement.h"
 #include "RasterUtilities.h"
 #include "SpatialResampler.h"
 #include "SpatialResamplerOptions.h"
+#include "switchOnEncoding.h"
 
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <math.h>
 #include <string>
-
-#include <opencv2/imgproc/imgproc.hpp>
+#include <vector>
 
 REGISTER_PLUGIN_BASIC(OpticksSpatialResampler, SpatialResampler);
+REGISTER_PLUGIN_BASIC(OpticksSpatialResampler, SpatialResamplerPager);
 
 namespace
 {
    // Ensures output file can be created by removing an existing
    // one if necessary.
-   void ensureOutput(const std::string& name)
+   void ensureOutput(const std::string& name, DataElement* pParent)
    {
       DataElement* pExistingOutput =
-         Service<ModelServices>()->getElement(name, TypeConverter::toString<RasterElement>(), NULL);
+         Service<ModelServices>()->getElement(name, TypeConverter::toString<RasterElement>(), pParent);
       if (pExistingOutput != NULL)
       {
          Service<ModelServices>()->destroyElement(pExistingOutput);
       }
    }
 
-   template<typename T>
-   void getOriginalAsType(T *pSource, cv::Mat sData, int row, int col)
+   double cubicWeight(double x)
    {
-      sData.at<T>(row , col) = *pSource;
+      // Cubic convolution with a = -0.75
+      const double a = -0.75;
+      x = fabs(x);
+      if (x <= 1.0)
+      {
+         return ((a + 2.0) * x - (a + 3.0)) * x * x + 1.0;
+      }
+      if (x < 2.0)
+      {
+         return ((a * x - 5.0 * a) * x + 8.0 * a) * x - 4.0 * a;
+      }
+      return 0.0;
    }
 
-   template<typename T>
-   void putOriginalAsType(T *pSource, cv::Mat sData, int row, int col)
+   double lanczos4Weight(double x)
    {
-      *pSource = sData.at<T>(row , col);
+      if (fabs(x) < 1e-12)
+      {
+         return 1.0;
+      }
+      if (fabs(x) >= 4.0)
+      {
+         return 0.0;
+      }
+      return 4.0 * sin(PI * x) * sin(PI * x / 4.0) / (PI * PI * x * x);
    }
 
-   int convertEncodingTypeOpenCV(EncodingType encodingType)
+   /**
+    * The source pixels and weights contributing to each output pixel along one axis.
+    *
+    * Every output pixel uses the same number of taps. Taps which fall outside of
+    * the source are clamped to the nearest edge pixel.
+    */
+   struct ResampleTaps
+   {
+      ResampleTaps() :
+         mCount(0)
+      {}
+
+      unsigned int mCount;
+      std::vector<unsigned int> mIndices;
+      std::vector<double> mWeights;
+   };
+
+   void computeTaps(unsigned int srcSize, unsigned int dstSize, InterpolationType interpolationMethod,
+      ResampleTaps& taps)
    {
-      switch (encodingType)
+      const double scale = static_cast<double>(srcSize) / dstSize;
+      const int lastIndex = static_cast<int>(srcSize) - 1;
+      if (interpolationMethod == INTERP_AREA && scale <= 1.0)
       {
-      case INT1SBYTE:
-         return CV_8S;
-      case INT1UBYTE:
-         return CV_8U;
-      case INT2SBYTES:
-         return CV_16S;
-      case INT2UBYTES:
-         return CV_16U;
-      case INT4SBYTES:
-         return CV_32S;
-      case INT4UBYTES:         // OpenCV doesn't have unsigned int as a type it can work with.
-         return CV_USRTYPE1;   // So substitute USERTYPE1.
-      case FLT4BYTES:
-         return CV_32F;
-      case FLT8BYTES:
-         return CV_64F;
-      case INT4SCOMPLEX:
-      case FLT8COMPLEX:        // OpenCV doesn't support complex data.
-      default:
-         return CV_USRTYPE1;   // So, substitute USRTYPE1.
+         // Up-sampling by area is equivalent to nearest neighbor
+         interpolationMethod = INTERP_NEAREST_NEIGHBOR;
       }
-   }
 
-   int convertInterpolationMethodOpenCV(InterpolationType interpolationMethod)
-   {
-      int cvInterpMethod;
+      int radius = 0;
+      double (*pWeight)(double) = NULL;
       switch (interpolationMethod)
       {
       case INTERP_NEAREST_NEIGHBOR:
-         cvInterpMethod = cv::INTER_NEAREST;
-         break;
-      case INTERP_BILINEAR:
-         cvInterpMethod = cv::INTER_LINEAR;
+         taps.mCount = 1;
          break;
       case INTERP_AREA:
-         cvInterpMethod = cv::INTER_AREA;
+         taps.mCount = static_cast<unsigned int>(ceil(scale)) + 1;
          break;
-      case INTERP_BICUBIC:
-         cvInterpMethod = cv::INTER_CUBIC;
+      case INTERP_BILINEAR:
+         radius = 1;
          break;
       case INTERP_LANCZOS4:
-         cvInterpMethod = cv::INTER_LANCZOS4;
+         radius = 4;
+         pWeight = lanczos4Weight;
          break;
+      case INTERP_BICUBIC:
       default:
-         cvInterpMethod = cv::INTER_CUBIC;
+         radius = 2;
+         pWeight = cubicWeight;
+         break;
+      }
+      if (radius > 0)
+      {
+         taps.mCount = 2 * radius;
+      }
+
+      taps.mIndices.resize(static_cast<size_t>(dstSize) * taps.mCount);
+      taps.mWeights.resize(taps.mIndices.size());
+      for (unsigned int dst = 0; dst < dstSize; ++dst)
+      {
+         unsigned int* pIndices = &taps.mIndices[static_cast<size_t>(dst) * taps.mCount];
+         double* pWeights = &taps.mWeights[static_cast<size_t>(dst) * taps.mCount];
+         if (interpolationMethod == INTERP_NEAREST_NEIGHBOR)
+         {
+            pIndices[0] = std::min(static_cast<int>(floor(dst * scale)), lastIndex);
+            pWeights[0] = 1.0;
+            continue;
+         }
+
+         if (interpolationMethod == INTERP_AREA)
+         {
+            // Average the source pixels covered by the output pixel
+            const double start = dst * scale;
+            const double stop = start + scale;
+            const int first = static_cast<int>(floor(start));
+            for (unsigned int tap = 0; tap < taps.mCount; ++tap)
+            {
+               const int src = first + static_cast<int>(tap);
+               const double overlap = std::min(stop, src + 1.0) - std::max(start, static_cast<double>(src));
+               pIndices[tap] = std::max(0, std::min(src, lastIndex));
+               pWeights[tap] = (overlap > 0.0 && src <= lastIndex) ? overlap / scale : 0.0;
+            }
+            continue;
+         }
+
+         // Align the pixel centers of the source and the output
+         const double center = (dst + 0.5) * scale - 0.5;
+         const int first = static_cast<int>(floor(center)) - radius + 1;
+         double total = 0.0;
+         for (unsigned int tap = 0; tap < taps.mCount; ++tap)
+         {
+            const int src = first + static_cast<int>(tap);
+            const double distance = center - src;
+            pIndices[tap] = std::max(0, std::min(src, lastIndex));
+            pWeights[tap] = (pWeight == NULL) ? std::max(0.0, 1.0 - fabs(distance)) : pWeight(distance);
+            total += pWeights[tap];
+         }
+         if (total != 0.0)
+         {
+            for (unsigned int tap = 0; tap < taps.mCount; ++tap)
+            {
+               pWeights[tap] /= total;
+            }
+         }
+      }
+   }
+
+   template<typename T>
+   void readRow(T*, DataAccessor& accessor, std::vector<double>& values)
+   {
+      for (std::vector<double>::iterator value = values.begin(); value != values.end(); ++value)
+      {
+         *value = static_cast<double>(*reinterpret_cast<T*>(accessor->getColumn()));
+         accessor->nextColumn();
+      }
+   }
+
+   template<typename T>
+   T convertValue(double value)
+   {
+      if (std::numeric_limits<T>::is_integer)
+      {
+         // Round and saturate to the range of the data type
+         value = floor(value + 0.5);
+         value = std::max(value, static_cast<double>(std::numeric_limits<T>::min()));
+         value = std::min(value, static_cast<double>(std::numeric_limits<T>::max()));
+      }
+      return static_cast<T>(value);
+   }
+
+   template<typename T>
+   void writeRow(T*, DataAccessor& accessor, const std::vector<double>& values)
+   {
+      for (std::vector<double>::const_iterator value = values.begin(); value != values.end(); ++value)
+      {
+         *reinterpret_cast<T*>(accessor->getColumn()) = convertValue<T>(*value);
+         accessor->nextColumn();
+      }
+   }
+
+   template<typename T>
+   void storeRow(T* pRow, const std::vector<double>& values)
+   {
+      for (std::vector<double>::const_iterator value = values.begin(); value != values.end(); ++value)
+      {
+         *pRow++ = convertValue<T>(*value);
       }
-      return cvInterpMethod;
    }
+
+   /**
+    * Resamples the rows of one source band.
+    *
+    * Each source row is read once and resampled horizontally. The horizontally
+    * resampled rows are kept only while an output row still needs them, so the
+    * memory used depends on the row width and the kernel size rather than on
+    * the size of the data set. Output rows must be resampled in increasing order.
+    */
+   class RowResampler
+   {
+   public:
+      RowResampler(DataAccessor& srcAcc, EncodingType encoding, unsigned int srcColumnCount,
+         const ResampleTaps& rowTaps, const ResampleTaps& columnTaps) :
+         mSrcAcc(srcAcc),
+         mEncoding(encoding),
+         mRowTaps(rowTaps),
+         mColumnTaps(columnTaps),
+         mSrcValues(srcColumnCount)
+      {}
+
+      bool resampleRow(unsigned int row, std::vector<double>& destValues)
+      {
+         const unsigned int columnCount = destValues.size();
+         const unsigned int* pRowIndices = &mRowTaps.mIndices[row * mRowTaps.mCount];
+         const double* pRowWeights = &mRowTaps.mWeights[row * mRowTaps.mCount];
+         mWindow.erase(mWindow.begin(), mWindow.lower_bound(
+            *std::min_element(pRowIndices, pRowIndices + mRowTaps.mCount)));
+
+         std::fill(destValues.begin(), destValues.end(), 0.0);
+         for (unsigned int rowTap = 0; rowTap < mRowTaps.mCount; ++rowTap)
+         {
+            if (pRowWeights[rowTap] == 0.0)
+            {
+               continue;
+            }
+
+            std::map<unsigned int, std::vector<double> >::iterator windowRow = mWindow.find(pRowIndices[rowTap]);
+            if (windowRow == mWindow.end())
+            {
+               mSrcAcc->toPixel(pRowIndices[rowTap], 0);
+               if (!mSrcAcc.isValid())
+               {
+                  return false;
+               }
+               switchOnEncoding(mEncoding, readRow, NULL, mSrcAcc, mSrcValues);
+
+               windowRow = mWindow.insert(std::make_pair(pRowIndices[rowTap], std::vector<double>())).first;
+               std::vector<double>& values = windowRow->second;
+               values.resize(columnCount);
+               const unsigned int* pColumnIndex = &mColumnTaps.mIndices.front();
+               const double* pColumnWeight = &mColumnTaps.mWeights.front();
+               for (unsigned int column = 0; column < columnCount; ++column)
+               {
+                  double value = 0.0;
+                  for (unsigned int columnTap = 0; columnTap < mColumnTaps.mCount; ++columnTap)
+                  {
+                     value += *pColumnWeight++ * mSrcValues[*pColumnIndex++];
+                  }
+                  values[column] = value;
+               }
+            }
+
+            const std::vector<double>& values = windowRow->second;
+            for (unsigned int column = 0; column < columnCount; ++column)
+            {
+               destValues[column] += pRowWeights[rowTap] * values[column];
+            }
+         }
+         return true;
+      }
+
+   private:
+      RowResampler& operator=(const RowResampler& rhs);
+
+      DataAccessor& mSrcAcc;
+      EncodingType mEncoding;
+      const ResampleTaps& mRowTaps;
+      const ResampleTaps& mColumnTaps;
+      std::vector<double> mSrcValues;
+
+      // Horizontally resampled source rows, keyed by source row number
+      std::map<unsigned int, std::vector<double> > mWindow;
+   };
+
+   /**
+    * Returns the range of source rows needed to resample a range of output rows.
+    */
+   void getSourceRows(const ResampleTaps& rowTaps, unsigned int firstRow, unsigned int rowCount,
+      unsigned int& firstSrcRow, unsigned int& lastSrcRow)
+   {
+      std::vector<unsigned int>::const_iterator firstTap = rowTaps.mIndices.begin() + firstRow * rowTaps.mCount;
+      std::vector<unsigned int>::const_iterator lastTap = firstTap + rowCount * rowTaps.mCount;
+      firstSrcRow = *std::min_element(firstTap, lastTap);
+      lastSrcRow = *std::max_element(firstTap, lastTap);
+   }
+
+   struct ResampleInput
+   {
+      ResampleInput() :
+         mpSource(NULL),
+         mpResult(NULL),
+         mpAbortFlag(NULL)
+      {}
+
+      const RasterElement* mpSource;
+      RasterElement* mpResult;
+      const bool* mpAbortFlag;
+      ResampleTaps mRowTaps;
+      ResampleTaps mColumnTaps;
+   };
+
+   /**
+    * Resamples a range of output rows in every band.
+    */
+   class ResampleThread : public mta::AlgorithmThread
+   {
+   public:
+      ResampleThread(const ResampleInput& input, int threadCount, int threadIndex, mta::ThreadReporter& reporter) :
+         mta::AlgorithmThread(threadIndex, reporter),
+         mInput(input),
+         mRange(getThreadRange(threadCount, static_cast<int>(
+            input.mRowTaps.mIndices.size() / std::max(input.mRowTaps.mCount, 1U)))),
+         mComplete(false)
+      {}
+
+      bool isComplete() const
+      {
+         return mComplete;
+      }
+
+      void run()
+      {
+         const RasterDataDescriptor* pSrcDesc =
+            dynamic_cast<const RasterDataDescriptor*>(mInput.mpSource->getDataDescriptor());
+         const RasterDataDescriptor* pDestDesc =
+            dynamic_cast<const RasterDataDescriptor*>(mInput.mpResult->getDataDescriptor());
+         if (pSrcDesc == NULL || pDestDesc == NULL)
+         {
+            return;
+         }
+         if (mRange.mFirst > mRange.mLast)
+         {
+            mComplete = true;
+            return;
+         }
+
+         const ResampleTaps& rowTaps = mInput.mRowTaps;
+         const ResampleTaps& columnTaps = mInput.mColumnTaps;
+         const EncodingType encoding = pSrcDesc->getDataType();
+         const unsigned int bandCount = pDestDesc->getBandCount();
+         const unsigned int columnCount = pDestDesc->getColumnCount();
+         const unsigned int rowCount = mRange.mLast - mRange.mFirst + 1;
+
+         // Only read the source rows needed by the kernel for this range of output rows
+         unsigned int firstSrcRow = 0;
+         unsigned int lastSrcRow = 0;
+         getSourceRows(rowTaps, mRange.mFirst, rowCount, firstSrcRow, lastSrcRow);
+
+         std::vector<double> destValues(columnCount);
+         int oldPercent = -1;
+         for (unsigned int band = 0; band < bandCount; ++band)
+         {
+            FactoryResource<DataRequest> pRequest;
+            pRequest->setRows(pSrcDesc->getActiveRow(firstSrcRow), pSrcDesc->getActiveRow(lastSrcRow));
+            pRequest->setBands(pSrcDesc->getActiveBand(band), pSrcDesc->getActiveBand(band));
+            DataAccessor srcAcc = mInput.mpSource->getDataAccessor(pRequest.release());
+
+            FactoryResource<DataRequest> pResultRequest;
+            pResultRequest->setRows(pDestDesc->getActiveRow(mRange.mFirst), pDestDesc->getActiveRow(mRange.mLast));
+            pResultRequest->setBands(pDestDesc->getActiveBand(band), pDestDesc->getActiveBand(band));
+            pResultRequest->setWritable(true);
+            DataAccessor destAcc = mInput.mpResult->getDataAccessor(pResultRequest.release());
+            if (!srcAcc.isValid() || !destAcc.isValid())
+            {
+               return;
+            }
+
+            RowResampler resampler(srcAcc, encoding, pSrcDesc->getColumnCount(), rowTaps, columnTaps);
+            for (int row = mRange.mFirst; row <= mRange.mLast; ++row)
+            {
+               int percent = static_cast<int>(100.0 * (band * rowCount + row - mRange.mFirst) / (bandCount * rowCount));
+               if (percent != oldPercent)
+               {
+                  if (mInput.mpAbortFlag != NULL && *mInput.mpAbortFlag)
+                  {
+                     return;
+                  }
+                  getReporter().reportProgress(getThreadIndex(), percent);
+                  oldPercent = percent;
+               }
+
+               if (!resampler.resampleRow(row, destValues))
+               {
+                  return;
+               }
+
+               destAcc->toPixel(row, 0);
+               if (!destAcc.isValid())
+               {
+                  return;
+               }
+               switchOnEncoding(encoding, writeRow, NULL, destAcc, destValues);
+            }
+         }
+
+         mComplete = true;
+      }
+
+   private:
+      ResampleThread& operator=(const ResampleThread& rhs);
+
+      const ResampleInput& mInput;
+      mta::AlgorithmThread::Range mRange;
+      bool mComplete;
+   };
+
+   struct ResampleOutput
+   {
+      bool compileOverallResults(const std::vector<ResampleThread*>& threads)
+      {
+         for (std::vector<ResampleThread*>::const_iterator thread = threads.begin(); thread != threads.end(); ++thread)
+         {
+            if ((*thread)->isComplete() == false)
+            {
+               return false;
+            }
+         }
+         return true;
+      }
+   };
 }
 
 SpatialResampler::SpatialResampler()
@@ -143,6 +500,9 @@ bool SpatialResampler::getInputSpecification(PlugInArgList*& pArgList)
       InterpolationType interpolationMethod = SpatialResamplerOptions::getSettingInterpolationMethod();
       VERIFY(pArgList->addArg<InterpolationType>("Interpolation Type", interpolationMethod,
          "Type of interpolation used to determine new pixel values"));
+      VERIFY(pArgList->addArg<bool>("Compute On Demand", false, "If true, the resampled data is computed as the "
+         "output element is read instead of being stored.  The output element is read-only and is destroyed with "
+         "the element to be resampled."));
       return true;
    }
    else
@@ -204,9 +564,22 @@ bool SpatialResampler::execute(PlugInArgList* pInArgList, PlugInArgList* pOutArg
       return false;
    }
 
+   bool onDemand = false;
+   if (pInArgList->getPlugInArgValue<bool>("Compute On Demand", onDemand) == false)
+   {
+      progress.report("No compute on demand flag provided.", 0, ERRORS, true);
+      return false;
+   }
+
+   if (xFactor <= 0.0 || yFactor <= 0.0)
+   {
+      progress.report("The scale factors must be greater than zero.", 0, ERRORS, true);
+      return false;
+   }
+
    // Check for previous results and other incurable error conditions before displaying the dialog.
    const std::string outputName = pRasterElement->getDisplayName(true) + "_Resampling_Result";
-   ensureOutput(outputName);
+   ensureOutput(outputName, onDemand ? pRasterElement : NULL);
    RasterDataDescriptor* pSrcDesc = dynamic_cast<RasterDataDescriptor*>(pRasterElement->getDataDescriptor());
    VERIFY(pSrcDesc != NULL);
 
@@ -216,94 +589,159 @@ bool SpatialResampler::execute(PlugInArgList* pInArgList, PlugInArgList* pOutArg
       progress.report("Spatial resampling cannot be performed on complex data.", 0, ERRORS, true);
       return false;
    }
-   else if (srcType == INT4SBYTES || srcType == INT4UBYTES)
+
+   const unsigned int rowCount = static_cast<unsigned int>(yFactor * pSrcDesc->getRowCount());
+   const unsigned int columnCount = static_cast<unsigned int>(xFactor * pSrcDesc->getColumnCount());
+   if (rowCount == 0 || columnCount == 0)
    {
-      progress.report("Spatial resampling cannot be performed on 4-byte integer data.", 0, ERRORS, true);
+      progress.report("The scale factors are too small to produce any output pixels.", 0, ERRORS, true);
       return false;
    }
 
-   FactoryResource<DataRequest> pRequest;
-   DataAccessor pSrcAcc = pRasterElement->getDataAccessor(pRequest.release());
+   if (onDemand)
+   {
+      // The output is resampled as it is read, so it must not outlive the element it reads
+      ExecutableResource pPager("Spatial Resampler Pager");
+      pPager->getInArgList().setPlugInArgValue("Source Element", pRasterElement);
+      pPager->getInArgList().setPlugInArgValue("Interpolation Type", &interpolationMethod);
+      ModelResource<RasterElement> pResultCube(ComputedPager::createElement(outputName, pRasterElement, rowCount,
+         columnCount, pSrcDesc->getBandCount(), srcType, pPager));
+      if (pResultCube.get() == NULL)
+      {
+         progress.report("Unable to create output raster element.", 0, ERRORS, true);
+         return false;
+      }
+      pResultCube->copyClassification(pRasterElement);
+
+      progress.report(getName() + " complete.", 100, NORMAL);
+      progress.upALevel();
+      pOutArgList->setPlugInArgValue(Executable::DataElementArg(), pResultCube.release());
+      return true;
+   }
 
-   ModelResource<RasterElement> pResultCube(RasterUtilities::createRasterElement(
-      outputName, yFactor * pSrcDesc->getRowCount(),
-      xFactor * pSrcDesc->getColumnCount(), pSrcDesc->getDataType()));
+   ModelResource<RasterElement> pResultCube(RasterUtilities::createRasterElement(outputName, rowCount,
+      columnCount, pSrcDesc->getBandCount(), srcType, pSrcDesc->getInterleaveFormat(),
+      pSrcDesc->getProcessingLocation() == IN_MEMORY));
    if (pResultCube.get() == NULL)
    {
       progress.report("Unable to create output raster element.", 0, ERRORS, true);
       return false;
    }
-   FactoryResource<DataRequest> pResultRequest;
-   pResultRequest->setWritable(true);
-   RasterDataDescriptor* pDestDesc = dynamic_cast<RasterDataDescriptor*>(pResultCube->getDataDescriptor());
-   DataAccessor pDestAcc = pResultCube->getDataAccessor(pResultRequest.release());
+   pResultCube->copyClassification(pRasterElement);
+
+   ResampleInput input;
+   input.mpSource = pRasterElement;
+   input.mpResult = pResultCube.get();
+   input.mpAbortFlag = &mAborted;
+   computeTaps(pSrcDesc->getRowCount(), rowCount, interpolationMethod, input.mRowTaps);
+   computeTaps(pSrcDesc->getColumnCount(), columnCount, interpolationMethod, input.mColumnTaps);
 
-   int matType;
-   if (srcType == INT1SBYTE)
+   ResampleOutput output;
+   mta::ProgressObjectReporter reporter("Resampling", progress.getCurrentProgress());
+   mta::MultiThreadedAlgorithm<ResampleInput, ResampleOutput, ResampleThread>
+      alg(mta::getNumRequiredThreads(rowCount), input, output, &reporter);
+   if (alg.run() != mta::SUCCESS || isAborted())
    {
-      // Since cv::resize() doesn't handle signed byte data,
-      // upconvert to signed short for processing.
-      matType = convertEncodingTypeOpenCV(INT2SBYTES);
+      if (isAborted())
+      {
+         progress.report("Cancelled", 0, ABORT, true);
+      }
+      else
+      {
+         progress.report("Unable to resample the data.", 0, ERRORS, true);
+      }
+      return false;
    }
-   else
+
+   progress.report(getName() + " complete.", 100, NORMAL);
+   progress.upALevel();
+   pOutArgList->setPlugInArgValue(Executable::DataElementArg(), pResultCube.release());
+   return true;
+}
+
+SpatialResamplerPager::SpatialResamplerPager() :
+   mpSource(NULL),
+   mInterpolationMethod(INTERP_NEAREST_NEIGHBOR)
+{
+   setName("Spatial Resampler Pager");
+   setCopyright(APP_COPYRIGHT);
+   setCreator("Ball Aerospace & Technologies Corp.");
+   setDescription("Resamples data as the result is read");
+   setDescriptorId("{9c4e2b71-0a8f-4d53-b6e7-3f15d8a2c960}");
+   setVersion(APP_VERSION_NUMBER);
+   setProductionStatus(APP_IS_PRODUCTION_RELEASE);
+   setShortDescription("Spatial resampler pager");
+}
+
+SpatialResamplerPager::~SpatialResamplerPager()
+{}
+
+bool SpatialResamplerPager::getInputSpecification(PlugInArgList*& pArgList)
+{
+   if (!ComputedPager::getInputSpecification(pArgList))
+   {
+      return false;
+   }
+   VERIFY(pArgList->addArg<RasterElement>("Source Element", NULL, "Element to be resampled."));
+   VERIFY(pArgList->addArg<InterpolationType>("Interpolation Type", INTERP_NEAREST_NEIGHBOR,
+      "Type of interpolation used to determine new pixel values"));
+   return true;
+}
+
+bool SpatialResamplerPager::parseInputArgs(PlugInArgList* pInputArgList)
+{
+   if (!ComputedPager::parseInputArgs(pInputArgList))
    {
-      matType = convertEncodingTypeOpenCV(srcType);
+      return false;
    }
-   try
+   mpSource = pInputArgList->getPlugInArgValue<RasterElement>("Source Element");
+   if (mpSource == NULL || pInputArgList->getPlugInArgValue("Interpolation Type", mInterpolationMethod) == false)
    {
-      cv::Mat testMat(pSrcDesc->getRowCount(), pSrcDesc->getColumnCount(), matType);
-      int progressPercent = 0;
-      progress.report("Reading source data", progressPercent, NORMAL);
-      float totalRows = pSrcDesc->getRowCount();
+      return false;
+   }
 
-      for (unsigned int row = 0; row < pSrcDesc->getRowCount(); ++row)
-      {
-         for (unsigned int col = 0; col < pSrcDesc->getColumnCount(); ++col)
-         {
-            VERIFY(pSrcAcc.isValid());
-            switchOnEncoding(pSrcDesc->getDataType(), getOriginalAsType, pSrcAcc->getColumn(), testMat, row, col);
-            pSrcAcc->nextColumn();
-         }
-         pSrcAcc->nextRow();
-         if (isAborted() == true)
-         {
-            progress.report("Cancelled", 0, ABORT, true);
-            return false;
-         }
-         progressPercent = row / totalRows * 33;
-         progress.report("Reading source data", progressPercent, NORMAL);
-      }
+   const RasterDataDescriptor* pSrcDesc = dynamic_cast<const RasterDataDescriptor*>(mpSource->getDataDescriptor());
+   return pSrcDesc != NULL && static_cast<int>(pSrcDesc->getBandCount()) == getBandCount();
+}
 
-      int cvInterpMethod = convertInterpolationMethodOpenCV(interpolationMethod);
-      cv::Mat resultsMat(yFactor * pSrcDesc->getRowCount(), xFactor * pSrcDesc->getColumnCount(), matType);
-      cv::resize(testMat, resultsMat, resultsMat.size(), 0, 0, cvInterpMethod);
+bool SpatialResamplerPager::computeRows(unsigned int startRow, unsigned int rowCount, unsigned int band, char* pData)
+{
+   VERIFY(mpSource != NULL);
+   const RasterDataDescriptor* pSrcDesc = dynamic_cast<const RasterDataDescriptor*>(mpSource->getDataDescriptor());
+   const RasterDataDescriptor* pDestDesc =
+      dynamic_cast<const RasterDataDescriptor*>(getRasterElement()->getDataDescriptor());
+   VERIFY(pSrcDesc != NULL && pDestDesc != NULL);
 
-      totalRows = resultsMat.rows;
-      for (int row = 0; row < resultsMat.rows; ++row)
-      {
-         for (int col = 0; col < resultsMat.cols; ++col)
-         {
-            switchOnEncoding(pSrcDesc->getDataType(), putOriginalAsType, pDestAcc->getColumn(), resultsMat, row, col);
-            pDestAcc->nextColumn();
-         }
-         pDestAcc->nextRow();
-         if (isAborted())
-         {
-            progress.report("Cancelled", 0, ABORT, true);
-            return false;
-         }
-         progressPercent = row / totalRows * 33 + 64;
-         progress.report("Writing result data", progressPercent, NORMAL);
-      }
-   }
-   catch (cv::Exception ev)
+   // The taps are small next to the data of a block, so they are not kept between blocks
+   ResampleTaps rowTaps;
+   ResampleTaps columnTaps;
+   computeTaps(pSrcDesc->getRowCount(), pDestDesc->getRowCount(), mInterpolationMethod, rowTaps);
+   computeTaps(pSrcDesc->getColumnCount(), pDestDesc->getColumnCount(), mInterpolationMethod, columnTaps);
+
+   unsigned int firstSrcRow = 0;
+   unsigned int lastSrcRow = 0;
+   getSourceRows(rowTaps, startRow, rowCount, firstSrcRow, lastSrcRow);
+
+   FactoryResource<DataRequest> pRequest;
+   pRequest->setRows(pSrcDesc->getActiveRow(firstSrcRow), pSrcDesc->getActiveRow(lastSrcRow));
+   pRequest->setBands(pSrcDesc->getActiveBand(band), pSrcDesc->getActiveBand(band));
+   DataAccessor srcAcc = mpSource->getDataAccessor(pRequest.release());
+   if (!srcAcc.isValid())
    {
-      progress.report(ev.msg, 0, ERRORS, true);
       return false;
    }
 
-   progress.report(getName() + " complete.", 100, NORMAL);
-   progress.upALevel();
-   pOutArgList->setPlugInArgValue(Executable::DataElementArg(), pResultCube.release());
+   const EncodingType encoding = pSrcDesc->getDataType();
+   const size_t rowBytes = static_cast<size_t>(getColumnCount()) * getBytesPerBand();
+   std::vector<double> destValues(pDestDesc->getColumnCount());
+   RowResampler resampler(srcAcc, encoding, pSrcDesc->getColumnCount(), rowTaps, columnTaps);
+   for (unsigned int row = 0; row < rowCount; ++row)
+   {
+      if (!resampler.resampleRow(startRow + row, destValues))
+      {
+         return false;
+      }
+      switchOnEncoding(encoding, storeRow, pData + row * rowBytes, destValues);
+   }
    return true;
-}
\ No newline at end of file
+}
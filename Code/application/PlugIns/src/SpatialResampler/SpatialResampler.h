@@ -11,6 +11,10 @@
 #define SPATIALRESAMPLER_H
 
 #include "AlgorithmShell.h"
+#include "ComputedPager.h"
+#include "TypesFile.h"
+
+class RasterElement;
 
 class SpatialResampler : public AlgorithmShell
 {
@@ -25,4 +29,26 @@ public:
    virtual bool setInteractive();
 };
 
+/**
+ * Resamples a block of rows at a time as the result is read.
+ */
+class SpatialResamplerPager : public ComputedPager
+{
+public:
+   SpatialResamplerPager();
+   virtual ~SpatialResamplerPager();
+
+   virtual bool getInputSpecification(PlugInArgList*& pArgList);
+   virtual bool parseInputArgs(PlugInArgList* pInputArgList);
+
+protected:
+   virtual bool computeRows(unsigned int startRow, unsigned int rowCount, unsigned int band, char* pData);
+
+private:
+   SpatialResamplerPager& operator=(const SpatialResamplerPager& rhs);
+
+   const RasterElement* mpSource;
+   InterpolationType mInterpolationMethod;
+};
+
 #endif
\ No newline at end of file
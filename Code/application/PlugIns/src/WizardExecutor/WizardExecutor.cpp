@@ -19,6 +19,7 @@
 #include "Layer.h"
 #include "MessageLogResource.h"
 #include "ModelServices.h"
+#include "MultiThreadedAlgorithm.h"
 #include "ObjectFactory.h"
 #include "ObjectResource.h"
 #include "PlugInArg.h"
@@ -38,16 +39,133 @@
 #include "xmlreader.h"
 
 #include <QtCore/QDir>
+#include <QtCore/QTime>
 #include <QtGui/QFileDialog>
 
+#include <algorithm>
+
 using namespace std;
 
 REGISTER_PLUGIN_BASIC(OpticksWizardExecutor, WizardExecutor);
 
+namespace
+{
+   struct ItemResult
+   {
+      ItemResult() :
+         mIndex(0),
+         mSuccess(false),
+         mSeconds(0.0)
+      {}
+
+      int mIndex;
+      bool mSuccess;
+      double mSeconds;
+      string mError;
+   };
+
+   struct ItemExecutionInput
+   {
+      ItemExecutionInput() :
+         mpMutex(NULL),
+         mpFailed(NULL),
+         mpAborted(NULL)
+      {}
+
+      vector<ExecutableAgent*> mExecutables;
+      mta::DMutex* mpMutex;
+      bool* mpFailed;
+      const bool* mpAborted;
+   };
+
+   /**
+    * Executes a range of a group of wizard items which are not connected to each other.
+    */
+   class ItemExecutionThread : public mta::AlgorithmThread
+   {
+   public:
+      ItemExecutionThread(const ItemExecutionInput& input, int threadCount, int threadIndex,
+         mta::ThreadReporter& reporter) :
+         mta::AlgorithmThread(threadIndex, reporter),
+         mInput(input),
+         mRange(getThreadRange(threadCount, static_cast<int>(input.mExecutables.size())))
+      {}
+
+      void run()
+      {
+         for (int i = mRange.mFirst; i <= mRange.mLast; ++i)
+         {
+            // Do not start any more items once an item has failed or the wizard has been aborted
+            {
+               mta::MutexLock lock(*mInput.mpMutex);
+               if (*mInput.mpFailed || *mInput.mpAborted)
+               {
+                  break;
+               }
+            }
+
+            ItemResult result;
+            result.mIndex = i;
+
+            QTime executionTime;
+            executionTime.start();
+            try
+            {
+               result.mSuccess = mInput.mExecutables[i]->execute();
+            }
+            catch (AssertException exc)
+            {
+               result.mSuccess = false;
+               result.mError = exc.getText();
+            }
+
+            result.mSeconds = executionTime.elapsed() / 1000.0;
+            mResults.push_back(result);
+            if (result.mSuccess == false)
+            {
+               mta::MutexLock lock(*mInput.mpMutex);
+               *mInput.mpFailed = true;
+            }
+
+            getReporter().reportProgress(getThreadIndex(), mRange.computePercent(i + 1));
+         }
+      }
+
+      const vector<ItemResult>& getResults() const
+      {
+         return mResults;
+      }
+
+   private:
+      ItemExecutionThread& operator=(const ItemExecutionThread& rhs);
+
+      const ItemExecutionInput& mInput;
+      Range mRange;
+      vector<ItemResult> mResults;
+   };
+
+   struct ItemExecutionOutput
+   {
+      bool compileOverallResults(const vector<ItemExecutionThread*>& threads)
+      {
+         for (vector<ItemExecutionThread*>::const_iterator iter = threads.begin(); iter != threads.end(); ++iter)
+         {
+            const vector<ItemResult>& results = (*iter)->getResults();
+            mResults.insert(mResults.end(), results.begin(), results.end());
+         }
+
+         return true;
+      }
+
+      vector<ItemResult> mResults;
+   };
+}
+
 WizardExecutor::WizardExecutor() :
    mbInteractive(false),
    mbAbort(false),
    mbDeleteWizard(false),
+   mbParallel(false),
    mpProgress(NULL),
    mpWizard(NULL),
    mpCurrentPlugIn(NULL),
@@ -96,6 +214,11 @@ bool WizardExecutor::hasAbort()
       bSuccess = mpCurrentPlugIn->hasAbort();
    }
 
+   for (vector<Executable*>::const_iterator iter = mParallelPlugIns.begin(); iter != mParallelPlugIns.end(); ++iter)
+   {
+      bSuccess = (*iter)->hasAbort() && bSuccess;
+   }
+
    return bSuccess;
 }
 
@@ -111,6 +234,9 @@ bool WizardExecutor::getInputSpecification(PlugInArgList*& pArgList)
    VERIFY(pArgList->addArg<Progress>(Executable::ProgressArg(), NULL, Executable::ProgressArgDescription()));
    VERIFY(pArgList->addArg<WizardObject>("Wizard", NULL, "Wizard object."));
    VERIFY(pArgList->addArg<Filename>("Filename", NULL, ".wiz file to be executed."));
+   VERIFY(pArgList->addArg<bool>("Parallel Execution", false, "If true, consecutive batch mode items which are not "
+      "connected to each other are executed at the same time. Only enable this for wizards whose plug-ins can "
+      "safely execute concurrently."));
 
    return true;
 }
@@ -163,6 +289,7 @@ bool WizardExecutor::execute(PlugInArgList* pInArgList, PlugInArgList* pOutArgLi
    pStep->addMessage(mMessage, "app", "2D53370C-DD0D-4160-9BD5-4D46C49A4B7E", true);
 
    vector<WizardItem*> populateList;
+   vector<WizardItem*> parallelItems;
    for (vector<WizardItem*>::const_iterator wiIter = wizardItems.begin(); wiIter != wizardItems.end(); ++wiIter)
    {
       bool bSuccess = false;
@@ -180,7 +307,22 @@ bool WizardExecutor::execute(PlugInArgList* pInArgList, PlugInArgList* pOutArgLi
          populateList.push_back(*wiIter);
          continue;
       }
-      if (!WizardUtilities::editItems(populateList, Service<DesktopServices>()->getMainWidget()))
+
+      // collect consecutive items which do not depend on each other and execute them at the same time
+      // once the next item cannot join them, so that each item sees the same inputs as in serial order
+      if (populateList.empty() && canLaunchInParallel(pItem, parallelItems))
+      {
+         parallelItems.push_back(pItem);
+         vector<WizardItem*>::const_iterator nextIter = wiIter + 1;
+         if (nextIter != wizardItems.end() && canLaunchInParallel(*nextIter, parallelItems))
+         {
+            continue;
+         }
+
+         bSuccess = launchPlugIns(parallelItems);
+         parallelItems.clear();
+      }
+      else if (!WizardUtilities::editItems(populateList, Service<DesktopServices>()->getMainWidget()))
       {
          mMessage = "Wizard cancelled by user.";
          if (mbDeleteWizard)
@@ -198,23 +340,26 @@ bool WizardExecutor::execute(PlugInArgList* pInArgList, PlugInArgList* pOutArgLi
          pStep->finalize(Message::Abort, mMessage);
          return false;
       }
-      populateList.push_back(*wiIter);
-      for (vector<WizardItem*>::const_iterator plIter = populateList.begin(); plIter != populateList.end(); ++plIter)
+      else
       {
-         if ((*plIter)->getType() == "Value")
-         {
-            mMessage = "Executing Value Item: " + (*plIter)->getName();
-            pStep->addMessage(mMessage, "app", "9FC4024E-00FA-42cd-8EC3-2AAE84843BA7", true);
-            bSuccess = true;
-            setConnectedNodeValues(*plIter);
-         }
-         else
+         populateList.push_back(*wiIter);
+         for (vector<WizardItem*>::const_iterator plIter = populateList.begin(); plIter != populateList.end(); ++plIter)
          {
-            bSuccess = launchPlugIn(*plIter);
-            resetNodeValues(*plIter);
+            if ((*plIter)->getType() == "Value")
+            {
+               mMessage = "Executing Value Item: " + (*plIter)->getName();
+               pStep->addMessage(mMessage, "app", "9FC4024E-00FA-42cd-8EC3-2AAE84843BA7", true);
+               bSuccess = true;
+               setConnectedNodeValues(*plIter);
+            }
+            else
+            {
+               bSuccess = launchPlugIn(*plIter);
+               resetNodeValues(*plIter);
+            }
          }
+         populateList.clear();
       }
-      populateList.clear();
 
       if (mbAbort)
       {
@@ -323,6 +468,12 @@ bool WizardExecutor::abort()
       bSuccess = mpCurrentPlugIn->abort();
    }
 
+   // Items which are running in parallel are aborted together
+   for (vector<Executable*>::const_iterator iter = mParallelPlugIns.begin(); iter != mParallelPlugIns.end(); ++iter)
+   {
+      bSuccess = (*iter)->abort() && bSuccess;
+   }
+
    return bSuccess;
 }
 
@@ -341,6 +492,10 @@ bool WizardExecutor::extractInputArgs(PlugInArgList* pInArgList)
       mpProgress = pArg->getPlugInArgValue<Progress>();
    }
 
+   // Parallel execution
+   mbParallel = false;
+   pInArgList->getPlugInArgValue("Parallel Execution", mbParallel);
+
    // Wizard object
    mpWizard = NULL;
    if ((pInArgList->getArg("Wizard", pArg) == true) && (pArg != NULL))
@@ -454,7 +609,8 @@ bool WizardExecutor::extractInputArgs(PlugInArgList* pInArgList)
    return true;
 }
 
-void WizardExecutor::populatePlugInArgList(PlugInArgList* pArgList, const WizardItem* pItem, bool bInArgs)
+void WizardExecutor::populatePlugInArgList(PlugInArgList* pArgList, const WizardItem* pItem, bool bInArgs,
+                                           Progress* pProgress)
 {
    if ((pArgList == NULL) || (pItem == NULL))
    {
@@ -509,7 +665,7 @@ void WizardExecutor::populatePlugInArgList(PlugInArgList* pArgList, const Wizard
                   else if (nodeType == TypeConverter::toString<Progress>() && bInArgs)
                   {
                      // only for input args - bkg plugin must set output arg to its Progress arg
-                     pArg->setActualValue(mpProgress);
+                     pArg->setActualValue(pProgress);
                   }
 
                   break;
@@ -521,7 +677,7 @@ void WizardExecutor::populatePlugInArgList(PlugInArgList* pArgList, const Wizard
          {
             if (argType == TypeConverter::toString<Progress>())
             {
-               pArg->setActualValue(mpProgress);
+               pArg->setActualValue(pProgress);
             }
          }
       }
@@ -547,10 +703,13 @@ bool WizardExecutor::launchPlugIn(WizardItem* pItem)
 
       if (mpCurrentPlugIn != NULL)
       {
-          populatePlugInArgList(&pExecutable->getInArgList(), pItem, true);
-          populatePlugInArgList(&pExecutable->getOutArgList(), pItem, false);
+          populatePlugInArgList(&pExecutable->getInArgList(), pItem, true, mpProgress);
+          populatePlugInArgList(&pExecutable->getOutArgList(), pItem, false, mpProgress);
 
+          QTime executionTime;
+          executionTime.start();
           pluginExecuteStatus = pExecutable->execute();
+          pStep->addProperty("Execution Time (s)", executionTime.elapsed() / 1000.0);
 
           // Execute the plug-in
           if (pluginExecuteStatus)
@@ -591,6 +750,184 @@ bool WizardExecutor::launchPlugIn(WizardItem* pItem)
    return pluginExecuteStatus;
 }
 
+bool WizardExecutor::launchPlugIns(const vector<WizardItem*>& items)
+{
+   if (items.size() == 1)
+   {
+      bool bSuccess = launchPlugIn(items.front());
+      resetNodeValues(items.front());
+      return bSuccess;
+   }
+
+   // Create the plug-ins and set their input values on the main thread. Each plug-in reports to its
+   // own thread safe progress since the wizard progress may be displayed in the main thread. Output
+   // values use the wizard progress so that connected items never receive a destroyed progress.
+   Service<UtilityServices> pUtilities;
+   vector<ExecutableResource*> executables;
+   vector<Progress*> progresses;
+   bool bSuccess = true;
+   for (vector<WizardItem*>::const_iterator iter = items.begin(); iter != items.end(); ++iter)
+   {
+      WizardItem* pItem = *iter;
+      Progress* pProgress = pUtilities->getProgress(true);
+      ExecutableResource* pExecutable = new ExecutableResource(pItem->getName(), string(), pProgress,
+         pItem->getBatchMode());
+      progresses.push_back(pProgress);
+      executables.push_back(pExecutable);
+
+      (*pExecutable)->setAutoArg(false);
+      if ((*pExecutable)->getPlugIn() == NULL)
+      {
+         mMessage = "The " + pItem->getName() + " plug-in could not be created! Wizard execution will be terminated.";
+         if (mpProgress != NULL)
+         {
+            mpProgress->updateProgress(mMessage, 0, ERRORS);
+         }
+
+         mpStep->addMessage(mMessage, "app", "8E0F8B5A-6A83-4F2A-9D2C-4F1C7E0A3B61", true);
+         bSuccess = false;
+         break;
+      }
+
+      populatePlugInArgList(&(*pExecutable)->getInArgList(), pItem, true, pProgress);
+      populatePlugInArgList(&(*pExecutable)->getOutArgList(), pItem, false, mpProgress);
+   }
+
+   if (bSuccess)
+   {
+      mta::DMutex mutex;
+      bool failed = false;
+
+      ItemExecutionInput input;
+      input.mpMutex = &mutex;
+      input.mpFailed = &failed;
+      input.mpAborted = &mbAbort;
+      for (vector<ExecutableResource*>::const_iterator iter = executables.begin(); iter != executables.end(); ++iter)
+      {
+         input.mExecutables.push_back((*iter)->get());
+
+         // Keep the plug-ins reachable so that aborting the wizard aborts them
+         Executable* pPlugIn = dynamic_cast<Executable*>((**iter)->getPlugIn());
+         if (pPlugIn != NULL)
+         {
+            mParallelPlugIns.push_back(pPlugIn);
+         }
+      }
+
+      // Create the step of each item before the items start. The log adds messages to the most recently
+      // created step, so the messages which the items log while they run are added to a separate group step.
+      vector<Step*> itemSteps;
+      for (vector<WizardItem*>::const_iterator iter = items.begin(); iter != items.end(); ++iter)
+      {
+         itemSteps.push_back(mpStep->addStep("Executing " + (*iter)->getType() + " Item: " + (*iter)->getName(),
+            "app", "6A743B49-618B-44ed-9C5A-B4D67FB809D2", false));
+      }
+
+      StepResource pGroupStep(mpStep->addStep("Executing Items In Parallel", "app",
+         "3B7D1E52-9C4A-4E86-B1F0-7A2D5C8E6F94", false));
+
+      ItemExecutionOutput output;
+      mta::MultiThreadedAlgorithm<ItemExecutionInput, ItemExecutionOutput, ItemExecutionThread>
+         alg(mta::getNumRequiredThreads(input.mExecutables.size()), input, output, NULL);
+      bSuccess = (alg.run() == mta::SUCCESS && failed == false && mbAbort == false);
+      mParallelPlugIns.clear();
+      if (pGroupStep.get() != NULL)
+      {
+         pGroupStep->finalize(bSuccess ? Message::Success : (mbAbort ? Message::Abort : Message::Failure));
+      }
+
+      // Report the items in wizard order. Items which were not started because another item failed have no result.
+      vector<const ItemResult*> results(items.size(), static_cast<const ItemResult*>(NULL));
+      for (vector<ItemResult>::const_iterator iter = output.mResults.begin(); iter != output.mResults.end(); ++iter)
+      {
+         results[iter->mIndex] = &(*iter);
+      }
+
+      for (vector<WizardItem*>::size_type i = 0; i < items.size(); ++i)
+      {
+         StepResource pStep(itemSteps[i]);
+         if (pStep.get() == NULL)
+         {
+            continue;
+         }
+
+         const ItemResult* pResult = results[i];
+         if (pResult == NULL)
+         {
+            pStep->finalize(Message::Abort, "The item was not executed because another item failed or the "
+               "wizard was aborted.");
+            continue;
+         }
+
+         WizardItem* pItem = items[i];
+         pStep->addProperty("Execution Time (s)", pResult->mSeconds);
+         if (pResult->mSuccess)
+         {
+            setConnectedNodeValues(pItem, &(*executables[i])->getOutArgList());
+            pStep->finalize(Message::Success);
+            continue;
+         }
+
+         string message = pResult->mError;
+         if (message.empty())
+         {
+            int percent = 0;
+            ReportingLevel level;
+            progresses[i]->getProgress(message, percent, level);
+         }
+
+         if (mpProgress != NULL && message.empty() == false)
+         {
+            mpProgress->updateProgress(message, 0, ERRORS);
+         }
+
+         pStep->finalize(Message::Failure, message);
+      }
+   }
+
+   // The plug-ins may refer to their progress objects until they are destroyed
+   for (vector<ExecutableResource*>::size_type i = 0; i < executables.size(); ++i)
+   {
+      delete executables[i];
+      pUtilities->destroyProgress(progresses[i]);
+   }
+
+   for (vector<WizardItem*>::const_iterator iter = items.begin(); iter != items.end(); ++iter)
+   {
+      resetNodeValues(*iter);
+   }
+
+   return bSuccess;
+}
+
+bool WizardExecutor::canLaunchInParallel(const WizardItem* pItem, const vector<WizardItem*>& parallelItems) const
+{
+   if (mbParallel == false || pItem == NULL || pItem->getBatchMode() == false)
+   {
+      return false;
+   }
+
+   // Plug-ins which create windows or views must execute in the main thread
+   const string& itemType = pItem->getType();
+   if (itemType != PlugInManagerServices::AlgorithmType() && itemType != PlugInManagerServices::ExporterType() &&
+      itemType != PlugInManagerServices::ImporterType() && itemType != PlugInManagerServices::GeoreferenceType())
+   {
+      return false;
+   }
+
+   vector<WizardItem*> inputItems;
+   pItem->getConnectedItems(true, inputItems);
+   for (vector<WizardItem*>::const_iterator iter = inputItems.begin(); iter != inputItems.end(); ++iter)
+   {
+      if (find(parallelItems.begin(), parallelItems.end(), *iter) != parallelItems.end())
+      {
+         return false;
+      }
+   }
+
+   return true;
+}
+
 void WizardExecutor::setConnectedNodeValues(WizardItem* pItem, PlugInArgList* pOutArgList)
 {
    VERIFYNRV(pItem != NULL);
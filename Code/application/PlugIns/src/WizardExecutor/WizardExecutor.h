@@ -15,6 +15,7 @@
 #include "WizardShell.h"
 
 #include <string>
+#include <vector>
 
 class Executable;
 class Progress;
@@ -44,8 +45,10 @@ public:
 
 protected:
    bool extractInputArgs(PlugInArgList* pInArgList);
-   void populatePlugInArgList(PlugInArgList* pArgList, const WizardItem* pItem, bool bInArgs);
+   void populatePlugInArgList(PlugInArgList* pArgList, const WizardItem* pItem, bool bInArgs, Progress* pProgress);
    bool launchPlugIn(WizardItem* pItem);
+   bool launchPlugIns(const std::vector<WizardItem*>& items);
+   bool canLaunchInParallel(const WizardItem* pItem, const std::vector<WizardItem*>& parallelItems) const;
    void setConnectedNodeValues(WizardItem* pItem, PlugInArgList* pOutArgList = NULL);
    void resetNodeValues(WizardItem* pItem);
    void resetAllNodeValues();
@@ -54,11 +57,13 @@ private:
    bool mbInteractive;
    bool mbAbort;
    bool mbDeleteWizard;
+   bool mbParallel;
    Service<DesktopServices> mpDesktop;
    Service<ObjectFactory> mpObjFact;
    Progress* mpProgress;
    WizardObject* mpWizard;
    Executable* mpCurrentPlugIn;
+   std::vector<Executable*> mParallelPlugIns;
 
    Step* mpStep;
    std::string mMessage;
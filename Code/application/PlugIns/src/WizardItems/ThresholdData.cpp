@@ -19,6 +19,7 @@
 #include "ObjectResource.h"
 #include "PlugInArgList.h"
 #include "PlugInRegistration.h"
+#include "PlugInResource.h"
 #include "RasterDataDescriptor.h"
 #include "RasterElement.h"
 #include "SpatialDataView.h"
@@ -26,6 +27,7 @@
 #include "ThresholdData.h"
 
 REGISTER_PLUGIN_BASIC(OpticksWizardItems, ThresholdData);
+REGISTER_PLUGIN_BASIC(OpticksWizardItems, ThresholdPager);
 
 namespace
 {
@@ -73,12 +75,31 @@ double convertToRawUnits(Statistics* pStatistics, const RegionUnits& units, doub
    }
    return 0.0;
 }
+
+bool isPassed(const PassArea& passArea, double value, double firstThreshold, double secondThreshold)
+{
+   switch (passArea)
+   {
+   case UPPER:
+      return value >= firstThreshold;
+   case LOWER:
+      return value <= firstThreshold;
+   case MIDDLE:
+      return value >= firstThreshold && value <= secondThreshold;
+   case OUTSIDE:
+      return value <= firstThreshold || value >= secondThreshold;
+   default:
+      break;
+   }
+   return false;
+}
 }
 
 ThresholdData::ThresholdData() :
       mpInputElement(NULL),
       mFirstThreshold(0.0),
-      mSecondThreshold(0.0)
+      mSecondThreshold(0.0),
+      mComputeOnDemand(false)
 {
    setName("Threshold Data");
    setVersion(APP_VERSION_NUMBER);
@@ -118,6 +139,10 @@ bool ThresholdData::getInputSpecification(PlugInArgList*& pArgList)
    unsigned int defaultBand(0);
    VERIFY(pArgList->addArg<unsigned int>("Display Band", defaultBand, "The original band number to be displayed. "
       "This is a one-based index. If no value is provided, the first active band will be displayed."));
+   VERIFY(pArgList->addArg<bool>("Compute On Demand", false, "If true, a mask of the display band is also "
+      "created. The mask is 1 where the data passes and 0 elsewhere, and is thresholded as it is read "
+      "instead of being stored, so it can be used by later items without storing another band. The mask is "
+      "read-only and is destroyed with the element."));
 
    return true;
 }
@@ -128,6 +153,8 @@ bool ThresholdData::getOutputSpecification(PlugInArgList*& pArgList)
    VERIFY(pArgList != NULL);
    VERIFY(pArgList->addArg<AoiElement>("Result", "The new AOI."));
    VERIFY(pArgList->addArg<AoiLayer>("Result Layer", "The new AOI layer."));
+   VERIFY(pArgList->addArg<RasterElement>("Result Mask", "The new mask if \"Compute On Demand\" is set, in "
+      "addition to the new AOI."));
    return true;
 }
 
@@ -143,6 +170,12 @@ bool ThresholdData::execute(PlugInArgList* pInArgList, PlugInArgList* pOutArgLis
       return false;
    }
 
+   if (mPassArea != UPPER && mPassArea != LOWER && mPassArea != MIDDLE && mPassArea != OUTSIDE)
+   {
+      reportError("Unknown or invalid pass area.", "{19c92b3b-52e9-442b-a01f-b545f819f200}");
+      return false;
+   }
+
    const RasterDataDescriptor* pDesc = static_cast<const RasterDataDescriptor*>(mpInputElement->getDataDescriptor());
    VERIFY(pDesc);
    DimensionDescriptor band;
@@ -181,6 +214,42 @@ bool ThresholdData::execute(PlugInArgList* pInArgList, PlugInArgList* pOutArgLis
       mFirstThreshold = convertToRawUnits(pStatistics, mRegionUnits, mFirstThreshold);
       mSecondThreshold = convertToRawUnits(pStatistics, mRegionUnits, mSecondThreshold);
    }
+
+   if (mComputeOnDemand)
+   {
+      // The mask is thresholded as it is read, so it must not outlive the element it reads
+      std::string maskName = pDesc->getName() + "_mask";
+      DataElement* pExisting = Service<ModelServices>()->getElement(maskName,
+         TypeConverter::toString<RasterElement>(), mpInputElement);
+      if (pExisting != NULL)
+      {
+         reportWarning("Overwriting existing mask.", "{1073c9c1-a6ba-4fad-81c5-7e727993b815}");
+         Service<ModelServices>()->destroyElement(pExisting);
+      }
+
+      ExecutableResource pPager("Threshold Pager");
+      pPager->getInArgList().setPlugInArgValue("Source Element", mpInputElement);
+      unsigned int bandNumber = band.getActiveNumber();
+      pPager->getInArgList().setPlugInArgValue("Band", &bandNumber);
+      pPager->getInArgList().setPlugInArgValue("First Threshold", &mFirstThreshold);
+      pPager->getInArgList().setPlugInArgValue("Second Threshold", &mSecondThreshold);
+      pPager->getInArgList().setPlugInArgValue("Pass Area", &mPassArea);
+      ModelResource<RasterElement> pMask(ComputedPager::createElement(maskName, mpInputElement,
+         pDesc->getRowCount(), pDesc->getColumnCount(), 1, INT1UBYTE, pPager));
+      if (pMask.get() == NULL)
+      {
+         reportError("Unable to create output mask.", "{5cb677b5-77ba-441e-9c77-d95453a36ead}");
+         return false;
+      }
+      pMask->copyClassification(mpInputElement);
+      if (pOutArgList != NULL)
+      {
+         pOutArgList->setPlugInArgValue("Result Mask", pMask.get());
+      }
+      pMask.release();
+   }
+
+   // The AOI results are always created, so items connected to them work in either mode
    FactoryResource<BitMask> pBitmask;
    for (unsigned int row = 0; row < pDesc->getRowCount(); ++row)
    {
@@ -190,35 +259,9 @@ bool ThresholdData::execute(PlugInArgList* pInArgList, PlugInArgList* pOutArgLis
       {
          VERIFY(acc.isValid());
          double val = ModelServices::getDataValue(pDesc->getDataType(), acc->getColumn(), 0);
-         switch (mPassArea)
+         if (isPassed(mPassArea, val, mFirstThreshold, mSecondThreshold))
          {
-         case UPPER:
-            if (val >= mFirstThreshold)
-            {
-               pBitmask->setPixel(col, row, true);
-            }
-            break;
-         case LOWER:
-            if (val <= mFirstThreshold)
-            {
-               pBitmask->setPixel(col, row, true);
-            }
-            break;
-         case MIDDLE:
-            if (val >= mFirstThreshold && val <= mSecondThreshold)
-            {
-               pBitmask->setPixel(col, row, true);
-            }
-            break;
-         case OUTSIDE:
-            if (val <= mFirstThreshold || val >= mSecondThreshold)
-            {
-               pBitmask->setPixel(col, row, true);
-            }
-            break;
-         default:
-            reportError("Unknown or invalid pass area.", "{19c92b3b-52e9-442b-a01f-b545f819f200}");
-            return false;
+            pBitmask->setPixel(col, row, true);
          }
          acc->nextColumn();
       }
@@ -298,6 +341,92 @@ bool ThresholdData::extractInputArgs(PlugInArgList* pInArgList)
       }
    }
    pInArgList->getPlugInArgValue("Display Band", mDisplayBandNumber);
+   pInArgList->getPlugInArgValue("Compute On Demand", mComputeOnDemand);
+
+   return true;
+}
+
+ThresholdPager::ThresholdPager() :
+   mpSource(NULL),
+   mBand(0),
+   mFirstThreshold(0.0),
+   mSecondThreshold(0.0)
+{
+   setName("Threshold Pager");
+   setCopyright(APP_COPYRIGHT);
+   setCreator("Ball Aerospace & Technologies Corp.");
+   setDescription("Thresholds data as the mask is read");
+   setDescriptorId("{24cd5b54-a6a9-4365-a7fd-d0d088dda776}");
+   setVersion(APP_VERSION_NUMBER);
+   setProductionStatus(APP_IS_PRODUCTION_RELEASE);
+   setShortDescription("Threshold pager");
+}
+
+ThresholdPager::~ThresholdPager()
+{
+}
 
+bool ThresholdPager::getInputSpecification(PlugInArgList*& pArgList)
+{
+   if (!ComputedPager::getInputSpecification(pArgList))
+   {
+      return false;
+   }
+   VERIFY(pArgList->addArg<RasterElement>("Source Element", NULL, "The element which will be thresholded."));
+   VERIFY(pArgList->addArg<unsigned int>("Band", 0, "The active number of the band which will be thresholded."));
+   VERIFY(pArgList->addArg<double>("First Threshold", 0.0, "The first raw threshold value."));
+   VERIFY(pArgList->addArg<double>("Second Threshold", 0.0,
+      "The second raw threshold value. Ignored if \"Pass Area\" is upper or lower."));
+   VERIFY(pArgList->addArg<PassArea>("Pass Area", PassArea(UPPER), "The area which will be set to 1 in the mask."));
+   return true;
+}
+
+bool ThresholdPager::parseInputArgs(PlugInArgList* pInputArgList)
+{
+   if (!ComputedPager::parseInputArgs(pInputArgList))
+   {
+      return false;
+   }
+   mpSource = pInputArgList->getPlugInArgValue<RasterElement>("Source Element");
+   if (mpSource == NULL || getBandCount() != 1 ||
+      !pInputArgList->getPlugInArgValue("Band", mBand) ||
+      !pInputArgList->getPlugInArgValue("First Threshold", mFirstThreshold) ||
+      !pInputArgList->getPlugInArgValue("Second Threshold", mSecondThreshold) ||
+      !pInputArgList->getPlugInArgValue("Pass Area", mPassArea) || !mPassArea.isValid())
+   {
+      return false;
+   }
+
+   const RasterDataDescriptor* pDesc = dynamic_cast<const RasterDataDescriptor*>(mpSource->getDataDescriptor());
+   return pDesc != NULL && mBand < pDesc->getBandCount();
+}
+
+bool ThresholdPager::computeRows(unsigned int startRow, unsigned int rowCount, unsigned int band, char* pData)
+{
+   VERIFY(mpSource != NULL && band == 0);
+   const RasterDataDescriptor* pDesc = static_cast<const RasterDataDescriptor*>(mpSource->getDataDescriptor());
+
+   FactoryResource<DataRequest> pReq;
+   pReq->setInterleaveFormat(BSQ);
+   pReq->setRows(pDesc->getActiveRow(startRow), pDesc->getActiveRow(startRow + rowCount - 1));
+   pReq->setBands(pDesc->getActiveBand(mBand), pDesc->getActiveBand(mBand), 1);
+   DataAccessor acc = mpSource->getDataAccessor(pReq.release());
+   if (!acc.isValid())
+   {
+      return false;
+   }
+
+   unsigned char* pMask = reinterpret_cast<unsigned char*>(pData);
+   for (unsigned int row = 0; row < rowCount; ++row)
+   {
+      for (unsigned int col = 0; col < pDesc->getColumnCount(); ++col)
+      {
+         VERIFY(acc.isValid());
+         double val = ModelServices::getDataValue(pDesc->getDataType(), acc->getColumn(), 0);
+         *pMask++ = isPassed(mPassArea, val, mFirstThreshold, mSecondThreshold) ? 1 : 0;
+         acc->nextColumn();
+      }
+      acc->nextRow();
+   }
    return true;
 }
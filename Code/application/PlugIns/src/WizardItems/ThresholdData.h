@@ -10,6 +10,7 @@
 #ifndef THRESHOLDDATA_H__
 #define THRESHOLDDATA_H__
 
+#include "ComputedPager.h"
 #include "DesktopItems.h"
 
 class RasterElement;
@@ -37,6 +38,32 @@ private:
    PassArea mPassArea;
    RegionUnits mRegionUnits;
    unsigned int mDisplayBandNumber;
+   bool mComputeOnDemand;
+};
+
+/**
+ * Thresholds one band of an element a block of rows at a time as the mask is read.
+ */
+class ThresholdPager : public ComputedPager
+{
+public:
+   ThresholdPager();
+   virtual ~ThresholdPager();
+
+   virtual bool getInputSpecification(PlugInArgList*& pArgList);
+   virtual bool parseInputArgs(PlugInArgList* pInputArgList);
+
+protected:
+   virtual bool computeRows(unsigned int startRow, unsigned int rowCount, unsigned int band, char* pData);
+
+private:
+   ThresholdPager& operator=(const ThresholdPager& rhs);
+
+   const RasterElement* mpSource;
+   unsigned int mBand;
+   double mFirstThreshold;
+   double mSecondThreshold;
+   PassArea mPassArea;
 };
 
 #endif
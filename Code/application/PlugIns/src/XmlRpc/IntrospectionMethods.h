@@ -53,6 +53,11 @@ public:
       return pSignatures;
    }
 
+   virtual bool isThreadSafe() const
+   {
+      return true;
+   }
+
 private:
    SystemListMethodsCallImp& operator=(const SystemListMethodsCallImp& rhs);
 
@@ -104,6 +109,11 @@ public:
       return pSignatures;
    }
 
+   virtual bool isThreadSafe() const
+   {
+      return true;
+   }
+
 private:
    SystemMethodHelpCallImp& operator=(const SystemMethodHelpCallImp& rhs);
 
@@ -162,6 +172,11 @@ public:
       return pSignatures;
    }
 
+   virtual bool isThreadSafe() const
+   {
+      return true;
+   }
+
 private:
    SystemMethodSignatureCallImp& operator=(const SystemMethodSignatureCallImp& rhs);
 
@@ -32,6 +32,10 @@ public:
    virtual XmlRpcParam *operator()(const XmlRpcParams &params);
    virtual QString getHelp();
    virtual XmlRpcArrayParam *getSignature();
+   virtual bool isThreadSafe() const
+   {
+      return true;
+   }
 };
 
 namespace Annotation
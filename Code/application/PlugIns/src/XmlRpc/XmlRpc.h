@@ -47,6 +47,19 @@ public:
    {
       return NULL;
    }
+
+   /**
+    * Determine whether this method may be called from a network thread.
+    *
+    * Methods which access the GUI or modify the session must be called on
+    * the main application thread, which is the default.
+    *
+    * @return True if the method does not access the GUI or modify shared state.
+    */
+   virtual bool isThreadSafe() const
+   {
+      return false;
+   }
 };
 
 /**
@@ -15,9 +15,12 @@
 #include "IntrospectionMethods.h"
 #include "MessageLogResource.h"
 #include "PlugInRegistration.h"
+#include "TileHandler.h"
 #include "UtilityServices.h"
 #include "XmlRpcServer.h"
 #include "xmlreader.h"
+#include <QtCore/QRegExp>
+#include <QtCore/QThread>
 #include <QtCore/QtDebug>
 
 XERCES_CPP_NAMESPACE_USE
@@ -27,6 +30,30 @@ XERCES_CPP_NAMESPACE_USE
 
 REGISTER_PLUGIN_BASIC(OpticksXmlRpc, XmlRpcServer);
 
+// Parses a request which failed on a network thread again on the main thread, so that the errors are logged
+class XmlRpcServer::LogRequestErrorsTask : public MuHttpServer::MainThreadTask
+{
+public:
+   LogRequestErrorsTask(const std::string& request) :
+      mRequest(request)
+   {
+   }
+
+   void run()
+   {
+      XmlReader xml(Service<UtilityServices>()->getMessageLog()->getLog(), false);
+      if (xml.parseString(mRequest) != NULL)
+      {
+         // The request is valid XML, so it is not a valid method call
+         MessageResource message("XML-RPC Warning", "app", "0B6E3F47-94C2-4A1D-8E5B-7F2C9A16D380");
+         message->addProperty("message", std::string("The XML-RPC request is not a valid method call."));
+      }
+   }
+
+private:
+   std::string mRequest;
+};
+
 XmlRpcServer::XmlRpcServer() : MuHttpServer(getSettingXmlRpcServerPort(), NULL)
 {
    PlugInShell::setName("XML-RPC Server");
@@ -40,6 +67,7 @@ XmlRpcServer::XmlRpcServer() : MuHttpServer(getSettingXmlRpcServerPort(), NULL)
    executeOnStartup(true);
    setWizardSupported(false);
    registerPath("images", new ImageHandler(this));
+   registerPath("tiles", new TileHandler(this));
 }
 
 XmlRpcServer::~XmlRpcServer()
@@ -91,11 +119,21 @@ bool XmlRpcServer::execute(PlugInArgList *pInArgList, PlugInArgList *pOutArgList
    registerMethodCall("system.listMethods", new SystemListMethodsCallImp(mMethodCalls));
    registerMethodCall("system.methodHelp", new SystemMethodHelpCallImp(mMethodCalls));
    registerMethodCall("system.methodSignature", new SystemMethodSignatureCallImp(mMethodCalls));
+
+   // Populate the fault table before any network threads can read it
+   XmlRpcMethodFault::populateFaults();
    return start();
 }
 
 void XmlRpcServer::registerMethodCall(const QString &name, XmlRpcMethodCallImp *pMethodCall)
 {
+   // Network threads read the method table without a lock, so it can not change once the server is running
+   if (isServerRunning())
+   {
+      delete pMethodCall;
+      VERIFYNRV_MSG(false, "XML-RPC methods must be registered before the server is started.");
+   }
+
    if (pMethodCall == NULL)
    {
       mMethodCalls.remove(name);
@@ -119,7 +157,8 @@ MuHttpServer::Response XmlRpcServer::getRequest(const QString &uri, const QStrin
                "The available methods are:</p>\n"
                "<table width=\"75%\" cellpadding=\"4\" border=\"1\" frame=\"border\" rules=\"all\">\n"
                "<tr><th>Method Signature</th><th>Method Help</th></tr>\n";
-   for (QMap<QString, XmlRpcMethodCallImp*>::Iterator mit = mMethodCalls.begin(); mit != mMethodCalls.end(); ++mit)
+   for (QMap<QString, XmlRpcMethodCallImp*>::ConstIterator mit = mMethodCalls.constBegin();
+      mit != mMethodCalls.constEnd(); ++mit)
    {
       XmlRpcMethodCallImp* pCall = mit.value();
       if (pCall == NULL)
@@ -185,6 +224,15 @@ MuHttpServer::Response XmlRpcServer::getRequest(const QString &uri, const QStrin
       faultIt.next();
       rsp.mBody += QString("<tr><td>%1</td><td>%2</td></tr>\n").arg(faultIt.key()).arg(faultIt.value());
    }
+   rsp.mBody += "</table>";
+   LatencyStatistics latency = getLatencyStatistics();
+   rsp.mBody += QString("<h1>Request Latency</h1>"
+      "<table width=\"75%\" cellpadding=\"4\" border=\"1\" frame=\"border\" rules=\"all\">\n"
+      "<tr><th>Requests</th><th>Median (ms)</th><th>90th Percentile (ms)</th>"
+      "<th>99th Percentile (ms)</th><th>Maximum (ms)</th></tr>\n"
+      "<tr><td>%1</td><td>%2</td><td>%3</td><td>%4</td><td>%5</td></tr>\n")
+      .arg(latency.mRequestCount).arg(latency.mMedian).arg(latency.mPercentile90)
+      .arg(latency.mPercentile99).arg(latency.mMaximum);
    rsp.mBody += "</table></body></html>";
    rsp.mHeaders["content-type"] = "text/html";
    rsp.mCode = HTTPRESPONSECODE_200_OK;
@@ -203,10 +251,14 @@ MuHttpServer::Response XmlRpcServer::postRequest(const QString &uri, const QStri
          "Only content-type: text/xml is allowed.</body></html>";
       return rsp;
    }
-   XmlReader xml(Service<UtilityServices>()->getMessageLog()->getLog(), false);
+
+   // The message log can not be used on the network threads which run thread-safe requests, so those
+   // requests are parsed without logging, and any errors are logged on the main thread afterward
+   bool mainThread = (QThread::currentThread() == thread());
+   XmlReader xml(mainThread ? Service<UtilityServices>()->getMessageLog()->getLog() : NULL, false);
+   std::string str = body.toStdString();
    try
    {
-      std::string str = body.toStdString();
       XERCES_CPP_NAMESPACE_QUALIFIER DOMDocument *pDoc = xml.parseString(str);
       DOMElement* pRoot = NULL;
       if (pDoc != NULL)
@@ -226,16 +278,41 @@ MuHttpServer::Response XmlRpcServer::postRequest(const QString &uri, const QStri
       rsp.mBody = "<html><body><h1>Internal server error</h1>"
                   "An exception was thrown while parsing the message</body></html>";
       rsp.mCode = HTTPRESPONSECODE_500_INTERNALSERVERERROR;
+      if (mainThread == false)
+      {
+         LogRequestErrorsTask task(str);
+         runOnMainThread(task);
+      }
    }
    return rsp;
 }
 
+bool XmlRpcServer::isThreadSafeRequest(RequestMethod method, const QString& uri, const QString& contentType,
+                                       const QString& body) const
+{
+   if (method != REQUESTMETHOD_POST || contentType != "text/xml")
+   {
+      return false;
+   }
+
+   // Find the method name without parsing the entire request
+   QRegExp methodName("<methodName>\\s*([^<\\s]+)\\s*</methodName>");
+   if (methodName.indexIn(body) < 0)
+   {
+      return false;
+   }
+
+   QMap<QString, XmlRpcMethodCallImp*>::const_iterator mcit = mMethodCalls.constFind(methodName.cap(1));
+   return mcit != mMethodCalls.constEnd() && mcit.value() != NULL && mcit.value()->isThreadSafe();
+}
+
 void XmlRpcServer::processMethodCall(const XmlRpcMethodCall &call, MuHttpServer::Response &rsp)
 {
    rsp.mHeaders["content-type"] = "text/xml";
    rsp.mCode = HTTPRESPONSECODE_200_OK;
-   QMap<QString, XmlRpcMethodCallImp*>::iterator mcit = mMethodCalls.find(call.getMethodName());
-   if (mcit != mMethodCalls.end())
+   // Only const access is used, since this may run on several network threads at once
+   QMap<QString, XmlRpcMethodCallImp*>::const_iterator mcit = mMethodCalls.constFind(call.getMethodName());
+   if (mcit != mMethodCalls.constEnd())
    {
       XmlRpcMethodCallImp* pCall = mcit.value();
       if (pCall != NULL)
@@ -43,6 +43,8 @@ protected:
       const FormValueMap& form);
    MuHttpServer::Response postRequest(const QString& uri, const QString& contentType, const QString& body,
       const FormValueMap& form);
+   bool isThreadSafeRequest(RequestMethod method, const QString& uri, const QString& contentType,
+      const QString& body) const;
    void processMethodCall(const XmlRpcMethodCall& call, MuHttpServer::Response& rsp);
 
 protected slots:
@@ -50,8 +52,11 @@ protected slots:
    void warning(const QString& msg);
 
 private:
+   class LogRequestErrorsTask;
+
    XmlRpcServer(const XmlRpcServer& rhs);
    XmlRpcServer& operator=(const XmlRpcServer& rhs);
+   // Only modified before the server is started, after which network threads read it concurrently
    QMap<QString, XmlRpcMethodCallImp*> mMethodCalls;
 };
 
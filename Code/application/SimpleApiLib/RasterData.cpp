@@ -22,169 +22,258 @@
 #include "SimpleApiErrors.h"
 #include "Statistics.h"
 #include "StringUtilities.h"
-#include "switchOnEncoding.h"
 #include "TypeConverter.h"
 
+#include <memory>
+#include <string.h>
 #include <vector>
 
 namespace
 {
-   template<typename T>
-   void copySubcube(T* pData, RasterElement* pElement,
-                    unsigned int rowStart, unsigned int rowEnd,
-                    unsigned int columnStart, unsigned int columnEnd,
-                    unsigned int bandStart, unsigned int bandEnd,
-                    bool push, bool& success)
-   {
-      unsigned int rows = rowEnd - rowStart + 1;
-      unsigned int columns = columnEnd - columnStart + 1;
-      unsigned int bands = bandEnd - bandStart + 1;
-      RasterDataDescriptor* pDesc = static_cast<RasterDataDescriptor*>(pElement->getDataDescriptor());
-      unsigned int bytesPerElement = pDesc->getBytesPerElement();
-      InterleaveFormatType interleave = pDesc->getInterleaveFormat();
+   /**
+    * Gets the strides of a block with the given size and interleave whose values are contiguous.
+    */
+   void getContiguousStrides(InterleaveFormatType interleave, unsigned int rows, unsigned int columns,
+      unsigned int bands, unsigned int bytesPerElement, int64_t& rowStride, int64_t& columnStride,
+      int64_t& bandStride)
+   {
       switch (interleave)
       {
+      case BIP:
+         bandStride = bytesPerElement;
+         columnStride = bandStride * bands;
+         rowStride = columnStride * columns;
+         break;
+      case BIL:
+         columnStride = bytesPerElement;
+         bandStride = columnStride * columns;
+         rowStride = bandStride * bands;
+         break;
       case BSQ:
+      default:
+         columnStride = bytesPerElement;
+         rowStride = columnStride * columns;
+         bandStride = rowStride * rows;
+         break;
+      }
+   }
+
+   /**
+    * Gets the strides of the values in the page of an accessor created by getWindowAccessor().
+    */
+   void getPageStrides(InterleaveFormatType interleave, const DataAccessorImpl* pAccessor,
+      unsigned int bytesPerElement, int64_t& rowStride, int64_t& columnStride, int64_t& bandStride)
+   {
+      rowStride = pAccessor->getRowStride();
+      switch (interleave)
+      {
+      case BIP:
+         bandStride = bytesPerElement;
+         columnStride = bandStride * pAccessor->getConcurrentBands();
+         break;
+      case BIL:
+         columnStride = bytesPerElement;
+         bandStride = columnStride * pAccessor->getConcurrentColumns();
+         break;
+      case BSQ:
+      default:
+         columnStride = bytesPerElement;
+         bandStride = 0;
+         break;
+      }
+   }
+
+   /**
+    * Creates an accessor for a window of an element in its own interleave.
+    *
+    * A BSQ accessor reads the given band.  BIP and BIL accessors read every band,
+    * so the values of a row are found with the strides from getPageStrides().
+    */
+   DataAccessor getWindowAccessor(RasterElement* pElement, const DataPointerArgs& args, unsigned int band,
+      bool writable)
+   {
+      const RasterDataDescriptor* pDesc = static_cast<const RasterDataDescriptor*>(pElement->getDataDescriptor());
+      FactoryResource<DataRequest> pRequest;
+      pRequest->setInterleaveFormat(pDesc->getInterleaveFormat());
+      pRequest->setRows(pDesc->getActiveRow(args.rowStart), pDesc->getActiveRow(args.rowEnd),
+         args.rowEnd - args.rowStart + 1);
+      pRequest->setColumns(pDesc->getActiveColumn(args.columnStart), pDesc->getActiveColumn(args.columnEnd),
+         args.columnEnd - args.columnStart + 1);
+      if (pDesc->getInterleaveFormat() == BSQ)
+      {
+         pRequest->setBands(pDesc->getActiveBand(band), pDesc->getActiveBand(band), 1);
+      }
+      pRequest->setWritable(writable);
+      return pElement->getDataAccessor(pRequest.release());
+   }
+
+   /**
+    * Copies the values of one row between two strided layouts.
+    */
+   void copyRow(char* pDest, int64_t destColumnStride, int64_t destBandStride,
+      const char* pSource, int64_t sourceColumnStride, int64_t sourceBandStride,
+      unsigned int columns, unsigned int bands, unsigned int bytesPerElement)
+   {
+      if (destColumnStride == bytesPerElement && sourceColumnStride == bytesPerElement)
+      {
+         // BSQ and BIL rows hold a contiguous run of columns for each band
+         for (unsigned int band = 0; band < bands; ++band)
          {
-            for (unsigned int band = 0; band < bands; ++band)
-            {
-               FactoryResource<DataRequest> pRequest;
-               if (push)
-               {
-                  pRequest->setWritable(true);
-               }
-               pRequest->setInterleaveFormat(BSQ);
-               pRequest->setRows(pDesc->getActiveRow(rowStart),
-                  pDesc->getActiveRow(rowEnd), 1);
-               pRequest->setColumns(pDesc->getActiveColumn(columnStart),
-                  pDesc->getActiveColumn(columnEnd), columns);
-               pRequest->setBands(pDesc->getActiveBand(bandStart + band),
-                  pDesc->getActiveBand(bandStart + band), 1);
-               DataAccessor daImage = pElement->getDataAccessor(pRequest.release());
-               if (!daImage.isValid())
-               {
-                  success = false;
-                  return;
-               }
-               for (unsigned int row = 0; row < rows; ++row)
-               {
-                  for (unsigned int col = 0; col < columns; ++col)
-                  {
-                     daImage->toPixel(rowStart + row, columnStart + col);
-                     if (!daImage.isValid())
-                     {
-                        success = false;
-                        return;
-                     }
-                     if (push)
-                     {
-                        memcpy(daImage->getColumn(),
-                           pData + (columns * rows * band) + (columns * row) + col, bytesPerElement);
-                     }
-                     else
-                     {
-                        memcpy(pData + (columns * rows * band) + (columns * row) + col,
-                           daImage->getColumn(), bytesPerElement);
-                     }
-                  }
-               }
-            }
-            break;
+            memcpy(pDest + band * destBandStride, pSource + band * sourceBandStride, columns * bytesPerElement);
          }
-      case BIP:
+      }
+      else if (destColumnStride == sourceColumnStride && destBandStride == sourceBandStride)
+      {
+         memcpy(pDest, pSource, static_cast<size_t>(columns * destColumnStride));
+      }
+      else
+      {
+         // BIP rows hold a contiguous run of bands for each column
+         for (unsigned int column = 0; column < columns; ++column)
          {
-            FactoryResource<DataRequest> pRequest;
-            if (push)
+            memcpy(pDest + column * destColumnStride, pSource + column * sourceColumnStride,
+               bands * bytesPerElement);
+         }
+      }
+   }
+
+   /**
+    * Copies a window of an element to or from a contiguous buffer in the interleave of the element.
+    *
+    * Each row is copied with as few memcpy() calls as the layouts allow.
+    */
+   bool transferWindow(RasterElement* pElement, const DataPointerArgs& args, char* pData, bool push)
+   {
+      const RasterDataDescriptor* pDesc = static_cast<const RasterDataDescriptor*>(pElement->getDataDescriptor());
+      const InterleaveFormatType interleave = pDesc->getInterleaveFormat();
+      const unsigned int bytesPerElement = pDesc->getBytesPerElement();
+      const unsigned int rows = args.rowEnd - args.rowStart + 1;
+      const unsigned int columns = args.columnEnd - args.columnStart + 1;
+      const unsigned int bands = args.bandEnd - args.bandStart + 1;
+
+      int64_t rowStride = 0;
+      int64_t columnStride = 0;
+      int64_t bandStride = 0;
+      getContiguousStrides(interleave, rows, columns, bands, bytesPerElement, rowStride, columnStride, bandStride);
+
+      // A BSQ page holds one band, so each band is copied with its own accessor
+      const unsigned int accessorCount = (interleave == BSQ) ? bands : 1;
+      const unsigned int accessorBands = (interleave == BSQ) ? 1 : bands;
+      for (unsigned int accessorIndex = 0; accessorIndex < accessorCount; ++accessorIndex)
+      {
+         DataAccessor accessor = getWindowAccessor(pElement, args, args.bandStart + accessorIndex, push);
+         if (!accessor.isValid())
+         {
+            return false;
+         }
+
+         int64_t pageRowStride = 0;
+         int64_t pageColumnStride = 0;
+         int64_t pageBandStride = 0;
+         getPageStrides(interleave, accessor.operator->(), bytesPerElement,
+            pageRowStride, pageColumnStride, pageBandStride);
+         const int64_t bandOffset = (interleave == BSQ) ? 0 : args.bandStart * pageBandStride;
+
+         char* pBlock = pData + accessorIndex * bandStride;
+         for (unsigned int row = 0; row < rows; ++row)
+         {
+            if (!accessor.isValid())
             {
-               pRequest->setWritable(true);
+               return false;
             }
-            pRequest->setInterleaveFormat(BIP);
-            pRequest->setRows(pDesc->getActiveRow(rowStart),
-               pDesc->getActiveRow(rowEnd), 1);
-            pRequest->setColumns(pDesc->getActiveColumn(columnStart),
-               pDesc->getActiveColumn(columnEnd), columns);
-            DataAccessor daImage = pElement->getDataAccessor(pRequest.release());
-            if (!daImage.isValid())
+            char* pPage = static_cast<char*>(accessor->getRow()) + bandOffset;
+            if (push)
             {
-               success = false;
-               return;
+               copyRow(pPage, pageColumnStride, pageBandStride, pBlock, columnStride, bandStride,
+                  columns, accessorBands, bytesPerElement);
             }
-            for (unsigned int row = 0; row < rows; ++row)
+            else
             {
-               for (unsigned int col = 0; col < columns; ++col)
-               {
-                  daImage->toPixel(rowStart + row, columnStart + col);
-                  if (!daImage.isValid())
-                  {
-                     success = false;
-                     return;
-                  }
-                  for (unsigned int band = 0; band < bands; ++band)
-                  {
-                     if (push)
-                     {
-                        memcpy(static_cast<T*>(daImage->getColumn()) + (band + bandStart),
-                           pData + (row * columns * bands) + (col * bands) + band, bytesPerElement);
-                     }
-                     else
-                     {
-                        memcpy(pData + (row * columns * bands) + (col * bands) + band,
-                           static_cast<T*>(daImage->getColumn()) + (band + bandStart), bytesPerElement);
-                     }
-                  }
-               }
+               copyRow(pBlock, columnStride, bandStride, pPage, pageColumnStride, pageBandStride,
+                  columns, accessorBands, bytesPerElement);
             }
-            break;
+            pBlock += rowStride;
+            accessor->nextRow();
          }
-      case BIL:
+      }
+      return true;
+   }
+
+   /**
+    * Gets the window of an element described by optional arguments, checking that it is within the element.
+    */
+   bool getWindow(const RasterDataDescriptor* pDesc, const DataPointerArgs* pArgs, DataPointerArgs& window)
+   {
+      if (pArgs == NULL)
+      {
+         DataPointerArgs cube = {
+            0, pDesc->getRowCount() - 1,
+            0, pDesc->getColumnCount() - 1,
+            0, pDesc->getBandCount() - 1,
+            static_cast<uint32_t>(pDesc->getInterleaveFormat()) };
+         window = cube;
+      }
+      else
+      {
+         window = *pArgs;
+      }
+      return window.rowStart <= window.rowEnd && window.rowEnd < pDesc->getRowCount() &&
+         window.columnStart <= window.columnEnd && window.columnEnd < pDesc->getColumnCount() &&
+         window.bandStart <= window.bandEnd && window.bandEnd < pDesc->getBandCount();
+   }
+
+   /**
+    * Marks every row of a window as modified by stepping writable accessors through it.
+    *
+    * A writable accessor only marks the rows of each page it fetches, so the pages of the
+    * whole window are fetched to record writes made directly to the memory of the element.
+    */
+   bool markWindowModified(RasterElement* pElement, const DataPointerArgs& window)
+   {
+      const RasterDataDescriptor* pDesc = static_cast<const RasterDataDescriptor*>(pElement->getDataDescriptor());
+      const unsigned int rows = window.rowEnd - window.rowStart + 1;
+      const unsigned int bandCount =
+         (pDesc->getInterleaveFormat() == BSQ) ? window.bandEnd - window.bandStart + 1 : 1;
+      for (unsigned int bandIndex = 0; bandIndex < bandCount; ++bandIndex)
+      {
+         DataAccessor accessor = getWindowAccessor(pElement, window, window.bandStart + bandIndex, true);
+         for (unsigned int row = 0; row < rows; ++row)
          {
-            for (unsigned int row = 0; row < rows; ++row)
+            if (!accessor.isValid())
             {
-               for (unsigned int band = 0; band < bands; ++band)
-               {
-                  FactoryResource<DataRequest> pRequest;
-                  if (push)
-                  {
-                     pRequest->setWritable(true);
-                  }
-                  pRequest->setInterleaveFormat(BIL);
-                  pRequest->setRows(pDesc->getActiveRow(rowStart + row),
-                     pDesc->getActiveRow(rowStart + row), 1);
-                  pRequest->setColumns(pDesc->getActiveColumn(columnStart),
-                     pDesc->getActiveColumn(columnEnd), columns);
-                  pRequest->setBands(pDesc->getActiveBand(bandStart + band),
-                     pDesc->getActiveBand(bandStart + band), 1);
-                  DataAccessor daImage = pElement->getDataAccessor(pRequest.release());
-                  if (!daImage.isValid())
-                  {
-                     success = false;
-                     return;
-                  }
-                  for (unsigned int col = 0; col < columns; ++col)
-                  {
-                     daImage->toPixel(rowStart + row, columnStart + col);
-                     if (!daImage.isValid())
-                     {
-                        success = false;
-                        return;
-                     }
-                     if (push)
-                     {
-                        memcpy(daImage->getColumn(),
-                           pData + (row * columns * bands) + (band * columns) + col, bytesPerElement);
-                     }
-                     else
-                     {
-                        memcpy(pData + (row * columns * bands) + (band * columns) + col,
-                           daImage->getColumn(), bytesPerElement);
-                     }
-                  }
-               }
+               return false;
             }
-            break;
+            accessor->nextRow();
          }
       }
+      return true;
    }
+
+   struct DataBlockImp : public DataBlock
+   {
+      DataBlockImp() :
+         mpElement(NULL),
+         mWritable(false),
+         mpCopy(NULL),
+         mRefCount(1)
+      {}
+
+      ~DataBlockImp()
+      {
+         delete [] mpCopy;
+      }
+
+      RasterElement* mpElement;
+      DataPointerArgs mWindow;
+      bool mWritable;
+
+      // Keeps the pages of a block which is not copied in memory
+      std::vector<DataAccessor> mAccessors;
+      char* mpCopy;
+
+      // Blocks are shared by the callers of a single thread, such as the Python interpreter, so this is not locked
+      int mRefCount;
+   };
 }
 
 extern "C"
@@ -353,8 +442,9 @@ extern "C"
          setLastError(SIMPLE_BAD_PARAMS);
          return NULL;
       }
-      void* pRawData = pRaster->getRawData();
-      if (pArgs == NULL && pRawData != NULL)
+      // Only the whole cube is returned without a copy, so only that pointer can be used to modify the element
+      void* pRawData = (pArgs == NULL) ? pRaster->getRawData() : NULL;
+      if (pRawData != NULL)
       {
          *pOwn = 0;
          setLastError(SIMPLE_NO_ERROR);
@@ -362,42 +452,22 @@ extern "C"
       }
       *pOwn = 1;
       const RasterDataDescriptor* pDesc = static_cast<const RasterDataDescriptor*>(pRaster->getDataDescriptor());
-      DataPointerArgs args = {
-         0, pDesc->getRowCount() - 1,
-         0, pDesc->getColumnCount() - 1,
-         0, pDesc->getBandCount() - 1,
-         0 };
-      switch (pDesc->getInterleaveFormat())
-      {
-      case BSQ:
-         args.interleaveFormat = 0;
-         break;
-      case BIP:
-         args.interleaveFormat = 1;
-         break;
-      case BIL:
-         args.interleaveFormat = 2;
-         break;
-      }
-      if (pArgs == NULL)
+      DataPointerArgs window;
+      if (!getWindow(pDesc, pArgs, window))
       {
-         pArgs = &args;
+         setLastError(SIMPLE_BAD_PARAMS);
+         return NULL;
       }
-      unsigned int rowCount = pArgs->rowEnd - pArgs->rowStart + 1;
-      unsigned int columnCount = pArgs->columnEnd - pArgs->columnStart + 1;
-      unsigned int bandCount = pArgs->bandEnd - pArgs->bandStart + 1;
+      unsigned int rowCount = window.rowEnd - window.rowStart + 1;
+      unsigned int columnCount = window.columnEnd - window.columnStart + 1;
+      unsigned int bandCount = window.bandEnd - window.bandStart + 1;
       char* pNewRawData = new (std::nothrow) char[rowCount * columnCount * bandCount * pDesc->getBytesPerElement()];
       if (pNewRawData == NULL)
       {
          setLastError(SIMPLE_NO_MEM);
          return NULL;
       }
-      bool success = true;
-      switchOnComplexEncoding(pDesc->getDataType(), copySubcube, pNewRawData, pRaster,
-         pArgs->rowStart, pArgs->rowEnd,
-         pArgs->columnStart, pArgs->columnEnd,
-         pArgs->bandStart, pArgs->bandEnd, false, success);
-      if (!success)
+      if (!transferWindow(pRaster, window, pNewRawData, false))
       {
          delete [] pNewRawData;
          setLastError(SIMPLE_OTHER_FAILURE);
@@ -421,8 +491,8 @@ extern "C"
          return 1;
       }
       const RasterDataDescriptor* pDesc = static_cast<const RasterDataDescriptor*>(pRaster->getDataDescriptor());
-      void* pRawData = pRaster->getRawData();
-      if (pArgs == NULL && pRawData != NULL)
+      void* pRawData = (pArgs == NULL) ? pRaster->getRawData() : NULL;
+      if (pRawData != NULL)
       {
          size_t len = pDesc->getRowCount() * pDesc->getColumnCount() * pDesc->getBandCount()
                     * pDesc->getBytesPerElement();
@@ -430,33 +500,13 @@ extern "C"
          setLastError(SIMPLE_NO_ERROR);
          return 0;
       }
-      DataPointerArgs args = {
-         0, pDesc->getRowCount() - 1,
-         0, pDesc->getColumnCount() - 1,
-         0, pDesc->getBandCount() - 1,
-         0 };
-      switch (pDesc->getInterleaveFormat())
+      DataPointerArgs window;
+      if (!getWindow(pDesc, pArgs, window))
       {
-      case BSQ:
-         args.interleaveFormat = 0;
-         break;
-      case BIP:
-         args.interleaveFormat = 1;
-         break;
-      case BIL:
-         args.interleaveFormat = 2;
-         break;
-      }
-      if (pArgs == NULL)
-      {
-         pArgs = &args;
+         setLastError(SIMPLE_BAD_PARAMS);
+         return 1;
       }
-      bool success = true;
-      switchOnComplexEncoding(pDesc->getDataType(), copySubcube, pData, pRaster,
-         pArgs->rowStart, pArgs->rowEnd,
-         pArgs->columnStart, pArgs->columnEnd,
-         pArgs->bandStart, pArgs->bandEnd, true, success);
-      if (!success)
+      if (!transferWindow(pRaster, window, reinterpret_cast<char*>(pData), true))
       {
          setLastError(SIMPLE_OTHER_FAILURE);
          return 1;
@@ -477,6 +527,144 @@ extern "C"
       setLastError(SIMPLE_NO_ERROR);
    }
 
+   DataBlock* createDataBlock(DataElement* pElement, DataPointerArgs* pArgs, int writable)
+   {
+      RasterElement* pRaster = dynamic_cast<RasterElement*>(pElement);
+      if (pRaster == NULL)
+      {
+         setLastError(SIMPLE_BAD_PARAMS);
+         return NULL;
+      }
+      const RasterDataDescriptor* pDesc = static_cast<const RasterDataDescriptor*>(pRaster->getDataDescriptor());
+      std::auto_ptr<DataBlockImp> pBlock(new DataBlockImp);
+      if (!getWindow(pDesc, pArgs, pBlock->mWindow))
+      {
+         setLastError(SIMPLE_BAD_PARAMS);
+         return NULL;
+      }
+
+      const DataPointerArgs& window = pBlock->mWindow;
+      const InterleaveFormatType interleave = pDesc->getInterleaveFormat();
+      const unsigned int bytesPerElement = pDesc->getBytesPerElement();
+      pBlock->mpElement = pRaster;
+      pBlock->mWritable = writable != 0;
+      pBlock->numRows = window.rowEnd - window.rowStart + 1;
+      pBlock->numColumns = window.columnEnd - window.columnStart + 1;
+      pBlock->numBands = window.bandEnd - window.bandStart + 1;
+      pBlock->encodingType = static_cast<uint32_t>(pDesc->getDataType());
+      pBlock->encodingTypeSize = bytesPerElement;
+      pBlock->copied = 0;
+
+      // The accessors keep the pages in memory until the block is destroyed
+      const unsigned int accessorCount = (interleave == BSQ) ? pBlock->numBands : 1;
+      for (unsigned int accessorIndex = 0; accessorIndex < accessorCount; ++accessorIndex)
+      {
+         DataAccessor accessor = getWindowAccessor(pRaster, window, window.bandStart + accessorIndex, writable != 0);
+         if (!accessor.isValid())
+         {
+            setLastError(SIMPLE_OTHER_FAILURE);
+            return NULL;
+         }
+         pBlock->mAccessors.push_back(accessor);
+      }
+
+      DataAccessorImpl* pAccessor = pBlock->mAccessors.front().operator->();
+      // Writes to the block are marked when it is stored or destroyed, so the cube pointer is not obtained as
+      // writable, which would save the entire cube in every session
+      const RasterElement* pConstRaster = pRaster;
+      char* pRawData = const_cast<char*>(reinterpret_cast<const char*>(pConstRaster->getRawData()));
+      if (accessorCount == 1 && pAccessor->getConcurrentRows() >= pBlock->numRows)
+      {
+         // The whole block is in one page
+         getPageStrides(interleave, pAccessor, bytesPerElement,
+            pBlock->rowStride, pBlock->columnStride, pBlock->bandStride);
+         pBlock->pData = static_cast<char*>(pAccessor->getRow()) +
+            (interleave == BSQ ? 0 : window.bandStart * pBlock->bandStride);
+      }
+      else if (pRawData != NULL)
+      {
+         // The whole cube is in memory
+         getContiguousStrides(interleave, pDesc->getRowCount(), pDesc->getColumnCount(), pDesc->getBandCount(),
+            bytesPerElement, pBlock->rowStride, pBlock->columnStride, pBlock->bandStride);
+         pBlock->pData = pRawData + window.rowStart * pBlock->rowStride + window.columnStart * pBlock->columnStride +
+            window.bandStart * pBlock->bandStride;
+      }
+      else
+      {
+         pBlock->mAccessors.clear();
+         size_t size = static_cast<size_t>(pBlock->numRows) * pBlock->numColumns * pBlock->numBands * bytesPerElement;
+         pBlock->mpCopy = new (std::nothrow) char[size];
+         if (pBlock->mpCopy == NULL)
+         {
+            setLastError(SIMPLE_NO_MEM);
+            return NULL;
+         }
+         if (!transferWindow(pRaster, window, pBlock->mpCopy, false))
+         {
+            setLastError(SIMPLE_OTHER_FAILURE);
+            return NULL;
+         }
+         getContiguousStrides(interleave, pBlock->numRows, pBlock->numColumns, pBlock->numBands, bytesPerElement,
+            pBlock->rowStride, pBlock->columnStride, pBlock->bandStride);
+         pBlock->pData = pBlock->mpCopy;
+         pBlock->copied = 1;
+      }
+
+      setLastError(SIMPLE_NO_ERROR);
+      return pBlock.release();
+   }
+
+   void retainDataBlock(DataBlock* pBlock)
+   {
+      if (pBlock == NULL)
+      {
+         setLastError(SIMPLE_BAD_PARAMS);
+         return;
+      }
+
+      ++static_cast<DataBlockImp*>(pBlock)->mRefCount;
+      setLastError(SIMPLE_NO_ERROR);
+   }
+
+   void destroyDataBlock(DataBlock* pBlock)
+   {
+      DataBlockImp* pBlockImp = static_cast<DataBlockImp*>(pBlock);
+      if (pBlockImp != NULL && --pBlockImp->mRefCount == 0)
+      {
+         if (pBlockImp->mWritable && pBlockImp->copied == 0)
+         {
+            markWindowModified(pBlockImp->mpElement, pBlockImp->mWindow);
+         }
+         delete pBlockImp;
+      }
+   }
+
+   int writeDataBlock(DataBlock* pBlock)
+   {
+      DataBlockImp* pBlockImp = static_cast<DataBlockImp*>(pBlock);
+      if (pBlockImp == NULL || pBlockImp->mpElement == NULL)
+      {
+         setLastError(SIMPLE_BAD_PARAMS);
+         return 1;
+      }
+      bool success = true;
+      if (pBlockImp->copied != 0)
+      {
+         success = transferWindow(pBlockImp->mpElement, pBlockImp->mWindow, pBlockImp->mpCopy, true);
+      }
+      else if (pBlockImp->mWritable)
+      {
+         success = markWindowModified(pBlockImp->mpElement, pBlockImp->mWindow);
+      }
+      if (!success)
+      {
+         setLastError(SIMPLE_OTHER_FAILURE);
+         return 1;
+      }
+      setLastError(SIMPLE_NO_ERROR);
+      return 0;
+   }
+
    DataAccessorImpl* createDataAccessor(DataElement* pElement, DataAccessorArgs* pArgs)
    {
       RasterElement* pRasterElement = dynamic_cast<RasterElement*>(pElement);
@@ -230,6 +230,101 @@ extern "C"
     */
    EXPORT_SYMBOL void updateRasterElement(DataElement* pElement);
 
+   /**
+    * Descriptor for a block of raster data in memory.
+    *
+    * The value at a row, column, and band of the block is located at
+    * pData + row * rowStride + column * columnStride + band * bandStride.
+    * The strides are in bytes and follow the interleave of the RasterElement,
+    * so the block can be used by external numerical code, such as a NumPy array,
+    * without copying it.
+    *
+    * @see createDataBlock()
+    */
+   struct DataBlock
+   {
+      void* pData;               /**< The value in the first row, column, and band of the block. */
+      uint32_t numRows;          /**< The number of rows in the block. */
+      uint32_t numColumns;       /**< The number of columns in the block. */
+      uint32_t numBands;         /**< The number of bands in the block. */
+      int64_t rowStride;         /**< The number of bytes between consecutive rows. */
+      int64_t columnStride;      /**< The number of bytes between consecutive columns. */
+      int64_t bandStride;        /**< The number of bytes between consecutive bands. */
+      uint32_t encodingType;     /**< The data type of each value.  @see DataInfo::encodingType */
+      uint32_t encodingTypeSize; /**< The number of bytes per value.  @see RasterUtilities::bytesInEncoding() */
+      uint32_t copied;           /**< 0 -> pData points to the data of the RasterElement, so changes to the block
+                                      change the RasterElement.  Any other value -> pData points to a copy, and changes
+                                      are only stored by calling writeDataBlock(). */
+   };
+
+   /**
+    * Obtain a block of raster data which must be destroyed by calling destroyDataBlock().
+    *
+    * When the data of the block is available in memory, the block points to it
+    * and the pages containing it are kept in memory until the block is destroyed.
+    * Otherwise the block is read into a new buffer with a single bulk copy.
+    * The block is valid until it is destroyed or the RasterElement is destroyed,
+    * whichever is first.
+    *
+    * @param pElement
+    *        The RasterElement to access.
+    * @param pArgs
+    *        The structure containing the rows, columns, and bands of the block or \c NULL to access the entire cube.
+    *        The interleave format is ignored, since the block always has the interleave of the RasterElement.
+    * @param writable
+    *        0 -> The block will only be read, Any other value -> The block will be modified.
+    * @return A newly-created DataBlock with a reference count of one.
+    *         On failure, \c NULL is returned and getLastError() may be queried for information on the error.
+    *
+    * @see getDataElement(), retainDataBlock(), destroyDataBlock(), writeDataBlock()
+    */
+   EXPORT_SYMBOL DataBlock* createDataBlock(DataElement* pElement, DataPointerArgs* pArgs, int writable);
+
+   /**
+    * Add a reference to a DataBlock.
+    *
+    * Each call must be matched by a call to destroyDataBlock().  This allows
+    * several external objects to share the block and the pages it keeps in memory.
+    * The reference count is not synchronized, so a block must only be shared
+    * within a single thread.
+    *
+    * @param pBlock
+    *        A DataBlock obtained by calling createDataBlock().
+    *
+    * @see createDataBlock(), destroyDataBlock()
+    */
+   EXPORT_SYMBOL void retainDataBlock(DataBlock* pBlock);
+
+   /**
+    * Remove a reference to a DataBlock, destroying it when no references remain.
+    *
+    * When a writable block which is not a copy is destroyed, its rows are marked
+    * as modified so the changes are saved in the next session.
+    *
+    * Suitable for use as a cleanup callback.
+    *
+    * @param pBlock
+    *        A DataBlock obtained by calling createDataBlock().
+    *
+    * @see createDataBlock(), retainDataBlock()
+    */
+   EXPORT_SYMBOL void destroyDataBlock(DataBlock* pBlock);
+
+   /**
+    * Store the contents of a DataBlock in its RasterElement.
+    *
+    * A block which is a copy is written with a single bulk copy.  A block which
+    * points to the data of the RasterElement has already been stored, so nothing
+    * is copied and its rows are only marked as modified.  The caller should call updateRasterElement() to redisplay the data.
+    *
+    * @param pBlock
+    *        A DataBlock obtained by calling createDataBlock() with a non-zero writable value.
+    * @return a non-zero on failure or a zero on success.
+    *
+    * @see createDataBlock(), updateRasterElement()
+    */
+   EXPORT_SYMBOL int writeDataBlock(DataBlock* pBlock);
+
    /**
     * Descriptor for data access.
     * Rows, columns, and bands are all 0-based and reflect active numbers.
@@ -15,6 +15,7 @@
 #include "DynamicObjectImp.h"
 #include "FilenameImp.h"
 #include "ObjectResource.h"
+#include "SignalBatch.h"
 #include "SpecialMetadata.h"
 #include "StringUtilities.h"
 #include "TypeConverter.h"
@@ -102,6 +103,11 @@ void DynamicObjectImp::merge(const DynamicObject* pObject)
       return;
    }
 
+   // Notify Modified once for the whole merge instead of once for each attribute
+   Subject* pSubject = dynamic_cast<Subject*>(this);
+   VERIFYNRV(pSubject != NULL);
+   SignalBatch batch(*pSubject);
+
    vector<string> attributes;
    pObject->getAttributeNames(attributes);
 
@@ -137,6 +143,11 @@ void DynamicObjectImp::adoptiveMerge(DynamicObject* pObject)
       return;
    }
 
+   // Notify Modified once for the whole merge instead of once for each attribute
+   Subject* pSubject = dynamic_cast<Subject*>(this);
+   VERIFYNRV(pSubject != NULL);
+   SignalBatch batch(*pSubject);
+
    vector<string> attributes;
    pObject->getAttributeNames(attributes);
 
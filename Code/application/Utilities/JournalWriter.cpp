@@ -0,0 +1,132 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2007 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#include "JournalWriter.h"
+
+#include <QtCore/QFile>
+#include <QtCore/QMutexLocker>
+#include <QtCore/QString>
+
+JournalWriter::JournalWriter(QFile* pJournal, int batchSize, unsigned long flushInterval, int maxPending) :
+   mpJournal(pJournal),
+   mBatchSize(batchSize),
+   mFlushInterval(flushInterval),
+   mMaxPending(maxPending),
+   mQueuedBytes(0),
+   mWrittenBytes(0),
+   mFlushRequests(0),
+   mStopping(false)
+{
+   start(QThread::LowPriority);
+}
+
+JournalWriter::~JournalWriter()
+{
+   mMutex.lock();
+   mStopping = true;
+   mDataAvailable.wakeAll();
+   mSpaceAvailable.wakeAll();
+   mMutex.unlock();
+
+   // The thread writes everything pending before it exits
+   wait();
+   if (mPending.isEmpty() == false)
+   {
+      writeBatch(mPending);
+      mPending.clear();
+   }
+}
+
+void JournalWriter::write(const QString& entry)
+{
+   QByteArray bytes = entry.toLocal8Bit();
+   bytes.append('\n');
+
+   QMutexLocker lock(&mMutex);
+   if (isRunning() == false)
+   {
+      writeBatch(bytes);
+      mQueuedBytes += bytes.size();
+      mWrittenBytes += bytes.size();
+      return;
+   }
+
+   while (mPending.size() >= mMaxPending && mStopping == false)
+   {
+      mSpaceAvailable.wait(&mMutex);
+   }
+
+   bool wasEmpty = mPending.isEmpty();
+   mPending.append(bytes);
+   mQueuedBytes += bytes.size();
+
+   // The thread waits for the first entry of a batch and for the batch to fill
+   if (wasEmpty || mPending.size() >= mBatchSize)
+   {
+      mDataAvailable.wakeOne();
+   }
+}
+
+void JournalWriter::flush()
+{
+   QMutexLocker lock(&mMutex);
+   const qint64 target = mQueuedBytes;
+   ++mFlushRequests;
+   mDataAvailable.wakeOne();
+   while (mWrittenBytes < target && isRunning())
+   {
+      mBatchWritten.wait(&mMutex);
+   }
+
+   --mFlushRequests;
+}
+
+void JournalWriter::run()
+{
+   QMutexLocker lock(&mMutex);
+   for (;;)
+   {
+      if (mPending.isEmpty())
+      {
+         if (mStopping)
+         {
+            break;
+         }
+
+         mDataAvailable.wait(&mMutex);
+         continue;
+      }
+
+      // Give more entries a chance to arrive before writing a partial batch
+      if (mPending.size() < mBatchSize && mFlushRequests == 0 && mStopping == false)
+      {
+         mDataAvailable.wait(&mMutex, mFlushInterval);
+      }
+
+      QByteArray batch = mPending;
+      mPending.clear();
+      mSpaceAvailable.wakeAll();
+
+      lock.unlock();
+      writeBatch(batch);
+      lock.relock();
+
+      mWrittenBytes += batch.size();
+      mBatchWritten.wakeAll();
+   }
+}
+
+void JournalWriter::writeBatch(const QByteArray& batch)
+{
+   if (mpJournal != NULL)
+   {
+      mpJournal->write(batch);
+      mpJournal->flush();
+   }
+}
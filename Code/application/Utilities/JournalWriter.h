@@ -0,0 +1,93 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2007 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#ifndef JOURNALWRITER_H
+#define JOURNALWRITER_H
+
+#include <QtCore/QByteArray>
+#include <QtCore/QMutex>
+#include <QtCore/QThread>
+#include <QtCore/QWaitCondition>
+
+class QFile;
+class QString;
+
+/**
+ *  Writes message log journal entries to a file on a background thread.
+ *
+ *  Entries are appended to a bounded buffer and written in batches. A batch is
+ *  written when it reaches the batch size or when the oldest entry has waited
+ *  for the flush interval, whichever comes first. Callers block only when the
+ *  buffer is full. All pending entries are written when the writer is destroyed.
+ */
+class JournalWriter : public QThread
+{
+public:
+   /**
+    *  Creates the writer and starts its thread.
+    *
+    *  @param   pJournal
+    *           The open file to write. The caller retains ownership and must
+    *           not write to the file or close it while the writer exists.
+    *  @param   batchSize
+    *           The number of bytes which causes pending entries to be written immediately.
+    *  @param   flushInterval
+    *           The maximum number of milliseconds an entry waits before being written.
+    *  @param   maxPending
+    *           The number of pending bytes at which write() blocks until the
+    *           pending entries have been written.
+    */
+   JournalWriter(QFile* pJournal, int batchSize = 64 * 1024, unsigned long flushInterval = 500,
+      int maxPending = 4 * 1024 * 1024);
+
+   /**
+    *  Writes all pending entries and stops the thread.
+    */
+   ~JournalWriter();
+
+   /**
+    *  Queues a single line for the journal.
+    *
+    *  @param   entry
+    *           The text of the line, without a trailing newline.
+    */
+   void write(const QString& entry);
+
+   /**
+    *  Blocks until every entry queued before the call has been written and flushed.
+    */
+   void flush();
+
+protected:
+   void run();
+
+private:
+   void writeBatch(const QByteArray& batch);
+
+   QFile* mpJournal;
+   const int mBatchSize;
+   const unsigned long mFlushInterval;
+   const int mMaxPending;
+
+   QMutex mMutex;
+   QWaitCondition mDataAvailable;
+   QWaitCondition mSpaceAvailable;
+   QWaitCondition mBatchWritten;
+   QByteArray mPending;
+   qint64 mQueuedBytes;
+   qint64 mWrittenBytes;
+   int mFlushRequests;
+   bool mStopping;
+
+   // Not implemented.
+   JournalWriter(const JournalWriter&);
+   JournalWriter& operator=(const JournalWriter&);
+};
+
+#endif
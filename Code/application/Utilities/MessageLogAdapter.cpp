@@ -11,8 +11,8 @@
 
 using namespace std;
 
-MessageLogAdapter::MessageLogAdapter(const char* name, const char* path, QFile *journal) :
-   MessageLogImp(name, path, journal)
+MessageLogAdapter::MessageLogAdapter(const char* name, const char* path, JournalWriter* pJournal) :
+   MessageLogImp(name, path, pJournal)
 {}
 
 MessageLogAdapter::~MessageLogAdapter()
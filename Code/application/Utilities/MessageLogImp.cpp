@@ -14,6 +14,7 @@
 #include "DynamicObjectAdapter.h"
 #include "FilenameImp.h"
 #include "Int64.h"
+#include "JournalWriter.h"
 #include "MessageLogAdapter.h"
 #include "UInt64.h"
 #include "xmlwriter.h"
@@ -28,10 +29,38 @@
 using namespace std;
 XERCES_CPP_NAMESPACE_USE
 
-MessageLogImp::MessageLogImp(const char* name, const char* path, QFile* journal) :
+namespace
+{
+   // Warnings are either messages with a warning or error action or messages with a severity property
+   bool isWarning(const Message* pMsg)
+   {
+      QString action = QString::fromStdString(pMsg->getAction());
+      if (action.compare("Warning", Qt::CaseInsensitive) == 0 || action.compare("Error", Qt::CaseInsensitive) == 0)
+      {
+         return true;
+      }
+
+      const DynamicObject* pProperties = pMsg->getProperties();
+      if (pProperties != NULL)
+      {
+         const string* pSeverity = dv_cast<string>(&pProperties->getAttribute("severity"));
+         if (pSeverity != NULL)
+         {
+            QString severity = QString::fromStdString(*pSeverity);
+            return severity.compare("Warning", Qt::CaseInsensitive) == 0 ||
+               severity.compare("Error", Qt::CaseInsensitive) == 0 ||
+               severity.compare("Fatal", Qt::CaseInsensitive) == 0;
+         }
+      }
+
+      return false;
+   }
+}
+
+MessageLogImp::MessageLogImp(const char* name, const char* path, JournalWriter* pJournal) :
          mpLogName(name),
          mpCurrentStep(NULL),
-         mpJournal(journal),
+         mpJournal(pJournal),
          mpWriter(NULL)
 {
    mpFilename = new FilenameImp(path);
@@ -68,8 +97,6 @@ MessageLogImp::MessageLogImp(const char* name, const char* path, QFile* journal)
    {
       fname = (string)path + fname + extension;
    }
-   mpJournalWriter = new QTextStream(mpJournal);
-
    QTemporaryFile* pTempFile = new QTemporaryFile(QString::fromStdString(fname));
    if (pTempFile != NULL)
    {
@@ -120,12 +147,6 @@ MessageLogImp::~MessageLogImp()
       delete mpLogFile;
       mpLogFile = NULL;
    }
-   if (mpJournalWriter != NULL)
-   {
-      delete mpJournalWriter;
-      mpJournalWriter = NULL;
-   }
-
    if (mpFilename != NULL)
    {
       delete dynamic_cast<FilenameImp*>(mpFilename);
@@ -278,7 +299,7 @@ const string& MessageLogImp::getLogName() const
 void MessageLogImp::messageAdded(Subject& subject, const string& signal, const boost::any& v)
 {
    Message* pMsg(boost::any_cast<Message*>(v));
-   if (mpJournalWriter == NULL || pMsg == NULL)
+   if (mpJournal == NULL || pMsg == NULL)
    {
       return;
    }
@@ -286,17 +307,27 @@ void MessageLogImp::messageAdded(Subject& subject, const string& signal, const b
    Step* pStp(dynamic_cast<Step*>(pMsg));
    StepImp* pStpImp(dynamic_cast<StepImp*>(pStp));
    MessageImp* pMsgImp(dynamic_cast<MessageImp*>(pMsg));
-   *mpJournalWriter << mpLogName.c_str() << " - ADDED "
+   QString entry;
+   QTextStream stream(&entry);
+   stream << mpLogName.c_str() << " - ADDED "
       << ((pStpImp != NULL) ? "Step" : "Message")
       << "[" << ((pStpImp != NULL) ? pStpImp : pMsgImp)->getStringId().c_str() << "] "
-      << pMsg->getAction().c_str() << endl << flush;
+      << pMsg->getAction().c_str();
+   stream.flush();
+   mpJournal->write(entry);
+
+   // Make sure that warnings are on disk in case they are followed by a crash
+   if (isWarning(pMsg))
+   {
+      mpJournal->flush();
+   }
    notify(SIGNAL_NAME(MessageLog, MessageAdded), v);
 }
 
 void MessageLogImp::messageModified(Subject& subject, const string& signal, const boost::any& v)
 {
    Message* pMsg(boost::any_cast<Message*>(v));
-   if (mpJournalWriter == NULL || pMsg == NULL)
+   if (mpJournal == NULL || pMsg == NULL)
    {
       return;
    }
@@ -304,18 +335,27 @@ void MessageLogImp::messageModified(Subject& subject, const string& signal, cons
    Step* pStp(dynamic_cast<Step*>(pMsg));
    StepImp* pStpImp(dynamic_cast<StepImp*>(pStp));
    MessageImp* pMsgImp(dynamic_cast<MessageImp*>(pMsg));
-   *mpJournalWriter << mpLogName.c_str() << " - PROPERTY ADDED "
+   QString entry;
+   QTextStream stream(&entry);
+   stream << mpLogName.c_str() << " - PROPERTY ADDED "
       << ((pStpImp != NULL) ? "Step" : "Message")
       << "[" << ((pStpImp != NULL) ? pStpImp : pMsgImp)->getStringId().c_str() << "."
-      << pMsg->getProperties()->getNumAttributes() << "] "
-      << endl << flush;
+      << pMsg->getProperties()->getNumAttributes() << "] ";
+   stream.flush();
+   mpJournal->write(entry);
+
+   // A severity is added as a property after the message is created
+   if (isWarning(pMsg))
+   {
+      mpJournal->flush();
+   }
    notify(SIGNAL_NAME(MessageLog, MessageModified), v);
 }
 
 void MessageLogImp::messageHidden(Subject& subject, const string& signal, const boost::any& v)
 {
    Message* pMsg(boost::any_cast<Message*>(v));
-   if (mpJournalWriter == NULL || pMsg == NULL)
+   if (mpJournal == NULL || pMsg == NULL)
    {
       return;
    }
@@ -323,27 +363,39 @@ void MessageLogImp::messageHidden(Subject& subject, const string& signal, const
    Step* pStp(dynamic_cast<Step*>(pMsg));
    StepImp* pStpImp(dynamic_cast<StepImp*>(pStp));
    MessageImp* pMsgImp(dynamic_cast<MessageImp*>(pMsg));
-   *mpJournalWriter << mpLogName.c_str() << " - FINALIZED "
+   QString entry;
+   QTextStream stream(&entry);
+   stream << mpLogName.c_str() << " - FINALIZED "
       << ((pStpImp != NULL) ? "Step" : "Message")
       << "[" << ((pStpImp != NULL) ? pStpImp : pMsgImp)->getStringId().c_str() << "] ";
+   bool failed = false;
    if (pStp != NULL)
    {
       switch (pStp->getResult())
       {
       case Message::Success:
-         *mpJournalWriter << "Success";
+         stream << "Success";
          break;
       case Message::Failure:
-         *mpJournalWriter << "Failure[" << pStp->getFailureMessage().c_str() << "]";
+         stream << "Failure[" << pStp->getFailureMessage().c_str() << "]";
+         failed = true;
          break;
       case Message::Abort:
-         *mpJournalWriter << "Abort";
+         stream << "Abort";
+         failed = true;
          break;
       default:
          break;
       }
    }
-   *mpJournalWriter << endl << flush;
+   stream.flush();
+   mpJournal->write(entry);
+
+   // Make sure that a failure is on disk in case it is followed by a crash
+   if (failed)
+   {
+      mpJournal->flush();
+   }
    notify(SIGNAL_NAME(MessageLog, MessageHidden), v);
 }
 
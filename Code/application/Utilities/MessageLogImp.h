@@ -28,6 +28,7 @@
 
 #include "XercesIncludes.h"
 
+class JournalWriter;
 class MessageImp;
 class StepImp;
 
@@ -102,7 +103,7 @@ public:
    /**
     *  Construct a new message log
     */
-   MessageLogImp(const char* name, const char* path, QFile *journal);
+   MessageLogImp(const char* name, const char* path, JournalWriter* pJournal);
    virtual ~MessageLogImp();
 
    virtual Message *createMessage(const std::string &action,
@@ -146,8 +147,7 @@ private:
    Filename* mpFilename;
    std::vector<Message*> mMessageList;
    Step* mpCurrentStep;
-   QFile* mpJournal;
-   QTextStream* mpJournalWriter;
+   JournalWriter* mpJournal;
    XMLWriter* mpWriter;
 };
 
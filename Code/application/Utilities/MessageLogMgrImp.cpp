@@ -9,6 +9,7 @@
 
 #include "ConfigurationSettings.h"
 #include "Filename.h"
+#include "JournalWriter.h"
 #include "MessageLogAdapter.h"
 #include "MessageLogMgrImp.h"
 #include "SessionManager.h"
@@ -21,7 +22,8 @@ MessageLogMgrImp* MessageLogMgrImp::spInstance = NULL;
 bool MessageLogMgrImp::mDestroyed = false;
 
 MessageLogMgrImp::MessageLogMgrImp() :
-   mpJournal(NULL)
+   mpJournal(NULL),
+   mpJournalWriter(NULL)
 {
    const Filename* pMessageLogPath = ConfigurationSettings::getSettingMessageLogPath();
    if (pMessageLogPath != NULL)
@@ -41,6 +43,7 @@ MessageLogMgrImp::MessageLogMgrImp() :
    mpJournal = new QTemporaryFile(QString::fromStdString(mLogPath) + "/journ");
    mpJournal->open(QIODevice::WriteOnly);
    mpJournal->setPermissions(QFile::WriteOwner);
+   mpJournalWriter = new JournalWriter(mpJournal);
 
    // Create a default session log
    createLog(Service<SessionManager>()->getName());
@@ -51,6 +54,10 @@ MessageLogMgrImp::~MessageLogMgrImp()
    notify(SIGNAL_NAME(Subject, Deleted));
    clear();
 
+   // Write any pending journal entries before closing the journal
+   delete mpJournalWriter;
+   mpJournalWriter = NULL;
+
    mpJournal->close();
    mpJournal->remove();
    delete mpJournal;
@@ -100,7 +107,7 @@ MessageLog* MessageLogMgrImp::createLog(const string& logName)
       return NULL;
    }
 
-   MessageLog* pLog = new MessageLogAdapter(logName.c_str(), mLogPath.c_str(), mpJournal);
+   MessageLog* pLog = new MessageLogAdapter(logName.c_str(), mLogPath.c_str(), mpJournalWriter);
    mLogMap.insert(pair<string, MessageLog*>(logName, pLog));
    notify(SIGNAL_NAME(MessageLogMgr, LogAdded), pLog);
 
@@ -17,6 +17,7 @@
 #include <string>
 #include <vector>
 
+class JournalWriter;
 class MessageLog;
 class QFile;
 
@@ -50,6 +51,7 @@ private:
    std::map<std::string, MessageLog*> mLogMap;
    std::string mLogPath;
    QFile* mpJournal;
+   JournalWriter* mpJournalWriter;
 };
 
 #endif
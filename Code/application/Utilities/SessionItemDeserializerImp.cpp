@@ -14,10 +14,12 @@
 using namespace std;
 XERCES_CPP_NAMESPACE_USE
 
-SessionItemDeserializerImp::SessionItemDeserializerImp(const string& filename, const vector<int64_t>& blockSizes) :
+SessionItemDeserializerImp::SessionItemDeserializerImp(const string& filename, const vector<int64_t>& blockSizes,
+                                                       const string& saveId) :
    mBaseFilename(filename),
    mCurrentBlock(0),
-   mBlockSizes(blockSizes)
+   mBlockSizes(blockSizes),
+   mSaveId(saveId)
 {
 }
 
@@ -113,3 +115,8 @@ int SessionItemDeserializerImp::getCurrentBlock() const
 {
    return mCurrentBlock;
 }
+
+string SessionItemDeserializerImp::getBlockId() const
+{
+   return filenameForCurrentBlock() + "|" + mSaveId;
+}
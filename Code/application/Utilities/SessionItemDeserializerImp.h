@@ -20,7 +20,8 @@
 class SessionItemDeserializerImp : public SessionItemDeserializer
 {
 public:
-   SessionItemDeserializerImp(const std::string &filename, const std::vector<int64_t> &blockSizes);
+   SessionItemDeserializerImp(const std::string &filename, const std::vector<int64_t> &blockSizes,
+      const std::string &saveId = std::string());
    ~SessionItemDeserializerImp();
    bool deserialize(void *pData, unsigned int size);
    bool deserialize(std::vector<unsigned char> &data);
@@ -28,6 +29,7 @@ public:
    XERCES_CPP_NAMESPACE_QUALIFIER DOMElement *deserialize(XmlReader &reader, const char *pRootElementName);
    void nextBlock();
    std::vector<int64_t> getBlockSizes() const;
+   std::string getBlockId() const;
    int getCurrentBlock() const;
 
 private:
@@ -39,6 +41,7 @@ private:
    LargeFileResource mFile;
    int mCurrentBlock;
    std::vector<int64_t> mBlockSizes;
+   std::string mSaveId;
 };
 
 #endif
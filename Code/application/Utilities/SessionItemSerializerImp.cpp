@@ -11,14 +11,29 @@
 #include "SessionItemSerializerImp.h"
 #include "xmlwriter.h"
 
+#include <vector>
+
 using namespace std;
 
-SessionItemSerializerImp::SessionItemSerializerImp(string filename) :
+namespace
+{
+   // Each update is written to the update file as its offset in the block and its size, followed by the data
+   struct UpdateHeader
+   {
+      int64_t mOffset;
+      int64_t mSize;
+   };
+}
+
+SessionItemSerializerImp::SessionItemSerializerImp(string filename, string committedSaveId, string saveId) :
    mBaseFilename(filename),
    mFilename(filename),
+   mCommittedSaveId(committedSaveId),
+   mSaveId(saveId),
    mTotalBlocks(1),
    mBytesReserved(0),
-   mBytesWritten(0)
+   mBytesWritten(0),
+   mUpdating(false)
 {
 }
 
@@ -72,6 +87,15 @@ bool SessionItemSerializerImp::serialize(const void *pData, int64_t size)
          return false;
       }
 
+      if (mUpdating)
+      {
+         UpdateHeader header = { mBytesWritten, size };
+         if (mFile.write(&header, sizeof(header)) != static_cast<int64_t>(sizeof(header)))
+         {
+            return false;
+         }
+      }
+
       int64_t bytesWritten = mFile.write(pData, size);
       mBytesWritten += bytesWritten;
       if (bytesWritten != size)
@@ -97,6 +121,7 @@ void SessionItemSerializerImp::endBlock()
    }
    mBytesReserved = 0;
    mBytesWritten = 0;
+   mUpdating = false;
    stringstream buf;
    buf << mBaseFilename << "." << mTotalBlocks++;
    mFilename = buf.str();
@@ -106,3 +131,89 @@ unsigned int SessionItemSerializerImp::getBlockCount() const
 {
    return mTotalBlocks;
 }
+
+string SessionItemSerializerImp::getBlockId() const
+{
+   // the block only becomes the previous block once the session index for this save has been written
+   return mFilename + "|" + mSaveId;
+}
+
+bool SessionItemSerializerImp::updateBlock(const string& previousBlockId)
+{
+   if (mCommittedSaveId.empty() || mSaveId.empty() || previousBlockId != mFilename + "|" + mCommittedSaveId ||
+      mBytesReserved == 0 || mBytesWritten != 0)
+   {
+      return false;
+   }
+
+   LargeFileResource block;
+   if (!block.open(mFilename, O_RDONLY | O_BINARY, S_IREAD) || block.fileLength() != mBytesReserved)
+   {
+      return false;
+   }
+   block.close();
+
+   // the block from the previous save is left untouched, and the changes are written to an update file
+   // which is only applied to the block after the new session index has been written
+   if (mFile.validHandle())
+   {
+      mFile.close();
+   }
+   if (!mFile.open(getUpdateFilename(mFilename, mSaveId), O_WRONLY | O_CREAT | O_BINARY | O_TRUNC,
+      S_IREAD | S_IWRITE))
+   {
+      return false;
+   }
+
+   mUpdating = true;
+   return true;
+}
+
+bool SessionItemSerializerImp::seek(int64_t offset)
+{
+   if (!mUpdating || offset < 0 || offset > mBytesReserved)
+   {
+      return false;
+   }
+
+   // the written byte count is the position in the block, so serialize() still enforces the reserved size
+   mBytesWritten = offset;
+   return true;
+}
+
+string SessionItemSerializerImp::getUpdateFilename(const string& blockFilename, const string& saveId)
+{
+   return blockFilename + "." + saveId + ".update";
+}
+
+bool SessionItemSerializerImp::applyUpdate(const string& updateFilename, const string& blockFilename)
+{
+   LargeFileResource update;
+   LargeFileResource block;
+   if (!update.open(updateFilename, O_RDONLY | O_BINARY, S_IREAD) ||
+      !block.open(blockFilename, O_WRONLY | O_BINARY, S_IREAD | S_IWRITE))
+   {
+      return false;
+   }
+
+   vector<char> data;
+   UpdateHeader header;
+   int64_t bytesRead = 0;
+   while ((bytesRead = update.read(&header, sizeof(header))) == static_cast<int64_t>(sizeof(header)))
+   {
+      if (header.mOffset < 0 || header.mSize < 0)
+      {
+         return false;
+      }
+
+      data.resize(static_cast<size_t>(header.mSize));
+      if (header.mSize > 0 && (update.read(&data.front(), header.mSize) != header.mSize ||
+         block.seek(header.mOffset, SEEK_SET) != header.mOffset ||
+         block.write(&data.front(), header.mSize) != header.mSize))
+      {
+         return false;
+      }
+   }
+
+   return bytesRead == 0;
+}
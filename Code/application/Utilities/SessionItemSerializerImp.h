@@ -21,7 +21,8 @@
 class SessionItemSerializerImp : public SessionItemSerializer
 {
 public:
-   SessionItemSerializerImp(std::string filename);
+   SessionItemSerializerImp(std::string filename, std::string committedSaveId = std::string(),
+      std::string saveId = std::string());
    virtual ~SessionItemSerializerImp();
 
    void reserve(int64_t size);
@@ -31,14 +32,25 @@ public:
    std::vector<int64_t> getBlockSizes() const;
    void endBlock();
    unsigned int getBlockCount() const;
+   std::string getBlockId() const;
+   bool updateBlock(const std::string& previousBlockId);
+   bool seek(int64_t offset);
+
+   // The changes made after updateBlock() are kept in an update file until the session index for the save has
+   // been written, and are then applied to the block.  Applying them again has no further effect.
+   static std::string getUpdateFilename(const std::string& blockFilename, const std::string& saveId);
+   static bool applyUpdate(const std::string& updateFilename, const std::string& blockFilename);
 
 private:
    std::string mBaseFilename;
    std::string mFilename;
+   std::string mCommittedSaveId;
+   std::string mSaveId;
    unsigned int mTotalBlocks;
    LargeFileResource mFile;
    int64_t mBytesReserved;
    int64_t mBytesWritten;
+   bool mUpdating;
    std::vector<int64_t> mBlockSizes;
 };
 
@@ -178,6 +178,7 @@ void SessionManagerImp::close()
    MessageLogMgrImp::instance()->clear();
 
    mName.clear();
+   mSaveId.clear();
    notify(SIGNAL_NAME(SessionManagerImp, SessionFullyClosed));
 }
 
@@ -606,6 +607,35 @@ void SessionManagerImp::createSessionItems(vector<IndexFileItem> &items, Progres
    }
 }
 
+bool SessionManagerImp::applyBlockUpdates(const string &dir, const string &saveId) const
+{
+   // apply the block updates of the given save, and remove those of any save which did not complete
+   QDir dirList(QString::fromStdString(dir));
+   QStringList files = dirList.entryList(QStringList() << "*.update", QDir::Files, QDir::Name);
+   const QString suffix = QString::fromStdString(
+      SessionItemSerializerImp::getUpdateFilename(string(), saveId));
+
+   bool success = true;
+   foreach (QString file, files)
+   {
+      if (saveId.empty() == false && file.endsWith(suffix))
+      {
+         string updatePath = dirList.filePath(file).toStdString();
+         string blockPath = updatePath.substr(0, updatePath.size() - suffix.size());
+         if (SessionItemSerializerImp::applyUpdate(updatePath, blockPath) == false)
+         {
+            // keep the update so that it is applied when the session is opened
+            success = false;
+            continue;
+         }
+      }
+
+      dirList.remove(file);
+   }
+
+   return success;
+}
+
 void SessionManagerImp::deleteObsoleteFiles(const string &dir, const vector<IndexFileItem> &itemsToKeep) const
 {
    QDir dirList(QString::fromStdString(dir));
@@ -618,9 +648,25 @@ void SessionManagerImp::deleteObsoleteFiles(const string &dir, const vector<Inde
    transform(files.begin(), files.end(), back_inserter(dirFilenames), boost::bind(&QString::toStdString, _1));
    sort(itemFilenames.begin(), itemFilenames.end());
 
+   // keep the additional blocks of the items, which are saved with the block number appended to the filename,
+   // so that the items can update their blocks in place instead of rewriting them
+   const string itemExtension = ".sessionItem.";
    vector<string> obsoleteFiles;
-   set_difference(dirFilenames.begin(), dirFilenames.end(), itemFilenames.begin(), itemFilenames.end(),
-      back_inserter(obsoleteFiles));
+   for (vector<string>::const_iterator pDirFilename = dirFilenames.begin();
+      pDirFilename != dirFilenames.end();
+      ++pDirFilename)
+   {
+      string itemFilename = *pDirFilename;
+      string::size_type blockPos = itemFilename.rfind(itemExtension);
+      if (blockPos != string::npos)
+      {
+         itemFilename.erase(blockPos + itemExtension.size() - 1);
+      }
+      if (!binary_search(itemFilenames.begin(), itemFilenames.end(), itemFilename))
+      {
+         obsoleteFiles.push_back(*pDirFilename);
+      }
+   }
 
    for (pFilename = obsoleteFiles.begin(); pFilename != obsoleteFiles.end(); ++pFilename)
    {
@@ -1078,6 +1124,12 @@ bool SessionManagerImp::open(const string &filename, Progress *pProgress)
       mIsSaveLoad = true;
       close();
       vector<IndexFileItem> items = readIndexFile(filename);
+
+      // finish applying the block updates of the save if it was interrupted after writing the index
+      if (applyBlockUpdates(mRestoreSessionPath, mSaveId) == false)
+      {
+         throw Failure("Unable to apply the updates saved to the session data.");
+      }
       MessageLogMgrImp::instance()->createLog(mName);
       if (pProgress)
       {
@@ -1173,6 +1225,7 @@ vector<SessionManagerImp::IndexFileItem> SessionManagerImp::readIndexFile(const
          {
             mName = SessionItemImp::generateUniqueId();
          }
+         mSaveId = A(pRootElement->getAttribute(X("save_id")));
          FOR_EACH_DOMNODE (pRootElement, pChild)
          {
             if (XMLString::equals(pChild->getNodeName(), X("session_item")))
@@ -1241,7 +1294,7 @@ bool SessionManagerImp::restoreSessionItem(IndexFileItem &item)
    VERIFY_MSG(pSessionItem!=NULL, 
       string("SessionItem '" + item.mType + "' not successfully created").c_str());
    ItemFilename filename;
-   SessionItemDeserializerImp deserializer(mRestoreSessionPath + "/" + filename(item), item.mBlockSizes);
+   SessionItemDeserializerImp deserializer(mRestoreSessionPath + "/" + filename(item), item.mBlockSizes, mSaveId);
    if (pSessionItem->deserialize(deserializer) == false)
    {
       destroyFailedSessionItem(item.mType, pSessionItem);
@@ -1267,6 +1320,7 @@ SessionManagerImp::serialize(const string& filename, Progress* pProgress)
 
    SerializationStatus status = SUCCESS;
    vector<IndexFileItem> items = getAllIndexFileItems();
+   string saveId = SessionItemImp::generateUniqueId();
 
    vector<pair<SessionItem*, string> > failedItems;
    vector<IndexFileItem> successItems;
@@ -1287,6 +1341,12 @@ SessionManagerImp::serialize(const string& filename, Progress* pProgress)
       mIsSaveLoad = true;
       deleteObsoleteFiles(sessionDirPath, items);
 
+      // the blocks must hold the last save before they can be updated again
+      if (applyBlockUpdates(sessionDirPath, mSaveId) == false)
+      {
+         mSaveId.clear();
+      }
+
       SessionItemSerializerImp sis(getPathForItem(sessionDirPath, ModelServicesImp::instance()));
       if (ModelServicesImp::instance()->serialize(sis) == false)
       {
@@ -1317,7 +1377,7 @@ SessionManagerImp::serialize(const string& filename, Progress* pProgress)
          {
             pProgress->updateProgress("Saving session items...", 100*i/count, NORMAL);
          }
-         SessionItemSerializerImp itemSerializer(filePath);
+         SessionItemSerializerImp itemSerializer(filePath, mSaveId, saveId);
          bool itemSuccess = pItem->serialize(itemSerializer);
          if (!itemSuccess)
          {
@@ -1334,14 +1394,34 @@ SessionManagerImp::serialize(const string& filename, Progress* pProgress)
          {
             ppItem->mBlockSizes = itemSerializer.getBlockSizes();
             successItems.push_back(*ppItem);
+
+            // remove any blocks left over from a previous save of this item which used more blocks
+            for (unsigned int block = max<size_t>(ppItem->mBlockSizes.size(), 1); ; ++block)
+            {
+               QString blockPath = QString::fromStdString(filePath) + "." + QString::number(block);
+               if (sessionDir.exists(blockPath) == false)
+               {
+                  break;
+               }
+               sessionDir.remove(blockPath);
+            }
          }
       }
 
-      if (successItems.size() == 0 || writeIndexFile(filename, successItems) == false)
+      if (successItems.size() == 0 || writeIndexFile(filename, successItems, saveId) == false)
       {
          failedItems.clear();
          status = FAILURE;
       }
+      else
+      {
+         // the new index refers to the updated blocks, so the updates can now be applied
+         mSaveId = saveId;
+         if (applyBlockUpdates(sessionDirPath, saveId) == false && pProgress != NULL)
+         {
+            pProgress->updateProgress("Some changes will be applied when the session is opened.", 100, WARNING);
+         }
+      }
       if (pProgress)
       {
          pProgress->updateProgress("Done.", 100, status == FAILURE ? ERRORS : NORMAL);
@@ -1350,6 +1430,7 @@ SessionManagerImp::serialize(const string& filename, Progress* pProgress)
 
    if (status == FAILURE)
    {
+      mSaveId.clear();
       remove(filename.c_str());
       QStringList files(sessionDir.entryList());
       foreach(QString file, files)
@@ -1366,7 +1447,8 @@ SessionManagerImp::serialize(const string& filename, Progress* pProgress)
    return make_pair(status, failedItems);
 }
 
-bool SessionManagerImp::writeIndexFile(const string &filename, const vector<IndexFileItem> &items)
+bool SessionManagerImp::writeIndexFile(const string &filename, const vector<IndexFileItem> &items,
+                                       const string &saveId)
 {
    FILE* pFile = fopen(filename.c_str(), "w");
    if (pFile == NULL)
@@ -1378,6 +1460,7 @@ bool SessionManagerImp::writeIndexFile(const string &filename, const vector<Inde
    xml.addAttr("version", APP_VERSION_NUMBER);
    xml.addAttr("id", mName);
    xml.addAttr("platform", AebPlatform::currentPlatform());
+   xml.addAttr("save_id", saveId);
    vector<IndexFileItem>::const_iterator ppItem;
    for (ppItem = items.begin(); ppItem != items.end(); ++ppItem)
    {
@@ -142,6 +142,7 @@ private:
    void destroyWindow(SessionItem *pItem);
    void destroyView(SessionItem *pItem);
 
+   bool applyBlockUpdates(const std::string &dir, const std::string &saveId) const;
    void createSessionItems(std::vector<IndexFileItem> &items, Progress *pProgress);
    void deleteObsoleteFiles(const std::string &dir, const std::vector<IndexFileItem> &itemsToKeep) const;
    void destroyFailedSessionItem(const std::string &type, SessionItem* pItem);
@@ -156,12 +157,14 @@ private:
    std::vector<IndexFileItem> readIndexFile(const std::string &filename);
    bool restoreSessionItem(IndexFileItem &item);
    void restoreSessionItems(std::vector<IndexFileItem> &items, Progress *pProgress);
-   bool writeIndexFile(const std::string &filename, const std::vector<IndexFileItem> &items);
+   bool writeIndexFile(const std::string &filename, const std::vector<IndexFileItem> &items,
+      const std::string &saveId);
 
    static SessionManagerImp* spInstance;
    static bool mDestroyed;
    std::string mName;
    std::string mRestoreSessionPath;
+   std::string mSaveId;    // identifies the last session save which was written or restored
    std::map<std::string, SessionItem*> mItems;
    bool mIsSaveLoad;
    unsigned int mSaveLockCount;
@@ -0,0 +1,197 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2007 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+using namespace std;
+
+ThreadPool::Worker::Worker(ThreadPool& pool) :
+   mPool(pool)
+{
+}
+
+void ThreadPool::Worker::run()
+{
+   mPool.runTasks(this);
+}
+
+ThreadPool::ThreadPool(unsigned int maxThreads, unsigned long idleTimeout) :
+   mMaxThreads(max(maxThreads, 1U)),
+   mIdleTimeout(idleTimeout),
+   mNextTaskId(1),
+   mIdleWorkers(0),
+   mStopping(false)
+{
+}
+
+ThreadPool::~ThreadPool()
+{
+   mMutex.lock();
+   mStopping = true;
+   mTaskAvailable.wakeAll();
+   mMutex.unlock();
+
+   // The workers run everything queued before they exit and no longer change
+   // the worker lists once they have been told to stop
+   for (vector<Worker*>::iterator iter = mWorkers.begin(); iter != mWorkers.end(); ++iter)
+   {
+      (*iter)->wait();
+      delete *iter;
+   }
+
+   mWorkers.clear();
+   deleteExpiredWorkers();
+}
+
+void ThreadPool::run(Function pFunction, void* pData)
+{
+   if (pFunction == NULL)
+   {
+      return;
+   }
+
+   Task task = { pFunction, pData, 0 };
+   QMutexLocker lock(&mMutex);
+   queueTask(task);
+}
+
+unsigned int ThreadPool::start(Function pFunction, void* pData)
+{
+   if (pFunction == NULL)
+   {
+      return 0;
+   }
+
+   QMutexLocker lock(&mMutex);
+   Task task = { pFunction, pData, mNextTaskId };
+   if (++mNextTaskId == 0)
+   {
+      // Zero is returned for a NULL function, so it is never a task
+      mNextTaskId = 1;
+   }
+
+   mUnfinishedTasks.insert(task.mId);
+   queueTask(task);
+   return task.mId;
+}
+
+void ThreadPool::wait(unsigned int task)
+{
+   QMutexLocker lock(&mMutex);
+   while (mUnfinishedTasks.find(task) != mUnfinishedTasks.end())
+   {
+      if (mTasks.empty())
+      {
+         // The function is running on another thread, which wakes this one when it or a queued function finishes
+         mTaskFinished.wait(&mMutex);
+         continue;
+      }
+
+      // Run the function here if no pool thread has taken it, and otherwise help with the queued functions
+      // until it returns, since every pool thread may be waiting for functions behind it in the queue
+      deque<Task>::iterator iter = mTasks.begin();
+      while (iter != mTasks.end() && iter->mId != task)
+      {
+         ++iter;
+      }
+
+      if (iter == mTasks.end())
+      {
+         iter = mTasks.begin();
+      }
+
+      Task queuedTask = *iter;
+      mTasks.erase(iter);
+      runTask(queuedTask, lock);
+   }
+}
+
+void ThreadPool::queueTask(const Task& task)
+{
+   deleteExpiredWorkers();
+   mTasks.push_back(task);
+
+   // Start a thread rather than queue behind busy threads until the pool is full. Threads which are waiting for
+   // a function are woken so they can run this one if every pool thread is busy.
+   if (mIdleWorkers >= mTasks.size())
+   {
+      mTaskAvailable.wakeOne();
+   }
+   else if (mWorkers.size() < mMaxThreads)
+   {
+      Worker* pWorker = new Worker(*this);
+      mWorkers.push_back(pWorker);
+      pWorker->start();
+   }
+   else
+   {
+      mTaskFinished.wakeAll();
+   }
+}
+
+void ThreadPool::runTasks(Worker* pWorker)
+{
+   QMutexLocker lock(&mMutex);
+   for (;;)
+   {
+      if (mTasks.empty())
+      {
+         if (mStopping)
+         {
+            break;
+         }
+
+         ++mIdleWorkers;
+         bool signaled = mTaskAvailable.wait(&mMutex, mIdleTimeout);
+         --mIdleWorkers;
+         if (signaled == false && mTasks.empty() && mStopping == false)
+         {
+            // The thread is deleted by the next call to run() or by the destructor
+            mWorkers.erase(find(mWorkers.begin(), mWorkers.end(), pWorker));
+            mExpiredWorkers.push_back(pWorker);
+            break;
+         }
+
+         continue;
+      }
+
+      Task task = mTasks.front();
+      mTasks.pop_front();
+      runTask(task, lock);
+   }
+}
+
+void ThreadPool::runTask(const Task& task, QMutexLocker& lock)
+{
+   lock.unlock();
+   task.mpFunction(task.mpData);
+   lock.relock();
+
+   // The function has returned, so its module may be unloaded once the waiting thread wakes up
+   if (task.mId != 0)
+   {
+      mUnfinishedTasks.erase(task.mId);
+      mTaskFinished.wakeAll();
+   }
+}
+
+void ThreadPool::deleteExpiredWorkers()
+{
+   // Expired workers have released the mutex for the last time, so waiting
+   // while holding it cannot deadlock
+   for (vector<Worker*>::iterator iter = mExpiredWorkers.begin(); iter != mExpiredWorkers.end(); ++iter)
+   {
+      (*iter)->wait();
+      delete *iter;
+   }
+
+   mExpiredWorkers.clear();
+}
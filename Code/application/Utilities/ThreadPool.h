@@ -0,0 +1,135 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2007 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <QtCore/QMutex>
+#include <QtCore/QMutexLocker>
+#include <QtCore/QThread>
+#include <QtCore/QWaitCondition>
+
+#include <deque>
+#include <set>
+#include <vector>
+
+/**
+ *  Runs functions on a bounded set of reusable threads.
+ *
+ *  Threads are kept after their function returns and are reused for later
+ *  functions. A thread is added whenever no idle thread is available, up to
+ *  the maximum number of threads, after which functions are queued.  A thread
+ *  which waits for a function in wait() runs queued functions itself until
+ *  that function has returned, so a function may wait for other functions in
+ *  the pool without deadlocking.  Threads which stay idle for the idle timeout
+ *  exit. Queued functions are run and all threads are stopped when the pool is
+ *  destroyed.
+ */
+class ThreadPool
+{
+public:
+   typedef void (*Function)(void*);
+
+   /**
+    *  Creates a pool without any threads.
+    *
+    *  @param   maxThreads
+    *           The maximum number of threads in the pool, which is normally
+    *           the number of processors.  The pool has at least one thread.
+    *  @param   idleTimeout
+    *           The number of milliseconds an idle thread waits for a function
+    *           before it exits.
+    */
+   ThreadPool(unsigned int maxThreads, unsigned long idleTimeout = 30000);
+
+   /**
+    *  Waits for all queued functions to return and stops the threads.
+    */
+   ~ThreadPool();
+
+   /**
+    *  Queues a function to run on a pool thread.
+    *
+    *  @param   pFunction
+    *           The function to run.
+    *  @param   pData
+    *           The argument to pass to the function.
+    */
+   void run(Function pFunction, void* pData);
+
+   /**
+    *  Queues a function to run on a pool thread which can be waited for.
+    *
+    *  @param   pFunction
+    *           The function to run.
+    *  @param   pData
+    *           The argument to pass to the function.
+    *
+    *  @return  The task, which must be passed to wait() exactly once, or zero
+    *           if \em pFunction is \c NULL.
+    */
+   unsigned int start(Function pFunction, void* pData);
+
+   /**
+    *  Waits for a function queued by start() to return.
+    *
+    *  While the function has not returned, the calling thread runs queued
+    *  functions, starting with the function being waited for if no pool
+    *  thread has taken it yet.
+    *
+    *  @param   task
+    *           The value returned by start().
+    */
+   void wait(unsigned int task);
+
+private:
+   struct Task
+   {
+      Function mpFunction;
+      void* mpData;
+      unsigned int mId;
+   };
+
+   class Worker : public QThread
+   {
+   public:
+      Worker(ThreadPool& pool);
+
+   protected:
+      void run();
+
+   private:
+      ThreadPool& mPool;
+   };
+
+   void queueTask(const Task& task);
+   void runTasks(Worker* pWorker);
+   void runTask(const Task& task, QMutexLocker& lock);
+   void deleteExpiredWorkers();
+
+   const unsigned int mMaxThreads;
+   const unsigned long mIdleTimeout;
+
+   QMutex mMutex;
+   QWaitCondition mTaskAvailable;
+   QWaitCondition mTaskFinished;
+   std::deque<Task> mTasks;
+   std::set<unsigned int> mUnfinishedTasks;
+   unsigned int mNextTaskId;
+   std::vector<Worker*> mWorkers;
+   std::vector<Worker*> mExpiredWorkers;
+   unsigned int mIdleWorkers;
+   bool mStopping;
+
+   // Not implemented.
+   ThreadPool(const ThreadPool&);
+   ThreadPool& operator=(const ThreadPool&);
+};
+
+#endif
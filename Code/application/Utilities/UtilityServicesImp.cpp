@@ -512,3 +512,18 @@ string UtilityServicesImp::getTextFromFile(const string& filename)
 
    return fileStr.toStdString();
 }
+
+void UtilityServicesImp::runInThreadPool(void (*pFunction)(void*), void* pData)
+{
+   mThreadPool.run(pFunction, pData);
+}
+
+unsigned int UtilityServicesImp::startInThreadPool(void (*pFunction)(void*), void* pData)
+{
+   return mThreadPool.start(pFunction, pData);
+}
+
+void UtilityServicesImp::waitForThreadPool(unsigned int task)
+{
+   mThreadPool.wait(task);
+}
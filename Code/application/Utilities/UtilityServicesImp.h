@@ -11,6 +11,7 @@
 #define _UTILITYSERVICESIMP_H
 
 #include "UtilityServices.h"
+#include "ThreadPool.h"
 #include "TypesFile.h"
 
 #include <map>
@@ -67,10 +68,13 @@ public:
    void overrideDefaultClassification(const std::string& newClassification);
 
    virtual std::string getTextFromFile(const std::string& filename);
+   virtual void runInThreadPool(void (*pFunction)(void*), void* pData);
+   virtual unsigned int startInThreadPool(void (*pFunction)(void*), void* pData);
+   virtual void waitForThreadPool(unsigned int task);
 
 protected:
    virtual ~UtilityServicesImp() {};
-   UtilityServicesImp() {};
+   UtilityServicesImp() : mThreadPool(getNumProcessors()) {};
 
 private:
    std::map<DateTime*, DateTimeImp*> mDts;
@@ -90,6 +94,7 @@ private:
    static UtilityServicesImp* spInstance;
    static bool mDestroyed;
    std::string mClassificationOverride;
+   ThreadPool mThreadPool;
 };
 
 #endif